@@ -56,6 +56,7 @@ SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
 #include <tcpip/src/hash_fnv.h>
 #include "system/debug/sys_debug.h"
 #include "at_cmd_app.h"
+#include "at_cmd_mem.h"
 
 void ATCMD_Init(void);
 
@@ -243,6 +244,8 @@ void APP_Initialize(void) {
 
 //	ATCMD_Init();
 
+	ATCMD_MemInit();
+
 	resetCause = RCON_ResetCauseGet();
 
 	POWER_DS_ReleaseGPIO();
@@ -310,15 +313,14 @@ void APP_Initialize(void) {
 
 }
 
-void ATCMD_Update(int termPollRateMs);
-
 extern SYS_MODULE_OBJ netSrvcHdl;
 extern SYS_MODULE_OBJ netSrvcHdl;
 extern uint8_t response_buffer[];
 extern int32_t response_buffer_length;
 
+static int8_t atcmd_initialize = 0;
+
 void APP_Tasks(void) {
-    static int8_t atcmd_initialize = 0;
     
     if ((atcmd_initialize == 0) && (SYS_STATUS_READY == WDRV_PIC32MZW_Status(sysObj.drvWifiPIC32MZW1)))
     {
@@ -329,7 +331,7 @@ void APP_Tasks(void) {
    if (atcmd_initialize == 0)
         return;
  
-    ATCMD_Update(50);
+    ATCMD_Update(0);
 
     if(atCmdAppContext.respond_to_app == 2)
     {
@@ -340,6 +342,17 @@ void APP_Tasks(void) {
     return;
 }
 
+void APP_TasksWait(void) {
+    if (atcmd_initialize == 0)
+    {
+        /* Keep polling for the WiFi driver until the AT engine is up */
+        ATCMD_PlatformEventWait(AT_CMD_CONF_IDLE_UPDATE_MS);
+        return;
+    }
+
+    ATCMD_UpdateWait();
+}
+
 /*******************************************************************************
  End of File
  */
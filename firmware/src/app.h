@@ -197,6 +197,40 @@ void APP_Initialize ( void );
 
 void APP_Tasks( void );
 
+
+/*******************************************************************************
+  Function:
+    void APP_TasksWait ( void )
+
+  Summary:
+    Blocks the application task until there is work for APP_Tasks().
+
+  Description:
+    This routine sleeps until the AT command engine is signalled by the UART,
+    a socket, the MQTT service or one of its callbacks, or until the engine's
+    own polling interval runs out, whichever comes first.
+
+  Precondition:
+    None.
+
+  Parameters:
+    None.
+
+  Returns:
+    None.
+
+  Example:
+    <code>
+    APP_Tasks();
+    APP_TasksWait();
+    </code>
+
+  Remarks:
+    This routine must be called from the task running APP_Tasks().
+ */
+
+void APP_TasksWait( void );
+
 #define APP_VERSION "2.0.0"
 
 //DOM-IGNORE-BEGIN
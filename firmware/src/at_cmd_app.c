@@ -78,6 +78,14 @@ extern const AT_CMD_TYPE_DESC atCmdTypeDescSOCKTLS;
 extern const AT_CMD_TYPE_DESC atCmdTypeDescSOCKWR;
 extern const AT_CMD_TYPE_DESC atCmdTypeDescSOCKWRTO;
 extern const AT_CMD_TYPE_DESC atCmdTypeDescSOCKRD;
+extern const AT_CMD_TYPE_DESC atCmdTypeDescSOCKPM;
+extern const AT_CMD_TYPE_DESC atCmdTypeDescSOCKCR;
+extern const AT_CMD_TYPE_DESC atCmdTypeDescSOCKSTAT;
+extern const AT_CMD_TYPE_DESC atCmdTypeDescSOCKTXM;
+extern const AT_CMD_TYPE_DESC atCmdTypeDescSOCKFL;
+extern const AT_CMD_TYPE_DESC atCmdTypeDescSOCKWRB;
+extern const AT_CMD_TYPE_DESC atCmdTypeDescSOCKTXR;
+extern const AT_CMD_TYPE_DESC atCmdTypeDescSOCKC;
 extern const AT_CMD_TYPE_DESC atCmdTypeDescSOCKCL;
 extern const AT_CMD_TYPE_DESC atCmdTypeDescSOCKLST;
 extern const AT_CMD_TYPE_DESC atCmdTypeDescDNSRESOLV;
@@ -99,6 +107,7 @@ extern const AT_CMD_TYPE_DESC atCmdTypeDescMQTTPROPRX;
 extern const AT_CMD_TYPE_DESC atCmdTypeDescMQTTPROPTXS;
 #endif
 extern const AT_CMD_TYPE_DESC atCmdTypeDescTLSC;
+extern const AT_CMD_TYPE_DESC atCmdTypeDescTLSSESS;
 extern const AT_CMD_TYPE_DESC atCmdTypeDescINFO;
 extern const AT_CMD_TYPE_DESC atCmdTypeDescLOADCERT;
 extern const AT_CMD_TYPE_DESC atCmdTypeDescREADCERT;
@@ -126,6 +135,14 @@ const AT_CMD_TYPE_DESC* atCmdTypeDescTable[] =
     &atCmdTypeDescSOCKWR,
     &atCmdTypeDescSOCKWRTO,
     &atCmdTypeDescSOCKRD,
+    &atCmdTypeDescSOCKPM,
+    &atCmdTypeDescSOCKCR,
+    &atCmdTypeDescSOCKSTAT,
+    &atCmdTypeDescSOCKTXM,
+    &atCmdTypeDescSOCKFL,
+    &atCmdTypeDescSOCKWRB,
+    &atCmdTypeDescSOCKTXR,
+    &atCmdTypeDescSOCKC,
     &atCmdTypeDescSOCKCL,
     &atCmdTypeDescSOCKLST,
     &atCmdTypeDescDNSRESOLV,
@@ -139,6 +156,7 @@ const AT_CMD_TYPE_DESC* atCmdTypeDescTable[] =
     &atCmdTypeDescMQTTPUB,
     &atCmdTypeDescMQTTDISCONN,
     &atCmdTypeDescTLSC,
+    &atCmdTypeDescTLSSESS,
     &atCmdTypeDescINFO,
     &atCmdTypeDescLOADCERT,
     &atCmdTypeDescREADCERT,
@@ -187,6 +205,13 @@ static const char* statusAppCodeStr[] = {
     "Multicast Error",                          // ATCMD_APP_STATUS_MULTICAST_ERROR
     "Time Error",                               // ATCMD_APP_STATUS_TIME_ERROR
     "MQTT Error",                               // ATCMD_APP_STATUS_MQTT_ERROR
+    "Socket Not In Push Mode",                  // ATCMD_APP_STATUS_SOCKET_NOT_PUSH_MODE
+    "Socket Not Listening",                     // ATCMD_APP_STATUS_SOCKET_NOT_LISTENING
+    "Socket Memory Budget Exceeded",            // ATCMD_APP_STATUS_SOCKET_MEM_BUDGET_EXCEEDED
+    "DNS Name Not Found",                       // ATCMD_APP_STATUS_DNS_NAME_ERROR
+    "DNS Too Many Queries",                     // ATCMD_APP_STATUS_DNS_BUSY
+    "Socket Read Failed",                       // ATCMD_APP_STATUS_SOCKET_READ_FAILED
+    "DNS Watch List Full",                      // ATCMD_APP_STATUS_DNS_WATCH_FULL
 };
 
 ATCMD_APP_CONTEXT atCmdAppContext;
@@ -234,6 +259,9 @@ bool ATCMD_APPStateMachineEvent(ATCMD_APP_EVENT event, bool commit)
     {
         //ATCMD_Printf("App State (+%d): %d -> %d\r\n", event, atCmdAppContext.appState, pState->newState);
         atCmdAppContext.appState = pState->newState;
+
+        /* Commands waiting on the state change get to see it straight away */
+        ATCMD_PlatformEventSignal();
     }
 
     return true;
@@ -66,9 +66,20 @@ SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
 #define AT_CMD_WAP_DFLT_IPV4_NETMASK            ((255 << 24) | (255 << 16) | (255 << 8) | (0))
 #define AT_CMD_WAP_DFLT_IPV4_GATEWAY            ((192 << 24) | (168 << 16) | (0 << 8) | (1))
 #define AT_CMD_WAP_DFLT_IPV4_DNS_SRV1           ((192 << 24) | (168 << 16) | (0 << 8) | (1))
+#define AT_CMD_DNS_NUM_QUERIES                  8
+#define AT_CMD_DNS_QUERY_TIMEOUT_MS             5000
 #define AT_CMD_SOCK_MAX_NUM                     20 /* TODO */
-#define AT_CMD_SOCK_MAX_CLIENTS                 5
-#define AT_CMD_SOCK_RX_BUFFER_SZ                2048
+#define AT_CMD_SOCK_MAX_CLIENTS                 12
+#define AT_CMD_SOCK_DFLT_BACKLOG                5
+#define AT_CMD_SOCK_MEM_BUDGET                  (96 * 1024)
+#define AT_CMD_SOCK_TCP_BUF_MIN_SZ              512
+#define AT_CMD_SOCK_TCP_BUF_MAX_SZ              32768
+#define AT_CMD_SOCK_TLS_MEM_SZ                  (20 * 1024)
+#define AT_CMD_SOCK_RD_MAX_SZ                   65535
+#define AT_CMD_SOCK_RD_CHUNK_SZ                 512
+#define AT_CMD_SOCK_TLS_SLICE_MS                20
+#define AT_CMD_SOCK_UDP_DGRAM_MAX_SZ            1472
+#define AT_CMD_SOCK_TX_STAGE_SZ                 AT_CMD_CONF_BIN_MAX_BUFFER_SIZE
 #define AT_CMD_CERT_FILE_MAX_SZ                 1500
 #define AT_CMD_PRIKEY_FILE_MAX_SZ               2000
 #define AT_CMD_MQTT_BROKER_SZ                   64
@@ -86,6 +97,8 @@ SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
 #define AT_CMD_MQTT_USER_PROP_STORE_SZ          128
 #define AT_CMD_TLS_NUM_STATES                   2
 #define AT_CMD_TLS_NUM_CONFS                    2
+#define AT_CMD_TLS_CTX_CACHE_SZ                 4
+#define AT_CMD_TLS_SESS_CACHE_SZ                4
 #define AT_CMD_TLS_CERT_NAME_SZ                 64
 #define AT_CMD_TLS_PRIKEY_NAME_SZ               32
 #define AT_CMD_TLS_PRIKEY_PW_SZ                 32
@@ -133,6 +146,13 @@ typedef enum
     ATCMD_APP_STATUS_MULTICAST_ERROR,
     ATCMD_APP_STATUS_TIME_ERROR,
     ATCMD_APP_STATUS_MQTT_ERROR,
+    ATCMD_APP_STATUS_SOCKET_NOT_PUSH_MODE,
+    ATCMD_APP_STATUS_SOCKET_NOT_LISTENING,
+    ATCMD_APP_STATUS_SOCKET_MEM_BUDGET_EXCEEDED,
+    ATCMD_APP_STATUS_DNS_NAME_ERROR,
+    ATCMD_APP_STATUS_DNS_BUSY,
+    ATCMD_APP_STATUS_SOCKET_READ_FAILED,
+    ATCMD_APP_STATUS_DNS_WATCH_FULL,
     MAX_ATCMD_APP_STATUS
 } ATCMD_APP_STATUS;
 
@@ -301,6 +321,7 @@ typedef struct
 #ifdef WOLFSSL_ENCRYPTED_KEYS
     char                        priKeyPassword[AT_CMD_TLS_PRIKEY_PW_SZ+1+1];
 #endif
+    bool                        sessionResume;
     int                         numSessions;
 } ATCMD_APP_TLS_CONF;
 
@@ -410,6 +431,15 @@ ATCMD_APP_STATE ATCMD_APPStateMachineCurrentState(void);
 ATCMD_STATUS ATCMD_WAP_Start(bool activeProvisioning);
 ATCMD_STATUS ATCMD_WAP_Stop(void);
 
+/* Called when a name resolution started by ATCMD_DNS_Resolve completes,
+   status is ATCMD_STATUS_OK with the IPv4 addresses or an AEC status code */
+typedef void (*ATCMD_DNS_CALLBACK)(const char *pName, ATCMD_STATUS status, const IPV4_ADDR *pAddrs, int numAddrs, const void *param);
+
+ATCMD_STATUS ATCMD_DNS_Resolve(const char *pName, ATCMD_DNS_CALLBACK callback, const void *param);
+void ATCMD_DNS_Cancel(ATCMD_DNS_CALLBACK callback, const void *param);
+ATCMD_STATUS ATCMD_DNS_Watch(const char *pName, bool *pWatched);
+void ATCMD_DNS_Unwatch(const char *pName, bool *pWatched);
+
 void ATCMD_PING_Callback(uint32_t ipAddress, uint32_t rtt, uint8_t errorCode);
 
 #endif /* _AT_CMD_APP_H */
@@ -31,6 +31,9 @@
 
 #include "include/at_cmds.h"
 #include "platform/platform.h"
+#ifdef AT_CMD_INCLUDE_FRAME_SUPPORT
+#include "at_cmd_frame.h"
+#endif
 
 static bool binaryMode;
 static int escapeCharCnt;
@@ -54,8 +57,15 @@ void ATCMD_BinaryInit(void)
  *****************************************************************************/
 void ATCMD_EnterBinaryMode(tpfATCMDBinaryDataHandler pBinDataHandler)
 {
+    /* Anything the command printed must go out ahead of the prompt */
+    ATCMD_PrintFlush();
+
 #ifdef AT_CMD_CONF_BIN_MODE_USE_PROMPT
+#ifdef AT_CMD_INCLUDE_FRAME_SUPPORT
+    if ((false == binaryMode) && (false == ATCMD_FrameModeIsActive()))
+#else
     if (false == binaryMode)
+#endif
         ATCMD_PlatformUARTWritePutByte(AT_CMD_CONF_BIN_MODE_PROMPT_CHAR);
 #endif
 
@@ -132,6 +142,8 @@ bool ATCMD_BinaryProcess(void)
             
             numBufBytes = 0;
             
+            /* The handler may have staged a response, keep it ahead of the line end */
+            ATCMD_PrintFlush();
             ATCMD_PlatformUARTWritePutBuffer("\r\n", 2);
 
             ATCMD_LeaveBinaryMode();
@@ -223,6 +235,7 @@ bool ATCMD_BinaryProcess(void)
 
         if ((curTimeMs - escapeCharLastTimeMs) > AT_CMD_CONF_BIN_ESCAPE_FINAL_TIMEOUT)
         {
+            ATCMD_PrintFlush();
             ATCMD_PlatformUARTWritePutBuffer("\r\n", 2);
 
             ATCMD_LeaveBinaryMode();
@@ -235,3 +248,46 @@ bool ATCMD_BinaryProcess(void)
 
     return true;
 }
+
+#ifdef AT_CMD_INCLUDE_FRAME_SUPPORT
+/*****************************************************************************
+ * Process a block of binary mode data received in a frame, no escape
+ * sequence or guard times apply
+ *****************************************************************************/
+void ATCMD_BinaryProcessFrame(const uint8_t *pBuf, size_t numBufBytes)
+{
+    if (0 != g_binModeNumBytes)
+    {
+        /* Fixed length transfer, all the data must arrive in a single frame */
+
+        if (numBufBytes != g_binModeNumBytes)
+        {
+            g_binModeNumBytes = 0;
+
+            ATCMD_LeaveBinaryMode();
+
+            ATCMD_ReportStatus(ATCMD_STATUS_INVALID_PARAMETER);
+
+            return;
+        }
+
+        if (NULL != pfBinaryDataHandler)
+            pfBinaryDataHandler(pBuf, numBufBytes);
+
+        g_binModeNumBytes = 0;
+    }
+    else if (numBufBytes > 0)
+    {
+        /* Open ended transfer, stay in binary mode until an empty frame arrives */
+
+        if (NULL != pfBinaryDataHandler)
+            pfBinaryDataHandler(pBuf, numBufBytes);
+
+        return;
+    }
+
+    ATCMD_LeaveBinaryMode();
+
+    ATCMD_ReportStatus(ATCMD_STATUS_OK);
+}
+#endif
@@ -0,0 +1,461 @@
+/**
+ *
+ * Copyright (c) 2019 Microchip Technology Inc. and its subsidiaries.
+ *
+ * Subject to your compliance with these terms, you may use Microchip
+ * software and any derivatives exclusively with Microchip products.
+ * It is your responsibility to comply with third party license terms applicable
+ * to your use of third party software (including open source software) that
+ * may accompany Microchip software.
+ *
+ * THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES,
+ * WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE,
+ * INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY,
+ * AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE
+ * LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL
+ * LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE
+ * SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE
+ * POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT
+ * ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY
+ * RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+ * THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+ *
+ */
+/*
+ * Support and FAQ: visit <a href="https://www.microchip.com/support/">Microchip Support</a>
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "include/at_cmds.h"
+#include "platform/platform.h"
+#include "at_cmd_parser.h"
+#include "at_cmd_frame.h"
+
+#define ATCMD_FRAME_MAX_NAME_LEN    32
+
+extern const AT_CMD_TYPE_DESC* pCurrentCmdTypeDesc;
+
+static bool frameMode;
+static uint8_t rxFrame[ATCMD_FRAME_HDR_SZ + AT_CMD_CONF_FRAME_MAX_BODY_SIZE + ATCMD_FRAME_CRC_SZ];
+static size_t rxFrameLength;
+static size_t rxFrameExpected;
+static uint32_t rxLastTimeMs;
+/* Response and AEC output is assembled in place between the header and CRC,
+   both are only accessed with the print lock held */
+static uint8_t txFrame[ATCMD_FRAME_HDR_SZ + AT_CMD_CONF_FRAME_TX_BUFFER_SIZE + ATCMD_FRAME_CRC_SZ];
+static size_t txBodyLength;
+static uint8_t txFrameType;
+static uint8_t reqCmdId;
+
+/*****************************************************************************
+ * Update a CRC-16/XMODEM with a block of bytes
+ *****************************************************************************/
+static uint16_t _FrameCRC16(uint16_t crc16, const uint8_t *pBuf, size_t numBufBytes)
+{
+    uint8_t i;
+
+    while (numBufBytes--)
+    {
+        crc16 ^= ((uint16_t)*pBuf++)<<8;
+        for(i=0; i<8; i++)
+        {
+            if(crc16 & 0x8000)
+            {
+                crc16 <<= 1;
+                crc16 ^= 0x1021;
+            }
+            else
+            {
+                crc16 <<= 1;
+            }
+        }
+    }
+
+    return crc16;
+}
+
+/*****************************************************************************
+ * Fill in the header and CRC around a body already placed in the frame and
+ * send it in one write, the caller holds the print lock
+ *****************************************************************************/
+static void _FrameWrite(uint8_t *pFrame, uint8_t type, uint8_t cmdId, size_t bodyLength)
+{
+    uint16_t crc16;
+
+    pFrame[0] = ATCMD_FRAME_SOF;
+    pFrame[1] = type;
+    pFrame[2] = cmdId;
+    pFrame[3] = (uint8_t)(bodyLength >> 8);
+    pFrame[4] = (uint8_t)bodyLength;
+
+    crc16 = _FrameCRC16(0, &pFrame[1], ATCMD_FRAME_HDR_SZ-1+bodyLength);
+
+    pFrame[ATCMD_FRAME_HDR_SZ+bodyLength]   = (uint8_t)(crc16 >> 8);
+    pFrame[ATCMD_FRAME_HDR_SZ+bodyLength+1] = (uint8_t)crc16;
+
+    ATCMD_PlatformUARTWritePutBuffer(pFrame, ATCMD_FRAME_HDR_SZ+bodyLength+ATCMD_FRAME_CRC_SZ);
+}
+
+/*****************************************************************************
+ * Send any buffered response or AEC output, the caller holds the print lock
+ *****************************************************************************/
+static void _FrameFlush(void)
+{
+    if (0 == txBodyLength)
+    {
+        return;
+    }
+
+    ATCMD_PrintMirror(&txFrame[ATCMD_FRAME_HDR_SZ], txBodyLength);
+
+    if (ATCMD_FRAME_TYPE_AEC == txFrameType)
+    {
+        _FrameWrite(txFrame, ATCMD_FRAME_TYPE_AEC, ATCMD_FRAME_CMD_ID_NONE, txBodyLength);
+    }
+    else
+    {
+        _FrameWrite(txFrame, ATCMD_FRAME_TYPE_RESPONSE, reqCmdId, txBodyLength);
+    }
+
+    txBodyLength = 0;
+}
+
+/*****************************************************************************
+ * Send a frame from the AT task, optionally after the buffered output
+ *****************************************************************************/
+static void _FrameSend(uint8_t *pFrame, uint8_t type, uint8_t cmdId, size_t bodyLength, bool flushOutput)
+{
+    bool locked;
+
+    /* Anything staged before framing started goes out first */
+    ATCMD_PrintFlush();
+
+    locked = ATCMD_PlatformPrintLock();
+
+    if (true == flushOutput)
+    {
+        _FrameFlush();
+    }
+
+    _FrameWrite(pFrame, type, cmdId, bodyLength);
+
+    if (true == locked)
+    {
+        ATCMD_PlatformPrintUnlock();
+    }
+}
+
+/*****************************************************************************
+ * Send a frame without a body
+ *****************************************************************************/
+static void _FrameSendNAK(uint8_t rejectedType)
+{
+    uint8_t frame[ATCMD_FRAME_HDR_SZ + ATCMD_FRAME_CRC_SZ];
+
+    _FrameSend(frame, ATCMD_FRAME_TYPE_NAK, rejectedType, 0, false);
+}
+
+/*****************************************************************************
+ * Send any buffered response or AEC output from the AT task
+ *****************************************************************************/
+static void _FrameFlushLocked(void)
+{
+    bool locked = ATCMD_PlatformPrintLock();
+
+    _FrameFlush();
+
+    if (true == locked)
+    {
+        ATCMD_PlatformPrintUnlock();
+    }
+}
+
+/*****************************************************************************
+ * Reply to a command name lookup, the reply reuses the received frame which
+ * has room for the header and CRC around the body
+ *****************************************************************************/
+static void _FrameLookup(uint8_t *pBody, size_t bodyLength)
+{
+    char cmdName[ATCMD_FRAME_MAX_NAME_LEN+1];
+    int cmdID = -1;
+
+    if (bodyLength <= ATCMD_FRAME_MAX_NAME_LEN)
+    {
+        memcpy(cmdName, pBody, bodyLength);
+        cmdName[bodyLength] = '\0';
+
+        cmdID = ATCMD_ParserGetCmdID(cmdName);
+    }
+
+    if ((cmdID < 0) || (cmdID >= ATCMD_FRAME_CMD_ID_NONE))
+    {
+        cmdID = ATCMD_FRAME_CMD_ID_NONE;
+    }
+
+    _FrameSend(pBody - ATCMD_FRAME_HDR_SZ, ATCMD_FRAME_TYPE_LOOKUP, (uint8_t)cmdID, bodyLength, false);
+}
+
+/*****************************************************************************
+ * Act on a received frame, returns true if a request was dispatched
+ *****************************************************************************/
+static bool _FrameDispatch(uint8_t type, uint8_t cmdId, uint8_t *pBody, size_t bodyLength)
+{
+    switch (type)
+    {
+        case ATCMD_FRAME_TYPE_REQUEST:
+        {
+            if (true == ATCMD_ModeIsBinary())
+            {
+                break;
+            }
+
+            _FrameFlushLocked();
+
+            reqCmdId = cmdId;
+
+            ATCMD_LeaveAECMode();
+            ATCMD_ParseCommandFrame(cmdId, pBody, bodyLength);
+
+            return true;
+        }
+
+        case ATCMD_FRAME_TYPE_DATA:
+        {
+            if (false == ATCMD_ModeIsBinary())
+            {
+                break;
+            }
+
+            ATCMD_BinaryProcessFrame(pBody, bodyLength);
+
+            return false;
+        }
+
+        case ATCMD_FRAME_TYPE_LOOKUP:
+        {
+            _FrameLookup(pBody, bodyLength);
+
+            return false;
+        }
+
+        default:
+        {
+            break;
+        }
+    }
+
+    _FrameSendNAK(type);
+
+    return false;
+}
+
+/*****************************************************************************
+ * Initialise framed mode
+ *****************************************************************************/
+void ATCMD_FrameInit(void)
+{
+    frameMode = false;
+}
+
+/*****************************************************************************
+ * Return if the host interface is currently framed
+ *****************************************************************************/
+bool ATCMD_FrameModeIsActive(void)
+{
+    return frameMode;
+}
+
+/*****************************************************************************
+ * Change the host interface to framed mode
+ *****************************************************************************/
+void ATCMD_FrameEnter(void)
+{
+    bool locked = ATCMD_PlatformPrintLock();
+
+    frameMode       = true;
+    rxFrameLength   = 0;
+    txBodyLength    = 0;
+    reqCmdId        = ATCMD_FRAME_CMD_ID_NONE;
+
+    if (true == locked)
+    {
+        ATCMD_PlatformPrintUnlock();
+    }
+}
+
+/*****************************************************************************
+ * Change the host interface back to the line editor
+ *****************************************************************************/
+void ATCMD_FrameLeave(void)
+{
+    bool locked = ATCMD_PlatformPrintLock();
+
+    _FrameFlush();
+
+    frameMode = false;
+
+    if (true == locked)
+    {
+        ATCMD_PlatformPrintUnlock();
+    }
+}
+
+/*****************************************************************************
+ * Process UART data in framed mode
+ *****************************************************************************/
+bool ATCMD_FrameProcess(void)
+{
+    uint32_t curTimeMs;
+    size_t numBytes;
+    bool reqDispatched = false;
+
+    curTimeMs = ATCMD_PlatformGetSysTimeMs();
+
+    if ((rxFrameLength > 0) && ((curTimeMs - rxLastTimeMs) > AT_CMD_CONF_FRAME_RX_TIMEOUT_MS))
+    {
+        /* Drop a stalled partial frame and hunt for the next SOF */
+
+        rxFrameLength = 0;
+    }
+
+    /* Requests are executed one at a time, leave further input in the UART
+       buffer until the current one has completed */
+
+    while ((NULL == pCurrentCmdTypeDesc) || (true == ATCMD_ModeIsBinary()))
+    {
+        if (0 == rxFrameLength)
+        {
+            do
+            {
+                if (0 == ATCMD_PlatformUARTReadGetCount())
+                {
+                    return reqDispatched;
+                }
+
+                rxFrame[0] = ATCMD_PlatformUARTReadGetByte();
+            }
+            while (ATCMD_FRAME_SOF != rxFrame[0]);
+
+            rxFrameLength   = 1;
+            rxFrameExpected = ATCMD_FRAME_HDR_SZ;
+            rxLastTimeMs    = curTimeMs;
+        }
+
+        numBytes = ATCMD_PlatformUARTReadGetBuffer(&rxFrame[rxFrameLength], rxFrameExpected - rxFrameLength);
+
+        if (numBytes > 0)
+        {
+            rxFrameLength += numBytes;
+            rxLastTimeMs   = curTimeMs;
+        }
+
+        if (rxFrameLength < rxFrameExpected)
+        {
+            break;
+        }
+
+        if (ATCMD_FRAME_HDR_SZ == rxFrameExpected)
+        {
+            size_t bodyLength;
+
+            bodyLength = ((size_t)rxFrame[3] << 8) | rxFrame[4];
+
+            if (bodyLength > AT_CMD_CONF_FRAME_MAX_BODY_SIZE)
+            {
+                _FrameSendNAK(rxFrame[1]);
+                rxFrameLength = 0;
+            }
+            else
+            {
+                rxFrameExpected = ATCMD_FRAME_HDR_SZ + bodyLength + ATCMD_FRAME_CRC_SZ;
+            }
+
+            continue;
+        }
+
+        rxFrameLength = 0;
+
+        numBytes = rxFrameExpected - ATCMD_FRAME_HDR_SZ - ATCMD_FRAME_CRC_SZ;
+
+        if (_FrameCRC16(0, &rxFrame[1], rxFrameExpected - 1) != 0)
+        {
+            /* Running the CRC over the received CRC leaves zero for a good frame */
+
+            _FrameSendNAK(rxFrame[1]);
+            continue;
+        }
+
+        if (true == _FrameDispatch(rxFrame[1], rxFrame[2], &rxFrame[ATCMD_FRAME_HDR_SZ], numBytes))
+        {
+            reqDispatched = true;
+        }
+    }
+
+    return reqDispatched;
+}
+
+/*****************************************************************************
+ * Buffer output into response or AEC frames, a frame is sent at the end of
+ * each line or when the buffer fills. Any task may print, the print lock is
+ * held from buffering to sending so frames are never mixed or interleaved
+ *****************************************************************************/
+void ATCMD_FramePrint(bool isAEC, const char *pMsg, size_t msgLength)
+{
+    uint8_t type;
+    bool locked;
+
+    type = (true == isAEC) ? ATCMD_FRAME_TYPE_AEC : ATCMD_FRAME_TYPE_RESPONSE;
+
+    locked = ATCMD_PlatformPrintLock();
+
+    if ((txBodyLength > 0) && (type != txFrameType))
+    {
+        _FrameFlush();
+    }
+
+    txFrameType = type;
+
+    while (msgLength > 0)
+    {
+        size_t numBytes;
+
+        numBytes = AT_CMD_CONF_FRAME_TX_BUFFER_SIZE - txBodyLength;
+
+        if (numBytes > msgLength)
+        {
+            numBytes = msgLength;
+        }
+
+        memcpy(&txFrame[ATCMD_FRAME_HDR_SZ+txBodyLength], pMsg, numBytes);
+
+        txBodyLength += numBytes;
+        pMsg         += numBytes;
+        msgLength    -= numBytes;
+
+        if ((AT_CMD_CONF_FRAME_TX_BUFFER_SIZE == txBodyLength) || ((0 == msgLength) && ('\n' == pMsg[-1])))
+        {
+            _FrameFlush();
+        }
+    }
+
+    if (true == locked)
+    {
+        ATCMD_PlatformPrintUnlock();
+    }
+}
+
+/*****************************************************************************
+ * Send the final status of the current request
+ *****************************************************************************/
+void ATCMD_FrameReportStatus(const ATCMD_STATUS statusCode)
+{
+    uint8_t frame[ATCMD_FRAME_HDR_SZ + 2 + ATCMD_FRAME_CRC_SZ];
+
+    frame[ATCMD_FRAME_HDR_SZ]   = (uint8_t)((uint16_t)statusCode >> 8);
+    frame[ATCMD_FRAME_HDR_SZ+1] = (uint8_t)statusCode;
+
+    _FrameSend(frame, ATCMD_FRAME_TYPE_STATUS, reqCmdId, 2, true);
+}
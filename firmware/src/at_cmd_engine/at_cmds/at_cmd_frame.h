@@ -0,0 +1,77 @@
+/**
+ *
+ * Copyright (c) 2019 Microchip Technology Inc. and its subsidiaries.
+ *
+ * Subject to your compliance with these terms, you may use Microchip
+ * software and any derivatives exclusively with Microchip products.
+ * It is your responsibility to comply with third party license terms applicable
+ * to your use of third party software (including open source software) that
+ * may accompany Microchip software.
+ *
+ * THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES,
+ * WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE,
+ * INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY,
+ * AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE
+ * LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL
+ * LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE
+ * SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE
+ * POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT
+ * ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY
+ * RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+ * THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+ *
+ */
+/*
+ * Support and FAQ: visit <a href="https://www.microchip.com/support/">Microchip Support</a>
+ */
+
+#ifndef _AT_CMD_FRAME_H
+#define _AT_CMD_FRAME_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "include/at_cmds.h"
+
+/* Frame layout, multi-byte fields are big endian:
+
+     SOF | TYPE | CMD_ID | LENGTH (2) | BODY (LENGTH) | CRC16 (2)
+
+   The CRC is CRC-16/XMODEM over TYPE to the end of BODY. REQUEST bodies hold
+   the command parameters as TLVs, a one byte ATCMD_PARAM_TYPE, a two byte length
+   and the value; integers are always four bytes. */
+
+#define ATCMD_FRAME_SOF             0xa5
+#define ATCMD_FRAME_HDR_SZ          5
+#define ATCMD_FRAME_CRC_SZ          2
+#define ATCMD_FRAME_CMD_ID_NONE     0xff
+
+typedef enum
+{
+    ATCMD_FRAME_TYPE_REQUEST    = 1,    /* Host: command ID and TLV parameters */
+    ATCMD_FRAME_TYPE_RESPONSE,          /* Device: output of the request in progress */
+    ATCMD_FRAME_TYPE_AEC,               /* Device: asynchronous event output */
+    ATCMD_FRAME_TYPE_STATUS,            /* Device: final status of a request, two byte status code */
+    ATCMD_FRAME_TYPE_DATA,              /* Host: raw binary mode payload, empty frame ends binary mode */
+    ATCMD_FRAME_TYPE_LOOKUP,            /* Both: command name, reply carries its command ID */
+    ATCMD_FRAME_TYPE_NAK                /* Device: frame rejected, CMD_ID holds the rejected type */
+} ATCMD_FRAME_TYPE;
+
+#ifdef __cplusplus  // Provide C++ Compatibility
+extern "C" {
+#endif
+
+void ATCMD_FrameInit(void);
+bool ATCMD_FrameModeIsActive(void);
+void ATCMD_FrameEnter(void);
+void ATCMD_FrameLeave(void);
+bool ATCMD_FrameProcess(void);
+void ATCMD_FramePrint(bool isAEC, const char *pMsg, size_t msgLength);
+void ATCMD_FrameReportStatus(const ATCMD_STATUS statusCode);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _AT_CMD_FRAME_H */
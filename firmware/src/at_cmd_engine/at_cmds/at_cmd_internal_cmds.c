@@ -29,6 +29,9 @@
 
 #include "include/at_cmds.h"
 #include "at_cmd_app.h"
+#ifdef AT_CMD_INCLUDE_FRAME_SUPPORT
+#include "at_cmd_frame.h"
+#endif
 
 /*******************************************************************************
 * Command interface prototypes
@@ -43,6 +46,17 @@ static ATCMD_STATUS _InternalCmdUpdate(const AT_CMD_TYPE_DESC* pCmdTypeDesc, con
 static const ATCMD_HELP_PARAM paramBAUD_RATE =
     {"BAUD_RATE", "Baud rate", ATCMD_PARAM_TYPE_CLASS_INTEGER, 0};
 
+#ifdef AT_CMD_INCLUDE_FRAME_SUPPORT
+static const ATCMD_HELP_PARAM paramFRAME_MODE =
+    {"MODE", "Host interface mode", ATCMD_PARAM_TYPE_CLASS_INTEGER,
+        .numOpts = 2,
+        {
+            {"0", "Line mode"},
+            {"1", "Framed mode"}
+        }
+    };
+#endif
+
 /*******************************************************************************
 * Command examples
 *******************************************************************************/
@@ -169,6 +183,45 @@ const AT_CMD_TYPE_DESC atCmdTypeDescIPR =
         }
     };
 
+#ifdef AT_CMD_INCLUDE_FRAME_SUPPORT
+const AT_CMD_TYPE_DESC atCmdTypeDescFRM =
+    {
+        .pCmdName   = "+FRM",
+        .cmdInit    = _InternalCmdInit,
+        .cmdExecute = _InternalCmdExecute,
+        .cmdUpdate  = _InternalCmdUpdate,
+        .pSummary   = "This command switches the host interface between line and framed mode",
+        .appVal     = ATCMD_INT_APP_VAL_FRM,
+        .numVars    = 2,
+        {
+            {
+                .numParams   = 0,
+                .pParams     =
+                {
+                    NULL
+                },
+                .numExamples = 0,
+                .pExamples   =
+                {
+                    NULL
+                }
+            },
+            {
+                .numParams   = 1,
+                .pParams     =
+                {
+                    &paramFRAME_MODE
+                },
+                .numExamples = 0,
+                .pExamples   =
+                {
+                    NULL
+                }
+            }
+        }
+    };
+#endif
+
 /*******************************************************************************
 * External references
 *******************************************************************************/
@@ -180,6 +233,9 @@ const AT_CMD_TYPE_DESC atCmdTypeDescIPR =
 * Local data
 *******************************************************************************/
 uint32_t newBaudRate;
+#ifdef AT_CMD_INCLUDE_FRAME_SUPPORT
+static int newFrameMode;
+#endif
 
 /*******************************************************************************
 * Local functions
@@ -191,6 +247,9 @@ uint32_t newBaudRate;
 static ATCMD_STATUS _InternalCmdInit(const AT_CMD_TYPE_DESC* pCmdTypeDesc)
 {
     newBaudRate = 0;
+#ifdef AT_CMD_INCLUDE_FRAME_SUPPORT
+    newFrameMode = -1;
+#endif
 
     return ATCMD_STATUS_OK;
 }
@@ -306,6 +365,38 @@ static ATCMD_STATUS _InternalCmdExecute(const AT_CMD_TYPE_DESC* pCmdTypeDesc, co
             break;
         }
 
+#ifdef AT_CMD_INCLUDE_FRAME_SUPPORT
+        case ATCMD_INT_APP_VAL_FRM:
+        {
+            if (0 == numParams)
+            {
+                ATCMD_Printf("+FRM:%d\r\n", (true == ATCMD_FrameModeIsActive()) ? 1 : 0);
+            }
+            else if (1 == numParams)
+            {
+                if (false == ATCMD_ParamValidateTypes(pCmdTypeDesc, 1, numParams, pParamList))
+                {
+                    return ATCMD_STATUS_INVALID_PARAMETER;
+                }
+
+                if ((pParamList[0].value.i < 0) || (pParamList[0].value.i > 1))
+                {
+                    return ATCMD_STATUS_INVALID_PARAMETER;
+                }
+
+                /* Switch over once the status has been sent in the current mode */
+
+                newFrameMode = pParamList[0].value.i;
+            }
+            else
+            {
+                return ATCMD_STATUS_INCORRECT_NUM_PARAMS;
+            }
+
+            break;
+        }
+#endif
+
         default:
         {
             return ATCMD_STATUS_INVALID_CMD;
@@ -334,8 +425,29 @@ static ATCMD_STATUS _InternalCmdUpdate(const AT_CMD_TYPE_DESC* pCmdTypeDesc, con
 
             break;
         }
+
+#ifdef AT_CMD_INCLUDE_FRAME_SUPPORT
+        case ATCMD_INT_APP_VAL_FRM:
+        {
+            if (1 == newFrameMode)
+            {
+                ATCMD_FrameEnter();
+            }
+            else if (0 == newFrameMode)
+            {
+                ATCMD_FrameLeave();
+            }
+
+            newFrameMode = -1;
+
+            break;
+        }
+#endif
     }
 
+    /* Only ever acts on a command just executed */
+    ATCMD_UpdateSetPending(pCmdTypeDesc, false);
+
     return ATCMD_STATUS_OK;
 }
 
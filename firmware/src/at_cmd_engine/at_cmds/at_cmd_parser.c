@@ -46,6 +46,9 @@ extern const AT_CMD_TYPE_DESC atCmdTypeDescGMM;
 extern const AT_CMD_TYPE_DESC atCmdTypeDescGMR;
 #endif
 extern const AT_CMD_TYPE_DESC atCmdTypeDescIPR;
+#ifdef AT_CMD_INCLUDE_FRAME_SUPPORT
+extern const AT_CMD_TYPE_DESC atCmdTypeDescFRM;
+#endif
 
 const AT_CMD_TYPE_DESC* atCmdTypeDescTableInt[] =
 {
@@ -59,11 +62,18 @@ const AT_CMD_TYPE_DESC* atCmdTypeDescTableInt[] =
     &atCmdTypeDescGMR,
 #endif
     &atCmdTypeDescIPR,
+#ifdef AT_CMD_INCLUDE_FRAME_SUPPORT
+    &atCmdTypeDescFRM,
+#endif
     NULL,
 };
 
 extern const AT_CMD_TYPE_DESC* pCurrentCmdTypeDesc;
 
+/* Both command tables sorted by name, -1 if they did not fit */
+static const AT_CMD_TYPE_DESC* cmdIndex[AT_CMD_CONF_MAX_CMD_TYPES];
+static int numCmdIndex = -1;
+
 /*****************************************************************************
  * Convert a char representation of a digit into a number
  *****************************************************************************/
@@ -140,6 +150,151 @@ static const AT_CMD_TYPE_DESC* _FindCmdDesc(const AT_CMD_TYPE_DESC **pCmdTableEn
     return NULL;
 }
 
+/*****************************************************************************
+ * Find the position of a command name in the sorted index, or where it
+ * would be inserted
+ *****************************************************************************/
+static int _FindCmdIndexPos(const char *pCmd, bool *pFound)
+{
+    int low  = 0;
+    int high = numCmdIndex;
+
+    *pFound = false;
+
+    while (low < high)
+    {
+        int mid = (low + high) >> 1;
+        int cmp = strcmp(cmdIndex[mid]->pCmdName, pCmd);
+
+        if (0 == cmp)
+        {
+            *pFound = true;
+            return mid;
+        }
+
+        if (cmp < 0)
+        {
+            low = mid + 1;
+        }
+        else
+        {
+            high = mid;
+        }
+    }
+
+    return low;
+}
+
+/*****************************************************************************
+ * Add a command table to the sorted index, earlier entries win on duplicates
+ *****************************************************************************/
+static bool _AddCmdIndexTable(const AT_CMD_TYPE_DESC **pCmdTableEntry)
+{
+    while (NULL != *pCmdTableEntry)
+    {
+        if (NULL != (*pCmdTableEntry)->pCmdName)
+        {
+            bool found;
+            int pos;
+
+            pos = _FindCmdIndexPos((*pCmdTableEntry)->pCmdName, &found);
+
+            if (false == found)
+            {
+                if (numCmdIndex >= AT_CMD_CONF_MAX_CMD_TYPES)
+                {
+                    return false;
+                }
+
+                memmove(&cmdIndex[pos+1], &cmdIndex[pos], (numCmdIndex - pos) * sizeof(cmdIndex[0]));
+
+                cmdIndex[pos] = *pCmdTableEntry;
+                numCmdIndex++;
+            }
+        }
+
+        pCmdTableEntry++;
+    }
+
+    return true;
+}
+
+/*****************************************************************************
+ * Translate command string into the command descriptor, searching the
+ * application commands before the internal ones
+ *****************************************************************************/
+static const AT_CMD_TYPE_DESC* _LookupCmdDesc(const char *pCmd)
+{
+    const AT_CMD_TYPE_DESC *pCmdTypeDesc;
+    bool found;
+    int pos;
+
+    if (NULL == pCmd)
+    {
+        return NULL;
+    }
+
+    if (numCmdIndex < 0)
+    {
+        /* Index could not be built, fall back to scanning the tables */
+
+        pCmdTypeDesc = _FindCmdDesc(atCmdTypeDescTable, pCmd);
+
+        if (NULL == pCmdTypeDesc)
+        {
+            pCmdTypeDesc = _FindCmdDesc(atCmdTypeDescTableInt, pCmd);
+        }
+
+        return pCmdTypeDesc;
+    }
+
+    pos = _FindCmdIndexPos(pCmd, &found);
+
+    if (false == found)
+    {
+        return NULL;
+    }
+
+    return cmdIndex[pos];
+}
+
+/*****************************************************************************
+ * Build the sorted command index
+ *****************************************************************************/
+void ATCMD_ParserInit(void)
+{
+    numCmdIndex = 0;
+
+    if ((false == _AddCmdIndexTable(atCmdTypeDescTable)) || (false == _AddCmdIndexTable(atCmdTypeDescTableInt)))
+    {
+        numCmdIndex = -1;
+    }
+}
+
+/*****************************************************************************
+ * Translate a command name into its position in the sorted index, the ID
+ * used by framed requests
+ *****************************************************************************/
+int ATCMD_ParserGetCmdID(const char *pCmd)
+{
+    bool found;
+    int pos;
+
+    if ((NULL == pCmd) || (numCmdIndex < 0))
+    {
+        return -1;
+    }
+
+    pos = _FindCmdIndexPos(pCmd, &found);
+
+    if (false == found)
+    {
+        return -1;
+    }
+
+    return pos;
+}
+
 /*****************************************************************************
  * Execute the command
  *****************************************************************************/
@@ -156,6 +311,9 @@ static bool _ExecuteCommand(const AT_CMD_TYPE_DESC* pCmdTypeDesc, int numParams,
 
         pCurrentCmdTypeDesc = pCmdTypeDesc;
 
+        /* Make sure the command's update function runs while it is in progress */
+        ATCMD_UpdateSetPending(pCmdTypeDesc, true);
+
         status = pCmdTypeDesc->cmdExecute(pCmdTypeDesc, numParams, pParamList);
 
         if (ATCMD_STATUS_PENDING != status)
@@ -658,27 +816,22 @@ bool ATCMD_ParseCommandLine(char *pCmdLine)
     }
 
     /* Translate CMD field. */
-    pCmdTypeDesc = _FindCmdDesc(atCmdTypeDescTable, pCmdName);
+    pCmdTypeDesc = _LookupCmdDesc(pCmdName);
 
     if (NULL == pCmdTypeDesc)
     {
-        pCmdTypeDesc = _FindCmdDesc(atCmdTypeDescTableInt, pCmdName);
-
-        if (NULL == pCmdTypeDesc)
+        if (true == _ExecuteInternalCommand(pCmdName))
         {
-            if (true == _ExecuteInternalCommand(pCmdName))
-            {
-                ATCMD_ReportStatus(ATCMD_STATUS_OK);
+            ATCMD_ReportStatus(ATCMD_STATUS_OK);
 
-                return true;
-            }
-            else
-            {
-                /* Unknown CMD field found. */
-                ATCMD_ReportStatus(ATCMD_STATUS_UNKNOWN_CMD);
+            return true;
+        }
+        else
+        {
+            /* Unknown CMD field found. */
+            ATCMD_ReportStatus(ATCMD_STATUS_UNKNOWN_CMD);
 
-                return false;
-            }
+            return false;
         }
     }
 
@@ -739,6 +892,88 @@ bool ATCMD_ParseCommandLine(char *pCmdLine)
     return true;
 }
 
+/*****************************************************************************
+ * Execute a command received as a frame with TLV encoded parameters
+ *****************************************************************************/
+bool ATCMD_ParseCommandFrame(int cmdID, uint8_t *pParams, size_t paramsLength)
+{
+    ATCMD_PARAM params[AT_CMD_MAX_NUM_PARAMS];
+    int numParams = 0;
+
+    if ((cmdID < 0) || (cmdID >= numCmdIndex))
+    {
+        ATCMD_ReportStatus(ATCMD_STATUS_UNKNOWN_CMD);
+        return false;
+    }
+
+    while (paramsLength > 0)
+    {
+        uint8_t *pValue;
+        size_t length;
+
+        if ((paramsLength < 3) || (AT_CMD_MAX_NUM_PARAMS == numParams))
+        {
+            ATCMD_ReportStatus(ATCMD_STATUS_INCORRECT_NUM_PARAMS);
+            return false;
+        }
+
+        length = ((size_t)pParams[1] << 8) | pParams[2];
+
+        if (length > (paramsLength - 3))
+        {
+            ATCMD_ReportStatus(ATCMD_STATUS_INVALID_PARAMETER);
+            return false;
+        }
+
+        pValue = &pParams[3];
+
+        params[numParams].type = (ATCMD_PARAM_TYPE)pParams[0];
+
+        switch (pParams[0])
+        {
+            case ATCMD_PARAM_TYPE_INTEGER:
+            {
+                if (4 != length)
+                {
+                    ATCMD_ReportStatus(ATCMD_STATUS_INVALID_PARAMETER);
+                    return false;
+                }
+
+                params[numParams].value.u = ((uint32_t)pValue[0] << 24) | ((uint32_t)pValue[1] << 16) | ((uint32_t)pValue[2] << 8) | pValue[3];
+                params[numParams].length  = 1;
+                break;
+            }
+
+            case ATCMD_PARAM_TYPE_ASCII_STRING:
+            case ATCMD_PARAM_TYPE_HEX_STRING:
+            {
+                /* Slide the value over its TLV header so it can be null
+                   terminated in place, as the line parser does */
+
+                memmove(pParams, pValue, length);
+                pParams[length] = '\0';
+
+                params[numParams].value.p = pParams;
+                params[numParams].length  = length;
+                break;
+            }
+
+            default:
+            {
+                ATCMD_ReportStatus(ATCMD_STATUS_INVALID_PARAMETER);
+                return false;
+            }
+        }
+
+        numParams++;
+
+        pParams      += 3 + length;
+        paramsLength -= 3 + length;
+    }
+
+    return _ExecuteCommand(cmdIndex[cmdID], numParams, params);
+}
+
 /*****************************************************************************
  * Validate parameter list against the command variant descriptor
  *****************************************************************************/
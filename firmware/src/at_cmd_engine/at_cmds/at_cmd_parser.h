@@ -32,8 +32,11 @@
 extern "C" {
 #endif
 
+void ATCMD_ParserInit(void);
 uint16_t ATCMD_HexStringToBytes(const char *pStr, uint16_t strLength, uint8_t *pBytes);
 bool ATCMD_ParseCommandLine(char *pCmdLine);
+int ATCMD_ParserGetCmdID(const char *pCmd);
+bool ATCMD_ParseCommandFrame(int cmdID, uint8_t *pParams, size_t paramsLength);
 bool ATCMD_ParamValidateTypes(const AT_CMD_TYPE_DESC *pCmdDesc, const int varIdx, const int numParams, ATCMD_PARAM *pParamList);
 
 #ifdef __cplusplus
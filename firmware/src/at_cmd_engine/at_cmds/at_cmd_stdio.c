@@ -34,12 +34,28 @@
 #include "platform/platform.h"
 #include "terminal/terminal.h"
 #include "at_cmds/at_cmd_inet.h"
+#ifdef AT_CMD_INCLUDE_FRAME_SUPPORT
+#include "at_cmds/at_cmd_frame.h"
+#endif
 #include "at_cmd_app.h"
 
 static bool isAECOutput;
 static bool isAECLineClean;
 static int statusVebosityLevel;
 
+typedef struct
+{
+    void    *pTask;
+    bool    isAEC;
+    size_t  length;
+    /* Output sits at buf[1], leaving room either side for the CR and prompt of AEC lines */
+    char    buf[1 + AT_CMD_CONF_PRINT_STAGE_SIZE + 1];
+} ATCMD_PRINT_STAGE;
+
+/* Output is assembled per task and handed to the UART in one write, the
+   first stage belongs to the AT task */
+static ATCMD_PRINT_STAGE printStages[1 + AT_CMD_CONF_PRINT_NUM_TASK_STAGES];
+
 static const char* statusCodeStr[] = {
     "OK",                               // ATCMD_STATUS_OK
     "General Error",                    // ATCMD_STATUS_ERROR
@@ -100,25 +116,10 @@ extern int8_t response_buffer[1024];
 extern int32_t response_buffer_length;
 
 /*****************************************************************************
- * Print to output channel
+ * Copy output to the response buffer of an app waiting for it
  *****************************************************************************/
-void ATCMD_Print(const char *pMsg, size_t msgLength)
+void ATCMD_PrintMirror(const void *pMsg, size_t msgLength)
 {
-    if (0 == msgLength)
-    {
-        return;
-    }
-
-    if ((true == isAECOutput) && (true == isAECLineClean))
-    {
-        /* If sending AEC, if no other AEC output has been sent on this line
-           then send a CR first to wipe out the prompt */
-
-        ATCMD_PlatformUARTWritePutByte('\r');
-    }
-
-    ATCMD_PlatformUARTWritePutBuffer(pMsg, msgLength);
-
     if(atCmdAppContext.respond_to_app == 1)
     {
         /*
@@ -131,19 +132,54 @@ void ATCMD_Print(const char *pMsg, size_t msgLength)
             response_buffer_length += msgLength;
         }
     }
+}
 
-    if (true == isAECOutput)
+/*****************************************************************************
+ * Write out a stage, the caller holds the print lock
+ *****************************************************************************/
+static void _PrintStageWrite(ATCMD_PRINT_STAGE *pStage)
+{
+    char *pOut;
+    size_t outLength;
+
+    if (0 == pStage->length)
     {
+        return;
+    }
+
+    if (pStage != &printStages[0])
+    {
+        /* Whatever the AT task has staged was printed first, so goes first */
+        _PrintStageWrite(&printStages[0]);
+    }
+
+    ATCMD_PrintMirror(&pStage->buf[1], pStage->length);
+
+    pOut      = &pStage->buf[1];
+    outLength = pStage->length;
+
+    if (true == pStage->isAEC)
+    {
+        if (true == isAECLineClean)
+        {
+            /* If sending AEC, if no other AEC output has been sent on this line
+               then send a CR first to wipe out the prompt */
+
+            pOut--;
+            *pOut = '\r';
+            outLength++;
+        }
+
         /* If this AEC output would complete a line (terminates with LF) then
            generate a new prompt for user input. If no LF then make the line
            as incomplete so next time doesn't try and wipe out the prompt above */
 
-        if ('\n' == pMsg[msgLength-1])
+        if ('\n' == pStage->buf[pStage->length])
         {
 #ifdef AT_CMD_CONF_CMD_MODE_USE_PROMPT
             if (true == TP_EchoGet())
             {
-                ATCMD_PlatformUARTWritePutByte(AT_CMD_CONF_CMD_MODE_PROMPT_CHAR);
+                pOut[outLength++] = AT_CMD_CONF_CMD_MODE_PROMPT_CHAR;
             }
 #endif
             isAECLineClean = true;
@@ -153,385 +189,154 @@ void ATCMD_Print(const char *pMsg, size_t msgLength)
             isAECLineClean = false;
         }
     }
-}
-
-/*****************************************************************************
- * Print to output channel with formatting support
- *****************************************************************************/
-void ATCMD_Printf(const char *format, ...)
-{
-    char tmpBuf[AT_CMD_CONF_PRINTF_OUT_BUF_SIZE];
-    int len = 0;
-    va_list args;
-    va_start( args, format );
 
-    len = vsnprintf(tmpBuf, AT_CMD_CONF_PRINTF_OUT_BUF_SIZE, format, args);
+    ATCMD_PlatformUARTWritePutBuffer(pOut, outLength);
 
-    va_end( args );
+    pStage->length = 0;
 
-    ATCMD_Print(tmpBuf, len);
-}
-
-/*****************************************************************************
- * Print to output channel at formatted MAC address
- *****************************************************************************/
-void ATCMD_PrintMACAddress(const uint8_t *pMACAddr)
-{
-    char tmpBuf[20];
-    int len = 0;
-    int i;
-
-    tmpBuf[len++] = '"';
-
-    /* Produce format "aa:bb:cc:dd:ee:ff" */
-
-    for (i=0; i<6; i++)
+    if (pStage != &printStages[0])
     {
-        ByteToStr(*pMACAddr++, &tmpBuf[len]);
-        len += 2;
-        if (i < 5)
-        {
-            tmpBuf[len++] = ':';
-        }
+        pStage->pTask = NULL;
     }
-
-    tmpBuf[len++] = '"';
-
-    ATCMD_Print(tmpBuf, len);
 }
 
 /*****************************************************************************
- * Print to output channel at formatted IPv4 address
+ * Find the stage of the calling task, the caller holds the print lock
  *****************************************************************************/
-void ATCMD_PrintIPv4Address(const uint32_t ipv4Addr)
+static ATCMD_PRINT_STAGE* _PrintStageGet(void)
 {
-    char tmpBuf[20];
-    int len = 0;
-
-    tmpBuf[0] = '"';
+    ATCMD_PRINT_STAGE *pFreeStage = NULL;
+    void *pTask;
+    int i;
 
-    /* Produce format "a.b.c.d" */
+    pTask = ATCMD_PlatformGetTaskID();
 
-    if (NULL == at_cmd_inet_ntop(0, &ipv4Addr, &tmpBuf[1], sizeof(tmpBuf)-1))
+    if ((true == ATCMD_PlatformIsEventTask()) || (NULL == pTask))
     {
-        return;
+        return &printStages[0];
     }
 
-    len = strlen(tmpBuf);
-
-    tmpBuf[len++] = '"';
-
-    ATCMD_Print(tmpBuf, len);
-}
-
-/*****************************************************************************
- * Print to output channel a string with escaped control characters
- *****************************************************************************/
-void ATCMD_PrintStringASCIIEsc(const char *pStr, size_t strLength)
-{
-    char tmpBuf[AT_CMD_CONF_PRINTF_OUT_BUF_SIZE];
-    int len = 0;
-
-    tmpBuf[len++] = '"';
-
-    /* Produce format "..." with displayable characters and known escape sequences */
-
-    while (strLength--)
+    for (i=1; i<(sizeof(printStages)/sizeof(ATCMD_PRINT_STAGE)); i++)
     {
-        if ((*pStr >= 0x20) && (*pStr <= 0x7e))
+        if (pTask == printStages[i].pTask)
         {
-            /* Displayable characters go straight through, except \ and " which
-               must be escaped with \ */
-
-            if (('\\' == *pStr) || ('"' == *pStr))
-            {
-                tmpBuf[len++] = '\\';
-            }
-
-            tmpBuf[len++] = *pStr++;
+            return &printStages[i];
         }
-        else
-        {
-            tmpBuf[len++] = '\\';
-
-            if (0x00 == *pStr)
-            {
-                /* Just in case we've been asked to display a string not using
-                   null termination, display \0 */
-
-                tmpBuf[len++] = '0';
-            }
-            else if ((*pStr >= 0x07) && (*pStr <= 0x0d))
-            {
-                /* These escape codes are grouped nicely together, so use a
-                   lookup table to translate */
-
-                tmpBuf[len++] = "abtnvfr"[*pStr - 0x07];
-            }
-            else if (0x1b == *pStr)
-            {
-                /* Escape is off on it's own, produce \e */
-
-                tmpBuf[len++] = 'e';
-            }
-            else
-            {
-                /* Just in case we get an invalid character, backtrack
-                   to remove the '\' */
-                len--;
-            }
 
-            pStr++;
+        if ((NULL == pFreeStage) && (NULL == printStages[i].pTask))
+        {
+            pFreeStage = &printStages[i];
         }
     }
 
-    tmpBuf[len++] = '"';
-
-    ATCMD_Print(tmpBuf, len);
-}
-
-
-/*****************************************************************************
- * Print to output channel a string as a series of hex bytes
- *****************************************************************************/
-void ATCMD_PrintStringHex(const uint8_t *pBytes, size_t strLength)
-{
-    char tmpBuf[AT_CMD_CONF_PRINTF_OUT_BUF_SIZE];
-    int len = 0;
-
-    tmpBuf[len++] = '[';
+    if (NULL == pFreeStage)
+    {
+        /* Every stage is in use, send out another task's partial line */
 
-    /* Produce the format [....] containing pairs of characters, each representing
-       a single byte */
+        pFreeStage = &printStages[1];
 
-    while (strLength--)
-    {
-        ByteToStr(*pBytes++, &tmpBuf[len]);
-        len += 2;
+        _PrintStageWrite(pFreeStage);
     }
 
-    tmpBuf[len++] = ']';
+    pFreeStage->pTask = pTask;
 
-    ATCMD_Print(tmpBuf, len);
+    return pFreeStage;
 }
 
 /*****************************************************************************
- * Print to the output channel a string, in the most appropriate form possible
+ * Add output to a stage, the caller holds the print lock
  *****************************************************************************/
-void ATCMD_PrintStringSafe(const char *pStr, size_t strLength)
+static void _PrintStageAdd(ATCMD_PRINT_STAGE *pStage, const char *pMsg, size_t msgLength)
 {
-    size_t i;
-    bool containsEscapableASCII = false;
-
-    if (0 == strLength)
+    while (msgLength > 0)
     {
-        ATCMD_Print("[]", 2);
-        return;
-    }
+        size_t numBytes;
 
-    for (i=0; i<strLength; i++)
-    {
-        if ((pStr[i] >= 0x20) && (pStr[i] <= 0x7e))
+        if (AT_CMD_CONF_PRINT_STAGE_SIZE == pStage->length)
         {
-            /* ASCII, only displayable characters */
+            _PrintStageWrite(pStage);
         }
-        else if (pStr[i] >= 128)
-        {
-            /* UTF-8 and other unknown encodings as well as plain binary data.
-               No other output format supported so go straight to hex display */
 
-            ATCMD_PrintStringHex((uint8_t*)pStr, strLength);
-            return;
-        }
-        else if ((0x00 == pStr[i]) || ((pStr[i] >= 0x07) && (pStr[i] <= 0x0d)) || (0x1b == pStr[i]))
-        {
-            /* Contains escaped ASCII */
+        numBytes = AT_CMD_CONF_PRINT_STAGE_SIZE - pStage->length;
 
-            containsEscapableASCII = true;
-        }
-        else
+        if (numBytes > msgLength)
         {
-            /* Non displayable ASCII or non escaped ASCII characters, go
-               straight to hex display */
-
-            ATCMD_PrintStringHex((uint8_t*)pStr, strLength);
-            return;
+            numBytes = msgLength;
         }
-    }
 
-    if (true == containsEscapableASCII)
-    {
-        ATCMD_PrintStringASCIIEsc(pStr, strLength);
-        return;
-    }
+        memcpy(&pStage->buf[1+pStage->length], pMsg, numBytes);
 
-    ATCMD_Print("\"", 1);
-    ATCMD_Print(pStr, strLength);
-    ATCMD_Print("\"", 1);
+        pStage->length += numBytes;
+        pMsg           += numBytes;
+        msgLength      -= numBytes;
+    }
 }
 
 /*****************************************************************************
- * Print to output channel a string with escaped control characters
+ * Hand any staged output to the UART; the AT task must call this before
+ * writing to the UART directly
  *****************************************************************************/
-void ATCMD_PrintStringASCIIEscWithDelimiterInfo(const char *pStr, size_t strLength, bool startDelimiter, bool endDelimiter)
+void ATCMD_PrintFlush(void)
 {
-    char tmpBuf[AT_CMD_CONF_PRINTF_OUT_BUF_SIZE];
-    int len = 0;
+    bool locked = ATCMD_PlatformPrintLock();
 
-    if(startDelimiter == true)
-        tmpBuf[len++] = '"';
+    _PrintStageWrite(&printStages[0]);
 
-    /* Produce format "..." with displayable characters and known escape sequences */
-
-    while (strLength--)
+    if (true == locked)
     {
-        if ((*pStr >= 0x20) && (*pStr <= 0x7e))
-        {
-            /* Displayable characters go straight through, except \ and " which
-               must be escaped with \ */
-
-            if (('\\' == *pStr) || ('"' == *pStr))
-            {
-                tmpBuf[len++] = '\\';
-            }
-
-            tmpBuf[len++] = *pStr++;
-        }
-        else
-        {
-            tmpBuf[len++] = '\\';
-
-            if (0x00 == *pStr)
-            {
-                /* Just in case we've been asked to display a string not using
-                   null termination, display \0 */
-
-                tmpBuf[len++] = '0';
-            }
-            else if ((*pStr >= 0x07) && (*pStr <= 0x0d))
-            {
-                /* These escape codes are grouped nicely together, so use a
-                   lookup table to translate */
-
-                tmpBuf[len++] = "abtnvfr"[*pStr - 0x07];
-            }
-            else if (0x1b == *pStr)
-            {
-                /* Escape is off on it's own, produce \e */
-
-                tmpBuf[len++] = 'e';
-            }
-            else
-            {
-                /* Just in case we get an invalid character, backtrack
-                   to remove the '\' */
-                len--;
-            }
-
-            pStr++;
-        }
+        ATCMD_PlatformPrintUnlock();
     }
-
-    if(endDelimiter == true)
-        tmpBuf[len++] = '"';
-
-    ATCMD_Print(tmpBuf, len);
 }
 
-
 /*****************************************************************************
- * Print to output channel a string as a series of hex bytes
+ * Print to output channel
  *****************************************************************************/
-void ATCMD_PrintStringHexWithDelimiterInfo(const uint8_t *pBytes, size_t strLength, bool startDelimiter, bool endDelimiter)
+void ATCMD_Print(const char *pMsg, size_t msgLength)
 {
-    char tmpBuf[AT_CMD_CONF_PRINTF_OUT_BUF_SIZE];
-    int len = 0;
-
-    if(startDelimiter == true)
-        tmpBuf[len++] = '[';
+    ATCMD_PRINT_STAGE *pStage;
+    bool locked;
 
-    /* Produce the format [....] containing pairs of characters, each representing
-       a single byte */
-
-    while (strLength--)
+    if (0 == msgLength)
     {
-        ByteToStr(*pBytes++, &tmpBuf[len]);
-        len += 2;
+        return;
     }
 
-    if(endDelimiter == true)
-        tmpBuf[len++] = ']';
+#ifdef AT_CMD_INCLUDE_FRAME_SUPPORT
+    if (true == ATCMD_FrameModeIsActive())
+    {
+        /* Framed output has no prompt to manage, output from other tasks
+           is never part of the current response so always goes out as AEC */
 
-    ATCMD_Print(tmpBuf, len);
-}
+        ATCMD_FramePrint(((true == isAECOutput) || (false == ATCMD_PlatformIsEventTask())), pMsg, msgLength);
+        return;
+    }
+#endif
 
+    locked = ATCMD_PlatformPrintLock();
 
-/*****************************************************************************
- * Print to the output channel a string, in the most appropriate form possible
- *****************************************************************************/
-void ATCMD_PrintStringSafeWithDelimiterInfo(const char *pStr, size_t strLength, bool startDelimiter, bool endDelimiter)
-{
-    size_t i;
-    bool containsEscapableASCII = false;
+    pStage = _PrintStageGet();
 
-    if (0 == strLength)
+    if ((pStage->length > 0) && (pStage->isAEC != isAECOutput))
     {
-        ATCMD_Print("[]", 2);
-        return;
+        _PrintStageWrite(pStage);
     }
 
-    for (i=0; i<strLength; i++)
-    {
-        if ((pStr[i] >= 0x20) && (pStr[i] <= 0x7e))
-        {
-            /* ASCII, only displayable characters */
-        }
-        else if (pStr[i] >= 128)
-        {
-            /* UTF-8 and other unknown encodings as well as plain binary data.
-               No other output format supported so go straight to hex display */
+    pStage->isAEC = isAECOutput;
 
-            ATCMD_PrintStringHexWithDelimiterInfo((uint8_t*)pStr, strLength, startDelimiter, endDelimiter);
-            return;
-        }
-        else if ((0x00 == pStr[i]) || ((pStr[i] >= 0x07) && (pStr[i] <= 0x0d)) || (0x1b == pStr[i]))
-        {
-            /* Contains escaped ASCII */
+    _PrintStageAdd(pStage, pMsg, msgLength);
 
-            containsEscapableASCII = true;
-        }
-        else
-        {
-            /* Non displayable ASCII or non escaped ASCII characters, go
-               straight to hex display */
+    /* AEC lines and output from other tasks go out a line at a time, the AT
+       task's responses go out once complete */
 
-            ATCMD_PrintStringHexWithDelimiterInfo((uint8_t*)pStr, strLength, startDelimiter, endDelimiter);
-            return;
-        }
+    if (('\n' == pMsg[msgLength-1]) && ((true == pStage->isAEC) || (pStage != &printStages[0])))
+    {
+        _PrintStageWrite(pStage);
     }
 
-    if (true == containsEscapableASCII)
+    if (true == locked)
     {
-        ATCMD_PrintStringASCIIEscWithDelimiterInfo(pStr, strLength, startDelimiter, endDelimiter);
-        return;
+        ATCMD_PlatformPrintUnlock();
     }
-
-    if(startDelimiter == true)
-        ATCMD_Print("\"", 1);
-    
-    ATCMD_Print(pStr, strLength);
-    
-    if(endDelimiter == true)
-        ATCMD_Print("\"", 1);
-}
-
-
-/*****************************************************************************
- * Sets the level of verbosity for status output
- *****************************************************************************/
-void ATCMD_SetStatusVerbosityLevel(int newLevel)
-{
-    statusVebosityLevel = newLevel;
 }
 
 /*****************************************************************************
@@ -541,6 +346,17 @@ void ATCMD_ReportStatus(const ATCMD_STATUS statusCode)
 {
     const char *pStatusMsg = NULL;
 
+#ifdef AT_CMD_INCLUDE_FRAME_SUPPORT
+    if ((true == ATCMD_FrameModeIsActive()) && (false == isAECOutput))
+    {
+        /* The status of a request goes back in its own frame, AEC status
+           reports stay as text inside an AEC frame */
+
+        ATCMD_FrameReportStatus(statusCode);
+        return;
+    }
+#endif
+
     /*
         Level 0:        0           1
         Level 1:        0           1:statusCode
@@ -613,6 +429,9 @@ void ATCMD_ReportStatus(const ATCMD_STATUS statusCode)
             }
         }
     }
+
+    /* The response is complete, send it in one go */
+    ATCMD_PrintFlush();
 }
 
 /*****************************************************************************
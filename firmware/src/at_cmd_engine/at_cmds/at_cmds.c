@@ -34,6 +34,9 @@
 #ifdef AT_CMD_INCLUDE_XMODEM_SUPPORT
 #include "at_cmd_xmodem.h"
 #endif
+#ifdef AT_CMD_INCLUDE_FRAME_SUPPORT
+#include "at_cmd_frame.h"
+#endif
 #include "platform/platform.h"
 #include "terminal/terminal.h"
 #include "at_cmd_app.h"
@@ -46,6 +49,99 @@ static uint32_t lastTermPollTimeMs;
 
 const AT_CMD_TYPE_DESC* pCurrentCmdTypeDesc;
 
+/* Descriptors with an update function, and a bit per descriptor with outstanding work;
+   every descriptor has at most one update function and the command index holds no
+   more than AT_CMD_CONF_MAX_CMD_TYPES descriptors */
+static const AT_CMD_TYPE_DESC* updateHooks[AT_CMD_CONF_MAX_CMD_TYPES];
+static int numUpdateHooks;
+static uint32_t updatePendingMap[(AT_CMD_CONF_MAX_CMD_TYPES + 31) / 32];
+
+/* Set when the AT task was woken by a signal; the event may have come from another
+   task, which cannot mark a module pending itself, so every module gets one pass */
+static bool updateSignalled;
+
+/*****************************************************************************
+ * Return to AEC output and get ready for the next command
+ *****************************************************************************/
+static void _StartNewCommandLine(void)
+{
+    ATCMD_EnterAECMode();
+
+#ifdef AT_CMD_INCLUDE_FRAME_SUPPORT
+    if (true == ATCMD_FrameModeIsActive())
+    {
+        /* No line editor or prompt in framed mode */
+        return;
+    }
+#endif
+
+    /* The prompt is written directly, so staged output must go first */
+    ATCMD_PrintFlush();
+
+    TP_CommandDecoderStartNewLine(consoleCmdBuffer, AT_CMD_CONF_MAX_COMMAND_LENGTH);
+}
+
+static bool _AddUpdateHooks(const AT_CMD_TYPE_DESC **pCmdTableEntry)
+{
+    while (NULL != *pCmdTableEntry)
+    {
+        if (NULL != (*pCmdTableEntry)->cmdUpdate)
+        {
+            if (numUpdateHooks >= AT_CMD_CONF_MAX_CMD_TYPES)
+            {
+                return false;
+            }
+
+            updateHooks[numUpdateHooks] = *pCmdTableEntry;
+
+            /* Every module starts out ticked until it says otherwise */
+            updatePendingMap[numUpdateHooks >> 5] |= (1UL << (numUpdateHooks & 31));
+
+            numUpdateHooks++;
+        }
+
+        pCmdTableEntry++;
+    }
+
+    return true;
+}
+
+/*****************************************************************************
+ * Call the update function of every module with outstanding work
+ *****************************************************************************/
+static void _UpdateCommands(void)
+{
+    ATCMD_STATUS status;
+    int i;
+    bool updateAll = updateSignalled;
+
+    updateSignalled = false;
+
+    for (i=0; i<numUpdateHooks; i++)
+    {
+        const AT_CMD_TYPE_DESC *pCmdTypeDesc = updateHooks[i];
+
+        if ((false == updateAll) && (pCmdTypeDesc != pCurrentCmdTypeDesc) && (0 == (updatePendingMap[i >> 5] & (1UL << (i & 31)))))
+        {
+            continue;
+        }
+
+        status = pCmdTypeDesc->cmdUpdate(pCmdTypeDesc, pCurrentCmdTypeDesc);
+
+        if (pCmdTypeDesc == pCurrentCmdTypeDesc)
+        {
+            if (ATCMD_STATUS_PENDING != status)
+            {
+                ATCMD_CompleteCommand(status);
+                if (false == ATCMD_ModeIsBinary())
+                {
+                    _StartNewCommandLine();
+                }
+            }
+        }
+    }
+}
+
 static void _ResetCommands(void)
 {
     const AT_CMD_TYPE_DESC **pCmdTableEntry;
@@ -117,6 +213,10 @@ void ATCMD_Init(void)
     ATCMD_XModemInit();
 #endif
 
+#ifdef AT_CMD_INCLUDE_FRAME_SUPPORT
+    ATCMD_FrameInit();
+#endif
+
     ATCMD_LeaveAECMode();
 
     ATCMD_APPInit();
@@ -132,6 +232,16 @@ void ATCMD_Init(void)
 
     ATCMD_EnterAECMode();
 
+    ATCMD_ParserInit();
+
+    /* Internal commands are updated first, as before */
+    numUpdateHooks = 0;
+    if ((false == _AddUpdateHooks(atCmdTypeDescTableInt)) || (false == _AddUpdateHooks(atCmdTypeDescTable)))
+    {
+        /* A module left out would never be ticked, make the build error visible */
+        ATCMD_PlatformUARTWritePutBuffer("\r\nERROR:AT_CMD_CONF_MAX_CMD_TYPES exceeded\r\n", 44);
+    }
+
     _ResetCommands();
 
     lastTermPollTimeMs = ATCMD_PlatformGetSysTimeMs();
@@ -142,12 +252,30 @@ void ATCMD_Init(void)
  *****************************************************************************/
 void ATCMD_Update(int termPollRateMs)
 {
-    const AT_CMD_TYPE_DESC **pCmdTableEntry;
     bool inBinaryMode = false;
-    ATCMD_STATUS status;
+#ifdef AT_CMD_INCLUDE_FRAME_SUPPORT
+    bool inFrameMode = ATCMD_FrameModeIsActive();
+#endif
 
-    if ((ATCMD_PlatformGetSysTimeMs() - lastTermPollTimeMs) > termPollRateMs)
+    if ((ATCMD_PlatformGetSysTimeMs() - lastTermPollTimeMs) >= termPollRateMs)
     {
+        /* The input processors below echo and prompt straight to the UART */
+        ATCMD_PrintFlush();
+
+#ifdef AT_CMD_INCLUDE_FRAME_SUPPORT
+        if (true == inFrameMode)
+        {
+            /* Frames carry both commands and binary mode data */
+
+            inBinaryMode = ATCMD_ModeIsBinary();
+
+            if ((true == ATCMD_FrameProcess()) && (NULL == pCurrentCmdTypeDesc) && (false == ATCMD_ModeIsBinary()))
+            {
+                ATCMD_EnterAECMode();
+            }
+        }
+        else
+#endif
         if (true == ATCMD_ModeIsBinary())
         {
             inBinaryMode = true;
@@ -182,8 +310,7 @@ void ATCMD_Update(int termPollRateMs)
                     {
                         if (false == ATCMD_ModeIsBinary())
                         {
-                            ATCMD_EnterAECMode();
-                            TP_CommandDecoderStartNewLine(consoleCmdBuffer, AT_CMD_CONF_MAX_COMMAND_LENGTH);
+                            _StartNewCommandLine();
                         }
                     }
 
@@ -200,62 +327,99 @@ void ATCMD_Update(int termPollRateMs)
 
     ATCMD_APPUpdate();
 
-    pCmdTableEntry = atCmdTypeDescTableInt;
+    _UpdateCommands();
 
-    while (NULL != *pCmdTableEntry)
+    /* If we transitioned back to command mode from binary mode then reset the AEC state
+       and command line input state */
+
+    if ((true == inBinaryMode) && (false == ATCMD_ModeIsBinary()))
     {
-        if (NULL != (*pCmdTableEntry)->cmdUpdate)
-        {
-            status = (*pCmdTableEntry)->cmdUpdate(*pCmdTableEntry, pCurrentCmdTypeDesc);
+        _StartNewCommandLine();
+    }
+#ifdef AT_CMD_INCLUDE_FRAME_SUPPORT
+    else if ((true == inFrameMode) && (false == ATCMD_FrameModeIsActive()))
+    {
+        /* Left framed mode, restart the line editor */
+
+        _StartNewCommandLine();
+    }
+#endif
+
+    /* Send any AEC output assembled during this pass */
+    ATCMD_PrintFlush();
+}
 
-            if (*pCmdTableEntry == pCurrentCmdTypeDesc)
+/*****************************************************************************
+ * Mark whether a module has outstanding work for its update function; must
+ * only be called from the AT task
+ *****************************************************************************/
+void ATCMD_UpdateSetPending(const AT_CMD_TYPE_DESC *pCmdTypeDesc, bool pending)
+{
+    int i;
+
+    for (i=0; i<numUpdateHooks; i++)
+    {
+        if (pCmdTypeDesc == updateHooks[i])
+        {
+            if (true == pending)
             {
-                if (ATCMD_STATUS_PENDING != status)
-                {
-                    ATCMD_CompleteCommand(status);
-                    if (false == ATCMD_ModeIsBinary())
-                    {
-                        ATCMD_EnterAECMode();
-                        TP_CommandDecoderStartNewLine(consoleCmdBuffer, AT_CMD_CONF_MAX_COMMAND_LENGTH);
-                    }
-                }
+                updatePendingMap[i >> 5] |= (1UL << (i & 31));
             }
+            else
+            {
+                updatePendingMap[i >> 5] &= ~(1UL << (i & 31));
+            }
+
+            return;
         }
+    }
+}
 
-        pCmdTableEntry++;
+/*****************************************************************************
+ * How long the AT task may sleep before ATCMD_Update() needs calling again,
+ * if nothing signals it sooner
+ *****************************************************************************/
+static uint32_t _UpdateWaitTimeMs(void)
+{
+    int i;
+
+    if (ATCMD_PlatformUARTReadGetCount() > 0)
+    {
+        /* Input arrived while the last update was running */
+        return 0;
     }
 
-    pCmdTableEntry = atCmdTypeDescTable;
+    if ((NULL != pCurrentCmdTypeDesc) || (true == ATCMD_ModeIsBinary()))
+    {
+        return AT_CMD_CONF_BUSY_UPDATE_MS;
+    }
 
-    while (NULL != *pCmdTableEntry)
+#ifdef AT_CMD_INCLUDE_XMODEM_SUPPORT
+    if (true == ATCMD_XModemIsStarted())
     {
-        if (NULL != (*pCmdTableEntry)->cmdUpdate)
-        {
-            status = (*pCmdTableEntry)->cmdUpdate(*pCmdTableEntry, pCurrentCmdTypeDesc);
+        return AT_CMD_CONF_BUSY_UPDATE_MS;
+    }
+#endif
 
-            if (*pCmdTableEntry == pCurrentCmdTypeDesc)
-            {
-                if (ATCMD_STATUS_PENDING != status)
-                {
-                    ATCMD_CompleteCommand(status);
-                    if (false == ATCMD_ModeIsBinary())
-                    {
-                        ATCMD_EnterAECMode();
-                        TP_CommandDecoderStartNewLine(consoleCmdBuffer, AT_CMD_CONF_MAX_COMMAND_LENGTH);
-                    }
-                }
-            }
+    for (i=0; i<(int)(sizeof(updatePendingMap) / sizeof(updatePendingMap[0])); i++)
+    {
+        if (0 != updatePendingMap[i])
+        {
+            return AT_CMD_CONF_IDLE_UPDATE_MS;
         }
-
-        pCmdTableEntry++;
     }
 
-    /* If we transitioned back to command mode from binary mode then reset the AEC state
-       and command line input state */
+    /* No module has timed work, sleep until something signals */
+    return ATCMD_PLATFORM_WAIT_FOREVER;
+}
 
-    if ((true == inBinaryMode) && (false == ATCMD_ModeIsBinary()))
+/*****************************************************************************
+ * Block the AT task until ATCMD_Update() needs calling again
+ *****************************************************************************/
+void ATCMD_UpdateWait(void)
+{
+    if (true == ATCMD_PlatformEventWait(_UpdateWaitTimeMs()))
     {
-        ATCMD_EnterAECMode();
-        TP_CommandDecoderStartNewLine(consoleCmdBuffer, AT_CMD_CONF_MAX_COMMAND_LENGTH);
+        updateSignalled = true;
     }
 }
@@ -90,7 +90,8 @@ typedef enum
     ATCMD_INT_APP_VAL_GMI,
     ATCMD_INT_APP_VAL_GMM,
     ATCMD_INT_APP_VAL_GMR,
-    ATCMD_INT_APP_VAL_IPR
+    ATCMD_INT_APP_VAL_IPR,
+    ATCMD_INT_APP_VAL_FRM
 } ATCMD_INT_APP_VAL;
 
 typedef union
@@ -174,11 +175,14 @@ void ATCMD_EnterAECMode(void);
 void ATCMD_LeaveAECMode(void);
 void ATCMD_Print(const char *pMsg, size_t msgLength);
 void ATCMD_Printf(const char *format, ...);
+void ATCMD_PrintFlush(void);
+void ATCMD_PrintMirror(const void *pMsg, size_t msgLength);
 void ATCMD_PrintMACAddress(const uint8_t *pMACAddr);
 void ATCMD_PrintIPv4Address(const uint32_t ipv4Addr);
 void ATCMD_PrintStringASCIIEsc(const char *pStr, size_t strLength);
 void ATCMD_PrintStringHex(const uint8_t *pBytes, size_t strLength);
 void ATCMD_PrintStringSafe(const char *pStr, size_t strLength);
+void ATCMD_PrintStringHexWithDelimiterInfo(const uint8_t *pBytes, size_t strLength, bool startDelimiter, bool endDelimiter);
 void ATCMD_PrintStringSafeWithDelimiterInfo(const char *pStr, size_t strLength, bool startDelimiter, bool endDelimiter);
 void ATCMD_SetStatusVerbosityLevel(int newLevel);
 void ATCMD_ReportStatus(const ATCMD_STATUS statusCode);
@@ -190,8 +194,11 @@ void ATCMD_EnterBinaryMode(tpfATCMDBinaryDataHandler pBinDataHandler);
 void ATCMD_LeaveBinaryMode(void);
 bool ATCMD_ModeIsBinary(void);
 void ATCMD_Update(int termPollRateMs);
+void ATCMD_UpdateWait(void);
+void ATCMD_UpdateSetPending(const AT_CMD_TYPE_DESC *pCmdTypeDesc, bool pending);
 void ATCMD_BinaryInit(void);
 bool ATCMD_BinaryProcess(void);
+void ATCMD_BinaryProcessFrame(const uint8_t *pBuf, size_t numBufBytes);
 
 const ATCMD_STORE_MAP_ELEMENT* ATCMD_StructStoreFindNext(const ATCMD_STORE_MAP_ELEMENT *pstaConfMap);
 const ATCMD_STORE_MAP_ELEMENT* ATCMD_StructStoreFindElementByID(const ATCMD_STORE_MAP_ELEMENT *pstaConfMap, int id);
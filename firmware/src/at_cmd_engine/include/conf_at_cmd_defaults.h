@@ -74,6 +74,46 @@
 #endif
 #define AT_CMD_CONF_BIN_MAX_BUFFER_SIZE         1400
         
+/* Maximum number of command descriptors held in the sorted lookup index */
+#ifndef AT_CMD_CONF_MAX_CMD_TYPES
+#define AT_CMD_CONF_MAX_CMD_TYPES               64
+#endif
+
+/* Longest time (in ms) the AT task sleeps without being signalled while a module has timed work */
+#ifndef AT_CMD_CONF_IDLE_UPDATE_MS
+#define AT_CMD_CONF_IDLE_UPDATE_MS              100
+#endif
+
+/* Longest time (in ms) the AT task sleeps while a command, binary mode or XMODEM transfer is in progress */
+#ifndef AT_CMD_CONF_BUSY_UPDATE_MS
+#define AT_CMD_CONF_BUSY_UPDATE_MS              5
+#endif
+
+/* Size of the buffers each task assembles its output in before writing it to the UART */
+#ifndef AT_CMD_CONF_PRINT_STAGE_SIZE
+#define AT_CMD_CONF_PRINT_STAGE_SIZE            512
+#endif
+
+/* Number of other tasks (MQTT, TCP/IP) which can have a line of output staged at once */
+#ifndef AT_CMD_CONF_PRINT_NUM_TASK_STAGES
+#define AT_CMD_CONF_PRINT_NUM_TASK_STAGES       2
+#endif
+
+/* Largest frame body accepted in framed mode, must hold a full binary mode write */
+#ifndef AT_CMD_CONF_FRAME_MAX_BODY_SIZE
+#define AT_CMD_CONF_FRAME_MAX_BODY_SIZE         1536
+#endif
+
+/* Output buffered per response or AEC frame in framed mode */
+#ifndef AT_CMD_CONF_FRAME_TX_BUFFER_SIZE
+#define AT_CMD_CONF_FRAME_TX_BUFFER_SIZE        256
+#endif
+
+/* Time (in ms) without input after which a partial frame is dropped */
+#ifndef AT_CMD_CONF_FRAME_RX_TIMEOUT_MS
+#define AT_CMD_CONF_FRAME_RX_TIMEOUT_MS         500
+#endif
+
 /* Attention base string. All commands must start with this. */
 #ifndef AT_CMD_CONF_AT_BASE_STRING
 #define AT_CMD_CONF_AT_BASE_STRING              "AT"
@@ -109,6 +149,21 @@
 #define AT_CMD_CONF_DEFAULT_SERIAL_BAUD_RATE    115200
 #endif
 
+/* Free space in the UART TX ring (in bytes) at which a stalled writer is woken. */
+#ifndef AT_CMD_CONF_UART_TX_WAKE_THRESHOLD
+#define AT_CMD_CONF_UART_TX_WAKE_THRESHOLD      512
+#endif
+
+/* Time (in ms) the AT task waits for the UART TX ring to drain before counting a stall timeout. */
+#ifndef AT_CMD_CONF_UART_TX_STALL_TIMEOUT_MS
+#define AT_CMD_CONF_UART_TX_STALL_TIMEOUT_MS    1000
+#endif
+
+/* Size of the buffer holding UART output until the AT task can send it, other tasks may use half. */
+#ifndef AT_CMD_CONF_UART_TX_DEFER_SIZE
+#define AT_CMD_CONF_UART_TX_DEFER_SIZE          2048
+#endif
+
 /*--------------------------------------------------------------------------------------*/
 
 #if (AT_CMD_CONF_CMD_MODE_PROMPT_CHAR + 0)
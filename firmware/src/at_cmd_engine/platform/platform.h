@@ -30,6 +30,19 @@
 
 #include "conf_at_cmd.h"
 
+/* Timeout for ATCMD_PlatformEventWait() which only returns once signalled */
+#define ATCMD_PLATFORM_WAIT_FOREVER     0xffffffffUL
+
+typedef struct
+{
+    uint32_t    numTxBytes;         /* Bytes queued for transmission */
+    uint32_t    numTxStalls;        /* Writes which had to wait for space */
+    uint32_t    numTxDropped;       /* Bytes from other tasks discarded with the defer buffer full */
+    uint32_t    txHighWaterMark;    /* Most bytes ever waiting in the TX ring */
+    uint32_t    numTxDeferred;      /* Bytes handed to the AT task to send */
+    uint32_t    numTxStallTimeouts; /* Stall timeouts passed while waiting for space */
+} ATCMD_PLATFORM_UART_TX_STATS;
+
 #ifdef __cplusplus  // Provide C++ Compatibility
 extern "C" {
 #endif
@@ -43,12 +56,21 @@ size_t ATCMD_PlatformUARTReadGetBuffer(void *pBuf, size_t numBytes);
 size_t ATCMD_PlatformUARTWriteGetSpace(void);
 bool ATCMD_PlatformUARTWritePutByte(uint8_t b);
 bool ATCMD_PlatformUARTWritePutBuffer(const void *pBuf, size_t numBytes);
+void ATCMD_PlatformUARTWriteGetStats(ATCMD_PLATFORM_UART_TX_STATS *pStats);
 size_t ATCMD_PlatformDebugUARTWriteGetSpace(void);
 bool ATCMD_PlatformDebugUARTWritePutByte(uint8_t b);
 bool ATCMD_PlatformDebugUARTWritePutBuffer(const void *pBuf, size_t numBytes);
 bool ATCMD_PlatformDebugUARTWriteBufferFlush(bool inCriticalSection);
 uint32_t ATCMD_PlatformGetSysTimeMs(void);
 
+void ATCMD_PlatformEventSignal(void);
+void ATCMD_PlatformEventSignalFromISR(void);
+bool ATCMD_PlatformEventWait(uint32_t timeoutMs);
+bool ATCMD_PlatformIsEventTask(void);
+void* ATCMD_PlatformGetTaskID(void);
+bool ATCMD_PlatformPrintLock(void);
+void ATCMD_PlatformPrintUnlock(void);
+
 #ifdef __cplusplus
 }
 #endif
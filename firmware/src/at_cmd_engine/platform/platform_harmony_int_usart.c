@@ -28,6 +28,7 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <stdio.h>
+#include <string.h>
 #include "platform/platform.h"
 
 #include "definitions.h"
@@ -43,14 +44,305 @@ uint32_t currBaudRate = ATCMD_UART_BAUD_RATE_DEF;
 /* Access semaphore for printing OK and asynch events */
 OSAL_SEM_HANDLE_TYPE printEventSemaphore;
 
+/* Held while output staged by the AT task is added to or written out, so
+   direct writes from other tasks cannot overtake it */
+static OSAL_MUTEX_HANDLE_TYPE printStageMutex;
+static bool printStageMutexValid;
+
+/* Task blocked in ATCMD_PlatformEventWait(), woken by a notification */
+static TaskHandle_t volatile eventTaskHandle = NULL;
+
+/* Given from the TX interrupt once the ring has drained to the wake threshold */
+static OSAL_SEM_HANDLE_TYPE txSpaceSemaphore;
+static ATCMD_PLATFORM_UART_TX_STATS txStats;
+
+/* Output which could not go straight into the TX ring without waiting, the
+   AT task moves it across as space frees up so other tasks never wait */
+static uint8_t txDeferBuf[AT_CMD_CONF_UART_TX_DEFER_SIZE];
+static size_t txDeferInIdx;
+static size_t txDeferOutIdx;
+static size_t txDeferLength;
+
+/* Set while the AT task is part way through a write and waiting for space */
+static bool txWriteActive;
+
+/* Set while the AT task holds the print lock, other tasks may be waiting on
+   it so it must not wait for the UART */
+static bool printStageLockedByEventTask;
+
+#ifdef AT_CMD_CONF_UART_TX_TEST_THROTTLE
+/* Bytes the simulated slow host will still accept, topped up every ms */
+static uint32_t volatile txThrottleBudget;
+#endif
+
 static void _timerCallback(uintptr_t context)
 {
     timerMS++;
+
+#ifdef AT_CMD_CONF_UART_TX_TEST_THROTTLE
+    if (txThrottleBudget < UART2_WriteBufferSizeGet())
+    {
+        uint32_t prevBudget = txThrottleBudget;
+
+        txThrottleBudget += AT_CMD_CONF_UART_TX_TEST_THROTTLE;
+
+        if ((prevBudget < AT_CMD_CONF_UART_TX_WAKE_THRESHOLD) && (txThrottleBudget >= AT_CMD_CONF_UART_TX_WAKE_THRESHOLD))
+        {
+            OSAL_SEM_PostISR(&txSpaceSemaphore);
+        }
+    }
+#endif
+}
+
+static void _uartReadCallback(UART_EVENT event, uintptr_t context)
+{
+    ATCMD_PlatformEventSignalFromISR();
+}
+
+static void _uartWriteCallback(UART_EVENT event, uintptr_t context)
+{
+    OSAL_SEM_PostISR(&txSpaceSemaphore);
+}
+
+/* Free space in the TX ring, less anything the simulated slow host will not take */
+static size_t _uartWriteSpace(void)
+{
+    size_t numFree = UART2_WriteFreeBufferCountGet();
+
+#ifdef AT_CMD_CONF_UART_TX_TEST_THROTTLE
+    if (numFree > txThrottleBudget)
+    {
+        numFree = txThrottleBudget;
+    }
+#endif
+
+    return numFree;
+}
+
+/* Put as much of a buffer as fits into the TX ring, the caller holds printEventSemaphore */
+static size_t _uartWrite(const uint8_t *pBuf, size_t numBytes)
+{
+    size_t numSent;
+#ifdef AT_CMD_CONF_UART_TX_TEST_THROTTLE
+    OSAL_CRITSECT_DATA_TYPE critStatus;
+
+    if (numBytes > txThrottleBudget)
+    {
+        numBytes = txThrottleBudget;
+    }
+#endif
+
+    if (0 == numBytes)
+    {
+        return 0;
+    }
+
+    numSent = UART2_Write((uint8_t *)pBuf, numBytes);
+
+#ifdef AT_CMD_CONF_UART_TX_TEST_THROTTLE
+    critStatus = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_HIGH);
+    txThrottleBudget -= numSent;
+    OSAL_CRIT_Leave(OSAL_CRIT_TYPE_HIGH, critStatus);
+#endif
+
+    txStats.numTxBytes += numSent;
+
+    return numSent;
+}
+
+/* Record how full the TX ring got, the caller holds printEventSemaphore */
+static void _uartUpdateHighWaterMark(void)
+{
+    size_t numPending;
+
+    numPending = UART2_WriteBufferSizeGet() - UART2_WriteFreeBufferCountGet();
+
+    if (numPending > txStats.txHighWaterMark)
+    {
+        txStats.txHighWaterMark = numPending;
+    }
+}
+
+/* Wait for the TX ring to drain to the wake threshold. The notification is
+   given as the free count reaches the threshold and the semaphore keeps it
+   until taken, so one given before the pend is not lost */
+static void _uartWaitTxSpace(void)
+{
+    while (_uartWriteSpace() < AT_CMD_CONF_UART_TX_WAKE_THRESHOLD)
+    {
+        if (taskSCHEDULER_RUNNING != xTaskGetSchedulerState())
+        {
+            continue;
+        }
+
+        if (OSAL_SEM_Pend(&txSpaceSemaphore, AT_CMD_CONF_UART_TX_STALL_TIMEOUT_MS) != OSAL_RESULT_TRUE)
+        {
+            /* Nothing is draining the ring (CTS held off?), keep waiting rather than lose output */
+            txStats.numTxStallTimeouts++;
+        }
+    }
+}
+
+/* Send the deferred output and then a buffer, waiting for space as needed */
+static bool _uartWriteWait(const uint8_t *pBuf, size_t numBytes)
+{
+    bool stalled = false;
+
+    if (OSAL_SEM_Pend(&printEventSemaphore, OSAL_WAIT_FOREVER) != OSAL_RESULT_TRUE)
+    {
+        return false;
+    }
+
+    txWriteActive = true;
+
+    while (1)
+    {
+        size_t numSent;
+
+        /* Deferred output was written first, so goes out first */
+
+        while (txDeferLength > 0)
+        {
+            size_t numDeferBytes = sizeof(txDeferBuf) - txDeferOutIdx;
+
+            if (numDeferBytes > txDeferLength)
+            {
+                numDeferBytes = txDeferLength;
+            }
+
+            numSent = _uartWrite(&txDeferBuf[txDeferOutIdx], numDeferBytes);
+
+            txDeferOutIdx  = (txDeferOutIdx + numSent) % sizeof(txDeferBuf);
+            txDeferLength -= numSent;
+
+            if (numSent < numDeferBytes)
+            {
+                break;
+            }
+        }
+
+        if (0 == txDeferLength)
+        {
+            numSent = _uartWrite(pBuf, numBytes);
+
+            pBuf     += numSent;
+            numBytes -= numSent;
+
+            if (0 == numBytes)
+            {
+                break;
+            }
+        }
+
+        if (false == stalled)
+        {
+            stalled = true;
+            txStats.numTxStalls++;
+        }
+
+        _uartUpdateHighWaterMark();
+
+        /* Other tasks defer their output while this one waits for space */
+
+        OSAL_SEM_Post(&printEventSemaphore);
+
+        _uartWaitTxSpace();
+
+        if (OSAL_SEM_Pend(&printEventSemaphore, OSAL_WAIT_FOREVER) != OSAL_RESULT_TRUE)
+        {
+            return false;
+        }
+    }
+
+    txWriteActive = false;
+
+    _uartUpdateHighWaterMark();
+
+    if (OSAL_SEM_Post(&printEventSemaphore) != OSAL_RESULT_TRUE)
+    {
+        return false;
+    }
+
+    return true;
+}
+
+/* Send a buffer if it fits in the TX ring, otherwise defer it to the AT task
+   if it fits within deferLimit bytes of the defer buffer, never waits */
+static bool _uartWriteNoWait(const uint8_t *pBuf, size_t numBytes, size_t deferLimit, bool canDrop)
+{
+    bool result = true;
+
+    if (OSAL_SEM_Pend(&printEventSemaphore, OSAL_WAIT_FOREVER) != OSAL_RESULT_TRUE)
+    {
+        return false;
+    }
+
+    if ((false == txWriteActive) && (0 == txDeferLength) && (_uartWriteSpace() >= numBytes))
+    {
+        _uartWrite(pBuf, numBytes);
+        _uartUpdateHighWaterMark();
+    }
+    else if ((txDeferLength <= deferLimit) && ((deferLimit - txDeferLength) >= numBytes))
+    {
+        size_t numCopyBytes = sizeof(txDeferBuf) - txDeferInIdx;
+
+        if (numCopyBytes > numBytes)
+        {
+            numCopyBytes = numBytes;
+        }
+
+        memcpy(&txDeferBuf[txDeferInIdx], pBuf, numCopyBytes);
+        memcpy(txDeferBuf, &pBuf[numCopyBytes], numBytes - numCopyBytes);
+
+        txDeferInIdx   = (txDeferInIdx + numBytes) % sizeof(txDeferBuf);
+        txDeferLength += numBytes;
+
+        txStats.numTxDeferred += numBytes;
+
+        ATCMD_PlatformEventSignal();
+    }
+    else
+    {
+        if (true == canDrop)
+        {
+            txStats.numTxDropped += numBytes;
+        }
+
+        result = false;
+    }
+
+    OSAL_SEM_Post(&printEventSemaphore);
+
+    return result;
 }
 
 void ATCMD_PlatformInit()
 {
 	SYS_TIME_CallbackRegisterMS(_timerCallback, 0, 1, SYS_TIME_PERIODIC);
+
+    /* Wake the AT task as soon as any byte is received */
+    UART2_ReadCallbackRegister(_uartReadCallback, 0);
+    UART2_ReadThresholdSet(1);
+    UART2_ReadNotificationEnable(true, true);
+
+    /* Writers stalled on a full TX ring are woken once this much space is free */
+    OSAL_SEM_Create(&txSpaceSemaphore, OSAL_SEM_TYPE_BINARY, 1, 0);
+    UART2_WriteCallbackRegister(_uartWriteCallback, 0);
+    UART2_WriteThresholdSet(AT_CMD_CONF_UART_TX_WAKE_THRESHOLD);
+    UART2_WriteNotificationEnable(true, false);
+
+    if (OSAL_RESULT_TRUE == OSAL_MUTEX_Create(&printStageMutex))
+    {
+        printStageMutexValid = true;
+    }
+
+#ifdef AT_CMD_CONF_UART_FLOW_CONTROL
+    /* Hand RTS/CTS over to the UART, the pins must be mapped in the pin manager */
+    U2MODECLR = _U2MODE_ON_MASK;
+    U2MODECLR = _U2MODE_UEN_MASK | _U2MODE_RTSMD_MASK;
+    U2MODESET = (2 << _U2MODE_UEN_POSITION);
+    U2MODESET = _U2MODE_ON_MASK;
+#endif
 }
 
 void ATCMD_PlatformUARTSetBaudRate(uint32_t baud)
@@ -148,7 +440,7 @@ size_t ATCMD_PlatformUARTReadGetBuffer(void *pBuf, size_t numBytes)
 
 size_t ATCMD_PlatformUARTWriteGetSpace(void)
 {
-    return UART2_WriteFreeBufferCountGet();
+    return _uartWriteSpace();
 }
 
 bool ATCMD_PlatformUARTWritePutByte(uint8_t b)
@@ -158,24 +450,132 @@ bool ATCMD_PlatformUARTWritePutByte(uint8_t b)
 
 bool ATCMD_PlatformUARTWritePutBuffer(const void *pBuf, const size_t numBytes)
 {
-    if (OSAL_SEM_Pend(&printEventSemaphore, OSAL_WAIT_FOREVER) != OSAL_RESULT_TRUE)
+    if ((taskSCHEDULER_RUNNING != xTaskGetSchedulerState()) ||
+        ((true == ATCMD_PlatformIsEventTask()) && (false == printStageLockedByEventTask)))
+    {
+        return _uartWriteWait(pBuf, numBytes);
+    }
+
+    if (true == ATCMD_PlatformIsEventTask())
+    {
+        /* Other tasks may be waiting on the print lock, only wait for the
+           UART if the output cannot even be deferred */
+
+        if (true == _uartWriteNoWait(pBuf, numBytes, sizeof(txDeferBuf), false))
+        {
+            return true;
+        }
+
+        return _uartWriteWait(pBuf, numBytes);
+    }
+
+    /* Other tasks (MQTT, TCP/IP) never wait for the UART, they only get half
+       of the defer buffer so there is always room left for the AT task */
+
+    return _uartWriteNoWait(pBuf, numBytes, sizeof(txDeferBuf)/2, true);
+}
+
+void ATCMD_PlatformUARTWriteGetStats(ATCMD_PLATFORM_UART_TX_STATS *pStats)
+{
+    if (NULL != pStats)
+    {
+        *pStats = txStats;
+    }
+}
+
+uint32_t ATCMD_PlatformGetSysTimeMs(void)
+{
+    return timerMS;
+}
+
+void ATCMD_PlatformEventSignal(void)
+{
+    if (NULL != eventTaskHandle)
+    {
+        xTaskNotifyGive(eventTaskHandle);
+    }
+}
+
+void ATCMD_PlatformEventSignalFromISR(void)
+{
+    BaseType_t higherPriorityTaskWoken = pdFALSE;
+
+    if (NULL != eventTaskHandle)
+    {
+        vTaskNotifyGiveFromISR(eventTaskHandle, &higherPriorityTaskWoken);
+    }
+
+    portEND_SWITCHING_ISR(higherPriorityTaskWoken);
+}
+
+bool ATCMD_PlatformEventWait(uint32_t timeoutMs)
+{
+    TickType_t timeoutTicks;
+
+    eventTaskHandle = xTaskGetCurrentTaskHandle();
+
+    if (0 == timeoutMs)
     {
         return false;
     }
 
-//	uint8_t b = '\0';
-    UART2_Write((uint8_t *)pBuf, numBytes);
-//	UART2_Write(&b, 1);
-    
+    if (ATCMD_PLATFORM_WAIT_FOREVER == timeoutMs)
+    {
+        timeoutTicks = portMAX_DELAY;
+    }
+    else
+    {
+        timeoutTicks = pdMS_TO_TICKS(timeoutMs);
+    }
 
-    if (OSAL_SEM_Post(&printEventSemaphore) != OSAL_RESULT_TRUE)
+    /* All signals raised since the last wait are consumed at once */
+    return (ulTaskNotifyTake(pdTRUE, timeoutTicks) > 0);
+}
+
+bool ATCMD_PlatformPrintLock(void)
+{
+    bool isEventTask = ATCMD_PlatformIsEventTask();
+
+    if (false == printStageMutexValid)
+    {
+        return false;
+    }
+
+    if (true == isEventTask)
+    {
+        /* Send output deferred by other tasks before taking the lock they may need */
+        _uartWriteWait(NULL, 0);
+    }
+
+    if (OSAL_RESULT_TRUE != OSAL_MUTEX_Lock(&printStageMutex, OSAL_WAIT_FOREVER))
     {
         return false;
     }
+
+    if (true == isEventTask)
+    {
+        printStageLockedByEventTask = true;
+    }
+
     return true;
 }
 
-uint32_t ATCMD_PlatformGetSysTimeMs(void)
+void ATCMD_PlatformPrintUnlock(void)
 {
-    return timerMS;
+    if (true == ATCMD_PlatformIsEventTask())
+    {
+        printStageLockedByEventTask = false;
+    }
+
+    OSAL_MUTEX_Unlock(&printStageMutex);
+}
+
+bool ATCMD_PlatformIsEventTask(void)
+{
+    return ((NULL != eventTaskHandle) && (xTaskGetCurrentTaskHandle() == eventTaskHandle));
+}
+
+void* ATCMD_PlatformGetTaskID(void)
+{
+    return xTaskGetCurrentTaskHandle();
 }
@@ -0,0 +1,610 @@
+/**
+ *
+ * Copyright (c) 2019 Microchip Technology Inc. and its subsidiaries.
+ *
+ * Subject to your compliance with these terms, you may use Microchip
+ * software and any derivatives exclusively with Microchip products.
+ * It is your responsibility to comply with third party license terms applicable
+ * to your use of third party software (including open source software) that
+ * may accompany Microchip software.
+ *
+ * THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES,
+ * WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE,
+ * INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY,
+ * AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE
+ * LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL
+ * LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE
+ * SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE
+ * POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT
+ * ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY
+ * RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+ * THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+ *
+ */
+/*
+ * Support and FAQ: visit <a href="https://www.microchip.com/support/">Microchip Support</a>
+ */
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "cJSON.h"
+#include "tcpip/tcpip.h"
+#include "tcpip/src/tcpip_heap_alloc.h"
+#include "at_cmd_app.h"
+#include "at_cmd_mem.h"
+
+#define ATCMD_MEM_NO_SITE           0xff
+#define ATCMD_MEM_MAX_REC_SIZE      ((1UL << 20) - 1)
+#define ATCMD_MEM_MAX_LOAD          ((AT_CMD_MEM_NUM_RECORDS * 7) / 8)
+#define ATCMD_MEM_REC_MASK          (AT_CMD_MEM_NUM_RECORDS - 1)
+
+#if ((AT_CMD_MEM_NUM_RECORDS & ATCMD_MEM_REC_MASK) != 0)
+#error "AT_CMD_MEM_NUM_RECORDS must be a power of 2"
+#endif
+
+#if (AT_CMD_MEM_NUM_SITES >= ATCMD_MEM_NO_SITE)
+#error "AT_CMD_MEM_NUM_SITES too large"
+#endif
+
+typedef struct
+{
+    uintptr_t   ptr;                /* 0 - free slot */
+    uint32_t    size    : 20;
+    uint32_t    owner   : 4;
+    uint32_t    site    : 8;
+} ATCMD_MEM_RECORD;
+
+typedef struct
+{
+    /* Open addressed table of live allocations, keyed by address */
+    ATCMD_MEM_RECORD        records[AT_CMD_MEM_NUM_RECORDS];
+    uint32_t                numRecords;
+    uint32_t                numUntracked;
+    uint32_t                currBytes;
+    uint32_t                peakBytes;
+    ATCMD_MEM_OWNER_STATS   owners[ATCMD_MEM_OWNER_NUM];
+    ATCMD_MEM_SIZE_BIN      sizeBins[ATCMD_MEM_NUM_SIZE_BINS];
+    ATCMD_MEM_SITE_STATS    sites[AT_CMD_MEM_NUM_SITES];
+} ATCMD_MEM_STATE;
+
+/* Zero initialised state is valid, allocations are tracked from reset */
+static ATCMD_MEM_STATE atCmdMemState;
+
+static const char* const atCmdMemOwnerNames[ATCMD_MEM_OWNER_NUM] =
+{
+    "OS",
+    "TCPIP",
+    "TLS",
+    "JSON"
+};
+
+/* Linker symbol, its address is the size of the heap */
+extern char _min_heap_size;
+
+/* wolfSSL user allocators, selected by XMALLOC_USER */
+void *XMALLOC(size_t n, void* heap, int type);
+void *XREALLOC(void *p, size_t n, void* heap, int type);
+void XFREE(void *p, void* heap, int type);
+
+static uint32_t _MemHash(uintptr_t ptr)
+{
+    uint32_t h = (uint32_t)(ptr >> 3) * 2654435761UL;
+
+    return (h ^ (h >> 16)) & ATCMD_MEM_REC_MASK;
+}
+
+static int _MemSizeBin(size_t size)
+{
+    int bin = 0;
+    size_t binSize = 16;
+
+    while ((size > binSize) && (bin < (ATCMD_MEM_NUM_SIZE_BINS-1)))
+    {
+        binSize <<= 1;
+        bin++;
+    }
+
+    return bin;
+}
+
+static int _MemRecordFind(uintptr_t ptr)
+{
+    uint32_t i = _MemHash(ptr);
+
+    while (0 != atCmdMemState.records[i].ptr)
+    {
+        if (ptr == atCmdMemState.records[i].ptr)
+        {
+            return i;
+        }
+
+        i = (i + 1) & ATCMD_MEM_REC_MASK;
+    }
+
+    return -1;
+}
+
+/* Returns the hotspot entry of a call site, a new entry replaces the least
+   used site with no live allocations */
+static uint8_t _MemSiteGet(ATCMD_MEM_OWNER owner, uintptr_t callSite)
+{
+    ATCMD_MEM_SITE_STATS *pSite;
+    int i;
+    int newSite = ATCMD_MEM_NO_SITE;
+    uint32_t minAllocs = UINT32_MAX;
+
+    if (0 == callSite)
+    {
+        return ATCMD_MEM_NO_SITE;
+    }
+
+    for (i=0; i<AT_CMD_MEM_NUM_SITES; i++)
+    {
+        pSite = &atCmdMemState.sites[i];
+
+        if ((callSite == pSite->callSite) && (owner == pSite->owner))
+        {
+            return i;
+        }
+
+        if ((0 == pSite->numLive) && (pSite->numAllocs < minAllocs))
+        {
+            minAllocs = pSite->numAllocs;
+            newSite   = i;
+        }
+    }
+
+    if (ATCMD_MEM_NO_SITE != newSite)
+    {
+        pSite = &atCmdMemState.sites[newSite];
+
+        memset(pSite, 0, sizeof(ATCMD_MEM_SITE_STATS));
+        pSite->callSite = callSite;
+        pSite->owner    = owner;
+    }
+
+    return newSite;
+}
+
+/* Removes a record, moving back the entries of its probe sequence */
+static void _MemRecordDrop(uint32_t i)
+{
+    ATCMD_MEM_RECORD *pRec = &atCmdMemState.records[i];
+    ATCMD_MEM_OWNER_STATS *pOwner = &atCmdMemState.owners[pRec->owner];
+    uint32_t j, k;
+
+    pOwner->currBytes -= pRec->size;
+    pOwner->numLive--;
+    atCmdMemState.sizeBins[_MemSizeBin(pRec->size)].numLive--;
+    atCmdMemState.currBytes -= pRec->size;
+
+    if (ATCMD_MEM_NO_SITE != pRec->site)
+    {
+        atCmdMemState.sites[pRec->site].currBytes -= pRec->size;
+        atCmdMemState.sites[pRec->site].numLive--;
+    }
+
+    atCmdMemState.numRecords--;
+    pRec->ptr = 0;
+
+    j = i;
+
+    while (1)
+    {
+        j = (j + 1) & ATCMD_MEM_REC_MASK;
+
+        if (0 == atCmdMemState.records[j].ptr)
+        {
+            break;
+        }
+
+        k = _MemHash(atCmdMemState.records[j].ptr);
+
+        /* Leave entries whose home slot lies cyclically in (i, j] */
+        if ((i <= j) ? ((i < k) && (k <= j)) : ((i < k) || (k <= j)))
+        {
+            continue;
+        }
+
+        atCmdMemState.records[i] = atCmdMemState.records[j];
+        atCmdMemState.records[j].ptr = 0;
+        i = j;
+    }
+}
+
+static void _MemRecordAdd(ATCMD_MEM_OWNER owner, void *ptr, size_t size, uintptr_t callSite)
+{
+    ATCMD_MEM_OWNER_STATS *pOwner = &atCmdMemState.owners[owner];
+    ATCMD_MEM_SIZE_BIN *pBin;
+    ATCMD_MEM_RECORD *pRec;
+    int i;
+
+    if (NULL == ptr)
+    {
+        pOwner->numFailed++;
+        return;
+    }
+
+    if (size > ATCMD_MEM_MAX_REC_SIZE)
+    {
+        size = ATCMD_MEM_MAX_REC_SIZE;
+    }
+
+    pBin = &atCmdMemState.sizeBins[_MemSizeBin(size)];
+
+    pOwner->numAllocs++;
+    pBin->numAllocs++;
+
+    /* A release that bypassed the tracker left a stale record */
+    i = _MemRecordFind((uintptr_t)ptr);
+
+    if (i >= 0)
+    {
+        _MemRecordDrop(i);
+    }
+
+    if (atCmdMemState.numRecords >= ATCMD_MEM_MAX_LOAD)
+    {
+        atCmdMemState.numUntracked++;
+        return;
+    }
+
+    i = _MemHash((uintptr_t)ptr);
+
+    while (0 != atCmdMemState.records[i].ptr)
+    {
+        i = (i + 1) & ATCMD_MEM_REC_MASK;
+    }
+
+    pRec = &atCmdMemState.records[i];
+
+    pRec->ptr   = (uintptr_t)ptr;
+    pRec->size  = size;
+    pRec->owner = owner;
+    pRec->site  = _MemSiteGet(owner, callSite);
+
+    atCmdMemState.numRecords++;
+
+    pOwner->currBytes += size;
+    pOwner->numLive++;
+
+    if (pOwner->currBytes > pOwner->peakBytes)
+    {
+        pOwner->peakBytes = pOwner->currBytes;
+    }
+
+    pBin->numLive++;
+
+    atCmdMemState.currBytes += size;
+
+    if (atCmdMemState.currBytes > atCmdMemState.peakBytes)
+    {
+        atCmdMemState.peakBytes = atCmdMemState.currBytes;
+    }
+
+    if (ATCMD_MEM_NO_SITE != pRec->site)
+    {
+        ATCMD_MEM_SITE_STATS *pSite = &atCmdMemState.sites[pRec->site];
+
+        pSite->numAllocs++;
+        pSite->numLive++;
+        pSite->currBytes += size;
+
+        if (pSite->currBytes > pSite->peakBytes)
+        {
+            pSite->peakBytes = pSite->currBytes;
+        }
+    }
+}
+
+static void _MemRecordFree(void *ptr)
+{
+    int i;
+
+    if (NULL == ptr)
+    {
+        return;
+    }
+
+    i = _MemRecordFind((uintptr_t)ptr);
+
+    if (i >= 0)
+    {
+        _MemRecordDrop(i);
+    }
+}
+
+/* The newlib heap has no locking of its own, as for heap_3 the scheduler is
+   suspended around it */
+static void* _MemAlloc(ATCMD_MEM_OWNER owner, size_t size, void *pCallSite)
+{
+    void *ptr;
+
+    vTaskSuspendAll();
+
+    ptr = malloc(size);
+
+    _MemRecordAdd(owner, ptr, size, (uintptr_t)pCallSite);
+
+    (void)xTaskResumeAll();
+
+    return ptr;
+}
+
+static void* _MemCalloc(ATCMD_MEM_OWNER owner, size_t nElems, size_t elemSize, void *pCallSite)
+{
+    void *ptr;
+
+    if ((0 != elemSize) && (nElems > (SIZE_MAX / elemSize)))
+    {
+        return NULL;
+    }
+
+    ptr = _MemAlloc(owner, nElems * elemSize, pCallSite);
+
+    if (NULL != ptr)
+    {
+        memset(ptr, 0, nElems * elemSize);
+    }
+
+    return ptr;
+}
+
+static void _MemFree(void *ptr)
+{
+    if (NULL == ptr)
+    {
+        return;
+    }
+
+    vTaskSuspendAll();
+
+    _MemRecordFree(ptr);
+
+    free(ptr);
+
+    (void)xTaskResumeAll();
+}
+
+static void* _MemJSONMalloc(size_t size)
+{
+    return _MemAlloc(ATCMD_MEM_OWNER_JSON, size, __builtin_return_address(0));
+}
+
+static void _MemJSONFree(void *ptr)
+{
+    _MemFree(ptr);
+}
+
+void ATCMD_MemInit(void)
+{
+    cJSON_Hooks hooks;
+
+    hooks.malloc_fn = _MemJSONMalloc;
+    hooks.free_fn   = _MemJSONFree;
+
+    cJSON_InitHooks(&hooks);
+}
+
+/* Called by the FreeRTOS traceMALLOC/traceFREE hooks */
+void ATCMD_MemTrackAlloc(ATCMD_MEM_OWNER owner, void *ptr, size_t size, void *pCallSite)
+{
+    vTaskSuspendAll();
+
+    _MemRecordAdd(owner, ptr, size, (uintptr_t)pCallSite);
+
+    (void)xTaskResumeAll();
+}
+
+void ATCMD_MemTrackFree(void *ptr)
+{
+    if (NULL == ptr)
+    {
+        return;
+    }
+
+    vTaskSuspendAll();
+
+    _MemRecordFree(ptr);
+
+    (void)xTaskResumeAll();
+}
+
+/* TCP/IP heap allocation functions, TCPIP_STACK_MALLOC_FUNC etc. */
+void* ATCMD_MemTCPIPMalloc(size_t size)
+{
+    return _MemAlloc(ATCMD_MEM_OWNER_TCPIP, size, __builtin_return_address(0));
+}
+
+void* ATCMD_MemTCPIPCalloc(size_t nElems, size_t elemSize)
+{
+    return _MemCalloc(ATCMD_MEM_OWNER_TCPIP, nElems, elemSize, __builtin_return_address(0));
+}
+
+void ATCMD_MemTCPIPFree(void *ptr)
+{
+    _MemFree(ptr);
+}
+
+void *XMALLOC(size_t n, void* heap, int type)
+{
+    (void)heap;
+    (void)type;
+
+    return _MemAlloc(ATCMD_MEM_OWNER_TLS, n, __builtin_return_address(0));
+}
+
+void *XREALLOC(void *p, size_t n, void* heap, int type)
+{
+    void *ptr;
+
+    (void)heap;
+    (void)type;
+
+    vTaskSuspendAll();
+
+    ptr = realloc(p, n);
+
+    /* On failure the original block is kept */
+    if ((NULL != ptr) || (0 == n))
+    {
+        _MemRecordFree(p);
+    }
+
+    if (0 != n)
+    {
+        _MemRecordAdd(ATCMD_MEM_OWNER_TLS, ptr, n, (uintptr_t)__builtin_return_address(0));
+    }
+
+    (void)xTaskResumeAll();
+
+    return ptr;
+}
+
+void XFREE(void *p, void* heap, int type)
+{
+    (void)heap;
+    (void)type;
+
+    _MemFree(p);
+}
+
+/* Largest block the heap can currently provide, found by a binary search of
+   trial allocations with the scheduler suspended, so only run it on request
+   and never as part of a snapshot */
+size_t ATCMD_MemLargestFreeBlock(void)
+{
+    size_t low  = 0;
+    size_t high = (size_t)&_min_heap_size;
+    size_t mid;
+    void *ptr;
+
+    vTaskSuspendAll();
+
+    while (low < high)
+    {
+        mid = low + ((high - low + 1) / 2);
+
+        ptr = malloc(mid);
+
+        if (NULL != ptr)
+        {
+            free(ptr);
+            low = mid;
+        }
+        else
+        {
+            high = mid - 1;
+        }
+    }
+
+    (void)xTaskResumeAll();
+
+    return low;
+}
+
+/* Block usage of the pool TCP/IP heap, per entry */
+static void _MemPoolStatsGet(ATCMD_MEM_POOL_STATS *pPool)
+{
+    memset(pPool, 0, sizeof(ATCMD_MEM_POOL_STATS));
+
+#if defined(TCPIP_STACK_USE_INTERNAL_HEAP_POOL)
+    TCPIP_STACK_HEAP_HANDLE heapH;
+    TCPIP_HEAP_POOL_ENTRY_LIST entryList;
+    TCPIP_HEAP_POOL_EXT_STATS extStats;
+    int numEntries;
+    int i;
+
+    heapH = TCPIP_STACK_HeapHandleGet(TCPIP_STACK_HEAP_TYPE_INTERNAL_HEAP_POOL, 0);
+
+    if (0 == heapH)
+    {
+        return;
+    }
+
+    numEntries = TCPIP_HEAP_POOL_Entries(heapH);
+
+    if (numEntries > AT_CMD_MEM_NUM_POOL_ENTRIES)
+    {
+        numEntries = AT_CMD_MEM_NUM_POOL_ENTRIES;
+    }
+
+    for (i=0; i<numEntries; i++)
+    {
+        ATCMD_MEM_POOL_ENTRY_STATS *pEntry = &pPool->entries[i];
+
+        if (false == TCPIP_HEAP_POOL_EntryList(heapH, i, &entryList))
+        {
+            break;
+        }
+
+        pEntry->blockSize    = entryList.blockSize;
+        pEntry->numBlocks    = entryList.nBlocks;
+        pEntry->usedBlocks   = entryList.nBlocks - entryList.freeBlocks;
+        pEntry->peakBlocks   = entryList.maxUsedBlocks;
+        pEntry->numAllocs    = entryList.nAllocs;
+        pEntry->numFallbacks = entryList.nFallbacks;
+        pEntry->numFailed    = entryList.nFailed;
+
+        pPool->usedBytes += entryList.totEntrySize - entryList.totFreeSize;
+    }
+
+    pPool->numEntries  = i;
+    pPool->regionBytes = TCPIP_HEAP_Size(heapH);
+    pPool->peakBytes   = TCPIP_HEAP_HighWatermark(heapH);
+
+    if ((true == TCPIP_HEAP_POOL_ExtStats(heapH, &extStats)) && (true == extStats.enabled))
+    {
+        pPool->extBytes     = extStats.currBytes;
+        pPool->extPeakBytes = extStats.maxBytes;
+        pPool->extAllocs    = extStats.nAllocs;
+        pPool->extFailed    = extStats.nFailed;
+    }
+#endif
+}
+
+void ATCMD_MemSnapshotGet(ATCMD_MEM_SNAPSHOT *pSnapshot)
+{
+    if (NULL == pSnapshot)
+    {
+        return;
+    }
+
+    pSnapshot->magic       = ATCMD_MEM_SNAPSHOT_MAGIC;
+    pSnapshot->version     = ATCMD_MEM_SNAPSHOT_VERSION;
+    pSnapshot->numOwners   = ATCMD_MEM_OWNER_NUM;
+    pSnapshot->numSizeBins = ATCMD_MEM_NUM_SIZE_BINS;
+    pSnapshot->numSites    = AT_CMD_MEM_NUM_SITES;
+    pSnapshot->timeMs      = ATCMD_PlatformGetSysTimeMs();
+    pSnapshot->heapSize    = (uint32_t)&_min_heap_size;
+    pSnapshot->maxRecords  = ATCMD_MEM_MAX_LOAD;
+
+    _MemPoolStatsGet(&pSnapshot->tcpipPool);
+
+    vTaskSuspendAll();
+
+    pSnapshot->currBytes    = atCmdMemState.currBytes;
+    pSnapshot->peakBytes    = atCmdMemState.peakBytes;
+    pSnapshot->numRecords   = atCmdMemState.numRecords;
+    pSnapshot->numUntracked = atCmdMemState.numUntracked;
+
+    memcpy(pSnapshot->owners, atCmdMemState.owners, sizeof(pSnapshot->owners));
+    memcpy(pSnapshot->sizeBins, atCmdMemState.sizeBins, sizeof(pSnapshot->sizeBins));
+    memcpy(pSnapshot->sites, atCmdMemState.sites, sizeof(pSnapshot->sites));
+
+    (void)xTaskResumeAll();
+}
+
+const char* ATCMD_MemOwnerName(ATCMD_MEM_OWNER owner)
+{
+    if (owner >= ATCMD_MEM_OWNER_NUM)
+    {
+        return "";
+    }
+
+    return atCmdMemOwnerNames[owner];
+}
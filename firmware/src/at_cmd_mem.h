@@ -0,0 +1,164 @@
+/**
+ *
+ * Copyright (c) 2019 Microchip Technology Inc. and its subsidiaries.
+ *
+ * Subject to your compliance with these terms, you may use Microchip
+ * software and any derivatives exclusively with Microchip products.
+ * It is your responsibility to comply with third party license terms applicable
+ * to your use of third party software (including open source software) that
+ * may accompany Microchip software.
+ *
+ * THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES,
+ * WHETHER EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE,
+ * INCLUDING ANY IMPLIED WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY,
+ * AND FITNESS FOR A PARTICULAR PURPOSE. IN NO EVENT WILL MICROCHIP BE
+ * LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, INCIDENTAL OR CONSEQUENTIAL
+ * LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND WHATSOEVER RELATED TO THE
+ * SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS BEEN ADVISED OF THE
+ * POSSIBILITY OR THE DAMAGES ARE FORESEEABLE.  TO THE FULLEST EXTENT
+ * ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN ANY WAY
+ * RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+ * THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+ *
+ */
+/*
+ * Support and FAQ: visit <a href="https://www.microchip.com/support/">Microchip Support</a>
+ */
+
+#ifndef _AT_CMD_MEM_H
+#define _AT_CMD_MEM_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Allocation tracker.
+
+   Allocations from the FreeRTOS heap (pvPortMalloc) are reported through the
+   traceMALLOC/traceFREE hooks. The TCP/IP heap, wolfSSL and cJSON allocate
+   through the wrappers below, which take the same newlib heap.
+
+   Each live allocation is recorded by address with its owner, size and the
+   call site (return address of the allocating call).
+
+   With the pool TCP/IP heap the TCPIP owner only sees the pool region, taken
+   once at stack init, and the external fallback allocations. The use of the
+   pool itself is read from the pool heap entries. */
+
+#ifndef AT_CMD_MEM_NUM_RECORDS
+#define AT_CMD_MEM_NUM_RECORDS          512     /* Power of 2 */
+#endif
+
+#ifndef AT_CMD_MEM_NUM_SITES
+#define AT_CMD_MEM_NUM_SITES            32
+#endif
+
+#ifndef AT_CMD_MEM_NUM_POOL_ENTRIES
+#define AT_CMD_MEM_NUM_POOL_ENTRIES     10
+#endif
+
+#define ATCMD_MEM_NUM_SIZE_BINS         12      /* <=16, <=32, ... <=16K, larger */
+#define ATCMD_MEM_SNAPSHOT_MAGIC        0x534d454dUL    /* "MEMS" */
+#define ATCMD_MEM_SNAPSHOT_VERSION      3
+
+typedef enum
+{
+    ATCMD_MEM_OWNER_OS,         /* pvPortMalloc: RTOS objects, OSAL_Malloc users */
+    ATCMD_MEM_OWNER_TCPIP,      /* TCP/IP stack heap */
+    ATCMD_MEM_OWNER_TLS,        /* wolfSSL */
+    ATCMD_MEM_OWNER_JSON,       /* cJSON */
+    ATCMD_MEM_OWNER_NUM
+} ATCMD_MEM_OWNER;
+
+/* The snapshot structures are laid out without padding, little endian,
+   they are dumped as they are by AT+INFO=4 */
+
+typedef struct
+{
+    uint32_t    currBytes;
+    uint32_t    peakBytes;
+    uint32_t    numLive;
+    uint32_t    numAllocs;
+    uint32_t    numFailed;
+} ATCMD_MEM_OWNER_STATS;
+
+typedef struct
+{
+    uint32_t    numAllocs;
+    uint32_t    numLive;
+} ATCMD_MEM_SIZE_BIN;
+
+typedef struct
+{
+    uint32_t    callSite;       /* 0 - unused */
+    uint8_t     owner;
+    uint8_t     reserved[3];
+    uint32_t    numAllocs;
+    uint32_t    numLive;
+    uint32_t    currBytes;
+    uint32_t    peakBytes;
+} ATCMD_MEM_SITE_STATS;
+
+typedef struct
+{
+    uint32_t    blockSize;
+    uint32_t    numBlocks;      /* Expanded blocks included */
+    uint32_t    usedBlocks;
+    uint32_t    peakBlocks;
+    uint32_t    numAllocs;
+    uint32_t    numFallbacks;   /* Served by a larger entry or externally */
+    uint32_t    numFailed;
+} ATCMD_MEM_POOL_ENTRY_STATS;
+
+typedef struct
+{
+    uint32_t    numEntries;     /* 0 - no pool heap */
+    uint32_t    regionBytes;    /* Block and expansion bytes of the pool region */
+    uint32_t    usedBytes;
+    uint32_t    peakBytes;
+    uint32_t    extBytes;       /* External fallback allocations */
+    uint32_t    extPeakBytes;
+    uint32_t    extAllocs;
+    uint32_t    extFailed;
+    ATCMD_MEM_POOL_ENTRY_STATS  entries[AT_CMD_MEM_NUM_POOL_ENTRIES];
+} ATCMD_MEM_POOL_STATS;
+
+typedef struct
+{
+    uint32_t                magic;
+    uint8_t                 version;
+    uint8_t                 numOwners;
+    uint8_t                 numSizeBins;
+    uint8_t                 numSites;
+    uint32_t                timeMs;
+    uint32_t                heapSize;
+    uint32_t                currBytes;
+    uint32_t                peakBytes;
+    uint16_t                numRecords;     /* Live allocations recorded */
+    uint16_t                maxRecords;
+    uint32_t                numUntracked;   /* Allocations not recorded, record table full */
+    ATCMD_MEM_OWNER_STATS   owners[ATCMD_MEM_OWNER_NUM];
+    ATCMD_MEM_SIZE_BIN      sizeBins[ATCMD_MEM_NUM_SIZE_BINS];
+    ATCMD_MEM_SITE_STATS    sites[AT_CMD_MEM_NUM_SITES];
+    ATCMD_MEM_POOL_STATS    tcpipPool;
+} ATCMD_MEM_SNAPSHOT;
+
+#ifdef __cplusplus  // Provide C++ Compatibility
+extern "C" {
+#endif
+
+void ATCMD_MemInit(void);
+void ATCMD_MemTrackAlloc(ATCMD_MEM_OWNER owner, void *ptr, size_t size, void *pCallSite);
+void ATCMD_MemTrackFree(void *ptr);
+void* ATCMD_MemTCPIPMalloc(size_t size);
+void* ATCMD_MemTCPIPCalloc(size_t nElems, size_t elemSize);
+void ATCMD_MemTCPIPFree(void *ptr);
+size_t ATCMD_MemLargestFreeBlock(void);
+void ATCMD_MemSnapshotGet(ATCMD_MEM_SNAPSHOT *pSnapshot);
+const char* ATCMD_MemOwnerName(ATCMD_MEM_OWNER owner);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _AT_CMD_MEM_H */
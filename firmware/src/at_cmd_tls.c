@@ -35,6 +35,31 @@
 
 extern ATCMD_APP_CONTEXT atCmdAppContext;
 
+typedef struct
+{
+    WOLFSSL_CTX         *pTlsCtx;
+    bool                isClient;
+    bool                isStale;
+    int                 numRefs;
+    uint32_t            confHash;
+    uint32_t            lastUse;
+    ATCMD_APP_TLS_CONF  tlsConf;
+} ATCMD_TLS_CTX_CACHE_ENTRY;
+
+typedef struct
+{
+    char                host[AT_CMD_TLS_SERVER_NAME_SZ+1];
+    uint16_t            port;
+    uint32_t            numFull;
+    uint32_t            numResumed;
+    uint32_t            lastTimeMs;
+} ATCMD_TLS_SESS_CACHE_ENTRY;
+
+static ATCMD_TLS_CTX_CACHE_ENTRY tlsCtxCache[AT_CMD_TLS_CTX_CACHE_SZ];
+static uint32_t tlsCtxCacheUseCount;
+static ATCMD_TLS_SESS_CACHE_ENTRY tlsSessCache[AT_CMD_TLS_NUM_CONFS][AT_CMD_TLS_SESS_CACHE_SZ];
+static uint8_t tlsSessGeneration[AT_CMD_TLS_NUM_CONFS];
+
 static int _sockWolfSSLRecvCallback(WOLFSSL *pSSLCtx, char *pBuf, int size, void *pAppCtx)
 {
     TCP_SOCKET hTCP = *(TCP_SOCKET*)pAppCtx;
@@ -95,23 +120,20 @@ static int _wolfsslPemPasswordCallback(char* passwd, int sz, int rw, void* userd
 }
 #endif
 
-static WOLFSSL_CTX* _tlsCreateTlsCtx(bool isClient)
+static WOLFSSL_CTX* _tlsCreateTlsCtx(ATCMD_APP_TLS_CONF *pTlsConf, bool isClient)
 {
     WOLFSSL_CTX *pTlsCtx;
-    ATCMD_APP_TLS_CONF *pTlsConf;
     const AT_CMD_CERT_ENTRY     *pCACertEntry = NULL;
     const AT_CMD_CERT_ENTRY     *pCertEntry   = NULL;
     const AT_CMD_PRIKEY_ENTRY   *pPriKeyEntry = NULL;
-    
-   if (true == isClient)
+
+    if (true == isClient)
     {
         pTlsCtx = wolfSSL_CTX_new(wolfSSLv23_client_method());
-        pTlsConf = &atCmdAppContext.tlsConf[0];
     }
     else
     {
         pTlsCtx = wolfSSL_CTX_new(wolfSSLv23_server_method());
-        pTlsConf = &atCmdAppContext.tlsConf[1];
     }
 
     if (NULL == pTlsCtx)
@@ -182,11 +204,376 @@ static WOLFSSL_CTX* _tlsCreateTlsCtx(bool isClient)
     }
 
     if (WOLFSSL_SUCCESS != wolfSSL_CTX_UseSupportedCurve(pTlsCtx, WOLFSSL_ECC_SECP256R1)) {
-        return false;
+        wolfSSL_CTX_free(pTlsCtx);
+        return NULL;
+    }
+    return pTlsCtx;
+}
+
+/* FNV-1a over the configuration fields which feed into a CTX */
+static uint32_t _tlsConfHash(const ATCMD_APP_TLS_CONF *pTlsConf, bool isClient)
+{
+    const uint8_t *pBytes = (const uint8_t*)pTlsConf;
+    size_t numBytes = offsetof(ATCMD_APP_TLS_CONF, numSessions);
+    uint32_t hash = 2166136261UL;
+
+    while (numBytes--)
+    {
+        hash = (hash ^ *pBytes++) * 16777619UL;
+    }
+
+    return (hash ^ (uint32_t)isClient) * 16777619UL;
+}
+
+static void _tlsCtxCacheFreeEntry(ATCMD_TLS_CTX_CACHE_ENTRY *pEntry)
+{
+    wolfSSL_CTX_free(pEntry->pTlsCtx);
+
+    memset(pEntry, 0, sizeof(ATCMD_TLS_CTX_CACHE_ENTRY));
+}
+
+/* Find or create a CTX for this configuration and take a reference to it */
+static WOLFSSL_CTX* _tlsCtxCacheGet(ATCMD_APP_TLS_CONF *pTlsConf, bool isClient)
+{
+    ATCMD_TLS_CTX_CACHE_ENTRY *pEntry;
+    ATCMD_TLS_CTX_CACHE_ENTRY *pFreeEntry = NULL;
+    WOLFSSL_CTX *pTlsCtx;
+    uint32_t confHash;
+    int i;
+
+    confHash = _tlsConfHash(pTlsConf, isClient);
+
+    for (i=0; i<AT_CMD_TLS_CTX_CACHE_SZ; i++)
+    {
+        pEntry = &tlsCtxCache[i];
+
+        if (NULL == pEntry->pTlsCtx)
+        {
+            if (NULL == pFreeEntry)
+            {
+                pFreeEntry = pEntry;
+            }
+
+            continue;
+        }
+
+        if ((true == pEntry->isStale) || (confHash != pEntry->confHash) || (isClient != pEntry->isClient))
+        {
+            continue;
+        }
+
+        if (0 != memcmp(&pEntry->tlsConf, pTlsConf, offsetof(ATCMD_APP_TLS_CONF, numSessions)))
+        {
+            continue;
+        }
+
+        pEntry->numRefs++;
+        pEntry->lastUse = ++tlsCtxCacheUseCount;
+
+        return pEntry->pTlsCtx;
+    }
+
+    pTlsCtx = _tlsCreateTlsCtx(pTlsConf, isClient);
+
+    if (NULL == pTlsCtx)
+    {
+        return NULL;
+    }
+
+    if (NULL == pFreeEntry)
+    {
+        /* Cache is full, evict the least recently used idle CTX */
+
+        for (i=0; i<AT_CMD_TLS_CTX_CACHE_SZ; i++)
+        {
+            pEntry = &tlsCtxCache[i];
+
+            if ((0 == pEntry->numRefs) && ((NULL == pFreeEntry) || ((int32_t)(pEntry->lastUse - pFreeEntry->lastUse) < 0)))
+            {
+                pFreeEntry = pEntry;
+            }
+        }
+
+        if (NULL == pFreeEntry)
+        {
+            /* Every cached CTX is in use, hand out an uncached one */
+            return pTlsCtx;
+        }
+
+        _tlsCtxCacheFreeEntry(pFreeEntry);
     }
+
+    pFreeEntry->pTlsCtx  = pTlsCtx;
+    pFreeEntry->isClient = isClient;
+    pFreeEntry->isStale  = false;
+    pFreeEntry->numRefs  = 1;
+    pFreeEntry->confHash = confHash;
+    pFreeEntry->lastUse  = ++tlsCtxCacheUseCount;
+
+    memcpy(&pFreeEntry->tlsConf, pTlsConf, offsetof(ATCMD_APP_TLS_CONF, numSessions));
+
     return pTlsCtx;
 }
 
+/* Drop a reference to a CTX, idle CTXs stay cached unless they are stale */
+static void _tlsCtxCacheRelease(WOLFSSL_CTX *pTlsCtx)
+{
+    int i;
+
+    for (i=0; i<AT_CMD_TLS_CTX_CACHE_SZ; i++)
+    {
+        ATCMD_TLS_CTX_CACHE_ENTRY *pEntry = &tlsCtxCache[i];
+
+        if (pTlsCtx == pEntry->pTlsCtx)
+        {
+            pEntry->numRefs--;
+
+            if ((0 == pEntry->numRefs) && (true == pEntry->isStale))
+            {
+                _tlsCtxCacheFreeEntry(pEntry);
+            }
+
+            return;
+        }
+    }
+
+    wolfSSL_CTX_free(pTlsCtx);
+}
+
+void ATCMD_TLS_CtxCacheFlush(void)
+{
+    int i;
+
+    for (i=0; i<AT_CMD_TLS_CTX_CACHE_SZ; i++)
+    {
+        ATCMD_TLS_CTX_CACHE_ENTRY *pEntry = &tlsCtxCache[i];
+
+        if (NULL == pEntry->pTlsCtx)
+        {
+            continue;
+        }
+
+        if (0 == pEntry->numRefs)
+        {
+            _tlsCtxCacheFreeEntry(pEntry);
+        }
+        else
+        {
+            /* Still in use, free it once the last session has gone */
+            pEntry->isStale = true;
+        }
+    }
+}
+
+/* Sessions are looked up by SNI when one is configured, otherwise by the
+   name or address the connection was made to */
+static const char* _tlsSessionHost(const ATCMD_APP_TLS_CONF *pTlsConf, const char *pHost)
+{
+    if (pTlsConf->serverName[0] > 0)
+    {
+        return &pTlsConf->serverName[1];
+    }
+
+    return pHost;
+}
+
+static int _tlsConfIndex(const ATCMD_APP_TLS_CONF *pTlsConf)
+{
+    int confIdx = pTlsConf - atCmdAppContext.tlsConf;
+
+    if ((confIdx < 0) || (confIdx >= AT_CMD_TLS_NUM_CONFS))
+    {
+        return -1;
+    }
+
+    return confIdx;
+}
+
+bool ATCMD_TLS_SessionServerID(const ATCMD_APP_TLS_CONF *pTlsConf, const char *pHost, uint16_t port, uint8_t *pServerID)
+{
+    int confIdx;
+    uint32_t hostHash = 2166136261UL;
+    const char *pStr;
+
+    if ((NULL == pTlsConf) || (NULL == pServerID) || (false == pTlsConf->sessionResume))
+    {
+        return false;
+    }
+
+    confIdx = _tlsConfIndex(pTlsConf);
+    pHost   = _tlsSessionHost(pTlsConf, pHost);
+
+    if ((confIdx < 0) || (NULL == pHost) || ('\0' == *pHost))
+    {
+        return false;
+    }
+
+    for (pStr = pHost; '\0' != *pStr; pStr++)
+    {
+        hostHash = (hostHash ^ (uint8_t)*pStr) * 16777619UL;
+    }
+
+    /* wolfSSL keeps at most ATCMD_TLS_SERVER_ID_SZ bytes of a server ID, so
+       pack in the configuration and flush generation, port, a hash of the
+       whole host name and as much of the host name as will fit. Bumping the
+       generation orphans every session cached for this configuration. */
+
+    memset(pServerID, 0, ATCMD_TLS_SERVER_ID_SZ);
+
+    pServerID[0] = confIdx;
+    pServerID[1] = tlsSessGeneration[confIdx];
+    pServerID[2] = port >> 8;
+    pServerID[3] = port;
+    pServerID[4] = hostHash >> 24;
+    pServerID[5] = hostHash >> 16;
+    pServerID[6] = hostHash >> 8;
+    pServerID[7] = hostHash;
+
+    strncpy((char*)&pServerID[8], pHost, ATCMD_TLS_SERVER_ID_SZ-8);
+
+    return true;
+}
+
+void ATCMD_TLS_SessionResume(const ATCMD_APP_TLS_CONF *pTlsConf, WOLFSSL *pTlsSess, const char *pHost, uint16_t port)
+{
+    uint8_t serverID[ATCMD_TLS_SERVER_ID_SZ];
+
+    if (false == ATCMD_TLS_SessionServerID(pTlsConf, pHost, port, serverID))
+    {
+        return;
+    }
+
+#ifdef HAVE_SESSION_TICKET
+    wolfSSL_UseSessionTicket(pTlsSess);
+#endif
+
+    /* Offers the cached session for this server if there is one, and files
+       the new session under this ID once the handshake completes */
+
+    wolfSSL_SetServerID(pTlsSess, serverID, ATCMD_TLS_SERVER_ID_SZ, 0);
+}
+
+void ATCMD_TLS_SessionEstablished(const ATCMD_APP_TLS_CONF *pTlsConf, WOLFSSL *pTlsSess, const char *pHost, uint16_t port)
+{
+    ATCMD_TLS_SESS_CACHE_ENTRY *pEntry = NULL;
+    int confIdx;
+    int i;
+
+    if ((NULL == pTlsConf) || (false == pTlsConf->sessionResume))
+    {
+        return;
+    }
+
+    confIdx = _tlsConfIndex(pTlsConf);
+    pHost   = _tlsSessionHost(pTlsConf, pHost);
+
+    if ((confIdx < 0) || (NULL == pHost))
+    {
+        return;
+    }
+
+    for (i=0; i<AT_CMD_TLS_SESS_CACHE_SZ; i++)
+    {
+        ATCMD_TLS_SESS_CACHE_ENTRY *pTmpEntry = &tlsSessCache[confIdx][i];
+
+        if ((port == pTmpEntry->port) && (0 == strncmp(pHost, pTmpEntry->host, AT_CMD_TLS_SERVER_NAME_SZ)))
+        {
+            pEntry = pTmpEntry;
+            break;
+        }
+
+        /* Otherwise reuse an empty or the oldest entry */
+
+        if ((NULL == pEntry) || (0 == pTmpEntry->port) || ((0 != pEntry->port) && ((int32_t)(pTmpEntry->lastTimeMs - pEntry->lastTimeMs) < 0)))
+        {
+            pEntry = pTmpEntry;
+        }
+    }
+
+    if ((port != pEntry->port) || (0 != strncmp(pHost, pEntry->host, AT_CMD_TLS_SERVER_NAME_SZ)))
+    {
+        memset(pEntry, 0, sizeof(ATCMD_TLS_SESS_CACHE_ENTRY));
+
+        strncpy(pEntry->host, pHost, AT_CMD_TLS_SERVER_NAME_SZ);
+        pEntry->port = port;
+    }
+
+    if (0 != wolfSSL_session_reused(pTlsSess))
+    {
+        pEntry->numResumed++;
+    }
+    else
+    {
+        pEntry->numFull++;
+    }
+
+    pEntry->lastTimeMs = ATCMD_PlatformGetSysTimeMs();
+}
+
+bool ATCMD_TLS_SessionInfoGet(const ATCMD_APP_TLS_CONF *pTlsConf, int index, ATCMD_TLS_SESS_INFO *pSessInfo)
+{
+    ATCMD_TLS_SESS_CACHE_ENTRY *pEntry;
+    int confIdx;
+
+    if ((NULL == pTlsConf) || (NULL == pSessInfo) || (index < 0) || (index >= AT_CMD_TLS_SESS_CACHE_SZ))
+    {
+        return false;
+    }
+
+    confIdx = _tlsConfIndex(pTlsConf);
+
+    if (confIdx < 0)
+    {
+        return false;
+    }
+
+    pEntry = &tlsSessCache[confIdx][index];
+
+    if (0 == pEntry->port)
+    {
+        return false;
+    }
+
+    pSessInfo->pHost      = pEntry->host;
+    pSessInfo->port       = pEntry->port;
+    pSessInfo->numFull    = pEntry->numFull;
+    pSessInfo->numResumed = pEntry->numResumed;
+    pSessInfo->lastTimeMs = pEntry->lastTimeMs;
+
+    return true;
+}
+
+void ATCMD_TLS_SessionFlush(const ATCMD_APP_TLS_CONF *pTlsConf)
+{
+    int confIdx;
+
+    if (NULL == pTlsConf)
+    {
+        /* Flush every configuration */
+
+        for (confIdx=0; confIdx<AT_CMD_TLS_NUM_CONFS; confIdx++)
+        {
+            ATCMD_TLS_SessionFlush(&atCmdAppContext.tlsConf[confIdx]);
+        }
+
+        return;
+    }
+
+    confIdx = _tlsConfIndex(pTlsConf);
+
+    if (confIdx < 0)
+    {
+        return;
+    }
+
+    /* wolfSSL has no way to drop individual client sessions, instead change
+       the server IDs so the old sessions are never found again and age out */
+
+    tlsSessGeneration[confIdx]++;
+
+    memset(tlsSessCache[confIdx], 0, sizeof(tlsSessCache[confIdx]));
+}
+
 WOLFSSL* ATCMD_TLS_AllocSession(int stateIdx, ATCMD_APP_TLS_CONF *pTlsConf, bool isClient, int fd)
 {
     ATCMD_APP_TLS_STATE *pTlsState;
@@ -206,7 +593,7 @@ WOLFSSL* ATCMD_TLS_AllocSession(int stateIdx, ATCMD_APP_TLS_CONF *pTlsConf, bool
 
     if (NULL == pTlsState->pTlsCtx)
     {
-        pTlsState->pTlsCtx = _tlsCreateTlsCtx(isClient);
+        pTlsState->pTlsCtx = _tlsCtxCacheGet(pTlsConf, isClient);
 
         if (NULL == pTlsState->pTlsCtx)
         {
@@ -231,6 +618,13 @@ WOLFSSL* ATCMD_TLS_AllocSession(int stateIdx, ATCMD_APP_TLS_CONF *pTlsConf, bool
     if (SSL_SUCCESS != wolfSSL_set_fd(pTlsSess, fd))
     {
         wolfSSL_free(pTlsSess);
+
+        if (0 == pTlsState->numCtxSessions)
+        {
+            _tlsCtxCacheRelease(pTlsState->pTlsCtx);
+            pTlsState->pTlsCtx = NULL;
+        }
+
         return NULL;
     }
 
@@ -258,16 +652,16 @@ bool ATCMD_TLS_FreeSession(int stateIdx, WOLFSSL *pTlsSess)
 
     pTlsState->numCtxSessions--;
 
+    if (NULL != pTlsState->pTlsConf)
+    {
+        pTlsState->pTlsConf->numSessions--;
+    }
+
     if (0 == pTlsState->numCtxSessions)
     {
-        wolfSSL_CTX_free(pTlsState->pTlsCtx);
+        _tlsCtxCacheRelease(pTlsState->pTlsCtx);
         pTlsState->pTlsCtx  = NULL;
-
-        if (NULL != pTlsState->pTlsConf)
-        {
-            pTlsState->pTlsConf->numSessions--;
-            pTlsState->pTlsConf = NULL;
-        }
+        pTlsState->pTlsConf = NULL;
     }
 
     return true;
@@ -31,7 +31,24 @@
 #include "include/at_cmds.h"
 #include "wolfssl/ssl.h"
 
+#define ATCMD_TLS_SERVER_ID_SZ  20
+
+typedef struct
+{
+    const char  *pHost;
+    uint16_t    port;
+    uint32_t    numFull;
+    uint32_t    numResumed;
+    uint32_t    lastTimeMs;
+} ATCMD_TLS_SESS_INFO;
+
 WOLFSSL* ATCMD_TLS_AllocSession(int stateIdx, ATCMD_APP_TLS_CONF *pTlsConf, bool isClient, int fd);
 bool ATCMD_TLS_FreeSession(int stateIdx, WOLFSSL *pTlsSess);
+void ATCMD_TLS_CtxCacheFlush(void);
+bool ATCMD_TLS_SessionServerID(const ATCMD_APP_TLS_CONF *pTlsConf, const char *pHost, uint16_t port, uint8_t *pServerID);
+void ATCMD_TLS_SessionResume(const ATCMD_APP_TLS_CONF *pTlsConf, WOLFSSL *pTlsSess, const char *pHost, uint16_t port);
+void ATCMD_TLS_SessionEstablished(const ATCMD_APP_TLS_CONF *pTlsConf, WOLFSSL *pTlsSess, const char *pHost, uint16_t port);
+bool ATCMD_TLS_SessionInfoGet(const ATCMD_APP_TLS_CONF *pTlsConf, int index, ATCMD_TLS_SESS_INFO *pSessInfo);
+void ATCMD_TLS_SessionFlush(const ATCMD_APP_TLS_CONF *pTlsConf);
 
 #endif /* _AT_CMD_TLS_H */
@@ -91,185 +91,338 @@ extern ATCMD_APP_CONTEXT atCmdAppContext;
 /*******************************************************************************
 * Local defines and types
 *******************************************************************************/
+typedef struct
+{
+    char                name[TCPIP_DNS_CLIENT_MAX_HOSTNAME_LEN];
+    ATCMD_DNS_CALLBACK  callback;       /* NULL - query slot is free */
+    const void          *param;
+    uint32_t            startTimeMs;
+} ATCMD_DNS_QUERY;
 
 /*******************************************************************************
 * Local data
 *******************************************************************************/
-static char nameToResolve[TCPIP_DNS_CLIENT_MAX_HOSTNAME_LEN];
+static ATCMD_DNS_QUERY dnsQueries[AT_CMD_DNS_NUM_QUERIES];
 
-static TCPIP_DNS_HANDLE dnsResolveHandle;
-static bool nameResolved;
-static uint32_t dnsResolveStartMs;
+static TCPIP_DNS_HANDLE dnsEventHandle;
 
 /*******************************************************************************
 * Local functions
 *******************************************************************************/
-static void _DNSResolvResetQuery(void)
+static void _DNSEventHandler(TCPIP_NET_HANDLE hNet, TCPIP_DNS_EVENT_TYPE evType, const char* pName, const void* hParam)
+{
+    /* Called from the TCP/IP stack, wake the AT task to collect the result */
+    if ((TCPIP_DNS_EVENT_NAME_RESOLVED == evType) || (TCPIP_DNS_EVENT_NAME_ERROR == evType))
+    {
+        ATCMD_PlatformEventSignal();
+    }
+}
+
+static void _DNSQueryComplete(const char *pName, TCPIP_DNS_RESULT dnsResult, ATCMD_DNS_CALLBACK callback, const void *param)
 {
-    memset(nameToResolve, 0, TCPIP_DNS_CLIENT_MAX_HOSTNAME_LEN);
+    IPV4_ADDR addrs[TCPIP_DNS_CLIENT_CACHE_PER_IPV4_ADDRESS];
+    int numAddrs = 0;
+    ATCMD_STATUS status;
+
+    switch (dnsResult)
+    {
+        case TCPIP_DNS_RES_OK:
+        {
+            numAddrs = TCPIP_DNS_GetIPv4Addresses(pName, 0, addrs, TCPIP_DNS_CLIENT_CACHE_PER_IPV4_ADDRESS);
+
+            status = (numAddrs > 0) ? ATCMD_STATUS_OK : ATCMD_APP_STATUS_DNS_NAME_ERROR;
+            break;
+        }
 
-    dnsResolveHandle = NULL;
-    nameResolved     = false;
+        case TCPIP_DNS_RES_NAME_IS_IPADDRESS:
+        {
+            /* An IPv6 literal is an address too, but not one this stack
+               can use */
+            if (false == TCPIP_Helper_StringToIPAddress(pName, &addrs[0]))
+            {
+                status = ATCMD_APP_STATUS_DNS_TYPE_NOT_SUPPORTED;
+                break;
+            }
+
+            numAddrs = 1;
+            status   = ATCMD_STATUS_OK;
+            break;
+        }
+
+        case TCPIP_DNS_RES_NAME_ERROR:
+        {
+            status = ATCMD_APP_STATUS_DNS_NAME_ERROR;
+            break;
+        }
+
+        case TCPIP_DNS_RES_PENDING:
+        case TCPIP_DNS_RES_SERVER_TMO:
+        case TCPIP_DNS_RES_NO_NAME_ENTRY:
+        {
+            /* No name entry: the entry left the cache before the query was
+               checked, it timed out or was purged; no answer was received */
+            status = ATCMD_APP_STATUS_DNS_TIMEOUT;
+            break;
+        }
+
+        default:
+        {
+            status = ATCMD_APP_STATUS_NETWORK_ERROR;
+            break;
+        }
+    }
+
+    callback(pName, status, addrs, numAddrs, param);
 }
 
-static void _DNSResolvEventHandler(TCPIP_NET_HANDLE hNet, TCPIP_DNS_EVENT_TYPE evType, const char* pName, const void* hParam)
+/* Checks the outstanding queries, returns true while any remain */
+static bool _DNSQueriesUpdate(void)
 {
-    if (TCPIP_DNS_EVENT_NAME_RESOLVED == evType)
+    ATCMD_DNS_QUERY *pQuery;
+    TCPIP_DNS_RESULT dnsResult;
+    IP_MULTI_ADDRESS ipAddress;
+    bool pending = false;
+    int i;
+
+    for (i=0; i<AT_CMD_DNS_NUM_QUERIES; i++)
     {
-        if (0 == memcmp(pName, nameToResolve, strlen(nameToResolve)))
+        pQuery = &dnsQueries[i];
+
+        if (NULL == pQuery->callback)
         {
-            nameResolved = true;
+            continue;
         }
+
+        dnsResult = TCPIP_DNS_IsResolved(pQuery->name, &ipAddress, IP_ADDRESS_TYPE_IPV4);
+
+        if ((TCPIP_DNS_RES_PENDING == dnsResult) && ((ATCMD_PlatformGetSysTimeMs() - pQuery->startTimeMs) < AT_CMD_DNS_QUERY_TIMEOUT_MS))
+        {
+            pending = true;
+            continue;
+        }
+
+        /* The slot stays busy until the callback returns, so the name
+           remains valid even if the callback starts another query */
+        _DNSQueryComplete(pQuery->name, dnsResult, pQuery->callback, pQuery->param);
+
+        pQuery->callback = NULL;
     }
+
+    return pending;
 }
 
-/*******************************************************************************
-* Command init functions
-*******************************************************************************/
-static ATCMD_STATUS _DNSRESOLVInit(const AT_CMD_TYPE_DESC* pCmdTypeDesc)
+static void _DNSRESOLVCallback(const char *pName, ATCMD_STATUS status, const IPV4_ADDR *pAddrs, int numAddrs, const void *param)
 {
-    dnsResolveHandle = NULL;
+    char ipAddrStr[20];
+    int i;
 
-    _DNSResolvResetQuery();
+    if (ATCMD_STATUS_OK != status)
+    {
+        ATCMD_ReportAECStatus("+DNSRESOLV", status);
+        return;
+    }
 
-    return ATCMD_STATUS_OK;
+    for (i=0; i<numAddrs; i++)
+    {
+        TCPIP_Helper_IPAddressToString(&pAddrs[i], ipAddrStr, sizeof(ipAddrStr));
+
+        ATCMD_Printf("+DNSRESOLV:0,\"%s\",\"%s\"\r\n", pName, ipAddrStr);
+    }
 }
 
 /*******************************************************************************
-* Command execute functions
+* Resolver interface
 *******************************************************************************/
-static ATCMD_STATUS _DNSRESOLVExecute(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const int numParams, ATCMD_PARAM *pParamList)
+
+/* Starts resolving the A record of a name. Any number of queries, up to
+   AT_CMD_DNS_NUM_QUERIES, may be outstanding at once. Answers already in the
+   cache are passed to the callback before this returns, otherwise it is
+   called from the AT task when the query completes or times out. Failures
+   known straight away are returned instead of being passed to the callback. */
+ATCMD_STATUS ATCMD_DNS_Resolve(const char *pName, ATCMD_DNS_CALLBACK callback, const void *param)
 {
-    if (2 == numParams)
-    {
-        /* Check the parameter types are correct */
+    ATCMD_DNS_QUERY *pQuery;
+    TCPIP_DNS_RESULT dnsResult;
+    int i;
 
-        if (false == ATCMD_ParamValidateTypes(pCmdTypeDesc, 0, numParams, pParamList))
-        {
-            return ATCMD_STATUS_INVALID_PARAMETER;
-        }
-    }
-    else
+    if ((NULL == pName) || (NULL == callback) || (strlen(pName) >= TCPIP_DNS_CLIENT_MAX_HOSTNAME_LEN))
     {
-        return ATCMD_STATUS_INCORRECT_NUM_PARAMS;
+        return ATCMD_STATUS_INVALID_PARAMETER;
     }
 
-    if (ATCMD_APP_STATE_STA_CONNECTED != atCmdAppContext.appState)
+    if (NULL == dnsEventHandle)
     {
-        return ATCMD_APP_STATUS_STA_NOT_CONNECTED;
+        dnsEventHandle = TCPIP_DNS_HandlerRegister(atCmdAppContext.netHandle, &_DNSEventHandler, NULL);
     }
 
-    _DNSResolvResetQuery();
+    dnsResult = TCPIP_DNS_Resolve(pName, TCPIP_DNS_TYPE_A);
 
-    if (1 == pParamList[0].value.i)
+    switch (dnsResult)
     {
-        TCPIP_DNS_RESULT dnsResult;
-                             IP_MULTI_ADDRESS ipAddress;
-                             char ipAddrStr[20];
+        case TCPIP_DNS_RES_OK:
+        case TCPIP_DNS_RES_NAME_IS_IPADDRESS:
+        {
+            _DNSQueryComplete(pName, dnsResult, callback, param);
 
-        /* A record lookup */
+            return ATCMD_STATUS_OK;
+        }
 
-        if (strlen((char*)pParamList[1].value.p) >= TCPIP_DNS_CLIENT_MAX_HOSTNAME_LEN)
+        case TCPIP_DNS_RES_NAME_ERROR:
         {
-            return ATCMD_STATUS_INVALID_PARAMETER;
+            return ATCMD_APP_STATUS_DNS_NAME_ERROR;
         }
 
-        strcpy(nameToResolve, (char*)pParamList[1].value.p);
+        case TCPIP_DNS_RES_CACHE_FULL:
+        {
+            return ATCMD_APP_STATUS_DNS_BUSY;
+        }
 
-        dnsResolveHandle = TCPIP_DNS_HandlerRegister(atCmdAppContext.netHandle, &_DNSResolvEventHandler, nameToResolve);
-        
-        if (NULL != dnsResolveHandle)
+        case TCPIP_DNS_RES_PENDING:
+        case TCPIP_DNS_RES_SOCKET_ERROR:
+        case TCPIP_DNS_RES_NO_INTERFACE:
         {
-            dnsResult = TCPIP_DNS_Resolve(nameToResolve, TCPIP_DNS_TYPE_A);
+            /* The query is retried by the DNS client */
+            break;
+        }
 
-           if (dnsResult < 0)
-            {
-                _DNSResolvResetQuery();
+        default:
+        {
+            return ATCMD_APP_STATUS_NETWORK_ERROR;
+        }
+    }
 
-                return ATCMD_APP_STATUS_DNS_TYPE_NOT_SUPPORTED;
-            }
-            else if (TCPIP_DNS_RES_NAME_IS_IPADDRESS == dnsResult)
-            {
-                ATCMD_Printf("+DNSRESOLV:0,\"%s\",\"%s\"\r\n", nameToResolve, nameToResolve);
+    pQuery = NULL;
 
-                _DNSResolvResetQuery();
-            }
-            else
-            {
-                                                          dnsResult = TCPIP_DNS_IsResolved(nameToResolve, &ipAddress, TCPIP_DNS_TYPE_A);
-                                                          
-                                                          if (TCPIP_DNS_RES_OK == dnsResult)
-                                                          {
-                                                                        TCPIP_Helper_IPAddressToString(&ipAddress.v4Add, ipAddrStr, sizeof(ipAddrStr));
-                                                                        ATCMD_Printf("+DNSRESOLV:0,\"%s\",\"%s\"\r\n", nameToResolve, ipAddrStr);
-                                                                        _DNSResolvResetQuery();
-                                                          }
-                else
-                                                          {
-                                                                        dnsResolveStartMs = ATCMD_PlatformGetSysTimeMs();
-                }
-            }
+    for (i=0; i<AT_CMD_DNS_NUM_QUERIES; i++)
+    {
+        if (NULL == dnsQueries[i].callback)
+        {
+            pQuery = &dnsQueries[i];
+            break;
         }
     }
-    else
+
+    if (NULL == pQuery)
     {
-        return ATCMD_APP_STATUS_DNS_TYPE_NOT_SUPPORTED;
+        return ATCMD_APP_STATUS_DNS_BUSY;
     }
 
+    strcpy(pQuery->name, pName);
+
+    pQuery->callback    = callback;
+    pQuery->param       = param;
+    pQuery->startTimeMs = ATCMD_PlatformGetSysTimeMs();
+
+    ATCMD_UpdateSetPending(&atCmdTypeDescDNSRESOLV, true);
+
     return ATCMD_STATUS_OK;
 }
 
-/*******************************************************************************
-* Command update functions
-*******************************************************************************/
-static ATCMD_STATUS _DNSRESOLVUpdate(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const AT_CMD_TYPE_DESC* pCurrentCmdTypeDesc)
+/* Abandons the outstanding queries started with this callback and parameter */
+void ATCMD_DNS_Cancel(ATCMD_DNS_CALLBACK callback, const void *param)
 {
-    TCPIP_DNS_RESULT dnsResult;
-    IP_MULTI_ADDRESS ipAddress;
-    char ipAddrStr[20];
+    int i;
 
-    if (true == nameResolved)
+    for (i=0; i<AT_CMD_DNS_NUM_QUERIES; i++)
     {
-        dnsResult = TCPIP_DNS_IsResolved(nameToResolve, &ipAddress, TCPIP_DNS_TYPE_A);
-
-        if (TCPIP_DNS_RES_PENDING == dnsResult)
+        if ((callback == dnsQueries[i].callback) && (param == dnsQueries[i].param))
         {
-            nameResolved = false;
+            dnsQueries[i].callback = NULL;
         }
-        else
-        {
-            if (TCPIP_DNS_RES_OK == dnsResult)
-            {
-                int numRes;
-                int resIdx;
+    }
+}
 
-                numRes = TCPIP_DNS_GetIPAddressesNumber(nameToResolve, IP_ADDRESS_TYPE_IPV4);
-                resIdx = 0;
+/* Keeps a configured endpoint name resolved so connecting to it does not wait
+   for the DNS server, the DNS client queries it again before the cached answer
+   expires. Empty names and IP address literals are ignored. Watches of the
+   same name are counted, pWatched records whether the caller holds one so
+   that ATCMD_DNS_Unwatch only ever releases the caller's own. */
+ATCMD_STATUS ATCMD_DNS_Watch(const char *pName, bool *pWatched)
+{
+    TCPIP_DNS_RESULT dnsResult;
 
-                while (numRes--)
-                {
-                    TCPIP_DNS_GetIPv4Addresses(nameToResolve, resIdx++, &ipAddress.v4Add, 1);
+    if ((NULL == pName) || ('\0' == pName[0]) || (true == *pWatched))
+    {
+        return ATCMD_STATUS_OK;
+    }
 
-                    TCPIP_Helper_IPAddressToString(&ipAddress.v4Add, ipAddrStr, sizeof(ipAddrStr));
+    dnsResult = TCPIP_DNS_WatchAdd(pName);
 
-                    ATCMD_Printf("+DNSRESOLV:0,\"%s\",\"%s\"\r\n", nameToResolve, ipAddrStr);
-                }
-            }
+    if (TCPIP_DNS_RES_OK == dnsResult)
+    {
+        *pWatched = true;
+    }
+    else if (TCPIP_DNS_RES_WATCH_FULL == dnsResult)
+    {
+        return ATCMD_APP_STATUS_DNS_WATCH_FULL;
+    }
 
-            _DNSResolvResetQuery();
-        }
+    return ATCMD_STATUS_OK;
+}
+
+void ATCMD_DNS_Unwatch(const char *pName, bool *pWatched)
+{
+    if (false == *pWatched)
+    {
+        return;
     }
-    else if (NULL != dnsResolveHandle)
+
+    TCPIP_DNS_WatchRemove(pName);
+
+    *pWatched = false;
+}
+
+/*******************************************************************************
+* Command init functions
+*******************************************************************************/
+static ATCMD_STATUS _DNSRESOLVInit(const AT_CMD_TYPE_DESC* pCmdTypeDesc)
+{
+    memset(dnsQueries, 0, sizeof(dnsQueries));
+
+    return ATCMD_STATUS_OK;
+}
+
+/*******************************************************************************
+* Command execute functions
+*******************************************************************************/
+static ATCMD_STATUS _DNSRESOLVExecute(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const int numParams, ATCMD_PARAM *pParamList)
+{
+    if (2 == numParams)
     {
-        uint32_t currTimeMs = ATCMD_PlatformGetSysTimeMs();
+        /* Check the parameter types are correct */
 
-        if ((currTimeMs - dnsResolveStartMs) > 5000)
+        if (false == ATCMD_ParamValidateTypes(pCmdTypeDesc, 0, numParams, pParamList))
         {
-            ATCMD_ReportAECStatus("+DNSRESOLV", ATCMD_APP_STATUS_DNS_TIMEOUT);
-
-            _DNSResolvResetQuery();
+            return ATCMD_STATUS_INVALID_PARAMETER;
         }
     }
+    else
+    {
+        return ATCMD_STATUS_INCORRECT_NUM_PARAMS;
+    }
+
+    if (ATCMD_APP_STATE_STA_CONNECTED != atCmdAppContext.appState)
+    {
+        return ATCMD_APP_STATUS_STA_NOT_CONNECTED;
+    }
+
+    if (1 == pParamList[0].value.i)
+    {
+        /* A record lookup, each query is reported as it completes */
+
+        return ATCMD_DNS_Resolve((char*)pParamList[1].value.p, _DNSRESOLVCallback, NULL);
+    }
+
+    return ATCMD_APP_STATUS_DNS_TYPE_NOT_SUPPORTED;
+}
+
+/*******************************************************************************
+* Command update functions
+*******************************************************************************/
+static ATCMD_STATUS _DNSRESOLVUpdate(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const AT_CMD_TYPE_DESC* pCurrentCmdTypeDesc)
+{
+    /* Nothing to do until the next query is started */
+    ATCMD_UpdateSetPending(pCmdTypeDesc, _DNSQueriesUpdate());
 
     return ATCMD_STATUS_OK;
 }
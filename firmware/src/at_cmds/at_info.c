@@ -28,6 +28,7 @@
 #include <stddef.h>
 
 #include "at_cmd_app.h"
+#include "at_cmd_mem.h"
 
 /*******************************************************************************
 * Command interface prototypes
@@ -39,9 +40,12 @@ static ATCMD_STATUS _INFOExecute(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const int
 *******************************************************************************/
 static const ATCMD_HELP_PARAM paramInfoType =
     {"TYPE", "Type of information", ATCMD_PARAM_TYPE_CLASS_INTEGER,
-        .numOpts = 1,
+        .numOpts = 4,
         {
-            {"1", "Task Report"}
+            {"1", "Task Report"},
+            {"2", "UART TX Report"},
+            {"3", "Memory Report"},
+            {"4", "Memory Snapshot"}
         }
     };
 
@@ -122,6 +126,99 @@ static bool _INFOReport01(void)
 #endif
 }
 
+static bool _INFOReport02(void)
+{
+    ATCMD_PLATFORM_UART_TX_STATS txStats;
+
+    ATCMD_PlatformUARTWriteGetStats(&txStats);
+
+    ATCMD_Printf("+INFO:%u,%u,%u,%u,%u,%u\r\n", txStats.numTxBytes, txStats.numTxStalls, txStats.numTxDropped, txStats.txHighWaterMark, txStats.numTxDeferred, txStats.numTxStallTimeouts);
+
+    return true;
+}
+
+static ATCMD_MEM_SNAPSHOT memSnapshot;
+
+static bool _INFOReport03(void)
+{
+    int i;
+
+    ATCMD_MemSnapshotGet(&memSnapshot);
+
+    ATCMD_Printf("+INFO:\"HEAP\",%u,%u,%u,%u,%u,%u\r\n", memSnapshot.heapSize, ATCMD_MemLargestFreeBlock(), memSnapshot.currBytes, memSnapshot.peakBytes, memSnapshot.numRecords, memSnapshot.numUntracked);
+
+    for (i=0; i<ATCMD_MEM_OWNER_NUM; i++)
+    {
+        ATCMD_MEM_OWNER_STATS *pOwner = &memSnapshot.owners[i];
+
+        ATCMD_Printf("+INFO:\"OWNER\",\"%s\",%u,%u,%u,%u,%u\r\n", ATCMD_MemOwnerName(i), pOwner->currBytes, pOwner->peakBytes, pOwner->numLive, pOwner->numAllocs, pOwner->numFailed);
+    }
+
+    if (0 != memSnapshot.tcpipPool.numEntries)
+    {
+        ATCMD_MEM_POOL_STATS *pPool = &memSnapshot.tcpipPool;
+
+        /* The TCPIP owner holds the pool region, its use is per entry */
+        ATCMD_Printf("+INFO:\"POOL\",%u,%u,%u,%u,%u,%u,%u\r\n", pPool->regionBytes, pPool->usedBytes, pPool->peakBytes, pPool->extBytes, pPool->extPeakBytes, pPool->extAllocs, pPool->extFailed);
+
+        for (i=0; i<pPool->numEntries; i++)
+        {
+            ATCMD_MEM_POOL_ENTRY_STATS *pEntry = &pPool->entries[i];
+
+            ATCMD_Printf("+INFO:\"POOLENT\",%u,%u,%u,%u,%u,%u,%u\r\n", pEntry->blockSize, pEntry->numBlocks, pEntry->usedBlocks, pEntry->peakBlocks, pEntry->numAllocs, pEntry->numFallbacks, pEntry->numFailed);
+        }
+    }
+
+    for (i=0; i<ATCMD_MEM_NUM_SIZE_BINS; i++)
+    {
+        /* Bins double from 16 bytes, the last one is open ended */
+        ATCMD_Printf("+INFO:\"SIZE\",%u,%u,%u\r\n", (i < (ATCMD_MEM_NUM_SIZE_BINS-1)) ? (16U << i) : 0U, memSnapshot.sizeBins[i].numAllocs, memSnapshot.sizeBins[i].numLive);
+    }
+
+    for (i=0; i<AT_CMD_MEM_NUM_SITES; i++)
+    {
+        ATCMD_MEM_SITE_STATS *pSite = &memSnapshot.sites[i];
+
+        if (0 == pSite->callSite)
+        {
+            continue;
+        }
+
+        ATCMD_Printf("+INFO:\"SITE\",0x%08x,\"%s\",%u,%u,%u,%u\r\n", pSite->callSite, ATCMD_MemOwnerName(pSite->owner), pSite->numAllocs, pSite->numLive, pSite->currBytes, pSite->peakBytes);
+    }
+
+    return true;
+}
+
+static bool _INFOReport04(void)
+{
+    const uint8_t *pData = (const uint8_t*)&memSnapshot;
+    size_t remain = sizeof(ATCMD_MEM_SNAPSHOT);
+
+    ATCMD_MemSnapshotGet(&memSnapshot);
+
+    ATCMD_Print("+INFO:[", 7);
+
+    while (remain > 0)
+    {
+        size_t chunkLen = (AT_CMD_CONF_PRINTF_OUT_BUF_SIZE-2)/2;
+
+        if (chunkLen > remain)
+        {
+            chunkLen = remain;
+        }
+
+        ATCMD_PrintStringHexWithDelimiterInfo(pData, chunkLen, false, false);
+
+        pData  += chunkLen;
+        remain -= chunkLen;
+    }
+
+    ATCMD_Print("]\r\n", 3);
+
+    return true;
+}
+
 /*******************************************************************************
 * Command init functions
 *******************************************************************************/
@@ -156,6 +253,36 @@ static ATCMD_STATUS _INFOExecute(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const int
             
             break;
         }
+
+        case 2:
+        {
+            if (false == _INFOReport02())
+            {
+                return ATCMD_STATUS_ERROR;
+            }
+
+            break;
+        }
+
+        case 3:
+        {
+            if (false == _INFOReport03())
+            {
+                return ATCMD_STATUS_ERROR;
+            }
+
+            break;
+        }
+
+        case 4:
+        {
+            if (false == _INFOReport04())
+            {
+                return ATCMD_STATUS_ERROR;
+            }
+
+            break;
+        }
         
         default:
         {
@@ -28,6 +28,7 @@
 #include <stddef.h>
 
 #include "at_cmd_app.h"
+#include "at_cmd_tls.h"
 #include "at_cmds/at_cmd_xmodem.h"
 #include "at_cmds/at_cmd_pkcs.h"
 #include "cert_header.h"
@@ -354,6 +355,8 @@ static ATCMD_STATUS _LOADUpdate(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const AT_C
                     atCmdAppContext.certFileLength = derFileLength;
 
                     NET_PRES_SetCertificate(atCmdAppContext.certFile, derFileLength, SSL_FILETYPE_ASN1);               
+                    ATCMD_TLS_CtxCacheFlush();
+                    ATCMD_TLS_SessionFlush(NULL);
                     ATCMD_Print("0\r\n", 3);
                 }
                 else
@@ -449,5 +452,7 @@ static ATCMD_STATUS _LOADUpdate(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const AT_C
         }
     }
 
+    ATCMD_UpdateSetPending(pCmdTypeDesc, ((0 != tsfrCtx.numBytes) || (true == xmTsfrComplete)));
+
     return ATCMD_STATUS_OK;
 }
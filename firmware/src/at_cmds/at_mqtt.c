@@ -376,6 +376,8 @@ const AT_CMD_TYPE_DESC atCmdTypeDescMQTTDISCONN =
 * External references
 *******************************************************************************/
 extern ATCMD_APP_CONTEXT atCmdAppContext;
+extern const uint8_t *net_pres_server_id;
+extern int net_pres_server_id_len;
 
 /*******************************************************************************
 * Local defines and types
@@ -600,6 +602,7 @@ static MqttClient mqttClient;
 //static uint32_t lastKeepAliveTimeMs;
 static uint32_t lastStateTransitionMs;
 static uint32_t currentStateTimeoutMs;
+static bool brokerWatched;
 
 /*******************************************************************************
 * Local functions
@@ -1114,6 +1117,8 @@ static int _mqttPropertyCallback(struct _MqttClient* pClient, MqttProp* pProp, v
 
 int32_t _MQTTCallback(SYS_MQTT_EVENT_TYPE eEventType, void *data, uint16_t len, void* cookie);
 
+static uint8_t mqttTlsServerID[ATCMD_TLS_SERVER_ID_SZ];
+
 static ATCMD_STATUS _mqttConnectStart(MqttClient *pMQTTClient, int cleanSession)
 {
     SYS_MQTT_Config cloudConfig;
@@ -1138,12 +1143,29 @@ static ATCMD_STATUS _mqttConnectStart(MqttClient *pMQTTClient, int cleanSession)
 	{
 		cloudConfig.sBrokerConfig.tlsEnabled = 0;
 	}
+
+    /* Let the TLS layer resume a cached session with the broker, including on auto reconnects */
+
+    net_pres_server_id     = NULL;
+    net_pres_server_id_len = 0;
+
+    if ((atCmdAppContext.mqttConf.tlsConfIdx > 0) && (atCmdAppContext.mqttConf.tlsConfIdx <= AT_CMD_TLS_NUM_CONFS))
+    {
+        if (true == ATCMD_TLS_SessionServerID(&atCmdAppContext.tlsConf[atCmdAppContext.mqttConf.tlsConfIdx-1], cloudConfig.sBrokerConfig.brokerName, cloudConfig.sBrokerConfig.serverPort, mqttTlsServerID))
+        {
+            net_pres_server_id     = mqttTlsServerID;
+            net_pres_server_id_len = ATCMD_TLS_SERVER_ID_SZ;
+        }
+    }
 		
         if(atCmdAppContext.mqttConf.keepAlive)
         {
             cloudConfig.sBrokerConfig.keepAliveInterval = atCmdAppContext.mqttConf.keepAlive;
         }
         
+        /* Messages are printed straight from the MQTT receive buffer */
+        cloudConfig.bMsgRcvdView = true;
+
 	pMQTTClient->mqtt_handle = SYS_MQTT_Connect(&cloudConfig, _MQTTCallback, NULL);
 
 	mqtt_appData.SysMqttHandle = pMQTTClient->mqtt_handle;
@@ -1176,6 +1198,8 @@ static ATCMD_STATUS _MQTTInit(const AT_CMD_TYPE_DESC* pCmdTypeDesc)
 {
     int s;
 
+    ATCMD_DNS_Unwatch((char*)&atCmdAppContext.mqttConf.broker[1], &brokerWatched);
+
     memset(&atCmdAppContext.mqttConf, 0, sizeof(ATCMD_APP_MQTT_CONF));
 
     atCmdAppContext.mqttConf.port = 8883;
@@ -1238,6 +1262,8 @@ static ATCMD_STATUS _MQTTCExecute(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const in
     }
     else if (2 == numParams)
     {
+        int numWritten;
+
         /* Check the parameter types are correct */
 
         if (false == ATCMD_ParamValidateTypes(pCmdTypeDesc, 2, numParams, pParamList))
@@ -1245,9 +1271,28 @@ static ATCMD_STATUS _MQTTCExecute(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const in
             return ATCMD_STATUS_INVALID_PARAMETER;
         }
 
+        /* The broker name is kept resolved in the background, follow any change to it */
+
+        if (1 == pParamList[0].value.i)
+        {
+            ATCMD_DNS_Unwatch((char*)&atCmdAppContext.mqttConf.broker[1], &brokerWatched);
+        }
+
         /* Access the element in the configuration structure */
 
-        if (0 == ATCMD_StructStoreWriteParam(mqttConfMap, &atCmdAppContext.mqttConf, pParamList[0].value.i, &pParamList[1]))
+        numWritten = ATCMD_StructStoreWriteParam(mqttConfMap, &atCmdAppContext.mqttConf, pParamList[0].value.i, &pParamList[1]);
+
+        if (1 == pParamList[0].value.i)
+        {
+            ATCMD_STATUS status = ATCMD_DNS_Watch((char*)&atCmdAppContext.mqttConf.broker[1], &brokerWatched);
+
+            if (ATCMD_STATUS_OK != status)
+            {
+                ATCMD_ReportAECStatus(pCmdTypeDesc->pCmdName, status);
+            }
+        }
+
+        if (0 == numWritten)
         {
             return ATCMD_STATUS_STORE_ACCESS_FAILED;
         }
@@ -1403,8 +1448,17 @@ static ATCMD_STATUS _MQTTPUBExecute(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const
 	pubConfig.qos = pParamList[1].value.i;
 	pubConfig.retain = pParamList[2].value.i;
 
-	SYS_MQTT_Publish(pMQTTClient->mqtt_handle, &pubConfig, 
-            (char *)pParamList[4].value.p, (uint16_t)pParamList[4].length);
+	if (SYS_MQTT_SUCCESS != SYS_MQTT_Publish(pMQTTClient->mqtt_handle, &pubConfig, 
+            (char *)pParamList[4].value.p, (uint16_t)pParamList[4].length))
+    {
+        return ATCMD_APP_STATUS_MQTT_ERROR;
+    }
+
+    if (pubConfig.qos > 0)
+    {
+        /* Packet ID which the +MQTTPUBACC/+MQTTPUBERR AEC will refer to */
+        ATCMD_Printf("+MQTTPUBID:%d\r\n", pubConfig.packetId);
+    }
 
     return ATCMD_STATUS_OK;
 }
@@ -1718,6 +1772,9 @@ static ATCMD_STATUS _MQTTUpdate(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const AT_C
 {
     MqttClient *pMQTTClient;
 
+    /* Nothing here is timed, session events signal the AT task when they occur */
+    ATCMD_UpdateSetPending(pCmdTypeDesc, false);
+
     if (ATCMD_MQTT_SESSION_STATE_NOT_CONNECTED == atCmdAppContext.mqttState.state)
     {
         return ATCMD_STATUS_OK;
@@ -1741,6 +1798,50 @@ static ATCMD_STATUS _MQTTUpdate(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const AT_C
     return ATCMD_STATUS_OK;
 }
 
+static void _MQTTPrintMsgView(const SYS_MQTT_PublishView *psView)
+{
+    const size_t maxOutputPrintBytes = (AT_CMD_CONF_PRINTF_OUT_BUF_SIZE/2) - 1;
+    const uint8_t *pMsg = psView->message;
+    size_t msgLength = psView->messageLength;
+    bool firstPiece = (0 == psView->offset);
+    bool lastPiece = ((psView->offset + psView->messageLength) >= psView->totalLength);
+
+    if (true == firstPiece)
+    {
+        ATCMD_Printf("+MQTTPUB:%d,", psView->topicLength);
+        ATCMD_PrintStringSafe(psView->topicName, psView->topicLength);
+        ATCMD_Printf(",%d,", (int)psView->totalLength);
+
+        if ((true == lastPiece) && (psView->totalLength < maxOutputPrintBytes))
+        {
+            /* Whole message in one piece, print it in the most appropriate form */
+            ATCMD_PrintStringSafe((const char*)pMsg, msgLength);
+            ATCMD_Print("\r\n", 2);
+            return;
+        }
+    }
+
+    /* Large or split messages are always printed as hex, so every piece uses the
+       same format, in slices that fit the print buffer */
+
+    do
+    {
+        size_t sliceLength = (msgLength > maxOutputPrintBytes) ? maxOutputPrintBytes : msgLength;
+
+        ATCMD_PrintStringHexWithDelimiterInfo(pMsg, sliceLength, firstPiece, false);
+
+        firstPiece = false;
+        pMsg += sliceLength;
+        msgLength -= sliceLength;
+    }
+    while (msgLength > 0);
+
+    if (true == lastPiece)
+    {
+        ATCMD_Print("]\r\n", 3);
+    }
+}
+
 int32_t _MQTTCallback(SYS_MQTT_EVENT_TYPE eEventType, void *data, uint16_t len, void* cookie)
 {
 		switch (eEventType) {
@@ -1758,6 +1859,13 @@ int32_t _MQTTCallback(SYS_MQTT_EVENT_TYPE eEventType, void *data, uint16_t len,
 //				SYS_CONSOLE_PRINT("%s: %s\r", psMsg->topicName, psMsg->message);
 			}
 				break;
+
+			case SYS_MQTT_EVENT_MSG_RCVD_VIEW:
+			{
+				/* Message received on Subscribed Topic, possibly one piece of it */
+				_MQTTPrintMsgView((SYS_MQTT_PublishView*)data);
+			}
+				break;
 	
 			case SYS_MQTT_EVENT_MSG_DISCONNECTED:
 			{
@@ -1790,7 +1898,7 @@ int32_t _MQTTCallback(SYS_MQTT_EVENT_TYPE eEventType, void *data, uint16_t len,
 			case SYS_MQTT_EVENT_MSG_PUBLISHED:
 			{
 				/* MQTT Client Msg Published */
-				ATCMD_Printf("+MQTTPUBACC\r\n");
+				ATCMD_Printf("+MQTTPUBACC:%d\r\n", *(uint16_t*)data);
 			}
 				break;
 	
@@ -1812,7 +1920,7 @@ int32_t _MQTTCallback(SYS_MQTT_EVENT_TYPE eEventType, void *data, uint16_t len,
 			case SYS_MQTT_EVENT_MSG_PUBACK_TO:
 			{
 				/* MQTT Client PubAck TimeOut; User will need to publish again */
-				ATCMD_Printf("+MQTTPUBERR\r\n");
+				ATCMD_Printf("+MQTTPUBERR:%d\r\n", *(uint16_t*)data);
 			}
 				break;
 	
@@ -1824,6 +1932,10 @@ int32_t _MQTTCallback(SYS_MQTT_EVENT_TYPE eEventType, void *data, uint16_t len,
 				break;
 	
 		}
+
+		/* MQTT state may have moved on under a pending command */
+		ATCMD_PlatformEventSignal();
+
 		return 0;
 }
 
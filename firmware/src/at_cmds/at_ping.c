@@ -37,7 +37,6 @@
 *******************************************************************************/
 static ATCMD_STATUS _PINGInit(const AT_CMD_TYPE_DESC* pCmdTypeDesc);
 static ATCMD_STATUS _PINGExecute(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const int numParams, ATCMD_PARAM *pParamList);
-static ATCMD_STATUS _PINGUpdate(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const AT_CMD_TYPE_DESC* pCurrentCmdTypeDesc);
 
 /*******************************************************************************
 * Command parameters
@@ -57,7 +56,7 @@ const AT_CMD_TYPE_DESC atCmdTypeDescPING =
         .pCmdName   = "+PING",
         .cmdInit    = _PINGInit,
         .cmdExecute = _PINGExecute,
-        .cmdUpdate  = _PINGUpdate,
+        .cmdUpdate  = NULL,
         .pSummary   = "This command sends a ping (ICMP Echo Request) to the target address",
         .numVars    = 1,
         {
@@ -88,38 +87,13 @@ extern ATCMD_APP_CONTEXT atCmdAppContext;
 /*******************************************************************************
 * Local data
 *******************************************************************************/
-static char nameToResolve[TCPIP_DNS_CLIENT_MAX_HOSTNAME_LEN];
-
 static TCPIP_ICMP_ECHO_REQUEST pingRequest;
 static TCPIP_ICMP_REQUEST_HANDLE pingHandle;
-static TCPIP_DNS_HANDLE dnsResolveHandle;
-static bool nameResolved;
 static uint32_t pingRequestTimeMs;
 
 /*******************************************************************************
 * Local functions
 *******************************************************************************/
-static void _PINGResolvResetQuery(void)
-{
-    if (NULL != dnsResolveHandle)
-    {
-        TCPIP_DNS_HandlerDeRegister(dnsResolveHandle);
-    }
-
-    memset(nameToResolve, 0, TCPIP_DNS_CLIENT_MAX_HOSTNAME_LEN);
-
-    dnsResolveHandle = NULL;
-    nameResolved     = false;
-}
-
-static void _PINGResolvEventHandler(TCPIP_NET_HANDLE hNet, TCPIP_DNS_EVENT_TYPE evType, const char* pName, const void* hParam)
-{
-    if (TCPIP_DNS_EVENT_NAME_RESOLVED == evType)
-    {
-        nameResolved = true;
-    }
-}
-
 static void _PingCallback(const TCPIP_ICMP_ECHO_REQUEST* pReqData, TCPIP_ICMP_REQUEST_HANDLE icmpHandle, TCPIP_ICMP_ECHO_REQUEST_RESULT result, const void* param)
 {
     char s[20];
@@ -139,18 +113,12 @@ static void _PingCallback(const TCPIP_ICMP_ECHO_REQUEST* pReqData, TCPIP_ICMP_RE
     }
 }
 
-static ATCMD_STATUS _PingTargetAddress(const char* pTargetIPAddrStr)
+static ATCMD_STATUS _PingTargetAddress(const IPV4_ADDR* pTargetAddr)
 {
     ICMP_ECHO_RESULT res;
 
-    _PINGResolvResetQuery();
-
-    if (false == TCPIP_Helper_StringToIPAddress(pTargetIPAddrStr, &pingRequest.targetAddr))
-    {
-        return ATCMD_STATUS_INVALID_PARAMETER;
-    }
-
-    pingRequest.sequenceNumber = 1;
+    pingRequest.targetAddr.Val  = pTargetAddr->Val;
+    pingRequest.sequenceNumber  = 1;
 
     res = TCPIP_ICMP_EchoRequest(&pingRequest, &pingHandle);
 
@@ -164,20 +132,31 @@ static ATCMD_STATUS _PingTargetAddress(const char* pTargetIPAddrStr)
     return ATCMD_STATUS_OK;
 }
 
+static void _PINGResolvCallback(const char *pName, ATCMD_STATUS status, const IPV4_ADDR *pAddrs, int numAddrs, const void *param)
+{
+    if (ATCMD_STATUS_OK == status)
+    {
+        status = _PingTargetAddress(&pAddrs[0]);
+    }
+
+    if (ATCMD_STATUS_OK != status)
+    {
+        ATCMD_ReportAECStatus("+PING", status);
+    }
+}
+
 /*******************************************************************************
 * Command init functions
 *******************************************************************************/
 static ATCMD_STATUS _PINGInit(const AT_CMD_TYPE_DESC* pCmdTypeDesc)
 {
-    dnsResolveHandle = NULL;
-
     pingRequest.netH        = atCmdAppContext.netHandle;
     pingRequest.identifier  = 0xCD78;
     pingRequest.pData       = NULL;
     pingRequest.dataSize    = 0;
     pingRequest.callback    = _PingCallback;
 
-    _PINGResolvResetQuery();
+    ATCMD_DNS_Cancel(_PINGResolvCallback, NULL);
 
     return ATCMD_STATUS_OK;
 }
@@ -196,34 +175,16 @@ static ATCMD_STATUS _PINGExecute(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const int
             return ATCMD_STATUS_INVALID_PARAMETER;
         }
 
-        TCPIP_DNS_RESULT dnsResult;
-
-        /* A record lookup */
-
-        strncpy(nameToResolve, (char*)pParamList[0].value.p, TCPIP_DNS_CLIENT_MAX_HOSTNAME_LEN);
-
-        dnsResolveHandle = TCPIP_DNS_HandlerRegister(atCmdAppContext.netHandle, &_PINGResolvEventHandler, nameToResolve);
+        IPV4_ADDR targetAddr;
 
-        if (NULL != dnsResolveHandle)
+        if (true == TCPIP_Helper_StringToIPAddress((char*)pParamList[0].value.p, &targetAddr))
         {
-            dnsResult = TCPIP_DNS_Resolve(nameToResolve, TCPIP_DNS_TYPE_A);
+            return _PingTargetAddress(&targetAddr);
+        }
 
-            if (dnsResult < 0)
-            {
-                _PINGResolvResetQuery();
+        /* Host name, the ping is sent once it has been resolved */
 
-                return ATCMD_APP_STATUS_PING_FAILED;
-            }
-            else if (TCPIP_DNS_RES_NAME_IS_IPADDRESS == dnsResult)
-            {
-                _PINGResolvResetQuery();
-
-                return _PingTargetAddress((char*)pParamList[0].value.p);
-            }
-            else
-            {
-            }
-        }
+        return ATCMD_DNS_Resolve((char*)pParamList[0].value.p, _PINGResolvCallback, NULL);
     }
     else
     {
@@ -232,36 +193,3 @@ static ATCMD_STATUS _PINGExecute(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const int
 
     return ATCMD_STATUS_OK;
 }
-
-/*******************************************************************************
-* Command update functions
-*******************************************************************************/
-static ATCMD_STATUS _PINGUpdate(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const AT_CMD_TYPE_DESC* pCurrentCmdTypeDesc)
-{
-    TCPIP_DNS_RESULT dnsResult;
-    IP_MULTI_ADDRESS ipAddress;
-    char ipAddrStr[20];
-
-    if (true == nameResolved)
-    {
-        dnsResult = TCPIP_DNS_IsResolved(nameToResolve, &ipAddress, TCPIP_DNS_TYPE_A);
-
-        if (TCPIP_DNS_RES_OK == dnsResult)
-        {
-            TCPIP_Helper_IPAddressToString(&ipAddress.v4Add, ipAddrStr, sizeof(ipAddrStr));
-
-            if (ATCMD_STATUS_OK != _PingTargetAddress(ipAddrStr))
-            {
-                /* TODO */
-            }
-        }
-        else
-        {
-            /* TODO */
-        }
-
-        _PINGResolvResetQuery();
-    }
-
-    return ATCMD_STATUS_OK;
-}
@@ -126,7 +126,7 @@ static ATCMD_STATUS _READCERTExecute(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const
         return ATCMD_STATUS_INCORRECT_NUM_PARAMS;
     }
 
-    readCertState = malloc(sizeof(ATCMD_READCERT_STATE));
+    readCertState = OSAL_Malloc(sizeof(ATCMD_READCERT_STATE));
     if(readCertState == NULL)
     {
         return ATCMD_STATUS_ERROR;
@@ -168,7 +168,7 @@ static ATCMD_STATUS _READCERTExecute(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const
             if ((readCertState->numBytesBuffered <= 0)) {
                 size_t  tmpNumBytesBuffered = readCertState->numBytesBuffered;
                 SYS_CONSOLE_PRINT("    Failed converting device Cert to PEM (%d)\r\n", readCertState->numBytesBuffered);
-                free(readCertState);
+                OSAL_Free(readCertState);
                 return tmpNumBytesBuffered;
             }
 
@@ -205,7 +205,7 @@ static ATCMD_STATUS _READCERTExecute(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const
             }
             else
             {
-                free(readCertState);
+                OSAL_Free(readCertState);
                 return ATCMD_STATUS_ERROR;                
             }
             break;
@@ -234,12 +234,12 @@ static ATCMD_STATUS _READCERTExecute(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const
 
     default:
         {
-            free(readCertState);
+            OSAL_Free(readCertState);
             return ATCMD_STATUS_ERROR;
         }
     }
 
-    free(readCertState);
+    OSAL_Free(readCertState);
     return ATCMD_STATUS_OK;
 }
 
@@ -26,6 +26,7 @@
  */
 
 #include <stddef.h>
+#include <limits.h>
 
 #include "at_cmd_app.h"
 #include "at_cmd_tls.h"
@@ -48,6 +49,14 @@ static ATCMD_STATUS _SOCKRDExecute(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const i
 static ATCMD_STATUS _SOCKCLExecute(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const int numParams, ATCMD_PARAM *pParamList);
 static ATCMD_STATUS _SOCKLSTExecute(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const int numParams, ATCMD_PARAM *pParamList);
 static ATCMD_STATUS _SOCKBMExecute(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const int numParams, ATCMD_PARAM *pParamList);
+static ATCMD_STATUS _SOCKPMExecute(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const int numParams, ATCMD_PARAM *pParamList);
+static ATCMD_STATUS _SOCKCRExecute(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const int numParams, ATCMD_PARAM *pParamList);
+static ATCMD_STATUS _SOCKSTATExecute(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const int numParams, ATCMD_PARAM *pParamList);
+static ATCMD_STATUS _SOCKTXMExecute(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const int numParams, ATCMD_PARAM *pParamList);
+static ATCMD_STATUS _SOCKFLExecute(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const int numParams, ATCMD_PARAM *pParamList);
+static ATCMD_STATUS _SOCKWRBExecute(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const int numParams, ATCMD_PARAM *pParamList);
+static ATCMD_STATUS _SOCKTXRExecute(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const int numParams, ATCMD_PARAM *pParamList);
+static ATCMD_STATUS _SOCKCExecute(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const int numParams, ATCMD_PARAM *pParamList);
 static ATCMD_STATUS _SOCKUpdate(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const AT_CMD_TYPE_DESC* pCurrentCmdTypeDesc);
 
 /*******************************************************************************
@@ -101,6 +110,40 @@ static const ATCMD_HELP_PARAM paramMCAST_PORT =
 static const ATCMD_HELP_PARAM paramTLS_CONF =
     {"TLS_CONF", "TLS certificate configuration", ATCMD_PARAM_TYPE_CLASS_INTEGER, 0};
 
+static const ATCMD_HELP_PARAM paramCHUNK_SZ =
+    {"CHUNK_SZ", "The maximum number of bytes in each +SOCKRXP indication (1 - 512 bytes), UDP indications hold one datagram and its source, 0 returns the socket to +SOCKRD reads", ATCMD_PARAM_TYPE_CLASS_INTEGER, 0};
+
+static const ATCMD_HELP_PARAM paramCREDITS =
+    {"CREDITS", "The number of +SOCKRXP indications the DTE is ready to receive", ATCMD_PARAM_TYPE_CLASS_INTEGER, 0};
+
+static const ATCMD_HELP_PARAM paramBACKLOG =
+    {"BACKLOG", "The number of connections a TCP socket may accept at once (1 - 12), 5 if omitted", ATCMD_PARAM_TYPE_CLASS_INTEGER, 0};
+
+static const ATCMD_HELP_PARAM paramTX_MODE =
+    {"TX_MODE", "How data written to a UDP socket is sent", ATCMD_PARAM_TYPE_CLASS_INTEGER,
+        .numOpts = 2,
+        {
+            {"1", "Each write is sent as a datagram"},
+            {"2", "Writes are assembled into one datagram (1 - 1472 bytes) until +SOCKFL"}
+        }
+    };
+
+static const ATCMD_HELP_PARAM paramLENGTH_WRB =
+    {"LENGTH", "The length of the batch (9 - 1400 bytes). Each datagram is a 4 byte IPv4 address, 2 byte port and 2 byte length followed by the data, in network byte order", ATCMD_PARAM_TYPE_CLASS_INTEGER, 0};
+
+static const ATCMD_HELP_PARAM paramOPT_ID =
+    {"OPT_ID", "Option ID number", ATCMD_PARAM_TYPE_CLASS_INTEGER,
+        .numOpts = 3,
+        {
+            {"1", "TCP receive buffer size (512 - 32768 bytes), sets the advertised window"},
+            {"2", "TCP transmit buffer size (512 - 32768 bytes)"},
+            {"3", "TCP congestion control (1 - NewReno, 2 - CUBIC), used from the next connection"}
+        }
+    };
+
+static const ATCMD_HELP_PARAM paramOPT_VAL =
+    {"OPT_VAL", "Option value", ATCMD_PARAM_TYPE_CLASS_INTEGER, 0};
+
 /*******************************************************************************
 * Command examples
 *******************************************************************************/
@@ -139,7 +182,7 @@ const AT_CMD_TYPE_DESC atCmdTypeDescSOCKBL =
         .cmdExecute = _SOCKBLExecute,
         .cmdUpdate  = NULL,
         .pSummary   = "This command is used to bind a socket to a local port",
-        .numVars    = 1,
+        .numVars    = 2,
         {
             {
                 .numParams   = 2,
@@ -153,6 +196,20 @@ const AT_CMD_TYPE_DESC atCmdTypeDescSOCKBL =
                 {
                     NULL
                 }
+            },
+            {
+                .numParams   = 3,
+                .pParams     =
+                {
+                    &paramSOCK_ID,
+                    &paramLCL_PORT,
+                    &paramBACKLOG
+                },
+                .numExamples = 0,
+                .pExamples   =
+                {
+                    NULL
+                }
             }
         }
     };
@@ -342,6 +399,70 @@ const AT_CMD_TYPE_DESC atCmdTypeDescSOCKRD =
         }
     };
 
+const AT_CMD_TYPE_DESC atCmdTypeDescSOCKPM =
+    {
+        .pCmdName   = "+SOCKPM",
+        .cmdInit    = NULL,
+        .cmdExecute = _SOCKPMExecute,
+        .cmdUpdate  = NULL,
+        .pSummary   = "This command is used to have received data sent to the DTE as it arrives, rather than on request",
+        .numVars    = 2,
+        {
+            {
+                .numParams   = 2,
+                .pParams     =
+                {
+                    &paramSOCK_ID,
+                    &paramCHUNK_SZ
+                },
+                .numExamples = 0,
+                .pExamples   =
+                {
+                    NULL
+                }
+            },
+            {
+                .numParams   = 3,
+                .pParams     =
+                {
+                    &paramSOCK_ID,
+                    &paramCHUNK_SZ,
+                    &paramCREDITS
+                },
+                .numExamples = 0,
+                .pExamples   =
+                {
+                    NULL
+                }
+            }
+        }
+    };
+
+const AT_CMD_TYPE_DESC atCmdTypeDescSOCKCR =
+    {
+        .pCmdName   = "+SOCKCR",
+        .cmdInit    = NULL,
+        .cmdExecute = _SOCKCRExecute,
+        .cmdUpdate  = NULL,
+        .pSummary   = "This command is used to allow further received data to be sent to the DTE from a socket in push mode",
+        .numVars    = 1,
+        {
+            {
+                .numParams   = 2,
+                .pParams     =
+                {
+                    &paramSOCK_ID,
+                    &paramCREDITS
+                },
+                .numExamples = 0,
+                .pExamples   =
+                {
+                    NULL
+                }
+            }
+        }
+    };
+
 const AT_CMD_TYPE_DESC atCmdTypeDescSOCKCL =
     {
         .pCmdName   = "+SOCKCL",
@@ -402,17 +523,206 @@ const AT_CMD_TYPE_DESC atCmdTypeDescSOCKLST =
         }
     };
 
+const AT_CMD_TYPE_DESC atCmdTypeDescSOCKSTAT =
+    {
+        .pCmdName   = "+SOCKSTAT",
+        .cmdInit    = NULL,
+        .cmdExecute = _SOCKSTATExecute,
+        .cmdUpdate  = NULL,
+        .pSummary   = "This command is used to query the connection counters of a listening TCP socket, the congestion control state and TLS handshake timing of a connected TCP socket or the transmit counters of a UDP socket",
+        .numVars    = 1,
+        {
+            {
+                .numParams   = 1,
+                .pParams     =
+                {
+                    &paramSOCK_ID
+                },
+                .numExamples = 0,
+                .pExamples   =
+                {
+                    NULL
+                }
+            }
+        }
+    };
+
+const AT_CMD_TYPE_DESC atCmdTypeDescSOCKTXM =
+    {
+        .pCmdName   = "+SOCKTXM",
+        .cmdInit    = NULL,
+        .cmdExecute = _SOCKTXMExecute,
+        .cmdUpdate  = NULL,
+        .pSummary   = "This command is used to set how data written to a UDP socket is sent",
+        .numVars    = 1,
+        {
+            {
+                .numParams   = 2,
+                .pParams     =
+                {
+                    &paramSOCK_ID,
+                    &paramTX_MODE
+                },
+                .numExamples = 0,
+                .pExamples   =
+                {
+                    NULL
+                }
+            }
+        }
+    };
+
+const AT_CMD_TYPE_DESC atCmdTypeDescSOCKFL =
+    {
+        .pCmdName   = "+SOCKFL",
+        .cmdInit    = NULL,
+        .cmdExecute = _SOCKFLExecute,
+        .cmdUpdate  = NULL,
+        .pSummary   = "This command is used to send the datagram assembled on a UDP socket",
+        .numVars    = 1,
+        {
+            {
+                .numParams   = 1,
+                .pParams     =
+                {
+                    &paramSOCK_ID
+                },
+                .numExamples = 0,
+                .pExamples   =
+                {
+                    NULL
+                }
+            }
+        }
+    };
+
+const AT_CMD_TYPE_DESC atCmdTypeDescSOCKWRB =
+    {
+        .pCmdName   = "+SOCKWRB",
+        .cmdInit    = NULL,
+        .cmdExecute = _SOCKWRBExecute,
+        .cmdUpdate  = NULL,
+        .pSummary   = "This command is used to send a batch of datagrams, each to its own destination, on a UDP socket; +SOCKWRB reports how many of the batch were sent",
+        .numVars    = 1,
+        {
+            {
+                .numParams   = 2,
+                .pParams     =
+                {
+                    &paramSOCK_ID,
+                    &paramLENGTH_WRB
+                },
+                .numExamples = 0,
+                .pExamples   =
+                {
+                    NULL
+                }
+            }
+        }
+    };
+
+const AT_CMD_TYPE_DESC atCmdTypeDescSOCKTXR =
+    {
+        .pCmdName   = "+SOCKTXR",
+        .cmdInit    = NULL,
+        .cmdExecute = _SOCKTXRExecute,
+        .cmdUpdate  = NULL,
+        .pSummary   = "This command is used to query how many bytes a socket can accept for sending without loss",
+        .numVars    = 1,
+        {
+            {
+                .numParams   = 1,
+                .pParams     =
+                {
+                    &paramSOCK_ID
+                },
+                .numExamples = 0,
+                .pExamples   =
+                {
+                    NULL
+                }
+            }
+        }
+    };
+
+const AT_CMD_TYPE_DESC atCmdTypeDescSOCKC =
+    {
+        .pCmdName   = "+SOCKC",
+        .cmdInit    = NULL,
+        .cmdExecute = _SOCKCExecute,
+        .cmdUpdate  = NULL,
+        .pSummary   = "This command is used to read or set the options of a socket",
+        .numVars    = 3,
+        {
+            {
+                .numParams   = 1,
+                .pParams     =
+                {
+                    &paramSOCK_ID
+                },
+                .numExamples = 0,
+                .pExamples   =
+                {
+                    NULL
+                }
+            },
+            {
+                .numParams   = 2,
+                .pParams     =
+                {
+                    &paramSOCK_ID,
+                    &paramOPT_ID
+                },
+                .numExamples = 0,
+                .pExamples   =
+                {
+                    NULL
+                }
+            },
+            {
+                .numParams   = 3,
+                .pParams     =
+                {
+                    &paramSOCK_ID,
+                    &paramOPT_ID,
+                    &paramOPT_VAL
+                },
+                .numExamples = 0,
+                .pExamples   =
+                {
+                    NULL
+                }
+            }
+        }
+    };
+
 /*******************************************************************************
 * External references
 *******************************************************************************/
 extern ATCMD_APP_CONTEXT atCmdAppContext;
-extern int CheckAvailableSize(WOLFSSL *ssl, int size);
 uint32_t g_binModeNumBytes = 0;
 
 /*******************************************************************************
 * Local defines and types
 *******************************************************************************/
 #define ATCMD_SOCK_BIND_TIMEOUT_MS  10000
+#define ATCMD_SOCK_RD_LINE_SZ       ((AT_CMD_CONF_PRINTF_OUT_BUF_SIZE - 2) / 2)
+#define ATCMD_SOCK_HANDLE_SEQ_MAX   ((INT_MAX / AT_CMD_SOCK_MAX_NUM) - 1)
+#define ATCMD_SOCK_WRB_HDR_SZ       8
+#define ATCMD_SOCK_TLS_TX_PAD_SZ    16
+#define ATCMD_SOCK_TCP_CB_SZ        256
+
+/* +SOCKC congestion control option values */
+#define ATCMD_SOCK_TCP_CC_NEWRENO   1
+#define ATCMD_SOCK_TCP_CC_CUBIC     2
+
+typedef enum
+{
+    ATCMD_SOCK_OPT_TCP_RX_BUFF = 1,
+    ATCMD_SOCK_OPT_TCP_TX_BUFF,
+    ATCMD_SOCK_OPT_TCP_CC,
+    ATCMD_SOCK_OPT_MAX
+} ATCMD_SOCK_OPT;
 
 typedef enum
 {
@@ -450,25 +760,42 @@ typedef struct _ATCMD_SOCK_STATE
     uint16_t                    pendingDataLength;
     uint32_t                    lastTimeMs;
     int                       childTransHandle[AT_CMD_SOCK_MAX_CLIENTS];
+    uint8_t                     backlog;
+    uint32_t                    numAccepted;
+    uint32_t                    numRejected;
+    bool                        udpHold;
+    uint32_t                    udpNumWrites;
+    uint32_t                    udpNumDatagrams;
+    uint32_t                    udpNumTxBytes;
+    uint16_t                    txNotifyLen;
+    uint16_t                    tlsTxOverhead;
+    uint16_t                    tcpRxBufSize;
+    uint16_t                    tcpTxBufSize;
+    uint8_t                     tcpCcAlg;
+    bool                        rdIsBinary;
+    uint16_t                    rdNumBytesRequested;
+    uint16_t                    pushChunkSize;
+    uint16_t                    pushCredits;
+    bool                        tlsWantRead;
+    uint16_t                    tlsNumSteps;
+    uint32_t                    tlsStartTimeMs;
+    uint32_t                    tlsBusyTimeMs;
+    uint32_t                    tlsTimeMs;
 } ATCMD_SOCK_STATE;
 
-typedef struct
-{
-    ATCMD_SOCK_STATE    *pSockState;
-    uint8_t             buffer[AT_CMD_SOCK_RX_BUFFER_SZ];
-    bool                isBinary;
-    uint16_t            numBytesRequested;
-    uint16_t            numBytesBuffered;
-    uint8_t*            pBufPtr;
-} ATCMD_SOCKRD_STATE;
-
 /*******************************************************************************
 * Local data
 *******************************************************************************/
 static ATCMD_SOCK_STATE socketState[AT_CMD_SOCK_MAX_NUM];
 static ATCMD_SOCK_STATE *pSOCKWRBinarySock;
 static int nextSocketHandle;
-static ATCMD_SOCKRD_STATE sockRdState;
+static uint8_t sockRdChunk[AT_CMD_SOCK_RD_CHUNK_SZ];
+static int sockUpdateFirst;
+static int16_t sockTCPTransMap[TCPIP_TCP_MAX_SOCKETS];
+static int16_t sockUDPTransMap[TCPIP_UDP_MAX_SOCKETS];
+static ATCMD_SOCK_STATE *pSOCKTXStageSock;
+static uint8_t sockTxStage[AT_CMD_SOCK_TX_STAGE_SZ];
+static uint16_t sockTxStageLen;
 
 /*******************************************************************************
 * Local functions
@@ -499,410 +826,1906 @@ static uint16_t _sockTCPReadReady(ATCMD_SOCK_STATE *pSockState)
     return numBytes;
 }
 
-static bool _sockTCPWriteReady(ATCMD_SOCK_STATE *pSockState, uint16_t numBufBytes)
+static uint16_t _sockTxSpace(ATCMD_SOCK_STATE *pSockState)
 {
     int sockPutReadyBytes;
 
+    if (ATCMD_SOCK_PROTO_UDP == pSockState->protocol)
+    {
+        return TCPIP_UDP_PutIsReady(pSockState->transHandle);
+    }
+
     sockPutReadyBytes = TCPIP_TCP_PutIsReady(pSockState->transHandle);
 
     if (ATCMD_SOCK_ENCRYPT_STATE_NONE == pSockState->encryptState)
     {
-        if (sockPutReadyBytes < numBufBytes)
-        {
-            return false;
-        }
+        return sockPutReadyBytes;
     }
-    else if (ATCMD_SOCK_ENCRYPT_STATE_DONE == pSockState->encryptState)
+    else if (ATCMD_SOCK_ENCRYPT_STATE_DONE != pSockState->encryptState)
+    {
+        return 0;
+    }
+
+    if (0 != wolfSSL_want_write(pSockState->pWolfSSLSession))
     {
         char buffer;
 
-        if (wolfSSL_write(pSockState->pWolfSSLSession, &buffer, 0) >= 0)
+        /* Push out the record left over from an earlier write first */
+
+        wolfSSL_write(pSockState->pWolfSSLSession, &buffer, 0);
+
+        if (0 != wolfSSL_want_write(pSockState->pWolfSSLSession))
         {
-            if (0 == CheckAvailableSize(pSockState->pWolfSSLSession, numBufBytes))
-            {
-                if (wolfSSL_GetOutputSize(pSockState->pWolfSSLSession, numBufBytes) > sockPutReadyBytes)
-                {
-                    return false;
-                }
-            }
+            return 0;
         }
+
+        sockPutReadyBytes = TCPIP_TCP_PutIsReady(pSockState->transHandle);
     }
-    else
+
+    if (0 == pSockState->tlsTxOverhead)
     {
-        return false;
-    }
+        int recordSize;
 
-    return true;
-}
+        /* Record overhead is fixed for the session, so size it once */
 
-static void _sockErrorAEC(int handle, ATCMD_APP_STATUS statusCode)
-{
-    const char *pStatusMsg = ATCMD_APPTranslateStatusCode(statusCode);
+        recordSize = wolfSSL_GetOutputSize(pSockState->pWolfSSLSession, 1);
 
-    ATCMD_Printf("+SOCKERR:%d,%d", handle, statusCode);
+        if (recordSize <= 0)
+        {
+            return 0;
+        }
 
-    if (NULL != pStatusMsg)
+        pSockState->tlsTxOverhead = recordSize - 1 + ATCMD_SOCK_TLS_TX_PAD_SZ;
+    }
+
+    if (sockPutReadyBytes <= pSockState->tlsTxOverhead)
     {
-        ATCMD_Printf(",%s", pStatusMsg);
+        return 0;
     }
 
-    ATCMD_Printf("\r\n");
+    return sockPutReadyBytes - pSockState->tlsTxOverhead;
 }
 
-static int _getSocketHandle(void)
+static uint16_t _sockTxWindow(ATCMD_SOCK_STATE *pSockState)
 {
-    if (0 == nextSocketHandle)
+    uint32_t numBytes;
+
+    numBytes = _sockTxSpace(pSockState);
+
+    /* TCP sockets may also fill the staging buffer, unless another socket holds it */
+
+    if ((ATCMD_SOCK_PROTO_TCP == pSockState->protocol) && ((NULL == pSOCKTXStageSock) || (pSockState == pSOCKTXStageSock)))
     {
-        nextSocketHandle = ATCMD_PlatformGetSysTimeMs();
+        numBytes += AT_CMD_SOCK_TX_STAGE_SZ - sockTxStageLen;
     }
-    else
+
+    if (numBytes > UINT16_MAX)
     {
-        nextSocketHandle++;
+        numBytes = UINT16_MAX;
     }
 
-    if (0 == nextSocketHandle)
+    return numBytes;
+}
+
+static int _sockTCPPut(ATCMD_SOCK_STATE *pSockState, const uint8_t *pBuf, uint16_t numBufBytes)
+{
+    int numBytes;
+
+    if (ATCMD_SOCK_ENCRYPT_STATE_NONE == pSockState->encryptState)
     {
-        nextSocketHandle++;
+        return TCPIP_TCP_ArrayPut(pSockState->transHandle, pBuf, numBufBytes);
+    }
+
+    numBytes = wolfSSL_write(pSockState->pWolfSSLSession, pBuf, numBufBytes);
+
+    if (numBytes < 0)
+    {
+        return -1;
     }
 
-    return nextSocketHandle;
+    return numBytes;
 }
 
-static ATCMD_SOCK_STATE* _findSocketByHandle(int handle)
+static bool _sockTCPWrite(ATCMD_SOCK_STATE *pSockState, const uint8_t *pBuf, uint16_t numBufBytes)
 {
-    int i;
+    int numBytes = 0;
 
-    for (i=0; i<AT_CMD_SOCK_MAX_NUM; i++)
+    if ((ATCMD_SOCK_ENCRYPT_STATE_NONE != pSockState->encryptState) && (ATCMD_SOCK_ENCRYPT_STATE_DONE != pSockState->encryptState))
     {
-        if (false == socketState[i].inUse)
+        return false;
+    }
+
+    /* Anything already staged goes first to keep the stream in order */
+
+    if ((pSockState != pSOCKTXStageSock) || (0 == sockTxStageLen))
+    {
+        numBytes = _sockTxSpace(pSockState);
+
+        if (numBytes > numBufBytes)
         {
-            if (-1 == handle)
-            {
-                /* Asked for handle -1 (any) and found an empty structure */
+            numBytes = numBufBytes;
+        }
 
-                memset(&socketState[i], 0, sizeof(ATCMD_SOCK_STATE));
+        if ((ATCMD_SOCK_ENCRYPT_STATE_DONE == pSockState->encryptState) && (numBytes < numBufBytes))
+        {
+            /* Keep TLS records whole, the remainder is staged and sent as one */
 
-                return &socketState[i];
-            }
+            numBytes = 0;
         }
-        else if (handle == socketState[i].handle)
+
+        if (numBytes > 0)
         {
-            /* Asked for a specific handle and found it */
+            numBytes = _sockTCPPut(pSockState, pBuf, numBytes);
 
-            return &socketState[i];
+            if (numBytes < 0)
+            {
+                return false;
+            }
         }
     }
 
-    return NULL;
-}
+    if (numBytes == numBufBytes)
+    {
+        return true;
+    }
 
-static ATCMD_SOCK_STATE* _findSocketByTransHandle(int transHandle)
-{
-    int i;
+    /* Stage the rest, it is within the window advertised to the DTE */
 
-    for (i=0; i<AT_CMD_SOCK_MAX_NUM; i++)
+    if ((NULL != pSOCKTXStageSock) && (pSockState != pSOCKTXStageSock))
     {
-        if (transHandle == socketState[i].transHandle)
-        {
-            /* Asked for a specific handle and found it */
+        return false;
+    }
 
-            return &socketState[i];
-        }
+    if ((numBufBytes - numBytes) > (AT_CMD_SOCK_TX_STAGE_SZ - sockTxStageLen))
+    {
+        return false;
     }
 
-    return NULL;
+    memcpy(&sockTxStage[sockTxStageLen], &pBuf[numBytes], numBufBytes - numBytes);
+
+    sockTxStageLen   += numBufBytes - numBytes;
+    pSOCKTXStageSock  = pSockState;
+
+    /* Tell the DTE once a full write fits again */
+
+    pSockState->txNotifyLen = AT_CMD_SOCK_TX_STAGE_SZ;
+
+    return true;
 }
 
-static ATCMD_SOCK_STATE* _findUDPSocketByTransHandle(UDP_SOCKET transHandle)
+static void _sockTxStageRelease(ATCMD_SOCK_STATE *pSockState)
 {
-    int i;
-
-    for (i=0; i<AT_CMD_SOCK_MAX_NUM; i++)
+    if (pSOCKTXStageSock == pSockState)
     {
-        if ((true == socketState[i].inUse) && (ATCMD_SOCK_PROTO_UDP == socketState[i].protocol) && (transHandle == socketState[i].transHandle))
-        {
-            /* Asked for a specific handle and found it */
-
-            return &socketState[i];
-        }
+        pSOCKTXStageSock = NULL;
+        sockTxStageLen   = 0;
     }
-
-    return NULL;
 }
 
-static void _closeSocket(ATCMD_SOCK_STATE *pSockState)
+static void _sockTxStageDrain(void)
 {
+    ATCMD_SOCK_STATE *pSockState = pSOCKTXStageSock;
+    int numBytes;
+
     if (NULL == pSockState)
     {
         return;
     }
 
-    if (false == pSockState->inUse)
+    numBytes = _sockTxSpace(pSockState);
+
+    if (numBytes > sockTxStageLen)
     {
-        return;
+        numBytes = sockTxStageLen;
     }
 
-    if (-1 == pSockState->transHandle)
+    if (0 == numBytes)
     {
-        pSockState->inUse = false;
         return;
     }
 
-    if (NULL != pSockState->pParent)
+    numBytes = _sockTCPPut(pSockState, sockTxStage, numBytes);
+
+    if (numBytes <= 0)
     {
-        /* For server listening socket spawned sockets, just disconnect but
-           leave the socket present for reuse. */
-        if (true == TCPIP_TCP_Disconnect(pSockState->transHandle))
-        {
-            if (NULL != pSockState->pWolfSSLSession)
-            {
-                ATCMD_TLS_FreeSession(pSockState->tlsConfIdx, pSockState->pWolfSSLSession);
-            }
+        return;
+    }
 
-            pSockState->encryptState = ATCMD_SOCK_ENCRYPT_STATE_NONE;
-        }
+    sockTxStageLen -= numBytes;
 
-        pSockState->remoteIPv4Addr.Val = 0;
-        pSockState->remotePort         = 0;
-        pSockState->pendingDataLength  = 0;
+    if (sockTxStageLen > 0)
+    {
+        memmove(sockTxStage, &sockTxStage[numBytes], sockTxStageLen);
     }
     else
     {
-        if (ATCMD_SOCK_PROTO_UDP == pSockState->protocol)
-        {
-            TCPIP_UDP_SignalHandlerDeregister(pSockState->transHandle, pSockState->sigHandler);
-
-            TCPIP_UDP_Close(pSockState->transHandle);
-        }
-        else
-        {
-            TCPIP_TCP_SignalHandlerDeregister(pSockState->transHandle, pSockState->sigHandler);
-
-            if (NULL != pSockState->pWolfSSLSession)
-            {
-                ATCMD_TLS_FreeSession(pSockState->tlsConfIdx, pSockState->pWolfSSLSession);
-            }
+        pSOCKTXStageSock = NULL;
+    }
+}
 
-            pSockState->encryptState = ATCMD_SOCK_ENCRYPT_STATE_NONE;
+static void _sockErrorAEC(int handle, ATCMD_APP_STATUS statusCode)
+{
+    const char *pStatusMsg = ATCMD_APPTranslateStatusCode(statusCode);
 
-            TCPIP_TCP_Close(pSockState->transHandle);
-        }
+    ATCMD_Printf("+SOCKERR:%d,%d", handle, statusCode);
 
-        pSockState->transHandle    = -1;
-        pSockState->inUse          = false;
+    if (NULL != pStatusMsg)
+    {
+        ATCMD_Printf(",%s", pStatusMsg);
     }
+
+    ATCMD_Printf("\r\n");
 }
 
-static void _socketWriteBinaryDataHandler(const uint8_t *pBuf, size_t numBufBytes)
+static uint16_t _sockReadAvailable(ATCMD_SOCK_STATE *pSockState)
 {
-    if (NULL == pSOCKWRBinarySock)
+    if (ATCMD_SOCK_PROTO_UDP == pSockState->protocol)
     {
-        return;
+        return TCPIP_UDP_GetIsReady(pSockState->transHandle);
     }
 
-    if (ATCMD_SOCK_PROTO_UDP == pSOCKWRBinarySock->protocol)
-    {
-        /* UDP socket, ensure remote address/port is set before trying to sendto */
+    return _sockTCPReadReady(pSockState);
+}
 
-        if ((0 == pSOCKWRBinarySock->remoteIPv4Addr.Val) || (0 == pSOCKWRBinarySock->remotePort))
+static uint16_t _sockReadChunk(ATCMD_SOCK_STATE *pSockState, uint8_t *pBuf, uint16_t numBytes)
+{
+    if (ATCMD_SOCK_ENCRYPT_STATE_NONE == pSockState->encryptState)
+    {
+        if (ATCMD_SOCK_PROTO_UDP == pSockState->protocol)
         {
-            return;
+            return TCPIP_UDP_ArrayGet(pSockState->transHandle, pBuf, numBytes);
         }
-
-        if (TCPIP_UDP_PutIsReady(pSOCKWRBinarySock->transHandle) < numBufBytes)
+        else
         {
-            return;
+            return TCPIP_TCP_ArrayGet(pSockState->transHandle, pBuf, numBytes);
         }
+    }
+    else if (ATCMD_SOCK_ENCRYPT_STATE_DONE == pSockState->encryptState)
+    {
+        int readRes = wolfSSL_read(pSockState->pWolfSSLSession, pBuf, numBytes);
 
-        if (0 == TCPIP_UDP_ArrayPut(pSOCKWRBinarySock->transHandle, pBuf, numBufBytes))
+        if (readRes > 0)
         {
-            return;
+            return readRes;
         }
+    }
+
+    return 0;
+}
+
+/* Send everything available, up to the requested length, to the DTE in one pass */
+static void _sockReadStream(ATCMD_SOCK_STATE *pSockState)
+{
+    uint16_t numBytes;
+    uint16_t numChunkBytes;
+
+    numBytes = _sockReadAvailable(pSockState);
+
+    if (numBytes > pSockState->rdNumBytesRequested)
+    {
+        numBytes = pSockState->rdNumBytesRequested;
+    }
 
-        TCPIP_UDP_Flush(pSOCKWRBinarySock->transHandle);
+    pSockState->rdNumBytesRequested = 0;
+
+    if (0 == numBytes)
+    {
+        return;
     }
-    else if (ATCMD_SOCK_PROTO_TCP == pSOCKWRBinarySock->protocol)
+
+    if (true == pSockState->rdIsBinary)
     {
-        if (false == _sockTCPWriteReady(pSOCKWRBinarySock, numBufBytes))
-        {
-            return;
-        }
+        bool readFailed = false;
+
+        /* The length is limited to data the stack (or TLS session) already
+           holds, so each chunk read returns in full and the data follows a
+           single header in one binary block */
+
+        ATCMD_Printf("+SOCKRD:%d,%d,", pSockState->handle, numBytes);
+        ATCMD_Print("\r\n", 2);
+        ATCMD_EnterBinaryMode(NULL);
 
-        if (ATCMD_SOCK_ENCRYPT_STATE_NONE == pSOCKWRBinarySock->encryptState)
+        while (numBytes > 0)
         {
-            if (0 == TCPIP_TCP_ArrayPut(pSOCKWRBinarySock->transHandle, pBuf, numBufBytes))
+            uint16_t numReadBytes;
+
+            numChunkBytes = (numBytes > sizeof(sockRdChunk)) ? sizeof(sockRdChunk) : numBytes;
+
+            numReadBytes = 0;
+
+            if (false == readFailed)
             {
-                return;
+                numReadBytes = _sockReadChunk(pSockState, sockRdChunk, numChunkBytes);
+            }
+
+            if (numReadBytes < numChunkBytes)
+            {
+                /* Should not happen, but the length is already announced so
+                   keep the block that size and report the error after it */
+
+                memset(&sockRdChunk[numReadBytes], 0, numChunkBytes - numReadBytes);
+                readFailed = true;
             }
+
+            pSockState->pendingDataLength -= numReadBytes;
+
+            ATCMD_Print((char*)sockRdChunk, numChunkBytes);
+
+            numBytes -= numChunkBytes;
         }
-        else
+
+        ATCMD_LeaveBinaryMode();
+
+        if (true == readFailed)
+        {
+            _sockErrorAEC(pSockState->handle, ATCMD_APP_STATUS_SOCKET_READ_FAILED);
+        }
+    }
+    else
+    {
+        /* Each line is limited so its hex form fits the print buffer */
+
+        while (numBytes > 0)
         {
-            if (wolfSSL_write(pSOCKWRBinarySock->pWolfSSLSession, pBuf, numBufBytes) < 0)
+            numChunkBytes = (numBytes > ATCMD_SOCK_RD_LINE_SZ) ? ATCMD_SOCK_RD_LINE_SZ : numBytes;
+
+            numChunkBytes = _sockReadChunk(pSockState, sockRdChunk, numChunkBytes);
+
+            if (0 == numChunkBytes)
             {
-                return;
+                break;
             }
+
+            pSockState->pendingDataLength -= numChunkBytes;
+
+            ATCMD_Printf("+SOCKRD:%d,%d,", pSockState->handle, numChunkBytes);
+            ATCMD_PrintStringSafe((char*)sockRdChunk, numChunkBytes);
+            ATCMD_Print("\r\n", 2);
+
+            numBytes -= numChunkBytes;
         }
     }
-    else
+
+    if (ATCMD_SOCK_PROTO_UDP == pSockState->protocol)
     {
-        return;
+        UDP_SOCKET_INFO udpSockInfo;
+
+        pSockState->pendingDataLength = TCPIP_UDP_GetIsReady(pSockState->transHandle);
+
+        if (pSockState->pendingDataLength > 0)
+        {
+            TCPIP_UDP_SocketInfoGet(pSockState->transHandle, &udpSockInfo);
+
+            ATCMD_Printf("+SOCKRXU:%d,", pSockState->handle);
+            ATCMD_PrintIPv4Address(udpSockInfo.sourceIPaddress.v4Add.Val);
+            ATCMD_Printf(",%d,%d\r\n", udpSockInfo.remotePort, pSockState->pendingDataLength);
+        }
     }
 }
 
-static void _tcpSocketSignalHandler(TCP_SOCKET hTCP, TCPIP_NET_HANDLE hNet, TCPIP_TCP_SIGNAL_TYPE sigType, const void* param)
+/* Send one chunk of received data to the DTE for a socket in push mode,
+   returns true if another chunk could be sent straight away; a UDP chunk
+   never spans datagrams and carries the datagram's source, a datagram
+   larger than the chunk size is sent in several chunks */
+static bool _sockPushData(ATCMD_SOCK_STATE *pSockState)
 {
-    ATCMD_SOCK_STATE *const pSockState = (ATCMD_SOCK_STATE *const)param;
+    uint16_t numBytes;
+    uint16_t numSliceBytes;
+    uint8_t *pData;
+    UDP_SOCKET_INFO udpSockInfo;
 
-//    ATCMD_Printf("TSH(%d): (0x%08x) 0x%04x\r\n", hTCP, param, sigType);
+    if (0 == pSockState->pushCredits)
+    {
+        return false;
+    }
 
-    if (true == ATCMD_ModeIsBinary())
+    /* For UDP only the current datagram is ready */
+    numBytes = _sockReadAvailable(pSockState);
+
+    if (numBytes > pSockState->pushChunkSize)
     {
-        return;        
+        numBytes = pSockState->pushChunkSize;
     }
-    
-    if (NULL == pSockState)
+
+    if (0 == numBytes)
     {
-        return;
+        return false;
     }
 
-    if (0 != (sigType & TCPIP_TCP_SIGNAL_ESTABLISHED))
+    if (ATCMD_SOCK_PROTO_UDP == pSockState->protocol)
     {
-        TCP_SOCKET_INFO tcpSockInfo;
+        /* The source must be taken before the datagram is consumed */
+        TCPIP_UDP_SocketInfoGet(pSockState->transHandle, &udpSockInfo);
+    }
 
-        if (NULL != pSockState->pParent)
+    numBytes = _sockReadChunk(pSockState, sockRdChunk, numBytes);
+
+    if (0 == numBytes)
+    {
+        return false;
+    }
+
+    pSockState->pushCredits--;
+
+    if (ATCMD_SOCK_PROTO_UDP == pSockState->protocol)
+    {
+        ATCMD_Printf("+SOCKRXP:%d,", pSockState->handle);
+        ATCMD_PrintIPv4Address(udpSockInfo.sourceIPaddress.v4Add.Val);
+        ATCMD_Printf(",%d,%d,", udpSockInfo.remotePort, numBytes);
+    }
+    else
+    {
+        ATCMD_Printf("+SOCKRXP:%d,%d,", pSockState->handle, numBytes);
+    }
+
+    if (numBytes <= ATCMD_SOCK_RD_LINE_SZ)
+    {
+        ATCMD_PrintStringSafe((char*)sockRdChunk, numBytes);
+        ATCMD_Print("\r\n", 2);
+    }
+    else
+    {
+        /* Too large for a single print, send as hex in slices that fit the print buffer */
+
+        pData = sockRdChunk;
+
+        ATCMD_Print("[", 1);
+
+        while (numBytes > 0)
         {
-            pSockState->needsEncryption = pSockState->pParent->needsEncryption;
+            numSliceBytes = (numBytes > ATCMD_SOCK_RD_LINE_SZ) ? ATCMD_SOCK_RD_LINE_SZ : numBytes;
+
+            ATCMD_PrintStringHexWithDelimiterInfo(pData, numSliceBytes, false, false);
+
+            pData    += numSliceBytes;
+            numBytes -= numSliceBytes;
+        }
+
+        ATCMD_Print("]\r\n", 3);
+    }
+
+    pSockState->pendingDataLength = _sockReadAvailable(pSockState);
+
+    return ((pSockState->pushCredits > 0) && (pSockState->pendingDataLength > 0));
+}
+
+/* Socket handles carry the index of their socket structure in the low
+   part, handle = (sequence * AT_CMD_SOCK_MAX_NUM) + index, so they can be
+   looked up directly while still differing each time a structure is reused */
+static int _getSocketHandle(ATCMD_SOCK_STATE *pSockState)
+{
+    if (0 == nextSocketHandle)
+    {
+        nextSocketHandle = ATCMD_PlatformGetSysTimeMs() % ATCMD_SOCK_HANDLE_SEQ_MAX;
+    }
+    else
+    {
+        nextSocketHandle++;
+    }
+
+    if ((0 == nextSocketHandle) || (nextSocketHandle > ATCMD_SOCK_HANDLE_SEQ_MAX))
+    {
+        nextSocketHandle = 1;
+    }
+
+    return (nextSocketHandle * AT_CMD_SOCK_MAX_NUM) + (pSockState - socketState);
+}
+
+static ATCMD_SOCK_STATE* _findSocketByHandle(int handle)
+{
+    int i;
+
+    if (-1 == handle)
+    {
+        for (i=0; i<AT_CMD_SOCK_MAX_NUM; i++)
+        {
+            if (false == socketState[i].inUse)
+            {
+                /* Asked for handle -1 (any) and found an empty structure */
+
+                memset(&socketState[i], 0, sizeof(ATCMD_SOCK_STATE));
+
+                socketState[i].transHandle = -1;
+
+                return &socketState[i];
+            }
+        }
+
+        return NULL;
+    }
+
+    if (handle < AT_CMD_SOCK_MAX_NUM)
+    {
+        return NULL;
+    }
+
+    i = handle % AT_CMD_SOCK_MAX_NUM;
+
+    if ((true == socketState[i].inUse) && (handle == socketState[i].handle))
+    {
+        /* Asked for a specific handle and found it */
+
+        return &socketState[i];
+    }
+
+    return NULL;
+}
+
+/* Change the transport handle of a socket, keeping the transport handle maps in step */
+static void _sockSetTransHandle(ATCMD_SOCK_STATE *pSockState, int16_t transHandle)
+{
+    int16_t sockIdx = pSockState - socketState;
+    int16_t *pTransMap;
+    int numTransHandles;
+
+    if (ATCMD_SOCK_PROTO_UDP == pSockState->protocol)
+    {
+        pTransMap       = sockUDPTransMap;
+        numTransHandles = TCPIP_UDP_MAX_SOCKETS;
+    }
+    else
+    {
+        pTransMap       = sockTCPTransMap;
+        numTransHandles = TCPIP_TCP_MAX_SOCKETS;
+    }
+
+    if ((pSockState->transHandle >= 0) && (pSockState->transHandle < numTransHandles) && (sockIdx == pTransMap[pSockState->transHandle]))
+    {
+        pTransMap[pSockState->transHandle] = -1;
+    }
+
+    pSockState->transHandle = transHandle;
+
+    if ((transHandle >= 0) && (transHandle < numTransHandles))
+    {
+        pTransMap[transHandle] = sockIdx;
+    }
+}
+
+static size_t _sockTCPMemSize(const ATCMD_SOCK_STATE *pSockState)
+{
+    size_t numBytes = ATCMD_SOCK_TCP_CB_SZ;
+
+    /* Sizes left at zero are the stack defaults */
+
+    numBytes += (0 != pSockState->tcpRxBufSize) ? pSockState->tcpRxBufSize : TCPIP_TCP_SOCKET_DEFAULT_RX_SIZE;
+    numBytes += (0 != pSockState->tcpTxBufSize) ? pSockState->tcpTxBufSize : TCPIP_TCP_SOCKET_DEFAULT_TX_SIZE;
+
+    return numBytes;
+}
+
+/* Map a +SOCKC congestion control value to the stack's algorithm, 0 being the build default */
+static TCP_CC_ALGORITHM _sockTCPCcAlgorithm(int ccAlg)
+{
+    switch (ccAlg)
+    {
+        case ATCMD_SOCK_TCP_CC_NEWRENO:
+        {
+            return TCP_CC_NEWRENO;
+        }
+
+        case ATCMD_SOCK_TCP_CC_CUBIC:
+        {
+            return TCP_CC_CUBIC;
+        }
+
+        default:
+        {
+            return TCPIP_TCP_CONGESTION_CONTROL;
+        }
+    }
+}
+
+static int _sockTCPCcOptValue(TCP_CC_ALGORITHM ccAlgorithm)
+{
+    if (TCP_CC_CUBIC == ccAlgorithm)
+    {
+        return ATCMD_SOCK_TCP_CC_CUBIC;
+    }
+
+    return ATCMD_SOCK_TCP_CC_NEWRENO;
+}
+
+static bool _sockTCPOptApply(ATCMD_SOCK_STATE *pSockState)
+{
+    if (0 != pSockState->tcpRxBufSize)
+    {
+        if (false == TCPIP_TCP_OptionsSet(pSockState->transHandle, TCP_OPTION_RX_BUFF, (void*)(uintptr_t)pSockState->tcpRxBufSize))
+        {
+            return false;
+        }
+    }
+
+    if (0 != pSockState->tcpTxBufSize)
+    {
+        if (false == TCPIP_TCP_OptionsSet(pSockState->transHandle, TCP_OPTION_TX_BUFF, (void*)(uintptr_t)pSockState->tcpTxBufSize))
+        {
+            return false;
+        }
+    }
+
+    if (0 != pSockState->tcpCcAlg)
+    {
+        if (false == TCPIP_TCP_OptionsSet(pSockState->transHandle, TCP_OPTION_CONGESTION_CONTROL, (void*)(uintptr_t)_sockTCPCcAlgorithm(pSockState->tcpCcAlg)))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static size_t _sockMemInUse(void)
+{
+    int i;
+    size_t numBytes = 0;
+
+    /* Estimate of the heap held by TCP buffers and TLS sessions, recomputed
+       on demand so it can't drift from the socket states */
+
+    for (i=0; i<AT_CMD_SOCK_MAX_NUM; i++)
+    {
+        if (false == socketState[i].inUse)
+        {
+            continue;
+        }
+
+        if ((ATCMD_SOCK_PROTO_TCP == socketState[i].protocol) && (-1 != socketState[i].transHandle))
+        {
+            numBytes += _sockTCPMemSize(&socketState[i]);
+        }
+
+        if ((ATCMD_SOCK_ENCRYPT_STATE_STARTING == socketState[i].encryptState) ||
+            (ATCMD_SOCK_ENCRYPT_STATE_NEGOTIATING == socketState[i].encryptState) ||
+            (ATCMD_SOCK_ENCRYPT_STATE_DONE == socketState[i].encryptState))
+        {
+            numBytes += AT_CMD_SOCK_TLS_MEM_SZ;
+        }
+    }
+
+    return numBytes;
+}
+
+static ATCMD_SOCK_STATE* _findSocketByTransHandle(TCP_SOCKET transHandle)
+{
+    ATCMD_SOCK_STATE *pSockState;
+
+    if ((transHandle < 0) || (transHandle >= TCPIP_TCP_MAX_SOCKETS) || (-1 == sockTCPTransMap[transHandle]))
+    {
+        return NULL;
+    }
+
+    pSockState = &socketState[sockTCPTransMap[transHandle]];
+
+    if (false == pSockState->inUse)
+    {
+        return NULL;
+    }
+
+    return pSockState;
+}
+
+static ATCMD_SOCK_STATE* _findUDPSocketByTransHandle(UDP_SOCKET transHandle)
+{
+    ATCMD_SOCK_STATE *pSockState;
+
+    if ((transHandle < 0) || (transHandle >= TCPIP_UDP_MAX_SOCKETS) || (-1 == sockUDPTransMap[transHandle]))
+    {
+        return NULL;
+    }
+
+    pSockState = &socketState[sockUDPTransMap[transHandle]];
+
+    if (false == pSockState->inUse)
+    {
+        return NULL;
+    }
+
+    return pSockState;
+}
+
+static void _closeSocket(ATCMD_SOCK_STATE *pSockState)
+{
+    if (NULL == pSockState)
+    {
+        return;
+    }
+
+    if (false == pSockState->inUse)
+    {
+        return;
+    }
+
+    _sockTxStageRelease(pSockState);
+
+    pSockState->rdNumBytesRequested = 0;
+    pSockState->pushChunkSize       = 0;
+    pSockState->pushCredits         = 0;
+    pSockState->txNotifyLen         = 0;
+    pSockState->tlsNumSteps         = 0;
+    pSockState->tlsBusyTimeMs       = 0;
+    pSockState->tlsTimeMs           = 0;
+
+    if (-1 == pSockState->transHandle)
+    {
+        pSockState->inUse = false;
+        return;
+    }
+
+    if (NULL != pSockState->pParent)
+    {
+        /* For server listening socket spawned sockets, just disconnect but
+           leave the socket present for reuse. */
+        if (true == TCPIP_TCP_Disconnect(pSockState->transHandle))
+        {
+            if (NULL != pSockState->pWolfSSLSession)
+            {
+                ATCMD_TLS_FreeSession(pSockState->tlsConfIdx, pSockState->pWolfSSLSession);
+            }
+
+            pSockState->encryptState = ATCMD_SOCK_ENCRYPT_STATE_NONE;
+        }
+
+        pSockState->remoteIPv4Addr.Val = 0;
+        pSockState->remotePort         = 0;
+        pSockState->pendingDataLength  = 0;
+    }
+    else
+    {
+        if (ATCMD_SOCK_PROTO_UDP == pSockState->protocol)
+        {
+            TCPIP_UDP_SignalHandlerDeregister(pSockState->transHandle, pSockState->sigHandler);
+
+            TCPIP_UDP_Close(pSockState->transHandle);
+        }
+        else
+        {
+            TCPIP_TCP_SignalHandlerDeregister(pSockState->transHandle, pSockState->sigHandler);
+
+            if (NULL != pSockState->pWolfSSLSession)
+            {
+                ATCMD_TLS_FreeSession(pSockState->tlsConfIdx, pSockState->pWolfSSLSession);
+            }
+
+            pSockState->encryptState = ATCMD_SOCK_ENCRYPT_STATE_NONE;
+
+            TCPIP_TCP_Close(pSockState->transHandle);
+        }
+
+        _sockSetTransHandle(pSockState, -1);
+        pSockState->inUse          = false;
+    }
+}
+
+static bool _sockUDPFlush(ATCMD_SOCK_STATE *pSockState)
+{
+    uint16_t numBytes;
+
+    numBytes = TCPIP_UDP_TxCountGet(pSockState->transHandle);
+
+    if (0 == numBytes)
+    {
+        return true;
+    }
+
+    if (0 == TCPIP_UDP_Flush(pSockState->transHandle))
+    {
+        return false;
+    }
+
+    pSockState->udpNumDatagrams++;
+    pSockState->udpNumTxBytes += numBytes;
+
+    return true;
+}
+
+static void _sockUDPWriteDone(ATCMD_SOCK_STATE *pSockState)
+{
+    pSockState->udpNumWrites++;
+
+    /* When assembling, the datagram is only sent on +SOCKFL */
+
+    if (false == pSockState->udpHold)
+    {
+        _sockUDPFlush(pSockState);
+    }
+}
+
+static void _socketWriteBinaryDataHandler(const uint8_t *pBuf, size_t numBufBytes)
+{
+    if (NULL == pSOCKWRBinarySock)
+    {
+        return;
+    }
+
+    if (ATCMD_SOCK_PROTO_UDP == pSOCKWRBinarySock->protocol)
+    {
+        /* UDP socket, ensure remote address/port is set before trying to sendto */
+
+        if ((0 == pSOCKWRBinarySock->remoteIPv4Addr.Val) || (0 == pSOCKWRBinarySock->remotePort))
+        {
+            _sockErrorAEC(pSOCKWRBinarySock->handle, ATCMD_APP_STATUS_SOCKET_REMOTE_NOT_SET);
+            return;
+        }
+
+        /* The data is already taken from the DTE, so failures are reported
+           as the string mode commands report them */
+
+        if (TCPIP_UDP_PutIsReady(pSOCKWRBinarySock->transHandle) < numBufBytes)
+        {
+            pSOCKWRBinarySock->txNotifyLen = numBufBytes;
+            _sockErrorAEC(pSOCKWRBinarySock->handle, ATCMD_APP_STATUS_SOCKET_SEND_FAILED);
+            return;
+        }
+
+        if (0 == TCPIP_UDP_ArrayPut(pSOCKWRBinarySock->transHandle, pBuf, numBufBytes))
+        {
+            _sockErrorAEC(pSOCKWRBinarySock->handle, ATCMD_APP_STATUS_SOCKET_SEND_FAILED);
+            return;
+        }
+
+        _sockUDPWriteDone(pSOCKWRBinarySock);
+    }
+    else if (ATCMD_SOCK_PROTO_TCP == pSOCKWRBinarySock->protocol)
+    {
+        /* Only data beyond the advertised window is lost */
+
+        if (false == _sockTCPWrite(pSOCKWRBinarySock, pBuf, numBufBytes))
+        {
+            pSOCKWRBinarySock->txNotifyLen = numBufBytes;
+            _sockErrorAEC(pSOCKWRBinarySock->handle, ATCMD_APP_STATUS_SOCKET_SEND_FAILED);
+            return;
+        }
+    }
+    else
+    {
+        return;
+    }
+}
+
+static void _socketWriteBatchDataHandler(const uint8_t *pBuf, size_t numBufBytes)
+{
+    ATCMD_SOCK_STATE *pSockState = pSOCKWRBinarySock;
+    size_t offset;
+    int numDgrams;
+    int numSent;
+
+    if (NULL == pSockState)
+    {
+        return;
+    }
+
+    /* Check the whole batch is well formed before any of it is sent */
+
+    offset    = 0;
+    numDgrams = 0;
+
+    while (offset < numBufBytes)
+    {
+        uint16_t dgramLength;
+
+        if ((numBufBytes - offset) < ATCMD_SOCK_WRB_HDR_SZ)
+        {
+            _sockErrorAEC(pSockState->handle, ATCMD_APP_STATUS_SOCKET_SEND_FAILED);
+            return;
+        }
+
+        dgramLength = ((uint16_t)pBuf[offset+6] << 8) | pBuf[offset+7];
+
+        if ((0 == dgramLength) || ((numBufBytes - offset - ATCMD_SOCK_WRB_HDR_SZ) < dgramLength))
+        {
+            _sockErrorAEC(pSockState->handle, ATCMD_APP_STATUS_SOCKET_SEND_FAILED);
+            return;
+        }
+
+        offset += ATCMD_SOCK_WRB_HDR_SZ + dgramLength;
+
+        numDgrams++;
+    }
+
+    offset  = 0;
+    numSent = 0;
+
+    while (offset < numBufBytes)
+    {
+        IPV4_ADDR remoteAddr;
+        uint16_t remotePort;
+        uint16_t dgramLength;
+
+        memcpy(remoteAddr.v, &pBuf[offset], sizeof(remoteAddr.v));
+        remotePort  = ((uint16_t)pBuf[offset+4] << 8) | pBuf[offset+5];
+        dgramLength = ((uint16_t)pBuf[offset+6] << 8) | pBuf[offset+7];
+
+        offset += ATCMD_SOCK_WRB_HDR_SZ;
+
+        TCPIP_UDP_DestinationIPAddressSet(pSockState->transHandle, IP_ADDRESS_TYPE_IPV4, (IP_MULTI_ADDRESS*)&remoteAddr);
+        TCPIP_UDP_DestinationPortSet(pSockState->transHandle, remotePort);
+
+        if (TCPIP_UDP_PutIsReady(pSockState->transHandle) >= dgramLength)
+        {
+            if (dgramLength == TCPIP_UDP_ArrayPut(pSockState->transHandle, &pBuf[offset], dgramLength))
+            {
+                pSockState->udpNumWrites++;
+
+                if (true == _sockUDPFlush(pSockState))
+                {
+                    numSent++;
+                }
+            }
+            else
+            {
+                /* Nothing of a partial datagram may go out with the next one */
+                TCPIP_UDP_TxOffsetSet(pSockState->transHandle, 0, false);
+            }
+        }
+
+        offset += dgramLength;
+    }
+
+    /* Leave the socket sending to its bound remote again, or to no one
+       if it has none, rather than the last destination of the batch */
+
+    TCPIP_UDP_DestinationIPAddressSet(pSockState->transHandle, IP_ADDRESS_TYPE_IPV4, (IP_MULTI_ADDRESS*)&pSockState->remoteIPv4Addr);
+    TCPIP_UDP_DestinationPortSet(pSockState->transHandle, pSockState->remotePort);
+
+    ATCMD_Printf("+SOCKWRB:%d,%d,%d\r\n", pSockState->handle, numSent, numDgrams);
+}
+
+static void _tcpSocketSignalProcess(TCP_SOCKET hTCP, TCPIP_NET_HANDLE hNet, TCPIP_TCP_SIGNAL_TYPE sigType, const void* param)
+{
+    ATCMD_SOCK_STATE *const pSockState = (ATCMD_SOCK_STATE *const)param;
+
+//    ATCMD_Printf("TSH(%d): (0x%08x) 0x%04x\r\n", hTCP, param, sigType);
+
+    if (true == ATCMD_ModeIsBinary())
+    {
+        return;        
+    }
+    
+    if (NULL == pSockState)
+    {
+        return;
+    }
+
+    if ((NULL != pSockState->pParent) && (0 == pSockState->handle) && (0 == (sigType & TCPIP_TCP_SIGNAL_ESTABLISHED)))
+    {
+        /* Connection refused at admission, it is never reported to the DTE */
+        return;
+    }
+
+    if (0 != (sigType & TCPIP_TCP_SIGNAL_ESTABLISHED))
+    {
+        TCP_SOCKET_INFO tcpSockInfo;
+
+        if (NULL != pSockState->pParent)
+        {
+            pSockState->needsEncryption = pSockState->pParent->needsEncryption;
+
+            /* The TCP buffers were reserved at bind, a TLS session still has to
+               be allocated so refuse now rather than fail the handshake later */
+
+            if ((true == pSockState->needsEncryption) && ((_sockMemInUse() + AT_CMD_SOCK_TLS_MEM_SZ) > AT_CMD_SOCK_MEM_BUDGET))
+            {
+                pSockState->handle = 0;
+                pSockState->pParent->numRejected++;
+
+                TCPIP_TCP_Disconnect(pSockState->transHandle);
+                return;
+            }
+
+            pSockState->pParent->numAccepted++;
+        }
+
+        if (true == pSockState->needsEncryption)
+        {
+            if (ATCMD_SOCK_ENCRYPT_STATE_NONE == pSockState->encryptState)
+            {
+                pSockState->encryptState = ATCMD_SOCK_ENCRYPT_STATE_STARTING;
+                pSockState->needsEncryption = false;
+            }
+            else
+            {
+                SYS_CONSOLE_PRINT("\n_tcpSocketSignalHandler():ATCMD_APP_STATUS_SOCKET_TLS_FAILED\n");
+                _sockErrorAEC(pSockState->handle, ATCMD_APP_STATUS_SOCKET_TLS_FAILED);
+                return;
+            }
+        }
+
+        memset(&tcpSockInfo, 0, sizeof(tcpSockInfo));
+        if(false == TCPIP_TCP_SocketInfoGet(pSockState->transHandle, &tcpSockInfo))
+        {
+            ATCMD_Printf("TCPIP_TCP_SocketInfoGet() returned false; pSockState->transHandle = 0x%x ; hTCP = 0x%x", pSockState->transHandle, hTCP);            
+        }
+
+        if (NULL != pSockState->pParent)
+        {
+            pSockState->handle             = _getSocketHandle(pSockState);
+            pSockState->remoteIPv4Addr.Val = tcpSockInfo.remoteIPaddress.v4Add.Val == 0x01000000u ? 0: tcpSockInfo.remoteIPaddress.v4Add.Val;
+            pSockState->remotePort         = tcpSockInfo.remotePort;
+        }
+        else
+        {
+            pSockState->localPort = tcpSockInfo.localPort;
+        }
+
+        ATCMD_Printf("+SOCKIND:%d,", pSockState->handle);
+        ATCMD_PrintIPv4Address(tcpSockInfo.localIPaddress.v4Add.Val);
+        ATCMD_Printf(",%d,", pSockState->localPort);
+        ATCMD_PrintIPv4Address(pSockState->remoteIPv4Addr.Val);
+        ATCMD_Printf(",%d\r\n", pSockState->remotePort);
+
+        if (ATCMD_SOCK_ENCRYPT_STATE_NONE == pSockState->encryptState)
+        {
+            pSockState->isConnected = true;
+        }
+    }
+
+    if (0 != (sigType & TCPIP_TCP_SIGNAL_RX_DATA))
+    {
+        uint16_t numBytes;
+
+        numBytes = _sockTCPReadReady(pSockState);
+
+        if ((numBytes > 0) && (numBytes > pSockState->pendingDataLength) && (0 == pSockState->pushChunkSize))
+        {
+            ATCMD_Printf("+SOCKRXT:%d,%d\r\n", pSockState->handle, numBytes);
+        }
+
+        pSockState->pendingDataLength = numBytes;
+    }
+
+    if (0 != (sigType & (TCPIP_TCP_SIGNAL_TX_RST|TCPIP_TCP_SIGNAL_RX_FIN|TCPIP_TCP_SIGNAL_RX_RST|TCPIP_TCP_SIGNAL_KEEP_ALIVE_TMO)))
+    {
+        ATCMD_Printf("+SOCKCL:%d\r\n", pSockState->handle);
+
+        _sockTxStageRelease(pSockState);
+
+        if (true == TCPIP_TCP_Disconnect(pSockState->transHandle))
+        {
+            if (NULL != pSockState->pWolfSSLSession)
+            {
+                ATCMD_TLS_FreeSession(pSockState->tlsConfIdx, pSockState->pWolfSSLSession);
+            }
+
+            pSockState->encryptState = ATCMD_SOCK_ENCRYPT_STATE_NONE;
+        }
+
+        pSockState->remoteIPv4Addr.Val = 0;
+        pSockState->remotePort         = 0;
+        pSockState->pendingDataLength  = 0;
+    }
+}
+
+static void _tcpSocketSignalHandler(TCP_SOCKET hTCP, TCPIP_NET_HANDLE hNet, TCPIP_TCP_SIGNAL_TYPE sigType, const void* param)
+{
+    _tcpSocketSignalProcess(hTCP, hNet, sigType, param);
+
+    /* Let the AT task act on the new socket state, e.g. a pending read or TLS handshake */
+    ATCMD_PlatformEventSignal();
+}
+
+static void _udpSocketSignalHandler(UDP_SOCKET hUDP, TCPIP_NET_HANDLE hNet, TCPIP_UDP_SIGNAL_TYPE sigType, const void* param)
+{
+    ATCMD_SOCK_STATE *const pSockState = _findUDPSocketByTransHandle(hUDP);
+
+//    ATCMD_Printf("USH(%d): (0x%08x) 0x%04x\r\n", hUDP, param, sigType);
+
+    if (NULL == pSockState)
+    {
+        return;
+    }
+
+    if ((0 != (sigType & TCPIP_UDP_SIGNAL_RX_DATA)) && (0 == pSockState->pendingDataLength) && (0 == pSockState->pushChunkSize))
+    {
+        UDP_SOCKET_INFO udpSockInfo;
+
+        pSockState->pendingDataLength = TCPIP_UDP_GetIsReady(pSockState->transHandle);
+
+        TCPIP_UDP_SocketInfoGet(pSockState->transHandle, &udpSockInfo);
+
+        ATCMD_Printf("+SOCKRXU:%d,", pSockState->handle);
+        ATCMD_PrintIPv4Address(udpSockInfo.sourceIPaddress.v4Add.Val);
+        ATCMD_Printf(",%d,%d\r\n", udpSockInfo.remotePort, pSockState->pendingDataLength);
+    }
+
+    ATCMD_PlatformEventSignal();
+}
+
+/*******************************************************************************
+* Command init functions
+*******************************************************************************/
+static ATCMD_STATUS _SOCKInit(const AT_CMD_TYPE_DESC* pCmdTypeDesc)
+{
+    memset(socketState, 0, sizeof(socketState));
+    memset(sockTCPTransMap, 0xff, sizeof(sockTCPTransMap));
+    memset(sockUDPTransMap, 0xff, sizeof(sockUDPTransMap));
+    sockUpdateFirst = 0;
+    pSOCKTXStageSock = NULL;
+    sockTxStageLen = 0;
+
+    pSOCKWRBinarySock = NULL;
+    nextSocketHandle  = 0;
+
+    wolfSSL_Init();
+
+    return ATCMD_STATUS_OK;
+}
+
+/*******************************************************************************
+* Command execute functions
+*******************************************************************************/
+static ATCMD_STATUS _SOCKOExecute(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const int numParams, ATCMD_PARAM *pParamList)
+{
+    ATCMD_SOCK_STATE *pSockState = NULL;
+
+    /* Validate the parameters against the defined descriptors to ensure types match */
+
+    if (1 == numParams)
+    {
+        if (false == ATCMD_ParamValidateTypes(pCmdTypeDesc, 0, numParams, pParamList))
+        {
+            return ATCMD_STATUS_INVALID_PARAMETER;
+        }
+    }
+    else
+    {
+        return ATCMD_STATUS_INCORRECT_NUM_PARAMS;
+    }
+
+    /* Find empty socket structure to use for new socket */
+
+    pSockState = _findSocketByHandle(-1);
+
+    if (NULL == pSockState)
+    {
+        return ATCMD_APP_STATUS_NO_FREE_SOCKETS;
+    }
+
+    if (ATCMD_SOCK_PROTO_UDP == pParamList[0].value.i)
+    {
+        /* UDP */
+    }
+    else if (ATCMD_SOCK_PROTO_TCP == pParamList[0].value.i)
+    {
+        /* TCP */
+    }
+    else
+    {
+        return ATCMD_APP_STATUS_INVALID_SOCKET_PROTOCOL;
+    }
+
+    pSockState->isConnected     = false;
+    pSockState->handle          = _getSocketHandle(pSockState);
+    pSockState->protocol        = pParamList[0].value.i;
+    pSockState->pParent         = NULL;
+    pSockState->backlog         = 0;
+    pSockState->udpHold         = false;
+    pSockState->udpNumWrites    = 0;
+    pSockState->udpNumDatagrams = 0;
+    pSockState->udpNumTxBytes   = 0;
+    pSockState->tcpRxBufSize    = 0;
+    pSockState->tcpTxBufSize    = 0;
+    pSockState->tcpCcAlg        = 0;
+    pSockState->inUse           = true;
+    pSockState->needsEncryption = false;
+
+    ATCMD_Printf("+SOCKO:%d\r\n", pSockState->handle);
+
+    return ATCMD_STATUS_OK;
+}
+
+static ATCMD_STATUS _SOCKBLExecute(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const int numParams, ATCMD_PARAM *pParamList)
+{
+    ATCMD_SOCK_STATE *pSockState = NULL;
+
+    /* Validate the parameters against the defined descriptors to ensure types match */
+
+    if ((2 == numParams) || (3 == numParams))
+    {
+        if (false == ATCMD_ParamValidateTypes(pCmdTypeDesc, numParams-2, numParams, pParamList))
+        {
+            return ATCMD_STATUS_INVALID_PARAMETER;
+        }
+    }
+    else
+    {
+        return ATCMD_STATUS_INCORRECT_NUM_PARAMS;
+    }
+
+    /* Find the socket structure associated with this socket ID */
+
+    pSockState = _findSocketByHandle(pParamList[0].value.i);
+
+    if (NULL == pSockState)
+    {
+        return ATCMD_APP_STATUS_SOCKET_ID_NOT_FOUND;
+    }
+
+    if (ATCMD_SOCK_PROTO_UDP == pSockState->protocol)
+    {
+        /* UDP socket */
+
+        if (3 == numParams)
+        {
+            return ATCMD_STATUS_INVALID_PARAMETER;
+        }
+
+        pSockState->localPort  = pParamList[1].value.i;
+
+        _sockSetTransHandle(pSockState, TCPIP_UDP_ServerOpen(IP_ADDRESS_TYPE_IPV4, pSockState->localPort, NULL));
+
+        if (-1 == pSockState->transHandle)
+        {
+            _closeSocket(pSockState);
+
+            return ATCMD_APP_STATUS_SOCKET_BIND_FAILED;
+        }
+
+        pSockState->sigHandler = TCPIP_UDP_SignalHandlerRegister(pSockState->transHandle, 0xffff /*TCPIP_UDP_SIGNAL_RX_DATA*/, _udpSocketSignalHandler, pSockState);
+
+        TCPIP_UDP_OptionsSet(pSockState->transHandle, UDP_OPTION_BUFFER_POOL, (void*)true);
+    }
+    else if (ATCMD_SOCK_PROTO_TCP == pSockState->protocol)
+    {
+        int i;
+        int backlog = AT_CMD_SOCK_DFLT_BACKLOG;
+
+        /* TCP socket */
+
+        if (3 == numParams)
+        {
+            backlog = pParamList[2].value.i;
+
+            if ((backlog < 1) || (backlog > AT_CMD_SOCK_MAX_CLIENTS))
+            {
+                return ATCMD_STATUS_INVALID_PARAMETER;
+            }
+        }
+
+        pSockState->localPort   = pParamList[1].value.i;
+        pSockState->backlog     = 0;
+        pSockState->numAccepted = 0;
+        pSockState->numRejected = 0;
+
+        for (i=0; i<AT_CMD_SOCK_MAX_CLIENTS; i++)
+        {
+            pSockState->childTransHandle[i] = -1;
+        }
+
+        /* Pre-open one listening socket per backlog entry, each holding its
+           buffers from now on, stopping early if the memory budget runs out */
+
+        for (i=0; i<backlog; i++)
+        {
+            ATCMD_SOCK_STATE *pSrvSockState;
+
+            if ((_sockMemInUse() + _sockTCPMemSize(pSockState)) > AT_CMD_SOCK_MEM_BUDGET)
+            {
+                break;
+            }
+
+            pSrvSockState = _findSocketByHandle(-1);
+
+            if (NULL == pSrvSockState)
+            {
+                break;
+            }
+
+            pSrvSockState->protocol     = ATCMD_SOCK_PROTO_TCP;
+            pSrvSockState->tcpRxBufSize = pSockState->tcpRxBufSize;
+            pSrvSockState->tcpTxBufSize = pSockState->tcpTxBufSize;
+            pSrvSockState->tcpCcAlg     = pSockState->tcpCcAlg;
+
+            _sockSetTransHandle(pSrvSockState, TCPIP_TCP_ServerOpen(IP_ADDRESS_TYPE_IPV4, pSockState->localPort, NULL));
+
+            if (-1 == pSrvSockState->transHandle)
+            {
+                _closeSocket(pSrvSockState);
+                break;
+            }
+
+            if (false == _sockTCPOptApply(pSrvSockState))
+            {
+                TCPIP_TCP_Close(pSrvSockState->transHandle);
+                _sockSetTransHandle(pSrvSockState, -1);
+                break;
+            }
+
+            pSockState->childTransHandle[i] = pSrvSockState->transHandle;
+
+            pSrvSockState->sigHandler       = TCPIP_TCP_SignalHandlerRegister(pSrvSockState->transHandle, 0xffff /*TCPIP_TCP_SIGNAL_ESTABLISHED | TCPIP_TCP_SIGNAL_RX_RST | TCPIP_TCP_SIGNAL_RX_DATA*/, _tcpSocketSignalHandler, pSrvSockState);
+
+            pSrvSockState->handle           = 0;
+            pSrvSockState->localPort        = pSockState->localPort;
+            pSrvSockState->inUse            = true;
+            pSrvSockState->pParent          = pSockState;
+            pSrvSockState->needsEncryption  = pSockState->needsEncryption;
+        }
+
+        if (0 == i)
+        {
+            return ATCMD_APP_STATUS_SOCKET_BIND_FAILED;
+        }
+
+        pSockState->backlog = i;
+    }
+    else
+    {
+        return ATCMD_APP_STATUS_INVALID_SOCKET_PROTOCOL;
+    }
+
+    return ATCMD_STATUS_OK;
+}
+
+static ATCMD_STATUS _SOCKBRExecute(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const int numParams, ATCMD_PARAM *pParamList)
+{
+    ATCMD_SOCK_STATE *pSockState = NULL;
+
+    /* Validate the parameters against the defined descriptors to ensure types match */
+
+    if (3 == numParams)
+    {
+        if (false == ATCMD_ParamValidateTypes(pCmdTypeDesc, 0, numParams, pParamList))
+        {
+            return ATCMD_STATUS_INVALID_PARAMETER;
+        }
+    }
+    else
+    {
+        return ATCMD_STATUS_INCORRECT_NUM_PARAMS;
+    }
+
+    /* Find the socket structure associated with this socket ID */
+
+    pSockState = _findSocketByHandle(pParamList[0].value.i);
+
+    if (NULL == pSockState)
+    {
+        return ATCMD_APP_STATUS_SOCKET_ID_NOT_FOUND;
+    }
+
+    TCPIP_Helper_StringToIPAddress((char*)pParamList[1].value.p, &pSockState->remoteIPv4Addr);
+
+    pSockState->localPort  = 0;
+    pSockState->remotePort = pParamList[2].value.i;
+
+    if (ATCMD_SOCK_PROTO_UDP == pSockState->protocol)
+    {
+        /* UDP socket, bind to remote address/port, this shouldn't be necessary if using sendto */
+
+        _sockSetTransHandle(pSockState, TCPIP_UDP_ClientOpen(IP_ADDRESS_TYPE_IPV4, pSockState->remotePort, (IP_MULTI_ADDRESS*)&pSockState->remoteIPv4Addr));
+
+        if (-1 == pSockState->transHandle)
+        {
+            _closeSocket(pSockState);
+
+            return ATCMD_APP_STATUS_SOCKET_BIND_FAILED;
+        }
+
+        pSockState->sigHandler = TCPIP_UDP_SignalHandlerRegister(pSockState->transHandle, 0xffff /*TCPIP_UDP_SIGNAL_RX_DATA*/, _udpSocketSignalHandler, pSockState);
+
+        TCPIP_UDP_OptionsSet(pSockState->transHandle, UDP_OPTION_BUFFER_POOL, (void*)true);
+    }
+    else if (ATCMD_SOCK_PROTO_TCP == pSockState->protocol)
+    {
+        size_t memSize = _sockTCPMemSize(pSockState);
+
+        /* TCP socket, connect to remote address/port */
+
+        if (true == pSockState->needsEncryption)
+        {
+            memSize += AT_CMD_SOCK_TLS_MEM_SZ;
+        }
+
+        if ((_sockMemInUse() + memSize) > AT_CMD_SOCK_MEM_BUDGET)
+        {
+            return ATCMD_APP_STATUS_SOCKET_MEM_BUDGET_EXCEEDED;
         }
 
         if (true == pSockState->needsEncryption)
         {
-            if (ATCMD_SOCK_ENCRYPT_STATE_NONE == pSockState->encryptState)
+            pSockState->encryptState = ATCMD_SOCK_ENCRYPT_STATE_STARTING;
+        }
+
+        _sockSetTransHandle(pSockState, TCPIP_TCP_ClientOpen(IP_ADDRESS_TYPE_IPV4, pSockState->remotePort, (IP_MULTI_ADDRESS*)&pSockState->remoteIPv4Addr));
+
+        if (-1 == pSockState->transHandle)
+        {
+            _closeSocket(pSockState);
+
+            return ATCMD_APP_STATUS_SOCKET_BIND_FAILED;
+        }
+
+        /* The SYN may already be out, the larger receive window is then
+           advertised from the first ACK onwards. The congestion control
+           starts with the SYN+ACK so it is always in time */
+
+        if (false == _sockTCPOptApply(pSockState))
+        {
+            _closeSocket(pSockState);
+
+            return ATCMD_APP_STATUS_SOCKET_SET_OPT_FAILED;
+        }
+
+        pSockState->sigHandler = TCPIP_TCP_SignalHandlerRegister(pSockState->transHandle, 0xffff /*TCPIP_TCP_SIGNAL_ESTABLISHED | TCPIP_TCP_SIGNAL_RX_RST*/, _tcpSocketSignalHandler, pSockState);
+
+        pSockState->needsEncryption = false;
+    }
+    else
+    {
+        return ATCMD_APP_STATUS_INVALID_SOCKET_PROTOCOL;
+    }
+
+    pSockState->lastTimeMs = ATCMD_PlatformGetSysTimeMs();
+
+    return ATCMD_STATUS_OK;
+}
+
+static ATCMD_STATUS _SOCKBMExecute(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const int numParams, ATCMD_PARAM *pParamList)
+{
+    ATCMD_SOCK_STATE *pSockState = NULL;
+
+    if (3 == numParams)
+    {
+        if (false == ATCMD_ParamValidateTypes(pCmdTypeDesc, 0, numParams, pParamList))
+        {
+            return ATCMD_STATUS_INVALID_PARAMETER;
+        }
+    }
+    else
+    {
+        return ATCMD_STATUS_INCORRECT_NUM_PARAMS;
+    }
+
+    /* Find the socket structure associated with this socket ID */
+
+    pSockState = _findSocketByHandle(pParamList[0].value.i);
+
+    if (NULL == pSockState)
+    {
+        return ATCMD_APP_STATUS_SOCKET_ID_NOT_FOUND;
+    }
+
+    TCPIP_Helper_StringToIPAddress((char*)pParamList[1].value.p, &pSockState->remoteIPv4Addr);
+
+    pSockState->localPort  = pParamList[2].value.i;
+    pSockState->remotePort = pParamList[2].value.i;
+
+    if (ATCMD_SOCK_PROTO_UDP == pSockState->protocol)
+    {
+        UDP_OPTION_MULTICAST_DATA sockOpt;
+
+        _sockSetTransHandle(pSockState, TCPIP_UDP_ClientOpen(IP_ADDRESS_TYPE_IPV4, pSockState->remotePort, (IP_MULTI_ADDRESS*)&pSockState->remoteIPv4Addr));
+
+        if (-1 == pSockState->transHandle)
+        {
+            _closeSocket(pSockState);
+
+            return ATCMD_APP_STATUS_SOCKET_BIND_FAILED;
+        }
+
+        pSockState->sigHandler = TCPIP_UDP_SignalHandlerRegister(pSockState->transHandle, 0xffff /*TCPIP_UDP_SIGNAL_RX_DATA*/, _udpSocketSignalHandler, pSockState);
+
+        TCPIP_UDP_OptionsSet(pSockState->transHandle, UDP_OPTION_BUFFER_POOL, (void*)true);
+
+        sockOpt.flagsMask = 0xFF;
+        sockOpt.flagsValue = UDP_MCAST_FLAG_DEFAULT; 
+
+        if (false == TCPIP_UDP_Bind(pSockState->transHandle, IP_ADDRESS_TYPE_IPV4, pSockState->localPort, NULL))
+        {
+            return ATCMD_APP_STATUS_SOCKET_BIND_FAILED;
+        }
+
+        if (false == TCPIP_UDP_OptionsSet((UDP_SOCKET)pSockState->transHandle, UDP_OPTION_MULTICAST, &sockOpt))
+        {
+            return ATCMD_APP_STATUS_MULTICAST_ERROR;
+        }
+
+        if (TCPIP_IGMP_OK != TCPIP_IGMP_Subscribe((UDP_SOCKET)pSockState->transHandle, atCmdAppContext.netHandle, pSockState->remoteIPv4Addr, TCPIP_IGMP_FILTER_EXCLUDE, NULL, NULL))
+        {
+            return ATCMD_APP_STATUS_MULTICAST_ERROR;
+        }
+    }
+    else
+    {
+        return ATCMD_APP_STATUS_INVALID_SOCKET_PROTOCOL;
+    }
+
+    return ATCMD_STATUS_OK;
+}
+
+static ATCMD_STATUS _SOCKTLSExecute(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const int numParams, ATCMD_PARAM *pParamList)
+{
+    ATCMD_SOCK_STATE *pSockState = NULL;
+
+    /* Validate the parameters against the defined descriptors to ensure types match */
+
+    if (2 == numParams)
+    {
+        if (false == ATCMD_ParamValidateTypes(pCmdTypeDesc, 0, numParams, pParamList))
+        {
+            return ATCMD_STATUS_INVALID_PARAMETER;
+        }
+    }
+    else
+    {
+        return ATCMD_STATUS_INCORRECT_NUM_PARAMS;
+    }
+
+    if ((pParamList[1].value.i < 1) || (pParamList[1].value.i > AT_CMD_TLS_NUM_CONFS))
+    {
+        return ATCMD_STATUS_INVALID_PARAMETER;
+    }
+
+    /* Find the socket structure associated with this socket ID */
+
+    pSockState = _findSocketByHandle(pParamList[0].value.i);
+
+    if (NULL == pSockState)
+    {
+        return ATCMD_APP_STATUS_SOCKET_ID_NOT_FOUND;
+    }
+
+    if (ATCMD_SOCK_PROTO_TCP != pSockState->protocol)
+    {
+        return ATCMD_APP_STATUS_INVALID_SOCKET_PROTOCOL;
+    }
+
+    pSockState->tlsConfIdx = pParamList[1].value.i;
+
+    if (ATCMD_SOCK_ENCRYPT_STATE_NONE == pSockState->encryptState)
+    {
+        if (true == pSockState->isConnected)
+        {
+            pSockState->encryptState = ATCMD_SOCK_ENCRYPT_STATE_STARTING;
+
+            pSockState->isConnected = false;
+        }
+        else
+        {
+            pSockState->needsEncryption = true;
+        }
+    }
+    else if (ATCMD_SOCK_ENCRYPT_STATE_DONE == pSockState->encryptState)
+    {
+        ATCMD_Printf("+SOCKTLS:%d\r\n", pSockState->handle);
+    }
+
+    return ATCMD_STATUS_OK;
+}
+
+static ATCMD_STATUS _SOCKWRExecute(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const int numParams, ATCMD_PARAM *pParamList)
+{
+    ATCMD_SOCK_STATE *pSockState = NULL;
+
+    /* Validate the parameters against the defined descriptors to ensure types match */
+
+    if (3 == numParams)
+    {
+        if (false == ATCMD_ParamValidateTypes(pCmdTypeDesc, 0, numParams, pParamList))
+        {
+            return ATCMD_STATUS_INVALID_PARAMETER;
+        }
+    }
+    else if (2 == numParams)
+    {
+        if (false == ATCMD_ParamValidateTypes(pCmdTypeDesc, 1, numParams, pParamList))
+        {
+            return ATCMD_STATUS_INVALID_PARAMETER;
+        }
+
+        if (0 != pParamList[1].value.i)
+        {
+            g_binModeNumBytes = pParamList[1].value.i;
+        }
+    }
+    else
+    {
+        return ATCMD_STATUS_INCORRECT_NUM_PARAMS;
+    }
+
+    /* Find the socket structure associated with this socket ID */
+
+    pSockState = _findSocketByHandle(pParamList[0].value.i);
+
+    if (NULL == pSockState)
+    {
+        return ATCMD_APP_STATUS_SOCKET_ID_NOT_FOUND;
+    }
+
+    if ((0 == pSockState->remoteIPv4Addr.Val) || (0 == pSockState->remotePort))
+    {
+        return ATCMD_APP_STATUS_SOCKET_ID_NOT_FOUND;        
+    }
+    
+    if (2 == numParams)
+    {
+        /* Binary mode */
+
+        ATCMD_Print("\r\n", 2);
+        ATCMD_EnterBinaryMode(&_socketWriteBinaryDataHandler);
+        pSOCKWRBinarySock = pSockState;
+    }
+    else if (pParamList[1].value.i == pParamList[2].length)
+    {
+        /* ASCII or hex string mode */
+
+        if (ATCMD_SOCK_PROTO_UDP == pSockState->protocol)
+        {
+            /* UDP socket, ensure remote address/port is set before trying to sendto */
+
+            if ((0 == pSockState->remoteIPv4Addr.Val) || (0 == pSockState->remotePort))
             {
-                pSockState->encryptState = ATCMD_SOCK_ENCRYPT_STATE_STARTING;
-                pSockState->needsEncryption = false;
+                return ATCMD_APP_STATUS_SOCKET_REMOTE_NOT_SET;
             }
-            else
+
+            if (TCPIP_UDP_PutIsReady(pSockState->transHandle) < pParamList[2].length)
             {
-                SYS_CONSOLE_PRINT("\n_tcpSocketSignalHandler():ATCMD_APP_STATUS_SOCKET_TLS_FAILED\n");
-                _sockErrorAEC(pSockState->handle, ATCMD_APP_STATUS_SOCKET_TLS_FAILED);
-                return;
+                pSockState->txNotifyLen = pParamList[2].length;
+                return ATCMD_APP_STATUS_SOCKET_SEND_FAILED;
+            }
+
+            if (0 == TCPIP_UDP_ArrayPut(pSockState->transHandle, pParamList[2].value.p, pParamList[2].length))
+            {
+                return ATCMD_APP_STATUS_SOCKET_SEND_FAILED;
+            }
+
+            _sockUDPWriteDone(pSockState);
+        }
+        else if (ATCMD_SOCK_PROTO_TCP == pSockState->protocol)
+        {
+            /* TCP socket */
+
+            if (false == _sockTCPWrite(pSockState, pParamList[2].value.p, pParamList[2].length))
+            {
+                pSockState->txNotifyLen = pParamList[2].length;
+                return ATCMD_APP_STATUS_SOCKET_SEND_FAILED;
+            }
+        }
+        else
+        {
+            return ATCMD_APP_STATUS_INVALID_SOCKET_PROTOCOL;
+        }
+    }
+    else
+    {
+        return ATCMD_APP_STATUS_LENGTH_MISMATCH;
+    }
+
+    return ATCMD_STATUS_OK;
+}
+
+static ATCMD_STATUS _SOCKWRTOExecute(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const int numParams, ATCMD_PARAM *pParamList)
+{
+    ATCMD_SOCK_STATE *pSockState = NULL;
+
+    /* Validate the parameters against the defined descriptors to ensure types match */
+
+    if (5 == numParams)
+    {
+        if (false == ATCMD_ParamValidateTypes(pCmdTypeDesc, 0, numParams, pParamList))
+        {
+            return ATCMD_STATUS_INVALID_PARAMETER;
+        }
+    }
+    else if (4 == numParams)
+    {
+        if (false == ATCMD_ParamValidateTypes(pCmdTypeDesc, 1, numParams, pParamList))
+        {
+            return ATCMD_STATUS_INVALID_PARAMETER;
+        }
+
+        if (0 != pParamList[3].value.i)
+        {
+            g_binModeNumBytes = pParamList[3].value.i;
+        }
+    }
+    else
+    {
+        return ATCMD_STATUS_INCORRECT_NUM_PARAMS;
+    }
+
+    /* Find the socket structure associated with this socket ID */
+
+    pSockState = _findSocketByHandle(pParamList[0].value.i);
+
+    if (NULL == pSockState)
+    {
+        return ATCMD_APP_STATUS_SOCKET_ID_NOT_FOUND;
+    }
+
+    if (4 == numParams)
+    {
+        /* Binary mode */
+
+        ATCMD_Print("\r\n", 2);
+        ATCMD_EnterBinaryMode(&_socketWriteBinaryDataHandler);
+        pSOCKWRBinarySock = pSockState;
+        if ((0 == pSockState->remoteIPv4Addr.Val) || (0 == pSockState->remotePort))
+        {
+            IPV4_ADDR remoteAddr;
+            TCPIP_Helper_StringToIPAddress((char*)pParamList[1].value.p, &remoteAddr);
+            TCPIP_UDP_DestinationIPAddressSet(pSockState->transHandle, IP_ADDRESS_TYPE_IPV4, (IP_MULTI_ADDRESS*)&remoteAddr);
+            TCPIP_UDP_DestinationPortSet(pSockState->transHandle, pParamList[2].value.i);
+            pSockState->remoteIPv4Addr.Val = remoteAddr.Val;
+            pSockState->remotePort         = pParamList[2].value.i;
+        }
+    }
+    else if (pParamList[3].value.i == pParamList[4].length)
+    {
+        /* ASCII or hex string mode */
+
+        if (ATCMD_SOCK_PROTO_UDP == pSockState->protocol)
+        {
+            /* UDP socket, use supplied remote address/port instead of stored one */
+
+            UDP_SOCKET_INFO udpSockInfo;
+            IPV4_ADDR remoteAddr;
+
+            TCPIP_UDP_SocketInfoGet(pSockState->transHandle, &udpSockInfo);
+
+            TCPIP_Helper_StringToIPAddress((char*)pParamList[1].value.p, &remoteAddr);
+            TCPIP_UDP_DestinationIPAddressSet(pSockState->transHandle, IP_ADDRESS_TYPE_IPV4, (IP_MULTI_ADDRESS*)&remoteAddr);
+            TCPIP_UDP_DestinationPortSet(pSockState->transHandle, pParamList[2].value.i);
+
+            if (TCPIP_UDP_PutIsReady(pSockState->transHandle) < pParamList[4].length)
+            {
+                SYS_CONSOLE_PRINT("\nLength Expected = %d; Available = %d\n", pParamList[4].length, TCPIP_UDP_PutIsReady(pSockState->transHandle));
+                pSockState->txNotifyLen = pParamList[4].length;
+                return ATCMD_APP_STATUS_SOCKET_SEND_FAILED;
+            }
+
+            if (0 == TCPIP_UDP_ArrayPut(pSockState->transHandle, pParamList[4].value.p, pParamList[4].length))
+            {
+                SYS_CONSOLE_PRINT("\nTCPIP_UDP_ArrayPut() : Failed\n");
+                return ATCMD_APP_STATUS_SOCKET_SEND_FAILED;
+            }
+
+            _sockUDPWriteDone(pSockState);
+
+            if ((0 == pSockState->remoteIPv4Addr.Val) || (0 == pSockState->remotePort))
+            {
+                pSockState->remoteIPv4Addr.Val = remoteAddr.Val;
+                pSockState->remotePort         = pParamList[2].value.i;
             }
         }
+        else
+        {
+            return ATCMD_APP_STATUS_INVALID_SOCKET_PROTOCOL;
+        }
+    }
+    else
+    {
+        return ATCMD_APP_STATUS_LENGTH_MISMATCH;
+    }
+
+    return ATCMD_STATUS_OK;
+}
+
+static ATCMD_STATUS _SOCKRDExecute(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const int numParams, ATCMD_PARAM *pParamList)
+{
+    ATCMD_SOCK_STATE *pSockState = NULL;
+
+    if (3 == numParams)
+    {
+        if (false == ATCMD_ParamValidateTypes(pCmdTypeDesc, 0, numParams, pParamList))
+        {
+            return ATCMD_STATUS_INVALID_PARAMETER;
+        }
+    }
+    else
+    {
+        return ATCMD_STATUS_INCORRECT_NUM_PARAMS;
+    }
+
+    /* Find the socket structure associated with this socket ID */
+
+    pSockState = _findSocketByHandle(pParamList[0].value.i);
+
+    if (NULL == pSockState)
+    {
+        return ATCMD_APP_STATUS_SOCKET_ID_NOT_FOUND;
+    }
 
-        memset(&tcpSockInfo, 0, sizeof(tcpSockInfo));
-        if(false == TCPIP_TCP_SocketInfoGet(pSockState->transHandle, &tcpSockInfo))
-        {
-            ATCMD_Printf("TCPIP_TCP_SocketInfoGet() returned false; pSockState->transHandle = 0x%x ; hTCP = 0x%x", pSockState->transHandle, hTCP);            
-        }
+    if (pParamList[2].value.i > AT_CMD_SOCK_RD_MAX_SZ)
+    {
+        return ATCMD_STATUS_INVALID_PARAMETER;
+    }
 
-        if (NULL != pSockState->pParent)
+    if (pParamList[2].value.i > 0)
+    {
+        if (1 == pParamList[1].value.i)
         {
-            pSockState->handle             = _getSocketHandle();
-            pSockState->remoteIPv4Addr.Val = tcpSockInfo.remoteIPaddress.v4Add.Val == 0x01000000u ? 0: tcpSockInfo.remoteIPaddress.v4Add.Val;
-            pSockState->remotePort         = tcpSockInfo.remotePort;
+            /* ASCII or hex string */
+
+            pSockState->rdIsBinary          = false;
+            pSockState->rdNumBytesRequested = pParamList[2].value.i;
+
+            return ATCMD_STATUS_PENDING;
         }
-        else
+        else if (2 == pParamList[1].value.i)
         {
-            pSockState->localPort = tcpSockInfo.localPort;
-        }
+            /* Binary */
 
-        ATCMD_Printf("+SOCKIND:%d,", pSockState->handle);
-        ATCMD_PrintIPv4Address(tcpSockInfo.localIPaddress.v4Add.Val);
-        ATCMD_Printf(",%d,", pSockState->localPort);
-        ATCMD_PrintIPv4Address(pSockState->remoteIPv4Addr.Val);
-        ATCMD_Printf(",%d\r\n", pSockState->remotePort);
+            pSockState->rdIsBinary          = true;
+            pSockState->rdNumBytesRequested = pParamList[2].value.i;
 
-        if (ATCMD_SOCK_ENCRYPT_STATE_NONE == pSockState->encryptState)
+            return ATCMD_STATUS_PENDING;
+        }
+        else
         {
-            pSockState->isConnected = true;
+            return ATCMD_APP_STATUS_INVALID_SOCKET_PROTOCOL;
         }
     }
 
-    if (0 != (sigType & TCPIP_TCP_SIGNAL_RX_DATA))
-    {
-        uint16_t numBytes;
+    return ATCMD_STATUS_OK;
+}
 
-        numBytes = _sockTCPReadReady(pSockState);
+static ATCMD_STATUS _SOCKPMExecute(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const int numParams, ATCMD_PARAM *pParamList)
+{
+    ATCMD_SOCK_STATE *pSockState = NULL;
 
-        if ((numBytes > 0) && (numBytes > pSockState->pendingDataLength))
+    if (2 == numParams)
+    {
+        if (false == ATCMD_ParamValidateTypes(pCmdTypeDesc, 0, numParams, pParamList))
         {
-            ATCMD_Printf("+SOCKRXT:%d,%d\r\n", pSockState->handle, numBytes);
+            return ATCMD_STATUS_INVALID_PARAMETER;
         }
-
-        pSockState->pendingDataLength = numBytes;
     }
-
-    if (0 != (sigType & (TCPIP_TCP_SIGNAL_TX_RST|TCPIP_TCP_SIGNAL_RX_FIN|TCPIP_TCP_SIGNAL_RX_RST|TCPIP_TCP_SIGNAL_KEEP_ALIVE_TMO)))
+    else if (3 == numParams)
     {
-        ATCMD_Printf("+SOCKCL:%d\r\n", pSockState->handle);
-
-        if (true == TCPIP_TCP_Disconnect(pSockState->transHandle))
+        if (false == ATCMD_ParamValidateTypes(pCmdTypeDesc, 1, numParams, pParamList))
         {
-            if (NULL != pSockState->pWolfSSLSession)
-            {
-                ATCMD_TLS_FreeSession(pSockState->tlsConfIdx, pSockState->pWolfSSLSession);
-            }
-
-            pSockState->encryptState = ATCMD_SOCK_ENCRYPT_STATE_NONE;
+            return ATCMD_STATUS_INVALID_PARAMETER;
         }
-
-        pSockState->remoteIPv4Addr.Val = 0;
-        pSockState->remotePort         = 0;
-        pSockState->pendingDataLength  = 0;
     }
-}
+    else
+    {
+        return ATCMD_STATUS_INCORRECT_NUM_PARAMS;
+    }
 
-static void _udpSocketSignalHandler(UDP_SOCKET hUDP, TCPIP_NET_HANDLE hNet, TCPIP_UDP_SIGNAL_TYPE sigType, const void* param)
-{
-    ATCMD_SOCK_STATE *const pSockState = _findUDPSocketByTransHandle(hUDP);
+    /* Find the socket structure associated with this socket ID */
 
-//    ATCMD_Printf("USH(%d): (0x%08x) 0x%04x\r\n", hUDP, param, sigType);
+    pSockState = _findSocketByHandle(pParamList[0].value.i);
 
     if (NULL == pSockState)
     {
-        return;
+        return ATCMD_APP_STATUS_SOCKET_ID_NOT_FOUND;
     }
 
-    if ((0 != (sigType & TCPIP_UDP_SIGNAL_RX_DATA)) && (0 == pSockState->pendingDataLength))
+    if ((pParamList[1].value.i < 0) || (pParamList[1].value.i > AT_CMD_SOCK_RD_CHUNK_SZ))
     {
-        UDP_SOCKET_INFO udpSockInfo;
-
-        pSockState->pendingDataLength = TCPIP_UDP_GetIsReady(pSockState->transHandle);
-
-        TCPIP_UDP_SocketInfoGet(pSockState->transHandle, &udpSockInfo);
+        return ATCMD_STATUS_INVALID_PARAMETER;
+    }
 
-        ATCMD_Printf("+SOCKRXU:%d,", pSockState->handle);
-        ATCMD_PrintIPv4Address(udpSockInfo.sourceIPaddress.v4Add.Val);
-        ATCMD_Printf(",%d,%d\r\n", udpSockInfo.remotePort, pSockState->pendingDataLength);
+    if ((3 == numParams) && ((pParamList[2].value.i < 0) || (pParamList[2].value.i > UINT16_MAX)))
+    {
+        return ATCMD_STATUS_INVALID_PARAMETER;
     }
-}
 
-/*******************************************************************************
-* Command init functions
-*******************************************************************************/
-static ATCMD_STATUS _SOCKInit(const AT_CMD_TYPE_DESC* pCmdTypeDesc)
-{
-    memset(socketState, 0, sizeof(socketState));
-    memset(&sockRdState, 0, sizeof(sockRdState));
+    pSockState->pushChunkSize = pParamList[1].value.i;
 
-    pSOCKWRBinarySock = NULL;
-    nextSocketHandle  = 0;
+    if (0 == pSockState->pushChunkSize)
+    {
+        /* Back to pull mode, announce anything left for +SOCKRD on the next arrival */
 
-    wolfSSL_Init();
+        pSockState->pushCredits       = 0;
+        pSockState->pendingDataLength = 0;
+    }
+    else if (3 == numParams)
+    {
+        pSockState->pushCredits = pParamList[2].value.i;
+    }
 
     return ATCMD_STATUS_OK;
 }
 
-/*******************************************************************************
-* Command execute functions
-*******************************************************************************/
-static ATCMD_STATUS _SOCKOExecute(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const int numParams, ATCMD_PARAM *pParamList)
+static ATCMD_STATUS _SOCKCRExecute(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const int numParams, ATCMD_PARAM *pParamList)
 {
     ATCMD_SOCK_STATE *pSockState = NULL;
+    uint32_t numCredits;
 
-    /* Validate the parameters against the defined descriptors to ensure types match */
-
-    if (1 == numParams)
+    if (2 == numParams)
     {
         if (false == ATCMD_ParamValidateTypes(pCmdTypeDesc, 0, numParams, pParamList))
         {
@@ -914,48 +2737,44 @@ static ATCMD_STATUS _SOCKOExecute(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const in
         return ATCMD_STATUS_INCORRECT_NUM_PARAMS;
     }
 
-    /* Find empty socket structure to use for new socket */
+    /* Find the socket structure associated with this socket ID */
 
-    pSockState = _findSocketByHandle(-1);
+    pSockState = _findSocketByHandle(pParamList[0].value.i);
 
     if (NULL == pSockState)
     {
-        return ATCMD_APP_STATUS_NO_FREE_SOCKETS;
+        return ATCMD_APP_STATUS_SOCKET_ID_NOT_FOUND;
     }
 
-    if (ATCMD_SOCK_PROTO_UDP == pParamList[0].value.i)
+    if (0 == pSockState->pushChunkSize)
     {
-        /* UDP */
+        return ATCMD_APP_STATUS_SOCKET_NOT_PUSH_MODE;
     }
-    else if (ATCMD_SOCK_PROTO_TCP == pParamList[0].value.i)
+
+    if ((pParamList[1].value.i < 0) || (pParamList[1].value.i > UINT16_MAX))
     {
-        /* TCP */
+        return ATCMD_STATUS_INVALID_PARAMETER;
     }
-    else
+
+    /* Credits accumulate, saturating rather than wrapping */
+
+    numCredits = pSockState->pushCredits + pParamList[1].value.i;
+
+    if (numCredits > UINT16_MAX)
     {
-        return ATCMD_APP_STATUS_INVALID_SOCKET_PROTOCOL;
+        numCredits = UINT16_MAX;
     }
 
-    pSockState->isConnected     = false;
-    pSockState->handle          = _getSocketHandle();
-    pSockState->protocol        = pParamList[0].value.i;
-    pSockState->pParent         = NULL;
-    pSockState->inUse           = true;
-    pSockState->needsEncryption = false;
-    pSockState->transHandle     = -1;
-
-    ATCMD_Printf("+SOCKO:%d\r\n", pSockState->handle);
+    pSockState->pushCredits = numCredits;
 
     return ATCMD_STATUS_OK;
 }
 
-static ATCMD_STATUS _SOCKBLExecute(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const int numParams, ATCMD_PARAM *pParamList)
+static ATCMD_STATUS _SOCKCLExecute(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const int numParams, ATCMD_PARAM *pParamList)
 {
     ATCMD_SOCK_STATE *pSockState = NULL;
 
-    /* Validate the parameters against the defined descriptors to ensure types match */
-
-    if (2 == numParams)
+    if (1 == numParams)
     {
         if (false == ATCMD_ParamValidateTypes(pCmdTypeDesc, 0, numParams, pParamList))
         {
@@ -976,79 +2795,99 @@ static ATCMD_STATUS _SOCKBLExecute(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const i
         return ATCMD_APP_STATUS_SOCKET_ID_NOT_FOUND;
     }
 
-    if (ATCMD_SOCK_PROTO_UDP == pSockState->protocol)
+    if(pSockState->transHandle == -1)
     {
-        /* UDP socket */
+        int i = 0; 
+        ATCMD_SOCK_STATE *pTmpSockState = NULL;
+        
+        for(i = 0; i < AT_CMD_SOCK_MAX_CLIENTS; i++)
+        {
+            pTmpSockState = _findSocketByTransHandle(pSockState->childTransHandle[i]);
 
-        pSockState->localPort  = pParamList[1].value.i;
+            if ((NULL == pTmpSockState) || (pSockState != pTmpSockState->pParent))
+            {
+                continue;
+            }
+
+            if (ATCMD_SOCK_PROTO_UDP == pTmpSockState->protocol)
+            {
+                continue;
+            }
 
-        pSockState->transHandle = TCPIP_UDP_ServerOpen(IP_ADDRESS_TYPE_IPV4, pSockState->localPort, NULL);
+            if (NULL != pTmpSockState->pWolfSSLSession)
+            {
+                ATCMD_TLS_FreeSession(pTmpSockState->tlsConfIdx, pTmpSockState->pWolfSSLSession);
+            }
 
-        if (-1 == pSockState->transHandle)
-        {
-            _closeSocket(pSockState);
+            pTmpSockState->encryptState = ATCMD_SOCK_ENCRYPT_STATE_NONE;
+            TCPIP_TCP_Close(pTmpSockState->transHandle);
 
-            return ATCMD_APP_STATUS_SOCKET_BIND_FAILED;
+            _sockSetTransHandle(pTmpSockState, -1);
+            pTmpSockState->inUse          = false;
+            pTmpSockState->remoteIPv4Addr.Val = 0;
+            pTmpSockState->remotePort         = 0;
+            pTmpSockState->pendingDataLength  = 0;
         }
-
-        pSockState->sigHandler = TCPIP_UDP_SignalHandlerRegister(pSockState->transHandle, 0xffff /*TCPIP_UDP_SIGNAL_RX_DATA*/, _udpSocketSignalHandler, pSockState);
     }
-    else if (ATCMD_SOCK_PROTO_TCP == pSockState->protocol)
-    {
-        int i;
+    
+    _closeSocket(pSockState);
 
-        /* TCP socket */
+    return ATCMD_STATUS_OK;
+}
 
-        pSockState->localPort  = pParamList[1].value.i;
+static ATCMD_STATUS _SOCKLSTExecute(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const int numParams, ATCMD_PARAM *pParamList)
+{
+    int i;
 
-        for (i=0; i<AT_CMD_SOCK_MAX_CLIENTS; i++)
+    if (1 == numParams)
+    {
+        if (false == ATCMD_ParamValidateTypes(pCmdTypeDesc, 1, numParams, pParamList))
         {
-            ATCMD_SOCK_STATE *pSrvSockState;
-
-            pSrvSockState = _findSocketByHandle(-1);
+            return ATCMD_STATUS_INVALID_PARAMETER;
+        }
+    }
+    else if (numParams > 1)
+    {
+        return ATCMD_STATUS_INCORRECT_NUM_PARAMS;
+    }
 
-            if (NULL != pSrvSockState)
+    for (i=0; i<AT_CMD_SOCK_MAX_NUM; i++)
+    {
+        if ((true == socketState[i].inUse) && (0 != socketState[i].handle))
+        {
+            if ((0 == numParams) || (socketState[i].handle == pParamList[0].value.i))
             {
-                pSrvSockState->transHandle = TCPIP_TCP_ServerOpen(IP_ADDRESS_TYPE_IPV4, pSockState->localPort, NULL);
+                if (0 != socketState[i].remoteIPv4Addr.Val)
+                {
+                    ATCMD_Printf("+SOCKLST:%d,%d,", socketState[i].handle, socketState[i].protocol);
 
-                if (-1 == pSrvSockState->transHandle)
+                    ATCMD_PrintIPv4Address(socketState[i].remoteIPv4Addr.Val);
+                }
+                else
                 {
-                    _closeSocket(pSrvSockState);
+                    if(socketState[i].pParent)
+                        continue;
+                    
+                    ATCMD_Printf("+SOCKLST:%d,%d,", socketState[i].handle, socketState[i].protocol);
 
-                    return ATCMD_APP_STATUS_SOCKET_BIND_FAILED;
+                    ATCMD_Print("\"\"", 2);
                 }
-                
-                pSockState->childTransHandle[i] = pSrvSockState->transHandle;
-                
-                pSrvSockState->sigHandler       = TCPIP_TCP_SignalHandlerRegister(pSrvSockState->transHandle, 0xffff /*TCPIP_TCP_SIGNAL_ESTABLISHED | TCPIP_TCP_SIGNAL_RX_RST | TCPIP_TCP_SIGNAL_RX_DATA*/, _tcpSocketSignalHandler, pSrvSockState);
-
-                pSrvSockState->localPort        = pSockState->localPort;
-                pSrvSockState->protocol         = ATCMD_SOCK_PROTO_TCP;
-                pSrvSockState->inUse            = true;
-                pSrvSockState->pParent          = pSockState;
-                pSrvSockState->needsEncryption  = pSockState->needsEncryption;
-            }
-            else
-            {
-                // TODO
+
+                ATCMD_Printf(",%d,%d\r\n", socketState[i].remotePort, socketState[i].localPort);
             }
         }
     }
-    else
-    {
-        return ATCMD_APP_STATUS_INVALID_SOCKET_PROTOCOL;
-    }
 
     return ATCMD_STATUS_OK;
 }
 
-static ATCMD_STATUS _SOCKBRExecute(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const int numParams, ATCMD_PARAM *pParamList)
+static ATCMD_STATUS _SOCKSTATExecute(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const int numParams, ATCMD_PARAM *pParamList)
 {
     ATCMD_SOCK_STATE *pSockState = NULL;
+    int numActive = 0;
+    int i;
 
-    /* Validate the parameters against the defined descriptors to ensure types match */
-
-    if (3 == numParams)
+    if (1 == numParams)
     {
         if (false == ATCMD_ParamValidateTypes(pCmdTypeDesc, 0, numParams, pParamList))
         {
@@ -1069,63 +2908,68 @@ static ATCMD_STATUS _SOCKBRExecute(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const i
         return ATCMD_APP_STATUS_SOCKET_ID_NOT_FOUND;
     }
 
-    TCPIP_Helper_StringToIPAddress((char*)pParamList[1].value.p, &pSockState->remoteIPv4Addr);
-
-    pSockState->localPort  = 0;
-    pSockState->remotePort = pParamList[2].value.i;
-
     if (ATCMD_SOCK_PROTO_UDP == pSockState->protocol)
     {
-        /* UDP socket, bind to remote address/port, this shouldn't be necessary if using sendto */
+        UDP_SOCKET_INFO udpSockInfo;
 
-        pSockState->transHandle = TCPIP_UDP_ClientOpen(IP_ADDRESS_TYPE_IPV4, pSockState->remotePort, (IP_MULTI_ADDRESS*)&pSockState->remoteIPv4Addr);
+        memset(&udpSockInfo, 0, sizeof(udpSockInfo));
 
-        if (-1 == pSockState->transHandle)
+        if (-1 != pSockState->transHandle)
         {
-            _closeSocket(pSockState);
-
-            return ATCMD_APP_STATUS_SOCKET_BIND_FAILED;
+            TCPIP_UDP_SocketInfoGet(pSockState->transHandle, &udpSockInfo);
         }
 
-        pSockState->sigHandler = TCPIP_UDP_SignalHandlerRegister(pSockState->transHandle, 0xffff /*TCPIP_UDP_SIGNAL_RX_DATA*/, _udpSocketSignalHandler, pSockState);
+        ATCMD_Printf("+SOCKSTAT:%d,%u,%u,%u,%u,%u,%u\r\n", pSockState->handle, pSockState->udpNumWrites, pSockState->udpNumDatagrams, pSockState->udpNumTxBytes,
+                        udpSockInfo.txHeapAllocs, udpSockInfo.txPoolAllocs, udpSockInfo.txSpareReuses);
+
+        return ATCMD_STATUS_OK;
     }
-    else if (ATCMD_SOCK_PROTO_TCP == pSockState->protocol)
-    {
-        /* TCP socket, connect to remote address/port */
 
-        if (true == pSockState->needsEncryption)
-        {
-            pSockState->encryptState = ATCMD_SOCK_ENCRYPT_STATE_STARTING;
-        }
+    if (0 == pSockState->backlog)
+    {
+        TCP_SOCKET_INFO tcpSockInfo;
 
-        pSockState->transHandle = TCPIP_TCP_ClientOpen(IP_ADDRESS_TYPE_IPV4, pSockState->remotePort, (IP_MULTI_ADDRESS*)&pSockState->remoteIPv4Addr);
+        /* A bound, non listening, TCP socket reports the state of its connection */
 
         if (-1 == pSockState->transHandle)
         {
-            _closeSocket(pSockState);
-
-            return ATCMD_APP_STATUS_SOCKET_BIND_FAILED;
+            return ATCMD_APP_STATUS_SOCKET_NOT_LISTENING;
         }
 
-        pSockState->sigHandler = TCPIP_TCP_SignalHandlerRegister(pSockState->transHandle, 0xffff /*TCPIP_TCP_SIGNAL_ESTABLISHED | TCPIP_TCP_SIGNAL_RX_RST*/, _tcpSocketSignalHandler, pSockState);
+        memset(&tcpSockInfo, 0, sizeof(tcpSockInfo));
 
-        pSockState->needsEncryption = false;
+        TCPIP_TCP_SocketInfoGet(pSockState->transHandle, &tcpSockInfo);
+
+        ATCMD_Printf("+SOCKSTAT:%d,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u\r\n", pSockState->handle, tcpSockInfo.cwnd, tcpSockInfo.ssthresh, tcpSockInfo.srtt, tcpSockInfo.rttVar,
+                        tcpSockInfo.txRetransmits, tcpSockInfo.txTimeouts, tcpSockInfo.rxOooBytes, tcpSockInfo.rxOooDiscardBytes,
+                        pSockState->tlsTimeMs, pSockState->tlsBusyTimeMs, pSockState->tlsNumSteps);
+
+        return ATCMD_STATUS_OK;
     }
-    else
+
+    for (i=0; i<AT_CMD_SOCK_MAX_CLIENTS; i++)
     {
-        return ATCMD_APP_STATUS_INVALID_SOCKET_PROTOCOL;
+        ATCMD_SOCK_STATE *pChildSockState;
+
+        pChildSockState = _findSocketByTransHandle(pSockState->childTransHandle[i]);
+
+        if ((NULL != pChildSockState) && (pSockState == pChildSockState->pParent) && (0 != pChildSockState->remoteIPv4Addr.Val))
+        {
+            numActive++;
+        }
     }
 
-    pSockState->lastTimeMs = ATCMD_PlatformGetSysTimeMs();
+    ATCMD_Printf("+SOCKSTAT:%d,%d,%d,%u,%u\r\n", pSockState->handle, pSockState->backlog, numActive, pSockState->numAccepted, pSockState->numRejected);
 
     return ATCMD_STATUS_OK;
 }
 
-static ATCMD_STATUS _SOCKBMExecute(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const int numParams, ATCMD_PARAM *pParamList)
+static ATCMD_STATUS _SOCKTXMExecute(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const int numParams, ATCMD_PARAM *pParamList)
 {
     ATCMD_SOCK_STATE *pSockState = NULL;
+    uint16_t txBufSize;
 
-    if (3 == numParams)
+    if (2 == numParams)
     {
         if (false == ATCMD_ParamValidateTypes(pCmdTypeDesc, 0, numParams, pParamList))
         {
@@ -1146,59 +2990,50 @@ static ATCMD_STATUS _SOCKBMExecute(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const i
         return ATCMD_APP_STATUS_SOCKET_ID_NOT_FOUND;
     }
 
-    TCPIP_Helper_StringToIPAddress((char*)pParamList[1].value.p, &pSockState->remoteIPv4Addr);
-
-    pSockState->localPort  = pParamList[2].value.i;
-    pSockState->remotePort = pParamList[2].value.i;
-
-    if (ATCMD_SOCK_PROTO_UDP == pSockState->protocol)
+    if (ATCMD_SOCK_PROTO_UDP != pSockState->protocol)
     {
-        UDP_OPTION_MULTICAST_DATA sockOpt;
-
-        pSockState->transHandle = TCPIP_UDP_ClientOpen(IP_ADDRESS_TYPE_IPV4, pSockState->remotePort, (IP_MULTI_ADDRESS*)&pSockState->remoteIPv4Addr);
-
-        if (-1 == pSockState->transHandle)
-        {
-            _closeSocket(pSockState);
+        return ATCMD_APP_STATUS_INVALID_SOCKET_PROTOCOL;
+    }
 
-            return ATCMD_APP_STATUS_SOCKET_BIND_FAILED;
-        }
+    /* The mode sizes the transmit buffer, so the socket must be bound first */
 
-        pSockState->sigHandler = TCPIP_UDP_SignalHandlerRegister(pSockState->transHandle, 0xffff /*TCPIP_UDP_SIGNAL_RX_DATA*/, _udpSocketSignalHandler, pSockState);
+    if (-1 == pSockState->transHandle)
+    {
+        return ATCMD_APP_STATUS_SOCKET_SET_OPT_FAILED;
+    }
 
-        sockOpt.flagsMask = 0xFF;
-        sockOpt.flagsValue = UDP_MCAST_FLAG_DEFAULT; 
+    if (1 == pParamList[1].value.i)
+    {
+        pSockState->udpHold = false;
+        txBufSize = TCPIP_UDP_SOCKET_DEFAULT_TX_SIZE;
+    }
+    else if (2 == pParamList[1].value.i)
+    {
+        pSockState->udpHold = true;
+        txBufSize = AT_CMD_SOCK_UDP_DGRAM_MAX_SZ;
+    }
+    else
+    {
+        return ATCMD_STATUS_INVALID_PARAMETER;
+    }
 
-        if (false == TCPIP_UDP_Bind(pSockState->transHandle, IP_ADDRESS_TYPE_IPV4, pSockState->localPort, NULL))
-        {
-            return ATCMD_APP_STATUS_SOCKET_BIND_FAILED;
-        }
+    /* Resizing discards anything written, so send what was assembled first */
 
-        if (false == TCPIP_UDP_OptionsSet((UDP_SOCKET)pSockState->transHandle, UDP_OPTION_MULTICAST, &sockOpt))
-        {
-            return ATCMD_APP_STATUS_MULTICAST_ERROR;
-        }
+    _sockUDPFlush(pSockState);
 
-        if (TCPIP_IGMP_OK != TCPIP_IGMP_Subscribe((UDP_SOCKET)pSockState->transHandle, atCmdAppContext.netHandle, pSockState->remoteIPv4Addr, TCPIP_IGMP_FILTER_EXCLUDE, NULL, NULL))
-        {
-            return ATCMD_APP_STATUS_MULTICAST_ERROR;
-        }
-    }
-    else
+    if (false == TCPIP_UDP_OptionsSet(pSockState->transHandle, UDP_OPTION_TX_BUFF, (void*)(uintptr_t)txBufSize))
     {
-        return ATCMD_APP_STATUS_INVALID_SOCKET_PROTOCOL;
+        return ATCMD_APP_STATUS_SOCKET_SET_OPT_FAILED;
     }
 
     return ATCMD_STATUS_OK;
 }
 
-static ATCMD_STATUS _SOCKTLSExecute(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const int numParams, ATCMD_PARAM *pParamList)
+static ATCMD_STATUS _SOCKFLExecute(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const int numParams, ATCMD_PARAM *pParamList)
 {
     ATCMD_SOCK_STATE *pSockState = NULL;
 
-    /* Validate the parameters against the defined descriptors to ensure types match */
-
-    if (2 == numParams)
+    if (1 == numParams)
     {
         if (false == ATCMD_ParamValidateTypes(pCmdTypeDesc, 0, numParams, pParamList))
         {
@@ -1210,11 +3045,6 @@ static ATCMD_STATUS _SOCKTLSExecute(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const
         return ATCMD_STATUS_INCORRECT_NUM_PARAMS;
     }
 
-    if ((pParamList[1].value.i < 1) || (pParamList[1].value.i > AT_CMD_TLS_NUM_CONFS))
-    {
-        return ATCMD_STATUS_INVALID_PARAMETER;
-    }
-
     /* Find the socket structure associated with this socket ID */
 
     pSockState = _findSocketByHandle(pParamList[0].value.i);
@@ -1224,59 +3054,35 @@ static ATCMD_STATUS _SOCKTLSExecute(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const
         return ATCMD_APP_STATUS_SOCKET_ID_NOT_FOUND;
     }
 
-    if (ATCMD_SOCK_PROTO_TCP != pSockState->protocol)
+    if (ATCMD_SOCK_PROTO_UDP != pSockState->protocol)
     {
         return ATCMD_APP_STATUS_INVALID_SOCKET_PROTOCOL;
     }
 
-    pSockState->tlsConfIdx = pParamList[1].value.i;
-
-    if (ATCMD_SOCK_ENCRYPT_STATE_NONE == pSockState->encryptState)
+    if (-1 == pSockState->transHandle)
     {
-        if (true == pSockState->isConnected)
-        {
-            pSockState->encryptState = ATCMD_SOCK_ENCRYPT_STATE_STARTING;
-
-            pSockState->isConnected = false;
-        }
-        else
-        {
-            pSockState->needsEncryption = true;
-        }
+        return ATCMD_APP_STATUS_SOCKET_SEND_FAILED;
     }
-    else if (ATCMD_SOCK_ENCRYPT_STATE_DONE == pSockState->encryptState)
+
+    if (false == _sockUDPFlush(pSockState))
     {
-        ATCMD_Printf("+SOCKTLS:%d\r\n", pSockState->handle);
+        return ATCMD_APP_STATUS_SOCKET_SEND_FAILED;
     }
 
     return ATCMD_STATUS_OK;
 }
 
-static ATCMD_STATUS _SOCKWRExecute(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const int numParams, ATCMD_PARAM *pParamList)
+static ATCMD_STATUS _SOCKWRBExecute(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const int numParams, ATCMD_PARAM *pParamList)
 {
     ATCMD_SOCK_STATE *pSockState = NULL;
 
-    /* Validate the parameters against the defined descriptors to ensure types match */
-
-    if (3 == numParams)
+    if (2 == numParams)
     {
         if (false == ATCMD_ParamValidateTypes(pCmdTypeDesc, 0, numParams, pParamList))
         {
             return ATCMD_STATUS_INVALID_PARAMETER;
         }
     }
-    else if (2 == numParams)
-    {
-        if (false == ATCMD_ParamValidateTypes(pCmdTypeDesc, 1, numParams, pParamList))
-        {
-            return ATCMD_STATUS_INVALID_PARAMETER;
-        }
-
-        if (0 != pParamList[1].value.i)
-        {
-            g_binModeNumBytes = pParamList[1].value.i;
-        }
-    }
     else
     {
         return ATCMD_STATUS_INCORRECT_NUM_PARAMS;
@@ -1291,110 +3097,44 @@ static ATCMD_STATUS _SOCKWRExecute(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const i
         return ATCMD_APP_STATUS_SOCKET_ID_NOT_FOUND;
     }
 
-    if ((0 == pSockState->remoteIPv4Addr.Val) || (0 == pSockState->remotePort))
+    if (ATCMD_SOCK_PROTO_UDP != pSockState->protocol)
     {
-        return ATCMD_APP_STATUS_SOCKET_ID_NOT_FOUND;        
+        return ATCMD_APP_STATUS_INVALID_SOCKET_PROTOCOL;
     }
-    
-    if (2 == numParams)
-    {
-        /* Binary mode */
 
-        ATCMD_Print("\r\n", 2);
-        ATCMD_EnterBinaryMode(&_socketWriteBinaryDataHandler);
-        pSOCKWRBinarySock = pSockState;
-    }
-    else if (pParamList[1].value.i == pParamList[2].length)
+    if ((pParamList[1].value.i <= ATCMD_SOCK_WRB_HDR_SZ) || (pParamList[1].value.i > AT_CMD_CONF_BIN_MAX_BUFFER_SIZE))
     {
-        /* ASCII or hex string mode */
-
-        if (ATCMD_SOCK_PROTO_UDP == pSockState->protocol)
-        {
-            /* UDP socket, ensure remote address/port is set before trying to sendto */
-
-            if ((0 == pSockState->remoteIPv4Addr.Val) || (0 == pSockState->remotePort))
-            {
-                return ATCMD_APP_STATUS_SOCKET_REMOTE_NOT_SET;
-            }
-
-            if (TCPIP_UDP_PutIsReady(pSockState->transHandle) < pParamList[2].length)
-            {
-                return ATCMD_APP_STATUS_SOCKET_SEND_FAILED;
-            }
-
-            if (0 == TCPIP_UDP_ArrayPut(pSockState->transHandle, pParamList[2].value.p, pParamList[2].length))
-            {
-                return ATCMD_APP_STATUS_SOCKET_SEND_FAILED;
-            }
-
-            TCPIP_UDP_Flush(pSockState->transHandle);
-        }
-        else if (ATCMD_SOCK_PROTO_TCP == pSockState->protocol)
-        {
-            /* TCP socket */
+        return ATCMD_STATUS_INVALID_PARAMETER;
+    }
 
-            if (false == _sockTCPWriteReady(pSockState, pParamList[2].length))
-            {
-                return ATCMD_APP_STATUS_SOCKET_SEND_FAILED;
-            }
+    /* A partly assembled datagram would be merged with the first of the batch */
 
-            if (ATCMD_SOCK_ENCRYPT_STATE_NONE == pSockState->encryptState)
-            {
-                if (0 == TCPIP_TCP_ArrayPut(pSockState->transHandle, pParamList[2].value.p, pParamList[2].length))
-                {
-                    return ATCMD_APP_STATUS_SOCKET_SEND_FAILED;
-                }
-            }
-            else if (ATCMD_SOCK_ENCRYPT_STATE_DONE == pSockState->encryptState)
-            {
-                if (wolfSSL_write(pSockState->pWolfSSLSession, pParamList[2].value.p, pParamList[2].length) < 0)
-                {
-                    return ATCMD_APP_STATUS_SOCKET_SEND_FAILED;
-                }
-            }
-            else
-            {
-                return ATCMD_APP_STATUS_SOCKET_SEND_FAILED;
-            }
-        }
-        else
-        {
-            return ATCMD_APP_STATUS_INVALID_SOCKET_PROTOCOL;
-        }
-    }
-    else
+    if ((-1 == pSockState->transHandle) || (0 != TCPIP_UDP_TxCountGet(pSockState->transHandle)))
     {
-        return ATCMD_APP_STATUS_LENGTH_MISMATCH;
+        return ATCMD_APP_STATUS_SOCKET_SEND_FAILED;
     }
 
+    g_binModeNumBytes = pParamList[1].value.i;
+
+    ATCMD_Print("\r\n", 2);
+    ATCMD_EnterBinaryMode(&_socketWriteBatchDataHandler);
+    pSOCKWRBinarySock = pSockState;
+
     return ATCMD_STATUS_OK;
 }
 
-static ATCMD_STATUS _SOCKWRTOExecute(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const int numParams, ATCMD_PARAM *pParamList)
+static ATCMD_STATUS _SOCKTXRExecute(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const int numParams, ATCMD_PARAM *pParamList)
 {
     ATCMD_SOCK_STATE *pSockState = NULL;
+    uint16_t txWindow = 0;
 
-    /* Validate the parameters against the defined descriptors to ensure types match */
-
-    if (5 == numParams)
+    if (1 == numParams)
     {
         if (false == ATCMD_ParamValidateTypes(pCmdTypeDesc, 0, numParams, pParamList))
         {
             return ATCMD_STATUS_INVALID_PARAMETER;
         }
     }
-    else if (4 == numParams)
-    {
-        if (false == ATCMD_ParamValidateTypes(pCmdTypeDesc, 1, numParams, pParamList))
-        {
-            return ATCMD_STATUS_INVALID_PARAMETER;
-        }
-
-        if (0 != pParamList[3].value.i)
-        {
-            g_binModeNumBytes = pParamList[3].value.i;
-        }
-    }
     else
     {
         return ATCMD_STATUS_INCORRECT_NUM_PARAMS;
@@ -1409,151 +3149,203 @@ static ATCMD_STATUS _SOCKWRTOExecute(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const
         return ATCMD_APP_STATUS_SOCKET_ID_NOT_FOUND;
     }
 
-    if (4 == numParams)
+    if (-1 != pSockState->transHandle)
     {
-        /* Binary mode */
+        txWindow = _sockTxWindow(pSockState);
+    }
 
-        ATCMD_Print("\r\n", 2);
-        ATCMD_EnterBinaryMode(&_socketWriteBinaryDataHandler);
-        pSOCKWRBinarySock = pSockState;
-        if ((0 == pSockState->remoteIPv4Addr.Val) || (0 == pSockState->remotePort))
+    ATCMD_Printf("+SOCKTXR:%d,%d\r\n", pSockState->handle, txWindow);
+
+    return ATCMD_STATUS_OK;
+}
+
+static bool _sockOptPrint(ATCMD_SOCK_STATE *pSockState, int optId)
+{
+    switch (optId)
+    {
+        case ATCMD_SOCK_OPT_TCP_RX_BUFF:
         {
-            IPV4_ADDR remoteAddr;
-            TCPIP_Helper_StringToIPAddress((char*)pParamList[1].value.p, &remoteAddr);
-            TCPIP_UDP_DestinationIPAddressSet(pSockState->transHandle, IP_ADDRESS_TYPE_IPV4, (IP_MULTI_ADDRESS*)&remoteAddr);
-            TCPIP_UDP_DestinationPortSet(pSockState->transHandle, pParamList[2].value.i);
-            pSockState->remoteIPv4Addr.Val = remoteAddr.Val;
-            pSockState->remotePort         = pParamList[2].value.i;
+            ATCMD_Printf("+SOCKC:%d,%d,%d\r\n", pSockState->handle, optId, (0 != pSockState->tcpRxBufSize) ? pSockState->tcpRxBufSize : TCPIP_TCP_SOCKET_DEFAULT_RX_SIZE);
+            break;
         }
-    }
-    else if (pParamList[3].value.i == pParamList[4].length)
-    {
-        /* ASCII or hex string mode */
 
-        if (ATCMD_SOCK_PROTO_UDP == pSockState->protocol)
+        case ATCMD_SOCK_OPT_TCP_TX_BUFF:
         {
-            /* UDP socket, use supplied remote address/port instead of stored one */
+            ATCMD_Printf("+SOCKC:%d,%d,%d\r\n", pSockState->handle, optId, (0 != pSockState->tcpTxBufSize) ? pSockState->tcpTxBufSize : TCPIP_TCP_SOCKET_DEFAULT_TX_SIZE);
+            break;
+        }
 
-            UDP_SOCKET_INFO udpSockInfo;
-            IPV4_ADDR remoteAddr;
+        case ATCMD_SOCK_OPT_TCP_CC:
+        {
+            ATCMD_Printf("+SOCKC:%d,%d,%d\r\n", pSockState->handle, optId, (0 != pSockState->tcpCcAlg) ? pSockState->tcpCcAlg : _sockTCPCcOptValue(TCPIP_TCP_CONGESTION_CONTROL));
+            break;
+        }
 
-            TCPIP_UDP_SocketInfoGet(pSockState->transHandle, &udpSockInfo);
+        default:
+        {
+            return false;
+        }
+    }
 
-            TCPIP_Helper_StringToIPAddress((char*)pParamList[1].value.p, &remoteAddr);
-            TCPIP_UDP_DestinationIPAddressSet(pSockState->transHandle, IP_ADDRESS_TYPE_IPV4, (IP_MULTI_ADDRESS*)&remoteAddr);
-            TCPIP_UDP_DestinationPortSet(pSockState->transHandle, pParamList[2].value.i);
+    return true;
+}
 
-            if (TCPIP_UDP_PutIsReady(pSockState->transHandle) < pParamList[4].length)
-            {
-                SYS_CONSOLE_PRINT("\nLength Expected = %d; Available = %d\n", pParamList[4].length, TCPIP_UDP_PutIsReady(pSockState->transHandle));
-                return ATCMD_APP_STATUS_SOCKET_SEND_FAILED;
-            }
+static ATCMD_STATUS _sockTCPBufSet(ATCMD_SOCK_STATE *pSockState, int optId, int bufSize)
+{
+    uint16_t oldRxBufSize = pSockState->tcpRxBufSize;
+    uint16_t oldTxBufSize = pSockState->tcpTxBufSize;
+    size_t oldMemSize = _sockTCPMemSize(pSockState);
+    TCP_SOCKET_OPTION sockOpt;
+    uint16_t numPending;
 
-            if (0 == TCPIP_UDP_ArrayPut(pSockState->transHandle, pParamList[4].value.p, pParamList[4].length))
-            {
-                SYS_CONSOLE_PRINT("\nTCPIP_UDP_ArrayPut() : Failed\n");
-                return ATCMD_APP_STATUS_SOCKET_SEND_FAILED;
-            }
+    if ((bufSize < AT_CMD_SOCK_TCP_BUF_MIN_SZ) || (bufSize > AT_CMD_SOCK_TCP_BUF_MAX_SZ))
+    {
+        return ATCMD_STATUS_INVALID_PARAMETER;
+    }
+
+    if (-1 == pSockState->transHandle)
+    {
+        /* A listening socket's connections already hold their buffers */
 
-            TCPIP_UDP_Flush(pSockState->transHandle);
+        if (0 != pSockState->backlog)
+        {
+            return ATCMD_APP_STATUS_SOCKET_SET_OPT_FAILED;
+        }
 
-            if ((0 == pSockState->remoteIPv4Addr.Val) || (0 == pSockState->remotePort))
-            {
-                pSockState->remoteIPv4Addr.Val = remoteAddr.Val;
-                pSockState->remotePort         = pParamList[2].value.i;
-            }
+        /* Not yet open, applied and charged to the budget on bind */
+
+        if (ATCMD_SOCK_OPT_TCP_RX_BUFF == optId)
+        {
+            pSockState->tcpRxBufSize = bufSize;
         }
         else
         {
-            return ATCMD_APP_STATUS_INVALID_SOCKET_PROTOCOL;
+            pSockState->tcpTxBufSize = bufSize;
         }
+
+        return ATCMD_STATUS_OK;
     }
-    else
+
+    if (ATCMD_SOCK_OPT_TCP_RX_BUFF == optId)
     {
-        return ATCMD_APP_STATUS_LENGTH_MISMATCH;
+        sockOpt    = TCP_OPTION_RX_BUFF;
+        numPending = TCPIP_TCP_GetIsReady(pSockState->transHandle);
+
+        pSockState->tcpRxBufSize = bufSize;
     }
+    else
+    {
+        sockOpt    = TCP_OPTION_TX_BUFF;
+        numPending = TCPIP_TCP_FifoTxFullGet(pSockState->transHandle);
 
-    return ATCMD_STATUS_OK;
-}
+        pSockState->tcpTxBufSize = bufSize;
+    }
 
-static ATCMD_STATUS _SOCKRDExecute(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const int numParams, ATCMD_PARAM *pParamList)
-{
-    ATCMD_SOCK_STATE *pSockState = NULL;
+    /* Shrinking below the data held would lose it */
 
-    if (3 == numParams)
+    if (bufSize < numPending)
     {
-        if (false == ATCMD_ParamValidateTypes(pCmdTypeDesc, 0, numParams, pParamList))
-        {
-            return ATCMD_STATUS_INVALID_PARAMETER;
-        }
+        pSockState->tcpRxBufSize = oldRxBufSize;
+        pSockState->tcpTxBufSize = oldTxBufSize;
+
+        return ATCMD_APP_STATUS_SOCKET_SET_OPT_FAILED;
     }
-    else
+
+    if ((_sockTCPMemSize(pSockState) > oldMemSize) && (_sockMemInUse() > AT_CMD_SOCK_MEM_BUDGET))
     {
-        return ATCMD_STATUS_INCORRECT_NUM_PARAMS;
-    }
+        pSockState->tcpRxBufSize = oldRxBufSize;
+        pSockState->tcpTxBufSize = oldTxBufSize;
 
-    /* Find the socket structure associated with this socket ID */
+        return ATCMD_APP_STATUS_SOCKET_MEM_BUDGET_EXCEEDED;
+    }
 
-    pSockState = _findSocketByHandle(pParamList[0].value.i);
+    /* On failure the stack leaves the socket's buffers unchanged */
 
-    if (NULL == pSockState)
+    if (false == TCPIP_TCP_OptionsSet(pSockState->transHandle, sockOpt, (void*)(uintptr_t)bufSize))
     {
-        return ATCMD_APP_STATUS_SOCKET_ID_NOT_FOUND;
+        pSockState->tcpRxBufSize = oldRxBufSize;
+        pSockState->tcpTxBufSize = oldTxBufSize;
+
+        return ATCMD_APP_STATUS_SOCKET_SET_OPT_FAILED;
     }
 
-    if (pParamList[2].value.i > AT_CMD_SOCK_RX_BUFFER_SZ)
+    return ATCMD_STATUS_OK;
+}
+
+static ATCMD_STATUS _sockTCPCcSet(ATCMD_SOCK_STATE *pSockState, int ccAlg)
+{
+    int i;
+    int j;
+
+    if ((ccAlg != ATCMD_SOCK_TCP_CC_NEWRENO) && (ccAlg != ATCMD_SOCK_TCP_CC_CUBIC))
     {
         return ATCMD_STATUS_INVALID_PARAMETER;
     }
 
-    if (pParamList[2].value.i > 0)
-    {
-        sockRdState.numBytesBuffered = 0;
-        sockRdState.pBufPtr = sockRdState.buffer;
+    /* The stack picks the algorithm up at the next connection, a listening
+       socket passes it on to the sockets waiting for its connections */
 
-        if (1 == pParamList[1].value.i)
+    if (0 != pSockState->backlog)
+    {
+        for (i=0; i<AT_CMD_SOCK_MAX_CLIENTS; i++)
         {
-            /* ASCII or hex string */
+            ATCMD_SOCK_STATE *pChildSockState;
 
-            sockRdState.pSockState          = pSockState;
-            sockRdState.isBinary            = false;
-            sockRdState.numBytesRequested   = pParamList[2].value.i;
+            pChildSockState = _findSocketByTransHandle(pSockState->childTransHandle[i]);
 
-            return ATCMD_STATUS_PENDING;
-        }
-        else if (2 == pParamList[1].value.i)
-        {
-            /* Binary */
+            if ((NULL == pChildSockState) || (pSockState != pChildSockState->pParent))
+            {
+                continue;
+            }
 
-            sockRdState.pSockState          = pSockState;
-            sockRdState.isBinary            = true;
-            sockRdState.numBytesRequested   = pParamList[2].value.i;
+            if (false == TCPIP_TCP_OptionsSet(pChildSockState->transHandle, TCP_OPTION_CONGESTION_CONTROL, (void*)(uintptr_t)_sockTCPCcAlgorithm(ccAlg)))
+            {
+                /* Put the sockets already changed back, so they all still match the parent */
 
-            return ATCMD_STATUS_PENDING;
+                for (j=0; j<i; j++)
+                {
+                    pChildSockState = _findSocketByTransHandle(pSockState->childTransHandle[j]);
+
+                    if ((NULL != pChildSockState) && (pSockState == pChildSockState->pParent))
+                    {
+                        pChildSockState->tcpCcAlg = pSockState->tcpCcAlg;
+
+                        TCPIP_TCP_OptionsSet(pChildSockState->transHandle, TCP_OPTION_CONGESTION_CONTROL, (void*)(uintptr_t)_sockTCPCcAlgorithm(pSockState->tcpCcAlg));
+                    }
+                }
+
+                return ATCMD_APP_STATUS_SOCKET_SET_OPT_FAILED;
+            }
+
+            pChildSockState->tcpCcAlg = ccAlg;
         }
-        else
+    }
+    else if (-1 != pSockState->transHandle)
+    {
+        if (false == TCPIP_TCP_OptionsSet(pSockState->transHandle, TCP_OPTION_CONGESTION_CONTROL, (void*)(uintptr_t)_sockTCPCcAlgorithm(ccAlg)))
         {
-            return ATCMD_APP_STATUS_INVALID_SOCKET_PROTOCOL;
+            return ATCMD_APP_STATUS_SOCKET_SET_OPT_FAILED;
         }
     }
 
+    pSockState->tcpCcAlg = ccAlg;
+
     return ATCMD_STATUS_OK;
 }
 
-static ATCMD_STATUS _SOCKCLExecute(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const int numParams, ATCMD_PARAM *pParamList)
+static ATCMD_STATUS _SOCKCExecute(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const int numParams, ATCMD_PARAM *pParamList)
 {
     ATCMD_SOCK_STATE *pSockState = NULL;
+    int optId;
 
-    if (1 == numParams)
+    if ((numParams < 1) || (numParams > 3))
     {
-        if (false == ATCMD_ParamValidateTypes(pCmdTypeDesc, 0, numParams, pParamList))
-        {
-            return ATCMD_STATUS_INVALID_PARAMETER;
-        }
+        return ATCMD_STATUS_INCORRECT_NUM_PARAMS;
     }
-    else
+
+    if (false == ATCMD_ParamValidateTypes(pCmdTypeDesc, numParams-1, numParams, pParamList))
     {
-        return ATCMD_STATUS_INCORRECT_NUM_PARAMS;
+        return ATCMD_STATUS_INVALID_PARAMETER;
     }
 
     /* Find the socket structure associated with this socket ID */
@@ -1565,90 +3357,57 @@ static ATCMD_STATUS _SOCKCLExecute(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const i
         return ATCMD_APP_STATUS_SOCKET_ID_NOT_FOUND;
     }
 
-    if(pSockState->transHandle == -1)
-    {
-        int i = 0; 
-        ATCMD_SOCK_STATE *pTmpSockState = NULL;
-        
-        for(i = 0; i < AT_CMD_SOCK_MAX_CLIENTS; i++)
-        {
-            pTmpSockState = _findSocketByTransHandle(pSockState->childTransHandle[i]);
-
-            if (NULL == pTmpSockState)
-            {
-                continue;
-            }
-
-            if (ATCMD_SOCK_PROTO_UDP == pTmpSockState->protocol)
-            {
-                continue;
-            }
+    /* All the options defined so far are TCP ones */
 
-            if (NULL != pTmpSockState->pWolfSSLSession)
-            {
-                ATCMD_TLS_FreeSession(pTmpSockState->tlsConfIdx, pTmpSockState->pWolfSSLSession);
-            }
+    if (ATCMD_SOCK_PROTO_TCP != pSockState->protocol)
+    {
+        return ATCMD_APP_STATUS_INVALID_SOCKET_PROTOCOL;
+    }
 
-            pTmpSockState->encryptState = ATCMD_SOCK_ENCRYPT_STATE_NONE;
-            TCPIP_TCP_Close(pTmpSockState->transHandle);
+    if (1 == numParams)
+    {
+        /* Dump all options */
 
-            pTmpSockState->transHandle    = -1;
-            pTmpSockState->inUse          = false;
-            pTmpSockState->remoteIPv4Addr.Val = 0;
-            pTmpSockState->remotePort         = 0;
-            pTmpSockState->pendingDataLength  = 0;
+        for (optId=1; optId<ATCMD_SOCK_OPT_MAX; optId++)
+        {
+            _sockOptPrint(pSockState, optId);
         }
-    }
-    
-    _closeSocket(pSockState);
 
-    return ATCMD_STATUS_OK;
-}
+        return ATCMD_STATUS_OK;
+    }
 
-static ATCMD_STATUS _SOCKLSTExecute(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const int numParams, ATCMD_PARAM *pParamList)
-{
-    int i;
+    optId = pParamList[1].value.i;
 
-    if (1 == numParams)
+    if (2 == numParams)
     {
-        if (false == ATCMD_ParamValidateTypes(pCmdTypeDesc, 1, numParams, pParamList))
+        if (false == _sockOptPrint(pSockState, optId))
         {
             return ATCMD_STATUS_INVALID_PARAMETER;
         }
-    }
-    else if (numParams > 1)
-    {
-        return ATCMD_STATUS_INCORRECT_NUM_PARAMS;
+
+        return ATCMD_STATUS_OK;
     }
 
-    for (i=0; i<AT_CMD_SOCK_MAX_NUM; i++)
+    switch (optId)
     {
-        if ((true == socketState[i].inUse) && (0 != socketState[i].handle))
+        case ATCMD_SOCK_OPT_TCP_RX_BUFF:
+        case ATCMD_SOCK_OPT_TCP_TX_BUFF:
         {
-            if ((0 == numParams) || (socketState[i].handle == pParamList[0].value.i))
-            {
-                if (0 != socketState[i].remoteIPv4Addr.Val)
-                {
-                    ATCMD_Printf("+SOCKLST:%d,%d,", socketState[i].handle, socketState[i].protocol);
-
-                    ATCMD_PrintIPv4Address(socketState[i].remoteIPv4Addr.Val);
-                }
-                else
-                {
-                    if(socketState[i].pParent)
-                        continue;
-                    
-                    ATCMD_Printf("+SOCKLST:%d,%d,", socketState[i].handle, socketState[i].protocol);
+            return _sockTCPBufSet(pSockState, optId, pParamList[2].value.i);
+        }
 
-                    ATCMD_Print("\"\"", 2);
-                }
+        case ATCMD_SOCK_OPT_TCP_CC:
+        {
+            return _sockTCPCcSet(pSockState, pParamList[2].value.i);
+        }
 
-                ATCMD_Printf(",%d,%d\r\n", socketState[i].remotePort, socketState[i].localPort);
-            }
+        default:
+        {
+            break;
         }
     }
 
-    return ATCMD_STATUS_OK;
+    return ATCMD_STATUS_INVALID_PARAMETER;
 }
 
 /*******************************************************************************
@@ -1657,124 +3416,74 @@ static ATCMD_STATUS _SOCKLSTExecute(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const
 static ATCMD_STATUS _SOCKUpdate(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const AT_CMD_TYPE_DESC* pCurrentCmdTypeDesc)
 {
     int i;
+    int n;
     ATCMD_STATUS retStatus = ATCMD_STATUS_OK;
     uint32_t currentTimeMs = ATCMD_PlatformGetSysTimeMs();
+    uint32_t handshakeTimeMs = 0;
+    bool handshakeDeferred = false;
+    bool runAgain = false;
+    bool timedWork = false;
 
-    if (pCurrentCmdTypeDesc == pCmdTypeDesc)
+    if ((pCurrentCmdTypeDesc == pCmdTypeDesc) && (pCmdTypeDesc == &atCmdTypeDescSOCKRD))
     {
-        if ((pCmdTypeDesc == &atCmdTypeDescSOCKRD) && (NULL != sockRdState.pSockState))
-        {
-            uint16_t numBytes;
+        /* Read requests are held per socket, serve every one outstanding */
 
-            if ((0 == sockRdState.numBytesBuffered) && (sockRdState.numBytesRequested > 0))
+        for (i=0; i<AT_CMD_SOCK_MAX_NUM; i++)
+        {
+            if ((true == socketState[i].inUse) && (socketState[i].rdNumBytesRequested > 0))
             {
-                if (ATCMD_SOCK_PROTO_UDP == sockRdState.pSockState->protocol)
-                {
-                    numBytes = TCPIP_UDP_GetIsReady(sockRdState.pSockState->transHandle);
-                }
-                else
-                {
-                    numBytes = _sockTCPReadReady(sockRdState.pSockState);
-                }
-
-                if (numBytes > sockRdState.numBytesRequested)
-                {
-                    numBytes = sockRdState.numBytesRequested;
-                }
+                _sockReadStream(&socketState[i]);
+            }
+        }
+    }
 
-                if (ATCMD_SOCK_ENCRYPT_STATE_NONE == sockRdState.pSockState->encryptState)
-                {
-                    if (ATCMD_SOCK_PROTO_UDP == sockRdState.pSockState->protocol)
-                    {
-                        sockRdState.numBytesBuffered = TCPIP_UDP_ArrayGet(sockRdState.pSockState->transHandle, sockRdState.pBufPtr, numBytes);
-                    }
-                    else
-                    {
-                        sockRdState.numBytesBuffered = TCPIP_TCP_ArrayGet(sockRdState.pSockState->transHandle, sockRdState.pBufPtr, numBytes);
-                    }
-                }
-                else if (ATCMD_SOCK_ENCRYPT_STATE_DONE == sockRdState.pSockState->encryptState)
-                {
-                    int readRes = wolfSSL_read(sockRdState.pSockState->pWolfSSLSession, sockRdState.pBufPtr, numBytes);
+    _sockTxStageDrain();
 
-                    if (readRes > 0)
-                    {
-                        sockRdState.numBytesBuffered = readRes;
-                    }
-                }
+    /* Sockets are visited round-robin, starting from the first one whose TLS
+       handshake was held back last pass, so every handshake progresses */
 
-                sockRdState.pSockState->pendingDataLength -= sockRdState.numBytesBuffered;
-            }
+    for (n=0; n<AT_CMD_SOCK_MAX_NUM; n++)
+    {
+        ATCMD_SOCK_STATE *pSockState;
 
-            if (sockRdState.numBytesBuffered > 0)
-            {
-                numBytes = sockRdState.numBytesBuffered;
+        i = (sockUpdateFirst + n) % AT_CMD_SOCK_MAX_NUM;
 
-                if (numBytes > 128)
-                {
-                    numBytes = 128;
-                }
+        pSockState = &socketState[i];
 
-                if (true == sockRdState.isBinary)
-                {
-                    if (true != ATCMD_ModeIsBinary())
-                    {
-                        ATCMD_Printf("+SOCKRD:%d,%d,", sockRdState.pSockState->handle, sockRdState.numBytesBuffered);
-                        ATCMD_Print("\r\n", 2);
-                        ATCMD_EnterBinaryMode(NULL);
-                    }
+        if (true == pSockState->inUse)
+        {
+            /* Push mode sockets send one chunk per pass each, so all streams progress together */
 
-                    ATCMD_Print((char*)sockRdState.pBufPtr, numBytes);
-                }
-                else
+            if ((pSockState->pushChunkSize > 0) && (pSockState->pushCredits > 0) && (false == ATCMD_ModeIsBinary()))
+            {
+                if (true == _sockPushData(pSockState))
                 {
-                    ATCMD_Printf("+SOCKRD:%d,%d,", sockRdState.pSockState->handle, numBytes);
-                    ATCMD_PrintStringSafe((char*)sockRdState.pBufPtr, numBytes);
-                    ATCMD_Print("\r\n", 2);
+                    runAgain = true;
                 }
+            }
 
-                sockRdState.numBytesBuffered -= numBytes;
-                sockRdState.pBufPtr          += numBytes;
-
-                if (0 == sockRdState.numBytesBuffered)
-                {
-                    if (true == ATCMD_ModeIsBinary())
-                    {
-                        ATCMD_LeaveBinaryMode();
-                    }
-
-                    if (ATCMD_SOCK_PROTO_UDP == sockRdState.pSockState->protocol)
-                    {
-                        UDP_SOCKET_INFO udpSockInfo;
-
-                        sockRdState.pSockState->pendingDataLength = TCPIP_UDP_GetIsReady(sockRdState.pSockState->transHandle);
-
-                        if (sockRdState.pSockState->pendingDataLength > 0)
-                        {
-                            TCPIP_UDP_SocketInfoGet(sockRdState.pSockState->transHandle, &udpSockInfo);
+            /* Tell the DTE once the write window has opened up again */
 
-                            ATCMD_Printf("+SOCKRXU:%d,", sockRdState.pSockState->handle);
-                            ATCMD_PrintIPv4Address(udpSockInfo.sourceIPaddress.v4Add.Val);
-                            ATCMD_Printf(",%d,%d\r\n", udpSockInfo.remotePort, sockRdState.pSockState->pendingDataLength);
-                        }
-                    }
+            if ((pSockState->txNotifyLen > 0) && (pSockState != pSOCKTXStageSock) && (false == ATCMD_ModeIsBinary()))
+            {
+                uint16_t txWindow = _sockTxWindow(pSockState);
 
-                    sockRdState.pSockState = NULL;
-                }
-                else
+                if (txWindow >= pSockState->txNotifyLen)
                 {
-                    retStatus = ATCMD_STATUS_PENDING;
+                    ATCMD_Printf("+SOCKTXR:%d,%d\r\n", pSockState->handle, txWindow);
+
+                    pSockState->txNotifyLen = 0;
                 }
             }
-        }
-    }
 
-    for (i=0; i<AT_CMD_SOCK_MAX_NUM; i++)
-    {
-        ATCMD_SOCK_STATE *pSockState = &socketState[i];
+            /* Write window, held back push data and connection set up are
+               not all signalled, so these are polled while outstanding */
+
+            if ((pSockState->txNotifyLen > 0) || ((pSockState->pushChunkSize > 0) && (pSockState->pushCredits > 0) && (_sockReadAvailable(pSockState) > 0)))
+            {
+                timedWork = true;
+            }
 
-        if (true == pSockState->inUse)
-        {
             if (true == pSockState->isConnected)
             {
                 continue;
@@ -1782,6 +3491,8 @@ static ATCMD_STATUS _SOCKUpdate(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const AT_C
 
             if ((ATCMD_SOCK_PROTO_TCP == pSockState->protocol) && (0 != pSockState->remotePort))
             {
+                timedWork = true;
+
                 switch (pSockState->encryptState)
                 {
                     case ATCMD_SOCK_ENCRYPT_STATE_NONE:
@@ -1807,9 +3518,24 @@ static ATCMD_STATUS _SOCKUpdate(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const AT_C
                             break;
                         }
 
+                        pSockState->tlsWantRead    = false;
+                        pSockState->tlsNumSteps    = 0;
+                        pSockState->tlsStartTimeMs = currentTimeMs;
+                        pSockState->tlsBusyTimeMs  = 0;
+                        pSockState->tlsTimeMs      = 0;
+
                         if (NULL == pSockState->pParent)
                         {
                             pSockState->pWolfSSLSession = ATCMD_TLS_AllocSession(pSockState->tlsConfIdx, &atCmdAppContext.tlsConf[0], true, pSockState->transHandle);
+
+                            if (NULL != pSockState->pWolfSSLSession)
+                            {
+                                char remoteAddr[16];
+
+                                TCPIP_Helper_IPAddressToString(&pSockState->remoteIPv4Addr, remoteAddr, sizeof(remoteAddr));
+
+                                ATCMD_TLS_SessionResume(&atCmdAppContext.tlsConf[0], pSockState->pWolfSSLSession, remoteAddr, pSockState->remotePort);
+                            }
                         }
                         else
                         {
@@ -1828,6 +3554,7 @@ static ATCMD_STATUS _SOCKUpdate(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const AT_C
                     case ATCMD_SOCK_ENCRYPT_STATE_NEGOTIATING:
                     {
                         int result;
+                        uint32_t stepTimeMs;
 
                         if (NULL == pSockState->pWolfSSLSession)
                         {
@@ -1836,6 +3563,33 @@ static ATCMD_STATUS _SOCKUpdate(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const AT_C
                             break;
                         }
 
+                        pSockState->encryptState = ATCMD_SOCK_ENCRYPT_STATE_NEGOTIATING;
+
+                        /* Nothing to do until the peer's next flight arrives */
+
+                        if ((true == pSockState->tlsWantRead) && (0 == TCPIP_TCP_GetIsReady(pSockState->transHandle)) && (true == TCPIP_TCP_IsConnected(pSockState->transHandle)))
+                        {
+                            break;
+                        }
+
+                        /* Once this pass has spent its handshake budget leave the
+                           rest for the next pass, so other sockets and the
+                           command line are not held up by the crypto */
+
+                        if (handshakeTimeMs >= AT_CMD_SOCK_TLS_SLICE_MS)
+                        {
+                            if (false == handshakeDeferred)
+                            {
+                                handshakeDeferred = true;
+                                sockUpdateFirst   = i;
+                            }
+
+                            runAgain = true;
+                            break;
+                        }
+
+                        stepTimeMs = ATCMD_PlatformGetSysTimeMs();
+
                         if (0 == wolfSSL_is_server(pSockState->pWolfSSLSession))
                         {
                             result = wolfSSL_connect(pSockState->pWolfSSLSession);
@@ -1845,9 +3599,23 @@ static ATCMD_STATUS _SOCKUpdate(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const AT_C
                             result = wolfSSL_accept(pSockState->pWolfSSLSession);
                         }
 
+                        stepTimeMs = ATCMD_PlatformGetSysTimeMs() - stepTimeMs;
+
+                        handshakeTimeMs += stepTimeMs;
+
+                        pSockState->tlsBusyTimeMs += stepTimeMs;
+                        pSockState->tlsNumSteps++;
+                        pSockState->tlsWantRead = false;
+
                         if (SSL_SUCCESS == result)
                         {
                             pSockState->encryptState = ATCMD_SOCK_ENCRYPT_STATE_DONE;
+                            pSockState->tlsTxOverhead = 0;
+
+                            /* Reported by +SOCKSTAT */
+                            pSockState->tlsTimeMs = ATCMD_PlatformGetSysTimeMs() - pSockState->tlsStartTimeMs;
+
+                            runAgain = true;
                         }
                         else
                         {
@@ -1855,7 +3623,7 @@ static ATCMD_STATUS _SOCKUpdate(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const AT_C
 
                             if ((SSL_ERROR_WANT_READ == error) || (SSL_ERROR_WANT_WRITE == error))
                             {
-                                pSockState->encryptState = ATCMD_SOCK_ENCRYPT_STATE_NEGOTIATING;
+                                pSockState->tlsWantRead = (SSL_ERROR_WANT_READ == error);
                             }
                             else
                             {
@@ -1871,6 +3639,15 @@ static ATCMD_STATUS _SOCKUpdate(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const AT_C
                     {
                         pSockState->isConnected = true;
 
+                        if (NULL == pSockState->pParent)
+                        {
+                            char remoteAddr[16];
+
+                            TCPIP_Helper_IPAddressToString(&pSockState->remoteIPv4Addr, remoteAddr, sizeof(remoteAddr));
+
+                            ATCMD_TLS_SessionEstablished(&atCmdAppContext.tlsConf[0], pSockState->pWolfSSLSession, remoteAddr, pSockState->remotePort);
+                        }
+
                         ATCMD_Printf("+SOCKTLS:%d\r\n", pSockState->handle);
                         break;
                     }
@@ -1888,5 +3665,18 @@ static ATCMD_STATUS _SOCKUpdate(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const AT_C
         }
     }
 
+    if (false == handshakeDeferred)
+    {
+        sockUpdateFirst = 0;
+    }
+
+    if (true == runAgain)
+    {
+        /* Come straight back rather than waiting for the next socket event */
+        ATCMD_PlatformEventSignal();
+    }
+
+    ATCMD_UpdateSetPending(pCmdTypeDesc, ((true == timedWork) || (NULL != pSOCKTXStageSock)));
+
     return retStatus;
 }
@@ -35,6 +35,7 @@
 *******************************************************************************/
 static ATCMD_STATUS _TLSInit(const AT_CMD_TYPE_DESC* pCmdTypeDesc);
 static ATCMD_STATUS _TLSCExecute(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const int numParams, ATCMD_PARAM *pParamList);
+static ATCMD_STATUS _TLSSESSExecute(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const int numParams, ATCMD_PARAM *pParamList);
 
 /*******************************************************************************
 * Command parameters
@@ -48,6 +49,15 @@ static const ATCMD_HELP_PARAM paramID =
 static const ATCMD_HELP_PARAM paramVAL =
     {"VAL", "Parameter value", ATCMD_PARAM_TYPE_CLASS_ANY, 0};
 
+static const ATCMD_HELP_PARAM paramOP =
+    {"OP", "Operation", ATCMD_PARAM_TYPE_CLASS_INTEGER,
+        .numOpts = 2,
+        {
+            {"1", "List cached sessions"},
+            {"2", "Flush cached sessions"}
+        }
+    };
+
 /*******************************************************************************
 * Command examples
 *******************************************************************************/
@@ -106,6 +116,43 @@ const AT_CMD_TYPE_DESC atCmdTypeDescTLSC =
         }
     };
 
+const AT_CMD_TYPE_DESC atCmdTypeDescTLSSESS =
+    {
+        .pCmdName   = "+TLSSESS",
+        .cmdInit    = NULL,
+        .cmdExecute = _TLSSESSExecute,
+        .cmdUpdate  = NULL,
+        .pSummary   = "This command is used to list or flush the TLS sessions cached for resumption",
+        .numVars    = 2,
+        {
+            {
+                .numParams   = 1,
+                .pParams     =
+                {
+                    &paramCONF
+                },
+                .numExamples = 0,
+                .pExamples   =
+                {
+                    NULL
+                }
+            },
+            {
+                .numParams   = 2,
+                .pParams     =
+                {
+                    &paramCONF,
+                    &paramOP
+                },
+                .numExamples = 0,
+                .pExamples   =
+                {
+                    NULL
+                }
+            }
+        }
+    };
+
 /*******************************************************************************
 * External references
 *******************************************************************************/
@@ -114,7 +161,7 @@ extern ATCMD_APP_CONTEXT atCmdAppContext;
 /*******************************************************************************
 * Local defines and types
 *******************************************************************************/
-#define TLSC_MAP_MAX_PARAMS    5
+#define TLSC_MAP_MAX_PARAMS    6
 
 /*******************************************************************************
 * Local data
@@ -127,6 +174,7 @@ static const ATCMD_STORE_MAP_ELEMENT tlsConfMap[] = {
     {4,  offsetof(ATCMD_APP_TLS_CONF, priKeyPassword),  ATCMD_STORE_TYPE_STRING,    AT_CMD_TLS_PRIKEY_PW_SZ,    ATCMD_STORE_ACCESS_WRITE},
 #endif    
     {5,  offsetof(ATCMD_APP_TLS_CONF, serverName),      ATCMD_STORE_TYPE_STRING,    AT_CMD_TLS_SERVER_NAME_SZ,  ATCMD_STORE_ACCESS_RW},
+    {6,  offsetof(ATCMD_APP_TLS_CONF, sessionResume),   ATCMD_STORE_TYPE_BOOL,      1,                          ATCMD_STORE_ACCESS_RW},
     {0,  0,                                             ATCMD_STORE_TYPE_INVALID,   0,                          ATCMD_STORE_ACCESS_RW}
 };
 
@@ -134,14 +182,25 @@ static const ATCMD_STORE_MAP_ELEMENT tlsConfMap[] = {
 * Local functions
 *******************************************************************************/
 
+static bool serverNameWatched[AT_CMD_TLS_NUM_CONFS];
+
 /*******************************************************************************
 * Command init functions
 *******************************************************************************/
 static ATCMD_STATUS _TLSInit(const AT_CMD_TYPE_DESC* pCmdTypeDesc)
 {
+    int i;
+
+    for (i=0; i<AT_CMD_TLS_NUM_CONFS; i++)
+    {
+        ATCMD_DNS_Unwatch(&atCmdAppContext.tlsConf[i].serverName[1], &serverNameWatched[i]);
+    }
+
     memset(&atCmdAppContext.tlsConf, 0, sizeof(atCmdAppContext.tlsConf));
     memset(&atCmdAppContext.tlsState, 0, sizeof(atCmdAppContext.tlsState));
 
+    ATCMD_TLS_CtxCacheFlush();
+
     return ATCMD_STATUS_OK;
 }
 
@@ -195,17 +254,43 @@ static ATCMD_STATUS _TLSCExecute(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const int
     }
     else if (3 == numParams)
     {
+        int numWritten;
+
         if (0 != atCmdAppContext.tlsConf[pParamList[0].value.i-1].numSessions)
         {
             return ATCMD_STATUS_STORE_UPDATE_BLOCKED;
         }
 
+        /* The server name is kept resolved in the background, follow any change to it */
+
+        if (5 == pParamList[1].value.i)
+        {
+            ATCMD_DNS_Unwatch(&ptlsConf->serverName[1], &serverNameWatched[pParamList[0].value.i-1]);
+        }
+
         /* Access the element in the configuration structure */
 
-        if (0 == ATCMD_StructStoreWriteParam(tlsConfMap, ptlsConf, pParamList[1].value.i, &pParamList[2]))
+        numWritten = ATCMD_StructStoreWriteParam(tlsConfMap, ptlsConf, pParamList[1].value.i, &pParamList[2]);
+
+        if (5 == pParamList[1].value.i)
+        {
+            ATCMD_STATUS status = ATCMD_DNS_Watch(&ptlsConf->serverName[1], &serverNameWatched[pParamList[0].value.i-1]);
+
+            if (ATCMD_STATUS_OK != status)
+            {
+                ATCMD_ReportAECStatus(pCmdTypeDesc->pCmdName, status);
+            }
+        }
+
+        if (0 == numWritten)
         {
             return ATCMD_STATUS_STORE_ACCESS_FAILED;
         }
+
+        /* Any CTX or session built from the old settings must not be reused */
+
+        ATCMD_TLS_CtxCacheFlush();
+        ATCMD_TLS_SessionFlush(ptlsConf);
     }
     else
     {
@@ -215,6 +300,60 @@ static ATCMD_STATUS _TLSCExecute(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const int
     return ATCMD_STATUS_OK;
 }
 
+static ATCMD_STATUS _TLSSESSExecute(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const int numParams, ATCMD_PARAM *pParamList)
+{
+    ATCMD_APP_TLS_CONF *ptlsConf = NULL;
+    ATCMD_TLS_SESS_INFO sessInfo;
+    uint32_t currentTimeMs;
+    int i;
+
+    if ((1 == numParams) || (2 == numParams))
+    {
+        if (false == ATCMD_ParamValidateTypes(pCmdTypeDesc, numParams-1, numParams, pParamList))
+        {
+            return ATCMD_STATUS_INVALID_PARAMETER;
+        }
+    }
+    else
+    {
+        return ATCMD_STATUS_INCORRECT_NUM_PARAMS;
+    }
+
+    if ((pParamList[0].value.i < 1) || (pParamList[0].value.i > AT_CMD_TLS_NUM_CONFS))
+    {
+        return ATCMD_STATUS_INVALID_PARAMETER;
+    }
+
+    ptlsConf = &atCmdAppContext.tlsConf[pParamList[0].value.i-1];
+
+    if ((1 == numParams) || (1 == pParamList[1].value.i))
+    {
+        currentTimeMs = ATCMD_PlatformGetSysTimeMs();
+
+        for (i=0; i<AT_CMD_TLS_SESS_CACHE_SZ; i++)
+        {
+            if (false == ATCMD_TLS_SessionInfoGet(ptlsConf, i, &sessInfo))
+            {
+                continue;
+            }
+
+            ATCMD_Printf("+TLSSESS:%d,", pParamList[0].value.i);
+            ATCMD_PrintStringSafe(sessInfo.pHost, strlen(sessInfo.pHost));
+            ATCMD_Printf(",%d,%u,%u,%u\r\n", sessInfo.port, sessInfo.numFull, sessInfo.numResumed, (currentTimeMs - sessInfo.lastTimeMs) / 1000);
+        }
+    }
+    else if (2 == pParamList[1].value.i)
+    {
+        ATCMD_TLS_SessionFlush(ptlsConf);
+    }
+    else
+    {
+        return ATCMD_STATUS_INVALID_PARAMETER;
+    }
+
+    return ATCMD_STATUS_OK;
+}
+
 /*******************************************************************************
 * Command update functions
 *******************************************************************************/
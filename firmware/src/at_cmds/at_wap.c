@@ -269,6 +269,9 @@ static void _APNotifyCallback(DRV_HANDLE handle, WDRV_PIC32MZW_ASSOC_HANDLE asso
             pStaState->connected   = true;
             pStaState->assocHandle = assocHandle;
             pStaState->ipAddr      = 0;
+
+            /* Have the AT task start looking for the station's lease */
+            ATCMD_PlatformEventSignal();
         }
     }
     else if (WDRV_PIC32MZW_CONN_STATE_DISCONNECTED == currentState)
@@ -704,9 +707,11 @@ static ATCMD_STATUS _WAPExecute(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const int
 static ATCMD_STATUS _WAPUpdate(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const AT_CMD_TYPE_DESC* pCurrentCmdTypeDesc)
 {
     int i;
+    bool leasePending = false;
 
     if (ATCMD_APP_STATE_AP_STARTED != atCmdAppContext.appState)
     {
+        ATCMD_UpdateSetPending(pCmdTypeDesc, false);
         return ATCMD_STATUS_OK;
     }
 
@@ -740,10 +745,18 @@ static ATCMD_STATUS _WAPUpdate(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const AT_CM
                         }
                     }
                     while (0 != dhcpsLease);
+
+                    if (0 == pStaState->ipAddr)
+                    {
+                        leasePending = true;
+                    }
                 }
             }
         }
     }
 
+    /* DHCP server leases are not signalled, so poll until every station has one */
+    ATCMD_UpdateSetPending(pCmdTypeDesc, leasePending);
+
     return ATCMD_STATUS_OK;
 }
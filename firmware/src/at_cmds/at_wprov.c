@@ -796,9 +796,13 @@ static ATCMD_STATUS _WPROVUpdate(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const AT_
 {
     if (ATCMD_APP_STATE_PROV_AP_STARTED != atCmdAppContext.appState)
     {
+        /* Woken again by the state change which starts provisioning */
+        ATCMD_UpdateSetPending(pCmdTypeDesc, false);
     	return ATCMD_STATUS_OK;
     }
 
+    ATCMD_UpdateSetPending(pCmdTypeDesc, true);
+
 	SYS_NET_Task(netSrvcHdl);
 
 	return ATCMD_STATUS_PENDING;
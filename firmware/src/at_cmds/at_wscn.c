@@ -228,6 +228,8 @@ static bool _BSSFindNotifyCallback(DRV_HANDLE handle, uint8_t index, uint8_t ofT
         if (NULL != pBSSInfo)
         {
             OSAL_SEM_Post(&bssFindResult);
+
+            ATCMD_PlatformEventSignal();
         }
     }
 
@@ -486,5 +488,8 @@ static ATCMD_STATUS _WSCNUpdate(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const AT_C
         }
     }
 
+    /* Keep polling while results are held back for UART space */
+    ATCMD_UpdateSetPending(pCmdTypeDesc, (OSAL_SEM_GetCount(&bssFindResult) > 0));
+
     return ATCMD_STATUS_OK;
 }
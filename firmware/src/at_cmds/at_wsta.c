@@ -218,6 +218,7 @@ static WDRV_PIC32MZW_BSS_CONTEXT  bssCtx;
 static bool assocInfoPending;
 static TCPIP_DNS_HANDLE dnsResolveHandle;
 static bool ntpSrvResolved;
+static bool ntpSvrWatched;
 static uint32_t dnsResolveStartMs;
 
 /*******************************************************************************
@@ -241,6 +242,8 @@ static void _DNSResolvEventHandler(TCPIP_NET_HANDLE hNet, TCPIP_DNS_EVENT_TYPE e
         if (0 == memcmp(pName, &atCmdAppContext.wstaConf.ntpSvr[1], atCmdAppContext.wstaConf.ntpSvr[0]))
         {
             ntpSrvResolved = true;
+
+            ATCMD_PlatformEventSignal();
         }
     }
 }
@@ -290,12 +293,18 @@ static void _SNTPSetup(void)
             {
                 TCPIP_DNS_RESULT dnsResult;
 
-                dnsResult = TCPIP_DNS_Send_Query((char*)&atCmdAppContext.wstaConf.ntpSvr[1], TCPIP_DNS_TYPE_A);
+                /* Use the cached answer when there is one, the DNS client keeps the name fresh */
+
+                dnsResult = TCPIP_DNS_Resolve((char*)&atCmdAppContext.wstaConf.ntpSvr[1], TCPIP_DNS_TYPE_A);
 
                 if (TCPIP_DNS_RES_PENDING == dnsResult)
                 {
                     dnsResolveStartMs = ATCMD_PlatformGetSysTimeMs();
                 }
+                else if (TCPIP_DNS_RES_OK == dnsResult)
+                {
+                    ntpSrvResolved = true;
+                }
                 else
                 {
                     _DNSResolvResetQuery();
@@ -525,6 +534,8 @@ static ATCMD_STATUS _BSSConnect(
 *******************************************************************************/
 static ATCMD_STATUS _WSTAInit(const AT_CMD_TYPE_DESC* pCmdTypeDesc)
 {
+    ATCMD_DNS_Unwatch((char*)&atCmdAppContext.wstaConf.ntpSvr[1], &ntpSvrWatched);
+
     memset(&atCmdAppContext.wstaConf, 0, sizeof(ATCMD_APP_WSTA_CONF));
     memset(&atCmdAppContext.wstaConnState, 0, sizeof(ATCMD_APP_WSTA_STATE));
 
@@ -615,6 +626,8 @@ static ATCMD_STATUS _WSTACExecute(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const in
             return ATCMD_STATUS_INVALID_PARAMETER;
         }
 
+        int numWritten;
+
         /* If connected then block write access to all elements */
 
         if (0 != atCmdAppContext.wstaConnState.wstaState)
@@ -622,9 +635,28 @@ static ATCMD_STATUS _WSTACExecute(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const in
             return ATCMD_STATUS_STORE_UPDATE_BLOCKED;
         }
 
+        /* The NTP server name is kept resolved in the background, follow any change to it */
+
+        if (12 == pParamList[0].value.i)
+        {
+            ATCMD_DNS_Unwatch((char*)&atCmdAppContext.wstaConf.ntpSvr[1], &ntpSvrWatched);
+        }
+
         /* Access the element in the configuration structure */
 
-        if (0 == ATCMD_StructStoreWriteParam(wstaConfMap, &atCmdAppContext.wstaConf, pParamList[0].value.i, &pParamList[1]))
+        numWritten = ATCMD_StructStoreWriteParam(wstaConfMap, &atCmdAppContext.wstaConf, pParamList[0].value.i, &pParamList[1]);
+
+        if (12 == pParamList[0].value.i)
+        {
+            ATCMD_STATUS status = ATCMD_DNS_Watch((char*)&atCmdAppContext.wstaConf.ntpSvr[1], &ntpSvrWatched);
+
+            if (ATCMD_STATUS_OK != status)
+            {
+                ATCMD_ReportAECStatus(pCmdTypeDesc->pCmdName, status);
+            }
+        }
+
+        if (0 == numWritten)
         {
             return ATCMD_STATUS_STORE_ACCESS_FAILED;
         }
@@ -992,5 +1024,21 @@ static ATCMD_STATUS _WSTAUpdate(const AT_CMD_TYPE_DESC* pCmdTypeDesc, const AT_C
         assocInfoPending = false;
     }
 
+    /* State changes and DNS results signal the AT task, only the association
+       details and the timeouts need polling */
+
+    if (ATCMD_APP_STATE_STA_CONNECTED == atCmdAppContext.appState)
+    {
+        ATCMD_UpdateSetPending(pCmdTypeDesc, ((true == assocInfoPending) || (true == ntpSrvResolved) || (NULL != dnsResolveHandle)));
+    }
+    else if (ATCMD_APP_STATE_STA_CONNECTING == atCmdAppContext.appState)
+    {
+        ATCMD_UpdateSetPending(pCmdTypeDesc, (atCmdAppContext.wstaStateTimeout > 0));
+    }
+    else
+    {
+        ATCMD_UpdateSetPending(pCmdTypeDesc, false);
+    }
+
     return ATCMD_STATUS_OK;
 }
@@ -66,6 +66,30 @@ SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
 /* Binary mode fast copy buffer size */
 //#define AT_CMD_CONF_BIN_FAST_BUFFER_SIZE        16
 
+/* Maximum number of command descriptors held in the sorted lookup index */
+//#define AT_CMD_CONF_MAX_CMD_TYPES               64
+
+/* Longest time (in ms) the AT task sleeps without being signalled while idle */
+//#define AT_CMD_CONF_IDLE_UPDATE_MS              100
+
+/* Longest time (in ms) the AT task sleeps while a command, binary mode or XMODEM transfer is in progress */
+//#define AT_CMD_CONF_BUSY_UPDATE_MS              5
+
+/* Size of the buffers each task assembles its output in before writing it to the UART */
+//#define AT_CMD_CONF_PRINT_STAGE_SIZE            512
+
+/* Number of other tasks (MQTT, TCP/IP) which can have a line of output staged at once */
+//#define AT_CMD_CONF_PRINT_NUM_TASK_STAGES       2
+
+/* Largest frame body accepted in framed mode, must hold a full binary mode write */
+//#define AT_CMD_CONF_FRAME_MAX_BODY_SIZE         1536
+
+/* Output buffered per response or AEC frame in framed mode */
+//#define AT_CMD_CONF_FRAME_TX_BUFFER_SIZE        256
+
+/* Time (in ms) without input after which a partial frame is dropped */
+//#define AT_CMD_CONF_FRAME_RX_TIMEOUT_MS         500
+
 /* Attention base string. All commands must start with this. */
 //#define AT_CMD_CONF_AT_BASE_STRING              "AT"
 
@@ -87,6 +111,21 @@ SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
 /* Define the default serial baud rate. */
 //#define AT_CMD_CONF_DEFAULT_SERIAL_BAUD_RATE    115200
 
+/* Free space in the UART TX ring (in bytes) at which a stalled writer is woken. */
+//#define AT_CMD_CONF_UART_TX_WAKE_THRESHOLD      512
+
+/* Time (in ms) the AT task waits for the UART TX ring to drain before counting a stall timeout. */
+//#define AT_CMD_CONF_UART_TX_STALL_TIMEOUT_MS    1000
+
+/* Size of the buffer holding UART output until the AT task can send it, other tasks may use half. */
+//#define AT_CMD_CONF_UART_TX_DEFER_SIZE          2048
+
+/* Testing only: limit UART output to this many bytes per ms to act as a slow host, see AT+INFO=2. */
+//#define AT_CMD_CONF_UART_TX_TEST_THROTTLE       2
+
+/* Use RTS/CTS hardware flow control on the AT command UART. */
+//#define AT_CMD_CONF_UART_FLOW_CONTROL
+
 /* Is XMODEM support included */
 #define AT_CMD_INCLUDE_XMODEM_SUPPORT
 
@@ -102,6 +141,9 @@ SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
 /* Define XMODEM support for YMODEM */
 //#define AT_CMD_CONF_XMODEM_SUPPORT_YMODEM_PROTOCOL
 
+/* Is framed host interface support (+FRM) included */
+#define AT_CMD_INCLUDE_FRAME_SUPPORT
+
 #include "include/conf_at_cmd_defaults.h"
 
 #endif /* _CONF_AT_CMD_H */
@@ -88,6 +88,13 @@
 /* Misc */
 #define configUSE_APPLICATION_TASK_TAG          0
 
+/* Heap allocation tracking, see at_cmd_mem.h */
+#ifndef __ASSEMBLER__
+#include "at_cmd_mem.h"
+#define traceMALLOC( pvAddress, uiSize )        ATCMD_MemTrackAlloc( ATCMD_MEM_OWNER_OS, ( pvAddress ), ( uiSize ), __builtin_return_address( 0 ) )
+#define traceFREE( pvAddress, uiSize )          ATCMD_MemTrackFree( pvAddress )
+#endif
+
 
 /* Interrupt nesting behaviour configuration. */
 #define configPERIPHERAL_CLOCK_HZ               ( 100000000UL )
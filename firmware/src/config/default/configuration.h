@@ -210,6 +210,8 @@ extern "C" {
 #define USE_WOLF_STRTOK
 #define NO_OLD_TLS
 #define USE_FAST_MATH
+#define HAVE_SESSION_TICKET
+#define SMALL_SESSION_CACHE
 
 
 /*** TCP Configuration ***/
@@ -227,13 +229,14 @@ extern "C" {
 #define TCPIP_TCP_MAX_SYN_RETRIES		        	3
 #define TCPIP_TCP_AUTO_TRANSMIT_TIMEOUT_VAL			40
 #define TCPIP_TCP_WINDOW_UPDATE_TIMEOUT_VAL			200
-#define TCPIP_TCP_MAX_SOCKETS		                10
+#define TCPIP_TCP_MAX_SOCKETS		                16
 #define TCPIP_TCP_TASK_TICK_RATE		        	5
 #define TCPIP_TCP_MSL_TIMEOUT		        	    0
 #define TCPIP_TCP_QUIET_TIME		        	    0
 #define TCPIP_TCP_COMMANDS   false
 #define TCPIP_TCP_EXTERN_PACKET_PROCESS   false
 #define TCPIP_TCP_DISABLE_CRYPTO_USAGE		        	    false
+#define TCPIP_TCP_CONGESTION_CONTROL                TCP_CC_CUBIC
 
 
 
@@ -307,7 +310,9 @@ extern "C" {
 #define TCPIP_UDP_SOCKET_DEFAULT_TX_SIZE		    	512
 #define TCPIP_UDP_SOCKET_DEFAULT_TX_QUEUE_LIMIT    	 	3
 #define TCPIP_UDP_SOCKET_DEFAULT_RX_QUEUE_LIMIT			16
-#define TCPIP_UDP_USE_POOL_BUFFERS   false
+#define TCPIP_UDP_USE_POOL_BUFFERS   true
+#define TCPIP_UDP_SOCKET_POOL_BUFFERS		        	4
+#define TCPIP_UDP_SOCKET_POOL_BUFFER_SIZE		    	1472
 #define TCPIP_UDP_USE_TX_CHECKSUM             			true
 #define TCPIP_UDP_USE_RX_CHECKSUM             			true
 #define TCPIP_UDP_COMMANDS   false
@@ -316,7 +321,7 @@ extern "C" {
 
 /* MPLAB Harmony Net Presentation Layer Definitions*/
 #define NET_PRES_NUM_INSTANCE 1
-#define NET_PRES_NUM_SOCKETS 10
+#define NET_PRES_NUM_SOCKETS 16
 
 /* Net Pres RTOS Configurations*/
 #define NET_PRES_RTOS_STACK_SIZE                6144
@@ -331,8 +336,11 @@ extern "C" {
 #define TCPIP_STACK_USE_DNS
 #define TCPIP_DNS_CLIENT_SERVER_TMO					60
 #define TCPIP_DNS_CLIENT_TASK_PROCESS_RATE			200
-#define TCPIP_DNS_CLIENT_CACHE_ENTRIES				5
+#define TCPIP_DNS_CLIENT_CACHE_ENTRIES				16
 #define TCPIP_DNS_CLIENT_CACHE_ENTRY_TMO			0
+#define TCPIP_DNS_CLIENT_CACHE_NEGATIVE_TMO			30
+#define TCPIP_DNS_CLIENT_CACHE_REFRESH_TMO			10
+#define TCPIP_DNS_CLIENT_WATCH_ENTRIES				8
 #define TCPIP_DNS_CLIENT_CACHE_PER_IPV4_ADDRESS		5
 #define TCPIP_DNS_CLIENT_CACHE_PER_IPV6_ADDRESS		1
 #define TCPIP_DNS_CLIENT_ADDRESS_TYPE			    IP_ADDRESS_TYPE_IPV4
@@ -408,22 +416,72 @@ extern "C" {
 
 
 /*** TCPIP Heap Configuration ***/
-#define TCPIP_STACK_USE_EXTERNAL_HEAP
+#define TCPIP_STACK_USE_INTERNAL_HEAP_POOL
 
-#define TCPIP_STACK_MALLOC_FUNC                     malloc
+#define TCPIP_STACK_MALLOC_FUNC                     ATCMD_MemTCPIPMalloc
 
-#define TCPIP_STACK_CALLOC_FUNC                     calloc
+#define TCPIP_STACK_CALLOC_FUNC                     ATCMD_MemTCPIPCalloc
 
-#define TCPIP_STACK_FREE_FUNC                       free
+#define TCPIP_STACK_FREE_FUNC                       ATCMD_MemTCPIPFree
 
 
 
-#define TCPIP_STACK_HEAP_USE_FLAGS                   TCPIP_STACK_HEAP_FLAG_ALLOC_UNCACHED
+#define TCPIP_STACK_HEAP_USE_FLAGS                   (TCPIP_STACK_HEAP_FLAG_ALLOC_UNCACHED | TCPIP_STACK_HEAP_FLAG_POOL_EXTERNAL_FALLBACK)
 
 #define TCPIP_STACK_HEAP_USAGE_CONFIG                TCPIP_STACK_HEAP_USE_DEFAULT
 
 #define TCPIP_STACK_SUPPORTED_HEAPS                  1
 
+#define TCPIP_STACK_DRAM_RUN_LIMIT                   2048
+
+#define TCPIP_STACK_POOL_EXPANSION_SIZE              4096
+
+#define TCPIP_HEAP_POOL_ENTRIES_NUMBER               10
+
+/* full size MAC RX frames */
+#define TCPIP_HEAP_POOL_ENTRY_SIZE_IDX0              1760
+#define TCPIP_HEAP_POOL_ENTRY_BLOCKS_IDX0            4
+#define TCPIP_HEAP_POOL_ENTRY_EXP_BLOCKS_IDX0        2
+
+/* UDP pool buffers, TCP socket buffers (2 blocks per socket) */
+#define TCPIP_HEAP_POOL_ENTRY_SIZE_IDX1              1616
+#define TCPIP_HEAP_POOL_ENTRY_BLOCKS_IDX1            12
+#define TCPIP_HEAP_POOL_ENTRY_EXP_BLOCKS_IDX1        2
+
+#define TCPIP_HEAP_POOL_ENTRY_SIZE_IDX2              1024
+#define TCPIP_HEAP_POOL_ENTRY_BLOCKS_IDX2            2
+#define TCPIP_HEAP_POOL_ENTRY_EXP_BLOCKS_IDX2        1
+
+/* UDP TX buffers */
+#define TCPIP_HEAP_POOL_ENTRY_SIZE_IDX3              768
+#define TCPIP_HEAP_POOL_ENTRY_BLOCKS_IDX3            4
+#define TCPIP_HEAP_POOL_ENTRY_EXP_BLOCKS_IDX3        2
+
+#define TCPIP_HEAP_POOL_ENTRY_SIZE_IDX4              512
+#define TCPIP_HEAP_POOL_ENTRY_BLOCKS_IDX4            4
+#define TCPIP_HEAP_POOL_ENTRY_EXP_BLOCKS_IDX4        2
+
+/* TCP segment packets */
+#define TCPIP_HEAP_POOL_ENTRY_SIZE_IDX5              256
+#define TCPIP_HEAP_POOL_ENTRY_BLOCKS_IDX5            16
+#define TCPIP_HEAP_POOL_ENTRY_EXP_BLOCKS_IDX5        4
+
+#define TCPIP_HEAP_POOL_ENTRY_SIZE_IDX6              128
+#define TCPIP_HEAP_POOL_ENTRY_BLOCKS_IDX6            16
+#define TCPIP_HEAP_POOL_ENTRY_EXP_BLOCKS_IDX6        4
+
+#define TCPIP_HEAP_POOL_ENTRY_SIZE_IDX7              64
+#define TCPIP_HEAP_POOL_ENTRY_BLOCKS_IDX7            16
+#define TCPIP_HEAP_POOL_ENTRY_EXP_BLOCKS_IDX7        8
+
+#define TCPIP_HEAP_POOL_ENTRY_SIZE_IDX8              32
+#define TCPIP_HEAP_POOL_ENTRY_BLOCKS_IDX8            16
+#define TCPIP_HEAP_POOL_ENTRY_EXP_BLOCKS_IDX8        8
+
+#define TCPIP_HEAP_POOL_ENTRY_SIZE_IDX9              16
+#define TCPIP_HEAP_POOL_ENTRY_BLOCKS_IDX9            16
+#define TCPIP_HEAP_POOL_ENTRY_EXP_BLOCKS_IDX9        8
+
 
 
 
@@ -534,6 +592,7 @@ extern "C" {
 #define NO_SIG_WRAPPER
 #define NO_ERROR_STRINGS
 #define NO_WOLFSSL_MEMORY
+#define XMALLOC_USER
 /*Enabling TNGTLS certificate loading*/
 #define HAVE_SUPPORTED_CURVES
 #define WOLFSSL_ATECC608A
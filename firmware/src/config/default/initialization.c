@@ -327,6 +327,8 @@ const TCPIP_UDP_MODULE_CONFIG tcpipUDPInitData =
 {
     .nSockets       = TCPIP_UDP_MAX_SOCKETS,
     .sktTxBuffSize  = TCPIP_UDP_SOCKET_DEFAULT_TX_SIZE, 
+    .poolBuffers    = TCPIP_UDP_SOCKET_POOL_BUFFERS,
+    .poolBufferSize = TCPIP_UDP_SOCKET_POOL_BUFFER_SIZE,
 };
 
 /*** TCP Sockets Initialization Data ***/
@@ -421,6 +423,8 @@ const TCPIP_DNS_CLIENT_MODULE_CONFIG tcpipDNSClientInitData =
     .nIPv4Entries  = TCPIP_DNS_CLIENT_CACHE_PER_IPV4_ADDRESS,
     .ipAddressType       = TCPIP_DNS_CLIENT_ADDRESS_TYPE,
     .nIPv6Entries  = TCPIP_DNS_CLIENT_CACHE_PER_IPV6_ADDRESS,
+    .entryNegativeTmo   = TCPIP_DNS_CLIENT_CACHE_NEGATIVE_TMO,
+    .entryRefreshTmo    = TCPIP_DNS_CLIENT_CACHE_REFRESH_TMO,
 };
 
 
@@ -438,6 +442,74 @@ const TCPIP_IPV4_MODULE_CONFIG  tcpipIPv4InitData =
 
 
 
+#if defined(TCPIP_STACK_USE_INTERNAL_HEAP_POOL)
+TCPIP_STACK_HEAP_POOL_ENTRY tcpipHeapPoolEntryTbl[TCPIP_HEAP_POOL_ENTRIES_NUMBER] =
+{
+    {
+        .entrySize = TCPIP_HEAP_POOL_ENTRY_SIZE_IDX0,
+        .nBlocks = TCPIP_HEAP_POOL_ENTRY_BLOCKS_IDX0,
+        .nExpBlks = TCPIP_HEAP_POOL_ENTRY_EXP_BLOCKS_IDX0,
+    },
+    {
+        .entrySize = TCPIP_HEAP_POOL_ENTRY_SIZE_IDX1,
+        .nBlocks = TCPIP_HEAP_POOL_ENTRY_BLOCKS_IDX1,
+        .nExpBlks = TCPIP_HEAP_POOL_ENTRY_EXP_BLOCKS_IDX1,
+    },
+    {
+        .entrySize = TCPIP_HEAP_POOL_ENTRY_SIZE_IDX2,
+        .nBlocks = TCPIP_HEAP_POOL_ENTRY_BLOCKS_IDX2,
+        .nExpBlks = TCPIP_HEAP_POOL_ENTRY_EXP_BLOCKS_IDX2,
+    },
+    {
+        .entrySize = TCPIP_HEAP_POOL_ENTRY_SIZE_IDX3,
+        .nBlocks = TCPIP_HEAP_POOL_ENTRY_BLOCKS_IDX3,
+        .nExpBlks = TCPIP_HEAP_POOL_ENTRY_EXP_BLOCKS_IDX3,
+    },
+    {
+        .entrySize = TCPIP_HEAP_POOL_ENTRY_SIZE_IDX4,
+        .nBlocks = TCPIP_HEAP_POOL_ENTRY_BLOCKS_IDX4,
+        .nExpBlks = TCPIP_HEAP_POOL_ENTRY_EXP_BLOCKS_IDX4,
+    },
+    {
+        .entrySize = TCPIP_HEAP_POOL_ENTRY_SIZE_IDX5,
+        .nBlocks = TCPIP_HEAP_POOL_ENTRY_BLOCKS_IDX5,
+        .nExpBlks = TCPIP_HEAP_POOL_ENTRY_EXP_BLOCKS_IDX5,
+    },
+    {
+        .entrySize = TCPIP_HEAP_POOL_ENTRY_SIZE_IDX6,
+        .nBlocks = TCPIP_HEAP_POOL_ENTRY_BLOCKS_IDX6,
+        .nExpBlks = TCPIP_HEAP_POOL_ENTRY_EXP_BLOCKS_IDX6,
+    },
+    {
+        .entrySize = TCPIP_HEAP_POOL_ENTRY_SIZE_IDX7,
+        .nBlocks = TCPIP_HEAP_POOL_ENTRY_BLOCKS_IDX7,
+        .nExpBlks = TCPIP_HEAP_POOL_ENTRY_EXP_BLOCKS_IDX7,
+    },
+    {
+        .entrySize = TCPIP_HEAP_POOL_ENTRY_SIZE_IDX8,
+        .nBlocks = TCPIP_HEAP_POOL_ENTRY_BLOCKS_IDX8,
+        .nExpBlks = TCPIP_HEAP_POOL_ENTRY_EXP_BLOCKS_IDX8,
+    },
+    {
+        .entrySize = TCPIP_HEAP_POOL_ENTRY_SIZE_IDX9,
+        .nBlocks = TCPIP_HEAP_POOL_ENTRY_BLOCKS_IDX9,
+        .nExpBlks = TCPIP_HEAP_POOL_ENTRY_EXP_BLOCKS_IDX9,
+    },
+};
+
+TCPIP_STACK_HEAP_POOL_CONFIG tcpipHeapConfig =
+{
+    .heapType = TCPIP_STACK_HEAP_TYPE_INTERNAL_HEAP_POOL,
+    .heapFlags = TCPIP_STACK_HEAP_USE_FLAGS,
+    .heapUsage = TCPIP_STACK_HEAP_USAGE_CONFIG,
+    .malloc_fnc = TCPIP_STACK_MALLOC_FUNC,
+    .calloc_fnc = TCPIP_STACK_CALLOC_FUNC,
+    .free_fnc = TCPIP_STACK_FREE_FUNC,
+    .nPoolEntries = TCPIP_HEAP_POOL_ENTRIES_NUMBER,
+    .pEntries = tcpipHeapPoolEntryTbl,
+    .expansionHeapSize = TCPIP_STACK_POOL_EXPANSION_SIZE,
+};
+#else
 TCPIP_STACK_HEAP_EXTERNAL_CONFIG tcpipHeapConfig =
 {
     .heapType = TCPIP_STACK_HEAP_TYPE_EXTERNAL_HEAP,
@@ -447,6 +519,7 @@ TCPIP_STACK_HEAP_EXTERNAL_CONFIG tcpipHeapConfig =
     .calloc_fnc = TCPIP_STACK_CALLOC_FUNC,
     .free_fnc = TCPIP_STACK_FREE_FUNC,
 };
+#endif  // defined(TCPIP_STACK_USE_INTERNAL_HEAP_POOL)
 
 
 const TCPIP_NETWORK_CONFIG __attribute__((unused))  TCPIP_HOSTS_CONFIGURATION[] =
@@ -213,6 +213,8 @@ typedef enum
     TCPIP_DNS_RES_CACHE_FULL          = -8,   // the cache is full and no entry could be added
     TCPIP_DNS_RES_INVALID_HOSTNAME    = -9,   // Invalid hostname
     TCPIP_DNS_RES_SOCKET_ERROR       = -10,   // DNS UDP socket error: not ready, TX error, etc.
+    TCPIP_DNS_RES_NAME_ERROR         = -11,   // the DNS server reported no such name; the answer is cached
+    TCPIP_DNS_RES_WATCH_FULL         = -12,   // the watch list is full and no name could be added
 }TCPIP_DNS_RESULT;
 
 
@@ -244,6 +246,9 @@ typedef struct
                                         // Reserved for future improvements
     int             nIPv6Entries;       // Number of IPv6 address per DNS Name
                                         // Default value is 1 and is used only when IPv6 is enabled
+    uint32_t        entryNegativeTmo;   // "No such name" answers are cached for this tmo - seconds
+                                        // 0 means the entry is removed and the name queried again
+    uint32_t        entryRefreshTmo;    // Watched names are queried again this long before they expire - seconds
 
                                 
 }TCPIP_DNS_CLIENT_MODULE_CONFIG;
@@ -825,6 +830,80 @@ TCPIP_DNS_RESULT TCPIP_DNS_EntryQuery(TCPIP_DNS_ENTRY_QUERY *pDnsQuery, int quer
   */
 TCPIP_DNS_RESULT TCPIP_DNS_Send_Query(const char* hostName, TCPIP_DNS_RESOLVE_TYPE type);
 
+//****************************************************************************
+/*  Function:
+    TCPIP_DNS_RESULT TCPIP_DNS_WatchAdd(const char* hostName)
+
+  Summary:
+    Keeps a host name resolved in the DNS cache.
+
+  Description:
+    This function adds the host name to the DNS client watch list.
+    A watched name is resolved (type A) as soon as an interface is able to
+    carry DNS traffic, is queried again shortly before its cache entry
+    expires and is not replaced by newer names when the cache is full.
+    While a refresh query is ongoing the cached addresses are still reported.
+    A watched name that cannot be solved is queried again with a delay that
+    doubles after each failed attempt.
+
+  Precondition:
+    The DNS client module must be initialized.
+
+  Parameters:
+    hostName   - A pointer to the null terminated string specifying the
+                 host name to keep resolved.
+
+  Returns:
+    - TCPIP_DNS_RES_OK - the name is watched
+    - TCPIP_DNS_RES_NAME_IS_IPADDRESS - name is a IPv4 or IPv6 address, nothing to watch
+
+    Errors:
+    - TCPIP_DNS_RES_NO_SERVICE - DNS resolver non existent/uninitialized.
+    - TCPIP_DNS_RES_INVALID_HOSTNAME - invalid name supplied
+    - TCPIP_DNS_RES_WATCH_FULL - no more names can be watched
+
+  Remarks:
+    The number of watched names is given by TCPIP_DNS_CLIENT_WATCH_ENTRIES.
+    Adding a name that is already watched only increments its reference
+    count and does not use another entry.
+
+  */
+TCPIP_DNS_RESULT TCPIP_DNS_WatchAdd(const char* hostName);
+
+//****************************************************************************
+/*  Function:
+    TCPIP_DNS_RESULT TCPIP_DNS_WatchRemove(const char* hostName)
+
+  Summary:
+    Removes a host name from the DNS client watch list.
+
+  Description:
+    This function releases a reference taken by TCPIP_DNS_WatchAdd.
+    The background refresh of the name stops when its last reference
+    is released.
+    The cache entry itself is kept until it expires or is replaced.
+
+  Precondition:
+    The DNS client module must be initialized.
+
+  Parameters:
+    hostName   - A pointer to the null terminated string specifying the
+                 host name to be removed.
+
+  Returns:
+    - TCPIP_DNS_RES_OK - the reference was released
+
+    Errors:
+    - TCPIP_DNS_RES_NO_SERVICE - DNS resolver non existent/uninitialized.
+    - TCPIP_DNS_RES_INVALID_HOSTNAME - invalid name supplied
+    - TCPIP_DNS_RES_NO_NAME_ENTRY - the name is not watched
+
+  Remarks:
+    None
+
+  */
+TCPIP_DNS_RESULT TCPIP_DNS_WatchRemove(const char* hostName);
+
 //****************************************************************************
 /*  Function:
     TCPIP_DNS_RESULT TCPIP_DNS_ClientInfoGet(TCPIP_DNS_CLIENT_INFO* pClientInfo)
@@ -72,7 +72,13 @@ static TCPIP_DNS_RESULT     _DNS_Send_Query(TCPIP_DNS_DCPT* pDnsDcpt, TCPIP_DNS_
 static TCPIP_DNS_RESULT     _DNS_Resolve(const char* hostName, TCPIP_DNS_RESOLVE_TYPE type, bool forceQuery);
 static bool                 _DNS_ProcessPacket(TCPIP_DNS_DCPT* pDnsDcpt);
 static  TCPIP_DNS_RESULT    _DNSCompleteHashEntry(TCPIP_DNS_DCPT* pDnsDcpt, TCPIP_DNS_HASH_ENTRY* dnsHE);
+static  void                _DNSNegativeHashEntry(TCPIP_DNS_DCPT* pDnsDcpt, TCPIP_DNS_HASH_ENTRY* dnsHE);
+static  uint32_t            _DNSEntryTimeout(TCPIP_DNS_DCPT* pDnsDcpt, TCPIP_DNS_HASH_ENTRY* dnsHE);
 static  void                _DNS_CleanCache(TCPIP_DNS_DCPT* pDnsDcpt);
+static  void                _DNSRefreshHashEntry(TCPIP_DNS_DCPT* pDnsDcpt, TCPIP_DNS_HASH_ENTRY* dnsHE);
+static int                  _DNS_WatchIndex(TCPIP_DNS_DCPT* pDnsDcpt, const char* hostName);
+static void                 _DNS_WatchResolve(TCPIP_DNS_DCPT* pDnsDcpt, TCPIP_DNS_WATCH_ENTRY* pWatch);
+static bool                 _DNS_AnyNetIsValid(TCPIP_DNS_DCPT* pDnsDcpt);
 static TCPIP_DNS_RESULT     _DNS_IsNameResolved(const char* hostName, IPV4_ADDR* hostIPv4, IPV6_ADDR* hostIPv6, bool singleAddress);
 static bool                 _DNS_ValidateIf(TCPIP_NET_IF* pIf, TCPIP_DNS_HASH_ENTRY* pDnsHE, bool wrapAround);
 static bool                 _DNS_AddSelectionIf(TCPIP_NET_IF* pIf, TCPIP_NET_IF** dnsIfTbl, int tblEntries);
@@ -257,8 +263,8 @@ static void _DNS_CleanCacheEntry(TCPIP_DNS_DCPT* pDnsDcpt, TCPIP_DNS_HASH_ENTRY*
 {
     if(pDnsHE->hEntry.flags.busy)
     {
-        if((pDnsHE->hEntry.flags.value & TCPIP_DNS_FLAG_ENTRY_COMPLETE) == 0)
-        {   // deleting an unsolved entry
+        if((pDnsHE->hEntry.flags.value & (TCPIP_DNS_FLAG_ENTRY_COMPLETE | TCPIP_DNS_FLAG_ENTRY_REFRESH)) != TCPIP_DNS_FLAG_ENTRY_COMPLETE)
+        {   // deleting an unsolved or refreshing entry
             pDnsDcpt->unsolvedEntries--;
             _DNSAssertCond(pDnsDcpt->unsolvedEntries >= 0, __func__, __LINE__);
         }
@@ -293,7 +299,7 @@ static void _DNS_UpdateExpiredHashEntry_Notify(TCPIP_DNS_DCPT* pDnsDcpt, TCPIP_D
 static  TCPIP_DNS_RESULT  _DNSCompleteHashEntry(TCPIP_DNS_DCPT* pDnsDcpt, TCPIP_DNS_HASH_ENTRY* dnsHE)
 {
      
-    dnsHE->hEntry.flags.value &= ~TCPIP_DNS_FLAG_ENTRY_TIMEOUT;
+    dnsHE->hEntry.flags.value &= ~(TCPIP_DNS_FLAG_ENTRY_TIMEOUT | TCPIP_DNS_FLAG_ENTRY_NEGATIVE);
     dnsHE->hEntry.flags.value |= TCPIP_DNS_FLAG_ENTRY_COMPLETE;
     dnsHE->recordMask = TCPIP_DNS_ADDRESS_REC_NONE;
 
@@ -317,6 +323,87 @@ static  TCPIP_DNS_RESULT  _DNSCompleteHashEntry(TCPIP_DNS_DCPT* pDnsDcpt, TCPIP_
     return TCPIP_DNS_RES_OK;
 }
 
+// marks an entry as solved with a "no such name" answer
+// the entry answers further queries until it expires
+static  void _DNSNegativeHashEntry(TCPIP_DNS_DCPT* pDnsDcpt, TCPIP_DNS_HASH_ENTRY* dnsHE)
+{
+    dnsHE->hEntry.flags.value &= ~TCPIP_DNS_FLAG_ENTRY_TIMEOUT;
+    dnsHE->hEntry.flags.value |= TCPIP_DNS_FLAG_ENTRY_COMPLETE | TCPIP_DNS_FLAG_ENTRY_NEGATIVE;
+    dnsHE->recordMask = TCPIP_DNS_ADDRESS_REC_NONE;
+    dnsHE->nIPv4Entries = dnsHE->nIPv6Entries = 0;
+    dnsHE->ipTTL.Val = pDnsDcpt->negativeEntryTMO;
+
+    dnsHE->tRetry = dnsHE->tInsert = pDnsDcpt->dnsTime; 
+    pDnsDcpt->unsolvedEntries--;
+    _DNSAssertCond(pDnsDcpt->unsolvedEntries >= 0, __func__, __LINE__);
+}
+
+// returns the lifetime of a solved entry, seconds
+static  uint32_t _DNSEntryTimeout(TCPIP_DNS_DCPT* pDnsDcpt, TCPIP_DNS_HASH_ENTRY* dnsHE)
+{
+    if(pDnsDcpt->cacheEntryTMO == 0 || (dnsHE->hEntry.flags.value & TCPIP_DNS_FLAG_ENTRY_NEGATIVE) != 0)
+    {   // the TTL is the timeout period
+        return dnsHE->ipTTL.Val;
+    }
+
+    return pDnsDcpt->cacheEntryTMO;
+}
+
+// queries a solved entry again
+// the entry keeps its addresses until the answer replaces them
+static  void _DNSRefreshHashEntry(TCPIP_DNS_DCPT* pDnsDcpt, TCPIP_DNS_HASH_ENTRY* dnsHE)
+{
+    dnsHE->hEntry.flags.value |= TCPIP_DNS_FLAG_ENTRY_REFRESH;
+    dnsHE->tRetry = pDnsDcpt->dnsTime;
+    dnsHE->currRetry = 0;
+    int retryIfs = (pDnsDcpt->strictNet == 0) ? TCPIP_STACK_NumberOfNetworksGet() : 1;
+    dnsHE->nRetries = retryIfs * _TCPIP_DNS_IF_RETRY_COUNT;
+    pDnsDcpt->unsolvedEntries++;
+    _DNS_Send_Query(pDnsDcpt, dnsHE);
+}
+
+// starts resolving a watched name
+// and sets the earliest time of the next attempt, if this one does not solve it
+static void _DNS_WatchResolve(TCPIP_DNS_DCPT* pDnsDcpt, TCPIP_DNS_WATCH_ENTRY* pWatch)
+{
+    uint32_t retryTmo = _TCPIP_DNS_CLIENT_WATCH_RETRY_MIN_TMO;
+    int ix;
+
+    for(ix = 0; ix < pWatch->nAttempts && retryTmo < _TCPIP_DNS_CLIENT_WATCH_RETRY_MAX_TMO; ix++)
+    {
+        retryTmo <<= 1;
+    }
+    if(retryTmo > _TCPIP_DNS_CLIENT_WATCH_RETRY_MAX_TMO)
+    {
+        retryTmo = _TCPIP_DNS_CLIENT_WATCH_RETRY_MAX_TMO;
+    }
+
+    if(pWatch->nAttempts < 0xffff)
+    {
+        pWatch->nAttempts++;
+    }
+    pWatch->tRetry = pDnsDcpt->dnsTime + retryTmo;
+
+    _DNS_Resolve(pWatch->hostName, TCPIP_DNS_TYPE_A, false);
+}
+
+// returns the watch list index of a host name
+// or -1 if the name is not watched
+static int _DNS_WatchIndex(TCPIP_DNS_DCPT* pDnsDcpt, const char* hostName)
+{
+    int ix;
+
+    for(ix = 0; ix < TCPIP_DNS_CLIENT_WATCH_ENTRIES; ix++)
+    {
+        if(pDnsDcpt->watchList[ix].hostName[0] != 0 && strcmp(pDnsDcpt->watchList[ix].hostName, hostName) == 0)
+        {
+            return ix;
+        }
+    }
+
+    return -1;
+}
+
 static  void _DNSDeleteCacheEntries(TCPIP_DNS_DCPT* pDnsDcpt)
 {
     size_t          bktIx;
@@ -419,6 +506,8 @@ bool TCPIP_DNS_ClientInitialize(const TCPIP_STACK_MODULE_CTRL* const stackData,
         pDnsDcpt->hashDcpt = hashDcpt;
         pDnsDcpt->dnsSocket =  INVALID_UDP_SOCKET;
         pDnsDcpt->cacheEntryTMO = dnsData->entrySolvedTmo;
+        pDnsDcpt->negativeEntryTMO = dnsData->entryNegativeTmo;
+        pDnsDcpt->refreshEntryTMO = dnsData->entryRefreshTmo;
         pDnsDcpt->nIPv4Entries= dnsData->nIPv4Entries;
         pDnsDcpt->nIPv6Entries = dnsData->nIPv6Entries;
         pDnsDcpt->ipAddressType = dnsData->ipAddressType;
@@ -657,6 +746,7 @@ static TCPIP_DNS_RESULT _DNS_Resolve(const char* hostName, TCPIP_DNS_RESOLVE_TYP
     {   // no more entries
         return TCPIP_DNS_RES_CACHE_FULL; 
     }
+    dnsHE->lastUse = ++pDnsDcpt->useSeq;
 
     if(type == TCPIP_DNS_TYPE_A)
     {
@@ -673,6 +763,10 @@ static TCPIP_DNS_RESULT _DNS_Resolve(const char* hostName, TCPIP_DNS_RESOLVE_TYP
 
     if(forceQuery == 0 && dnsHE->hEntry.flags.newEntry == 0)
     {   // already in hash
+        if((dnsHE->hEntry.flags.value & TCPIP_DNS_FLAG_ENTRY_NEGATIVE) != 0)
+        {   // the server has no such name; don't ask again until the entry expires
+            return TCPIP_DNS_RES_NAME_ERROR;
+        }
         if((dnsHE->recordMask & recMask) == recMask)
         {   // already have the requested type
             if((dnsHE->hEntry.flags.value & TCPIP_DNS_FLAG_ENTRY_COMPLETE) != 0)
@@ -686,11 +780,17 @@ static TCPIP_DNS_RESULT _DNS_Resolve(const char* hostName, TCPIP_DNS_RESOLVE_TYP
 
     // this is a forced/new entry/query
     // update entry parameters
+    if(dnsHE->hEntry.flags.newEntry != 0 || (dnsHE->hEntry.flags.value & (TCPIP_DNS_FLAG_ENTRY_COMPLETE | TCPIP_DNS_FLAG_ENTRY_REFRESH)) == TCPIP_DNS_FLAG_ENTRY_COMPLETE)
+    {   // not counted as unsolved yet
+        pDnsDcpt->unsolvedEntries++;
+    }
+
     if(dnsHE->hEntry.flags.newEntry != 0)
     {
         dnsHE->nIPv4Entries = 0;
         dnsHE->nIPv6Entries = 0;
-        dnsHE->hEntry.flags.value &= ~(TCPIP_DNS_FLAG_ENTRY_COMPLETE | TCPIP_DNS_FLAG_ENTRY_TIMEOUT);
+        dnsHE->recordMask = TCPIP_DNS_ADDRESS_REC_NONE;
+        dnsHE->hEntry.flags.value &= ~(TCPIP_DNS_FLAG_ENTRY_COMPLETE | TCPIP_DNS_FLAG_ENTRY_TIMEOUT | TCPIP_DNS_FLAG_ENTRY_NEGATIVE | TCPIP_DNS_FLAG_ENTRY_REFRESH);
     }
     else
     {   // forced
@@ -702,7 +802,7 @@ static TCPIP_DNS_RESULT _DNS_Resolve(const char* hostName, TCPIP_DNS_RESOLVE_TYP
         {
             dnsHE->nIPv6Entries = 0;
         }
-        dnsHE->hEntry.flags.value &= ~TCPIP_DNS_FLAG_ENTRY_COMPLETE;
+        dnsHE->hEntry.flags.value &= ~(TCPIP_DNS_FLAG_ENTRY_COMPLETE | TCPIP_DNS_FLAG_ENTRY_NEGATIVE | TCPIP_DNS_FLAG_ENTRY_REFRESH);
     }
     dnsHE->ipTTL.Val = 0;
     dnsHE->resolve_type = type;
@@ -712,7 +812,6 @@ static TCPIP_DNS_RESULT _DNS_Resolve(const char* hostName, TCPIP_DNS_RESOLVE_TYP
     // if a strict interface, we try only on that; otherwise on all
     int retryIfs = (pDnsDcpt->strictNet == 0) ? TCPIP_STACK_NumberOfNetworksGet() : 1;
     dnsHE->nRetries = retryIfs * _TCPIP_DNS_IF_RETRY_COUNT;
-    pDnsDcpt->unsolvedEntries++;
     return _DNS_Send_Query(pDnsDcpt, dnsHE);
 }
 
@@ -737,6 +836,7 @@ static int _DNS_GetAddresses(const char* hostName, int startIndex, IP_MULTI_ADDR
     {
         return 0;
     }
+    dnsHashEntry->lastUse = ++pDnsDcpt->useSeq;
 
     recMask &= (TCPIP_DNS_ADDRESS_REC_MASK)dnsHashEntry->recordMask;
 
@@ -750,7 +850,7 @@ static int _DNS_GetAddresses(const char* hostName, int startIndex, IP_MULTI_ADDR
     {
         pDst4Addr = &pIPAddr->v4Add;
         pSrc4Addr =  dnsHashEntry->pip4Address + startIndex;
-        for(ix = startIndex; ix <= dnsHashEntry->nIPv4Entries && nAddrs < nIPAddresses; ix++, nAddrs++, pDst4Addr++, pSrc4Addr++)
+        for(ix = startIndex; ix < dnsHashEntry->nIPv4Entries && nAddrs < nIPAddresses; ix++, nAddrs++, pDst4Addr++, pSrc4Addr++)
         {
             pDst4Addr->Val = pSrc4Addr->Val;
         }
@@ -759,7 +859,7 @@ static int _DNS_GetAddresses(const char* hostName, int startIndex, IP_MULTI_ADDR
     {   // TCPIP_DNS_ADDRESS_REC_IPV6
         pDst6Addr = &pIPAddr->v6Add;
         pSrc6Addr =  dnsHashEntry->pip6Address + startIndex;
-        for(ix = startIndex; ix <= dnsHashEntry->nIPv6Entries && nAddrs < nIPAddresses; ix++, nAddrs++, pDst6Addr++)
+        for(ix = startIndex; ix < dnsHashEntry->nIPv6Entries && nAddrs < nIPAddresses; ix++, nAddrs++, pDst6Addr++, pSrc6Addr++)
         {
             memcpy(pDst6Addr->v, pSrc6Addr->v, sizeof(*pDst6Addr));
         }
@@ -905,12 +1005,18 @@ static TCPIP_DNS_RESULT  _DNS_IsNameResolved(const char* hostName, IPV4_ADDR* ho
     {
         return TCPIP_DNS_RES_NO_NAME_ENTRY;
     }
+    pDnsHE->lastUse = ++pDnsDcpt->useSeq;
 
     if((pDnsHE->hEntry.flags.value & TCPIP_DNS_FLAG_ENTRY_COMPLETE) == 0)
     {   // unsolved entry   
         return (pDnsHE->hEntry.flags.value & TCPIP_DNS_FLAG_ENTRY_TIMEOUT) == 0 ? TCPIP_DNS_RES_PENDING : TCPIP_DNS_RES_SERVER_TMO; 
     }
 
+    if((pDnsHE->hEntry.flags.value & TCPIP_DNS_FLAG_ENTRY_NEGATIVE) != 0)
+    {   // cached "no such name" answer
+        return TCPIP_DNS_RES_NAME_ERROR;
+    }
+
     // completed entry
     nIPv6Entries = pDnsHE->nIPv6Entries;
     nIPv4Entries = pDnsHE->nIPv4Entries;
@@ -999,16 +1105,9 @@ TCPIP_DNS_RESULT TCPIP_DNS_EntryQuery(TCPIP_DNS_ENTRY_QUERY *pDnsQuery, int quer
 
         if((pBkt->flags.value & TCPIP_DNS_FLAG_ENTRY_COMPLETE) != 0)
         {
-            pDnsQuery->status = TCPIP_DNS_RES_OK;
+            pDnsQuery->status = (pBkt->flags.value & TCPIP_DNS_FLAG_ENTRY_NEGATIVE) == 0 ? TCPIP_DNS_RES_OK : TCPIP_DNS_RES_NAME_ERROR;
             currTime = pDnsDcpt->dnsTime;
-            if(pDnsDcpt->cacheEntryTMO > 0)
-            {
-                pDnsQuery->ttlTime = pDnsDcpt->cacheEntryTMO - (currTime - pE->tInsert);
-            }
-            else
-            {
-                pDnsQuery->ttlTime = pE->ipTTL.Val - (currTime - pE->tInsert);
-            }
+            pDnsQuery->ttlTime = _DNSEntryTimeout(pDnsDcpt, pE) - (currTime - pE->tInsert);
 
             for(ix = 0; ix < pE->nIPv4Entries && ix < pDnsQuery->nIPv4Entries; ix++)
             {
@@ -1215,6 +1314,28 @@ static bool _DNS_NetIsValid(TCPIP_NET_IF* pIf)
 
     return false;
 }
+
+// returns true if at least one interface can carry DNS traffic
+static bool _DNS_AnyNetIsValid(TCPIP_DNS_DCPT* pDnsDcpt)
+{
+    int ix, nIfs;
+
+    if(pDnsDcpt->strictNet != 0)
+    {   // only the strict interface is used
+        return _DNS_NetIsValid(pDnsDcpt->strictNet);
+    }
+
+    nIfs = TCPIP_STACK_NumberOfNetworksGet();
+    for(ix = 0; ix < nIfs; ix++)
+    {
+        if(_DNS_NetIsValid((TCPIP_NET_IF*)TCPIP_STACK_IndexToNet(ix)))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
 // send a signal to the DNS module that data is available
 // no manager alert needed since this normally results as a higher layer (UDP) signal
 static void _DNSSocketRxSignalHandler(UDP_SOCKET hUDP, TCPIP_NET_HANDLE hNet, TCPIP_UDP_SIGNAL_TYPE sigType, const void* param)
@@ -1236,7 +1357,10 @@ static TCPIP_DNS_RESULT _DNS_Send_Query(TCPIP_DNS_DCPT* pDnsDcpt, TCPIP_DNS_HASH
     IPV4_ADDR           dnsServerAdd;
     UDP_SOCKET          dnsSocket = pDnsDcpt->dnsSocket;
     
-    pDnsHE->hEntry.flags.value &= ~TCPIP_DNS_FLAG_ENTRY_COMPLETE;
+    if((pDnsHE->hEntry.flags.value & TCPIP_DNS_FLAG_ENTRY_REFRESH) == 0)
+    {   // a refreshed entry is still solved
+        pDnsHE->hEntry.flags.value &= ~TCPIP_DNS_FLAG_ENTRY_COMPLETE;
+    }
 
     while(true)
     {
@@ -1407,6 +1531,95 @@ TCPIP_DNS_RESULT TCPIP_DNS_RemoveAll(void)
     return TCPIP_DNS_RES_OK;
 }
 
+TCPIP_DNS_RESULT TCPIP_DNS_WatchAdd(const char* hostName)
+{
+    TCPIP_DNS_DCPT        *pDnsDcpt;
+    IPV4_ADDR       ipv4Addr;
+    IPV6_ADDR       ipv6Addr;
+    int             ix, freeIx;
+    TCPIP_DNS_WATCH_ENTRY* pWatch;
+
+    pDnsDcpt = pgDnsDcpt;
+    if(pDnsDcpt == 0 || pDnsDcpt->hashDcpt == 0)
+    {
+        return TCPIP_DNS_RES_NO_SERVICE;
+    }
+
+    if(hostName == 0 || strlen(hostName) == 0 || strlen(hostName)  >= TCPIP_DNS_CLIENT_MAX_HOSTNAME_LEN)
+    {
+        return TCPIP_DNS_RES_INVALID_HOSTNAME; 
+    }
+
+    if(TCPIP_Helper_StringToIPAddress(hostName, &ipv4Addr) || TCPIP_Helper_StringToIPv6Address (hostName, &ipv6Addr))
+    {   // nothing to resolve
+        return  TCPIP_DNS_RES_NAME_IS_IPADDRESS;
+    }
+
+    ix = _DNS_WatchIndex(pDnsDcpt, hostName);
+    if(ix >= 0)
+    {   // already watched; just count the new reference
+        pDnsDcpt->watchList[ix].nRefs++;
+        return TCPIP_DNS_RES_OK;
+    }
+
+    freeIx = -1;
+    for(ix = 0; ix < TCPIP_DNS_CLIENT_WATCH_ENTRIES; ix++)
+    {
+        if(pDnsDcpt->watchList[ix].hostName[0] == 0)
+        {
+            freeIx = ix;
+            break;
+        }
+    }
+
+    if(freeIx < 0)
+    {
+        return TCPIP_DNS_RES_WATCH_FULL;
+    }
+
+    pWatch = pDnsDcpt->watchList + freeIx;
+    strcpy(pWatch->hostName, hostName);
+    pWatch->nRefs = 1;
+    pWatch->nAttempts = 0;
+    pWatch->tRetry = pDnsDcpt->dnsTime;
+
+    if(_DNS_AnyNetIsValid(pDnsDcpt))
+    {   // start now rather than on the next cache tick
+        _DNS_WatchResolve(pDnsDcpt, pWatch);
+    }
+
+    return TCPIP_DNS_RES_OK;
+}
+
+TCPIP_DNS_RESULT TCPIP_DNS_WatchRemove(const char* hostName)
+{
+    TCPIP_DNS_DCPT        *pDnsDcpt;
+    int             ix;
+
+    pDnsDcpt = pgDnsDcpt;
+    if(pDnsDcpt == 0 || pDnsDcpt->hashDcpt == 0)
+    {
+        return TCPIP_DNS_RES_NO_SERVICE;
+    }
+
+    if(hostName == NULL)
+    {
+        return TCPIP_DNS_RES_INVALID_HOSTNAME;
+    }
+
+    ix = _DNS_WatchIndex(pDnsDcpt, hostName);
+    if(ix < 0)
+    {
+        return TCPIP_DNS_RES_NO_NAME_ENTRY;
+    }
+
+    if(--pDnsDcpt->watchList[ix].nRefs == 0)
+    {   // last reference gone
+        pDnsDcpt->watchList[ix].hostName[0] = 0;
+    }
+    return TCPIP_DNS_RES_OK;
+}
+
 void TCPIP_DNS_ClientTask(void)
 {
     TCPIP_MODULE_SIGNAL sigPend;
@@ -1427,6 +1640,9 @@ static void TCPIP_DNS_CacheTimeout(TCPIP_DNS_DCPT* pDnsDcpt)
     OA_HASH_DCPT    *pOH;
     uint32_t        currTime;
     uint32_t        timeout;
+    uint32_t        refreshTmo;
+    int             watchIx;
+    TCPIP_DNS_WATCH_ENTRY* pWatch;
 
     // get current time: seconds
     currTime = pDnsDcpt->dnsTime;
@@ -1441,14 +1657,29 @@ static void TCPIP_DNS_CacheTimeout(TCPIP_DNS_DCPT* pDnsDcpt)
             if((pDnsHE->hEntry.flags.value & TCPIP_DNS_FLAG_ENTRY_COMPLETE) != 0)
             {   // solved entry: check timeout
                 // if cacheEntryTMO is equal to zero, then TTL time is the timeout period. 
-                if((timeout = pDnsDcpt->cacheEntryTMO) == 0)
-                {
-                    timeout = pDnsHE->ipTTL.Val;
-                }
+                timeout = _DNSEntryTimeout(pDnsDcpt, pDnsHE);
                 if((currTime - pDnsHE->tInsert) >= timeout)
                 {
                     _DNS_UpdateExpiredHashEntry_Notify(pDnsDcpt, pDnsHE);
                 }
+                else if((pDnsHE->hEntry.flags.value & TCPIP_DNS_FLAG_ENTRY_REFRESH) != 0)
+                {   // refresh ongoing; the old addresses are used until the entry expires
+                    if((currTime - pDnsHE->tRetry) >= TCPIP_DNS_CLIENT_LOOKUP_RETRY_TMO && pDnsHE->currRetry < pDnsHE->nRetries)
+                    {
+                        pDnsHE->tRetry = currTime;
+                        pDnsHE->currRetry++;
+                        _DNS_Send_Query(pDnsDcpt, pDnsHE);
+                    }
+                }
+                else if((pDnsHE->hEntry.flags.value & TCPIP_DNS_FLAG_ENTRY_NEGATIVE) == 0 && _DNS_WatchIndex(pDnsDcpt, pDnsHE->pHostName) >= 0)
+                {   // watched name: query it again shortly before it expires
+                    // a short lived entry is refreshed half way through
+                    refreshTmo = pDnsDcpt->refreshEntryTMO < timeout ? pDnsDcpt->refreshEntryTMO : timeout / 2;
+                    if(timeout - (currTime - pDnsHE->tInsert) <= refreshTmo)
+                    {
+                        _DNSRefreshHashEntry(pDnsDcpt, pDnsHE);
+                    }
+                }
             }
             else
             {   // unsolved entry
@@ -1478,6 +1709,34 @@ static void TCPIP_DNS_CacheTimeout(TCPIP_DNS_DCPT* pDnsDcpt)
             }
         }
     } 
+
+    // (re)start the resolution of the watched names missing from the cache:
+    // after an interface came up, an expired entry or a failed query
+    // names that keep failing are retried with an increasing delay
+    if(_DNS_AnyNetIsValid(pDnsDcpt))
+    {
+        pWatch = pDnsDcpt->watchList;
+        for(watchIx = 0; watchIx < TCPIP_DNS_CLIENT_WATCH_ENTRIES; watchIx++, pWatch++)
+        {
+            if(pWatch->hostName[0] == 0)
+            {
+                continue;
+            }
+
+            pDnsHE = (TCPIP_DNS_HASH_ENTRY*)TCPIP_OAHASH_EntryLookup(pOH, pWatch->hostName);
+            if(pDnsHE != 0)
+            {
+                if((pDnsHE->hEntry.flags.value & (TCPIP_DNS_FLAG_ENTRY_COMPLETE | TCPIP_DNS_FLAG_ENTRY_NEGATIVE)) == TCPIP_DNS_FLAG_ENTRY_COMPLETE)
+                {   // solved; start over with the shortest delay next time
+                    pWatch->nAttempts = 0;
+                }
+            }
+            else if((int32_t)(currTime - pWatch->tRetry) >= 0)
+            {
+                _DNS_WatchResolve(pDnsDcpt, pWatch);
+            }
+        }
+    }
 }
 
 
@@ -1707,6 +1966,13 @@ static int _DNS_ProcessRR(TCPIP_DNS_DCPT* pDnsDcpt, TCPIP_DNS_RR_PROCESS* pProc,
 
         if(dnsHE != 0)
         {
+            if(rrType == TCPIP_DNS_RR_TYPE_QUESTION && (dnsHE->hEntry.flags.value & TCPIP_DNS_FLAG_ENTRY_REFRESH) != 0)
+            {   // answer to a refresh query: the new records replace the cached ones
+                dnsHE->hEntry.flags.value &= ~(TCPIP_DNS_FLAG_ENTRY_COMPLETE | TCPIP_DNS_FLAG_ENTRY_REFRESH);
+                dnsHE->nIPv4Entries = dnsHE->nIPv6Entries = 0;
+                dnsHE->ipTTL.Val = 0;
+            }
+
             if((dnsHE->hEntry.flags.value & TCPIP_DNS_FLAG_ENTRY_COMPLETE) != 0)
             {
                 evDbgType = TCPIP_DNS_DBG_EVENT_COMPLETE_ERROR;
@@ -1804,9 +2070,17 @@ static bool _DNS_ProcessPacket(TCPIP_DNS_DCPT* pDnsDcpt)
         dnsHE = 0;
         procFail = false;
 
-        if((DNSHeader.Flags.v[0] & 0x03) != 0)
+        if((DNSHeader.Flags.v[0] & 0x0f) != 0)
         {   
             evType = TCPIP_DNS_EVENT_NAME_ERROR;
+            if((DNSHeader.Flags.v[0] & 0x0f) == _TCPIP_DNS_RCODE_NAME_ERROR)
+            {   // match the question to the entry so the answer can be cached
+                _DNS_ProcessRR(pDnsDcpt, &procRR, TCPIP_DNS_RR_TYPE_QUESTION);
+                if(procRR.evDbgType == TCPIP_DNS_DBG_EVENT_NONE)
+                {
+                    dnsHE = procRR.dnsHE;
+                }
+            }
             procFail = true;
             break;
         }
@@ -1855,8 +2129,15 @@ static bool _DNS_ProcessPacket(TCPIP_DNS_DCPT* pDnsDcpt)
             _DNSCompleteHashEntry(pDnsDcpt, dnsHE);
         }
         else if(evType == TCPIP_DNS_EVENT_NAME_ERROR && dnsHE != 0)
-        {   // Remove name if "No Such name"
-            TCPIP_DNS_RemoveEntry(dnsHE->pHostName);
+        {
+            if(pDnsDcpt->negativeEntryTMO != 0)
+            {   // keep the "No Such name" answer
+                _DNSNegativeHashEntry(pDnsDcpt, dnsHE);
+            }
+            else
+            {   // Remove name if "No Such name"
+                TCPIP_DNS_RemoveEntry(dnsHE->pHostName);
+            }
         }
     }
     else if (evDbgType != TCPIP_DNS_DBG_EVENT_NONE)
@@ -2055,17 +2336,23 @@ static size_t TCPIP_DNS_OAHASH_KeyHash(OA_HASH_DCPT* pOH, const void* key)
 }
 
 
+// selects the entry to make room for a new name:
+// an expired entry if there is one, otherwise the least recently used solved entry
+// entries still being resolved and watched names are never replaced
 static OA_HASH_ENTRY* TCPIP_DNS_OAHASH_DeleteEntry(OA_HASH_DCPT* pOH)
 {
     OA_HASH_ENTRY*  pBkt;
     size_t      bktIx;
     TCPIP_DNS_HASH_ENTRY  *pE;
+    TCPIP_DNS_HASH_ENTRY  *pLruE;
     TCPIP_DNS_DCPT        *pDnsDcpt;
     uint32_t        currTime;
-    uint32_t        timeout;
+    uint32_t        age, maxAge;
 
     pDnsDcpt = pgDnsDcpt;
     currTime = pDnsDcpt->dnsTime;
+    pLruE = 0;
+    maxAge = 0;
 
     for(bktIx = 0; bktIx < pOH->hEntries; bktIx++)
     {
@@ -2073,16 +2360,38 @@ static OA_HASH_ENTRY* TCPIP_DNS_OAHASH_DeleteEntry(OA_HASH_DCPT* pOH)
         if(pBkt->flags.busy != 0 && (pBkt->flags.value & TCPIP_DNS_FLAG_ENTRY_COMPLETE) != 0)
         {
             pE = (TCPIP_DNS_HASH_ENTRY*)pBkt;
-            timeout = (pDnsDcpt->cacheEntryTMO > 0) ? pDnsDcpt->cacheEntryTMO : pE->ipTTL.Val;
 
-            if((currTime - pE->tInsert) >= timeout)
+            if((pBkt->flags.value & TCPIP_DNS_FLAG_ENTRY_REFRESH) != 0)
+            {   // query ongoing, counted as unsolved
+                continue;
+            }
+
+            if((currTime - pE->tInsert) >= _DNSEntryTimeout(pDnsDcpt, pE))
             {
-                _DNSNotifyClients(pDnsDcpt, pE, TCPIP_DNS_EVENT_NAME_REMOVED);
-                return pBkt;
+                pLruE = pE;
+                break;
+            }
+
+            if(_DNS_WatchIndex(pDnsDcpt, pE->pHostName) >= 0)
+            {   // watched names stay in the cache
+                continue;
+            }
+
+            age = pDnsDcpt->useSeq - pE->lastUse;
+            if(pLruE == 0 || age > maxAge)
+            {
+                pLruE = pE;
+                maxAge = age;
             }
         }
     }
-    return 0;
+
+    if(pLruE != 0)
+    {
+        _DNSNotifyClients(pDnsDcpt, pLruE, TCPIP_DNS_EVENT_NAME_REMOVED);
+    }
+
+    return (OA_HASH_ENTRY*)pLruE;
 }
 
 
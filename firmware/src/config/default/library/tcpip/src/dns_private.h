@@ -74,10 +74,32 @@ THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
 // this should match the number of DNS servers per interface
 #define _TCPIP_DNS_IF_RETRY_COUNT 2
 
+// DNS header RCODE for a "no such name" answer
+#define _TCPIP_DNS_RCODE_NAME_ERROR     3
+
 // once an entry is unsolved and exhausted its retries
 // it will be removed from the cache
 #define _TCPIP_DNS_CLIENT_CACHE_UNSOLVED_EXPIRE_TMO     1
 
+// number of host names the client keeps solved in the cache
+#if !defined(TCPIP_DNS_CLIENT_WATCH_ENTRIES)
+#define TCPIP_DNS_CLIENT_WATCH_ENTRIES                  8
+#endif
+
+// a watched name missing from the cache is resolved again after a delay
+// that doubles with each attempt that did not solve it, seconds
+#define _TCPIP_DNS_CLIENT_WATCH_RETRY_MIN_TMO           4
+#define _TCPIP_DNS_CLIENT_WATCH_RETRY_MAX_TMO           256
+
+// a host name kept solved in the cache
+typedef struct
+{
+    char        hostName[TCPIP_DNS_CLIENT_MAX_HOSTNAME_LEN];    // empty if the entry is free
+    uint16_t    nRefs;          // number of TCPIP_DNS_WatchAdd calls not yet matched by TCPIP_DNS_WatchRemove
+    uint16_t    nAttempts;      // resolutions started since the name was last solved
+    uint32_t    tRetry;         // time the name may be resolved again, seconds
+}TCPIP_DNS_WATCH_ENTRY;
+
 // a DNS debug event
 typedef enum
 {
@@ -122,6 +144,9 @@ typedef enum
     TCPIP_DNS_FLAG_ENTRY_COMPLETE     = 0x0080,     // regular entry, complete
                                                     // else it's incomplete
     TCPIP_DNS_FLAG_ENTRY_TIMEOUT      = 0x0100,     // entry has timed out
+    TCPIP_DNS_FLAG_ENTRY_NEGATIVE     = 0x0200,     // complete entry caching a "no such name" answer
+    TCPIP_DNS_FLAG_ENTRY_REFRESH      = 0x0400,     // complete entry queried again before it expires
+                                                    // counted as unsolved until the answer arrives
                                                   
 }TCPIP_DNS_HASH_ENTRY_FLAGS;
 
@@ -140,6 +165,7 @@ typedef struct
     uint8_t*                    memblk;         // memory block for IPv4, IPv6 and hostname
     uint32_t                    tInsert;        // one time per hash entry
     uint32_t                    tRetry;         // retry time per hash entry
+    uint32_t                    lastUse;        // use sequence number of the last reference, for LRU replacement
     IPV4_ADDR*                  pip4Address;    // pointer to an array of IPv4: nIPv4Entries entries 
     IPV6_ADDR*                  pip6Address;    // pointer to an array of IPv6: nIPv6Entries entries
     TCPIP_UINT32_VAL            ipTTL;          // Minimum TTL per IPv4 and Ipv6 addresses
@@ -165,11 +191,15 @@ typedef struct
     tcpipSignalHandle       dnsSignalHandle;
     const void              *memH;
     uint32_t                cacheEntryTMO;
+    uint32_t                negativeEntryTMO;               // lifetime of a "no such name" entry, seconds
+    uint32_t                refreshEntryTMO;                // watched entries are queried again this long before they expire, seconds
+    uint32_t                useSeq;                         // incremented on every entry reference
     IP_ADDRESS_TYPE         ipAddressType;
 #if (TCPIP_DNS_CLIENT_USER_NOTIFICATION != 0)
     PROTECTED_SINGLE_LIST   dnsRegisteredUsers;
 #endif  // (TCPIP_DNS_CLIENT_USER_NOTIFICATION != 0)
     uint32_t                dnsTime;                        // coarse DNS time keeping, seconds
+    TCPIP_DNS_WATCH_ENTRY   watchList[TCPIP_DNS_CLIENT_WATCH_ENTRIES];  // names kept solved in the cache
     // unaligned members
     uint16_t                nIPv4Entries;
     uint16_t                nIPv6Entries;
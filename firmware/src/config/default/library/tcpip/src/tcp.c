@@ -67,12 +67,20 @@ THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
 #define TCP_OPTIONS_END_OF_LIST     (0x00u)		// End of List TCP Option Flag
 #define TCP_OPTIONS_NO_OP           (0x01u)		// No Op TCP Option
 #define TCP_OPTIONS_MAX_SEG_SIZE    (0x02u)		// Maximum segment size TCP flag
+#define TCP_OPTIONS_WND_SCALE       (0x03u)		// Window scale TCP option, RFC 7323
+#define TCP_OPTIONS_SACK_PERMITTED  (0x04u)		// SACK permitted TCP option, RFC 2018
+#define TCP_OPTIONS_SACK            (0x05u)		// SACK TCP option, RFC 2018
+
+// TCP options parsed out of a received segment
 typedef struct
 {
-	uint8_t        Kind;							// Type of option
-	uint8_t        Length;							// Length
-	TCPIP_UINT16_VAL    MaxSegSize;						// Maximum segment size
-} TCP_OPTIONS;									// TCP Options data structure							
+    uint16_t        maxSegSize;                         // MSS option value; 0 if not present
+    uint8_t         wndScale;                           // window scale shift
+    uint8_t         wndScaleRcvd;                       // window scale option present
+    uint8_t         sackPermitted;                      // SACK permitted option present
+    uint8_t         nSackBlocks;                        // number of valid sackBlock entries
+    TCP_SEQ_RANGE   sackBlock[TCP_SACK_MAX_BLOCKS];     // SACK option blocks
+} TCP_RX_OPTIONS;
 
 // Indicates if this packet is a retransmission (no reset) or a new packet (reset required)
 #define SENDTCP_RESET_TIMERS	0x01
@@ -248,6 +256,40 @@ static bool         _TCPNeedSend(TCB_STUB* pSkt);
 
 static void         _TCPSetHalfFlushFlag(TCB_STUB* pSkt);
 
+static bool         _TcpSeqRangeAdd(TCP_SEQ_RANGE* pRange, uint16_t* pCount, uint16_t maxCount, uint32_t startSeq, uint32_t endSeq, uint32_t* pDropBytes);
+
+static void         _TcpOooRangeDrain(TCB_STUB* pSkt);
+
+static void         _TcpOptionsParse(TCP_HEADER* h, TCP_RX_OPTIONS* pOpt);
+
+static void         _TcpSynOptionsProcess(TCB_STUB* pSkt, TCP_HEADER* h);
+
+static uint16_t     _TcpSynOptionsSet(TCB_STUB* pSkt, uint8_t* pOpt, uint16_t mss, bool isSynAck);
+
+static uint16_t     _TcpSackOptionSet(TCB_STUB* pSkt, uint8_t* pOpt);
+
+static void         _TcpCcStart(TCB_STUB* pSkt);
+
+static uint32_t     _TcpUnackedBytes(TCB_STUB* pSkt);
+
+static uint32_t     _TcpSendLimit(TCB_STUB* pSkt);
+
+static uint32_t     _TcpRtoTicks(TCB_STUB* pSkt);
+
+static void         _TcpRttSample(TCB_STUB* pSkt, uint32_t rttMs);
+
+static void         _TcpSackUpdate(TCB_STUB* pSkt, TCP_HEADER* h, uint32_t sndUna);
+
+static void         _TcpNewAckRcvd(TCB_STUB* pSkt, uint32_t ackedBytes, uint32_t ackNumber);
+
+static void         _TcpDupAckRcvd(TCB_STUB* pSkt);
+
+static void         _TcpRtoExpired(TCB_STUB* pSkt);
+
+static void         _TcpSackRetransmit(TCB_STUB* pSkt);
+
+static uint16_t     _TcpRetransmitSegment(TCB_STUB* pSkt, uint32_t seq, uint16_t maxLen);
+
 static bool         _TCPSetSourceAddress(TCB_STUB* pSkt, IP_ADDRESS_TYPE addType, IP_MULTI_ADDRESS* localAddress)
 {
     if(localAddress == 0)
@@ -1426,8 +1468,8 @@ static TCP_V4_PACKET* _TcpAllocateTxPacket(TCB_STUB* pSkt, IP_ADDRESS_TYPE addTy
     // allocate IPv4 packet
     allocFlags = TCPIP_MAC_PKT_FLAG_IPV4 | TCPIP_MAC_PKT_FLAG_SPLIT | TCPIP_MAC_PKT_FLAG_TX | TCPIP_MAC_PKT_FLAG_TCP;
     // allocate from main packet pool
-    // make sure there's enough room for TCP_OPTIONS
-    pv4Pkt = (TCP_V4_PACKET*)TCPIP_PKT_SocketAlloc(sizeof(TCP_V4_PACKET), sizeof(TCP_HEADER), sizeof(TCP_OPTIONS), allocFlags);
+    // make sure there's enough room for the TCP options
+    pv4Pkt = (TCP_V4_PACKET*)TCPIP_PKT_SocketAlloc(sizeof(TCP_V4_PACKET), sizeof(TCP_HEADER), TCP_OPTIONS_MAX_SIZE, allocFlags);
 
     if(pv4Pkt)
     {   // lazy linking of the data segments, when needed
@@ -2110,7 +2152,7 @@ static _TCP_SEND_RES _TcpDisconnect(TCB_STUB* pSkt, bool signalFIN)
                 do
                 {   
                     sendRes = _TcpSend(pSkt, tcpFlags, SENDTCP_RESET_TIMERS);
-                    if(sendRes < 0 || pSkt->remoteWindow == 0u)
+                    if(sendRes < 0 || _TcpSendLimit(pSkt) == 0u)
                         break;
                 } while(pSkt->txHead != pSkt->txUnackedTail);
             }
@@ -2327,6 +2369,18 @@ bool TCPIP_TCP_SocketInfoGet(TCP_SOCKET hTCP, TCP_SOCKET_INFO* remoteInfo)
     remoteInfo->rxPending = _TCPIsGetReady(pSkt);
     remoteInfo->txPending = TCPIP_TCP_FifoTxFullGet(hTCP);
     remoteInfo->flags = _TCP_SktFlagsGet(pSkt);
+    remoteInfo->rxOooBytes = pSkt->oooRxBytes;
+    remoteInfo->rxOooDiscardBytes = pSkt->oooDiscardBytes;
+    remoteInfo->ccAlgorithm = pSkt->pCcOps == TCPIP_TCP_CcOpsGet(TCP_CC_CUBIC) ? TCP_CC_CUBIC : TCP_CC_NEWRENO;
+    remoteInfo->cwnd = pSkt->cc.cwnd;
+    remoteInfo->ssthresh = pSkt->cc.ssthresh;
+    remoteInfo->srtt = pSkt->srtt >> 3;
+    remoteInfo->rttVar = pSkt->rttVar >> 2;
+    remoteInfo->txRetransmits = pSkt->txRetransmits;
+    remoteInfo->txFastRecoveries = pSkt->txFastRecoveries;
+    remoteInfo->txTimeouts = pSkt->txTimeouts;
+    remoteInfo->sndWndScale = pSkt->sndWndScale;
+    remoteInfo->sackPermitted = pSkt->ccFlags.sackOk != 0;
 
 	return true;
 }
@@ -2514,9 +2568,10 @@ bool TCPIP_TCP_Flush(TCP_SOCKET hTCP)
 
 static bool _TcpFlush(TCB_STUB* pSkt)
 {
-    if(pSkt->txHead != pSkt->txUnackedTail && pSkt->remoteWindow != 0)
-    {   // The check remoteWindow != 0 stops us sending lots of
+    if(pSkt->txHead != pSkt->txUnackedTail && _TcpSendLimit(pSkt) != 0)
+    {   // The check for a non zero window stops us sending lots of
         // ACKs with len == 0, when the other host is slow
+        // or the congestion window is full
         // Send the TCP segment with all unacked bytes
         return _TcpSend(pSkt, ACK, SENDTCP_RESET_TIMERS) == 0;
     }
@@ -2698,7 +2753,7 @@ static bool _TCPNeedSend(TCB_STUB* pSkt)
 
     if(pSkt->txHead != pSkt->txUnackedTail)
     {   // something to send
-        uint16_t toSendData, canSend;
+        uint32_t toSendData, canSend, sendLimit;
 
         // check how much we can send
         if(pSkt->txHead > pSkt->txUnackedTail)
@@ -2710,15 +2765,21 @@ static bool _TCPNeedSend(TCB_STUB* pSkt)
             toSendData = (pSkt->txEnd - pSkt->txUnackedTail) + (pSkt->txHead - pSkt->txStart);
         }
 
-        if(toSendData > pSkt->remoteWindow)
+        sendLimit = _TcpSendLimit(pSkt);
+        if(toSendData > sendLimit)
         {
-            canSend = pSkt->remoteWindow;
+            canSend = sendLimit;
         }
         else
         {
             canSend = toSendData;
         }
 
+        if(canSend == 0)
+        {   // the remote or the congestion window is full
+            return false;
+        }
+
         if(canSend >= pSkt->wRemoteMSS || canSend >= (pSkt->maxRemoteWindow >> 1))
         {
             return true;
@@ -3711,6 +3772,11 @@ static void TCPIP_TCP_Tick(void)
                     if(pSkt->txUnackedTail < pSkt->txTail)
                         w += pSkt->txEnd - pSkt->txStart;
 
+                    if(w != 0)
+                    {   // data lost: restart from a single segment window
+                        _TcpRtoExpired(pSkt);
+                    }
+
                     // Perform roll back of local SEQuence counter, remote window 
                     // adjustment, and cause all unacknowledged data to be 
                     // retransmitted by moving the unacked tail pointer.
@@ -3851,8 +3917,9 @@ static TCPIP_MAC_PKT_ACK_RES TCPIP_TCP_ProcessIPv6(TCPIP_MAC_PACKET* pRxPkt)
   ***************************************************************************/
 static _TCP_SEND_RES _TcpSend(TCB_STUB* pSkt, uint8_t vTCPFlags, uint8_t vSendFlags)
 {
-    TCP_OPTIONS     options;
-    uint32_t 		len, lenStart, lenEnd;
+    uint8_t         options[TCP_OPTIONS_MAX_SIZE];
+    uint16_t        optLen;
+    uint32_t 		len, lenStart, lenEnd, sendLimit;
     uint16_t 		loadLen, hdrLen, maxPayload;
     void*           pSendPkt;
     uint16_t 		mss = 0;
@@ -3933,6 +4000,7 @@ static _TCP_SEND_RES _TcpSend(TCB_STUB* pSkt, uint8_t vTCPFlags, uint8_t vSendFl
 #endif  // defined (TCPIP_STACK_USE_IPV4)
 
         header->DataOffset.Val = 0;
+        optLen = 0;
 
         // Put all socket application data in the TX space
         if(vTCPFlags & (SYN | RST))
@@ -3940,13 +4008,9 @@ static _TCP_SEND_RES _TcpSend(TCB_STUB* pSkt, uint8_t vTCPFlags, uint8_t vSendFl
             // Don't put any data in SYN and RST messages
             len = 0;
 
-            // Insert the MSS (Maximum Segment Size) TCP option if this is SYN packet
+            // Insert the MSS (Maximum Segment Size), window scale and SACK permitted TCP options if this is SYN packet
             if(vTCPFlags & SYN)
             {
-                options.Kind = TCP_OPTIONS_MAX_SEG_SIZE;
-                options.Length = 0x04;
-
-                // Load MSS and swap to big endian
 #if defined (TCPIP_STACK_USE_IPV6)
                 if(pSkt->addType == IP_ADDRESS_TYPE_IPV6)
                 {
@@ -3970,33 +4034,13 @@ static _TCP_SEND_RES _TcpSend(TCB_STUB* pSkt, uint8_t vTCPFlags, uint8_t vSendFl
                 }
 #endif  // defined (TCPIP_STACK_USE_IPV4)
 
-                options.MaxSegSize.Val = (((mss)&0x00FF)<<8) | (((mss)&0xFF00)>>8);
                 pSkt->localMSS = mss;
-
-                header->DataOffset.Val   += sizeof(options) >> 2;
-
-#if defined (TCPIP_STACK_USE_IPV6)
-                if(pSkt->addType == IP_ADDRESS_TYPE_IPV6)
-                {
-                    if (TCPIP_IPV6_TxIsPutReady((IPV6_PACKET*)pSendPkt, sizeof (options)) < sizeof (options))
-                    {
-                        sendRes = _TCP_SEND_NO_MEMORY;
-                        break;
-                    }
-                    TCPIP_IPV6_PutArray((IPV6_PACKET*)pSendPkt, (uint8_t*)&options, sizeof(options));
-                }
-#endif  // defined (TCPIP_STACK_USE_IPV6)
-
-#if defined (TCPIP_STACK_USE_IPV4)
-                if(pSkt->addType == IP_ADDRESS_TYPE_IPV4)
-                {
-                    memcpy(header + 1, &options, sizeof(options));
-                }
-#endif  // defined (TCPIP_STACK_USE_IPV4)
+                optLen = _TcpSynOptionsSet(pSkt, options, mss, (vTCPFlags & ACK) != 0);
 
                 if(pSkt->MySEQ == 0)
                 {   // Set Initial Sequence Number (ISN)
                     pSkt->MySEQ = _TCP_SktSetSequenceNo(pSkt);
+                    pSkt->sndMax = pSkt->MySEQ;
                 }
             }
         }
@@ -4004,6 +4048,12 @@ static _TCP_SEND_RES _TcpSend(TCB_STUB* pSkt, uint8_t vTCPFlags, uint8_t vSendFl
         {
             // Begin copying any application data over to the TX space
             maxPayload = pSkt->wRemoteMSS;
+            if((vTCPFlags & ACK) != 0 && pSkt->addType == IP_ADDRESS_TYPE_IPV4)
+            {   // report the out-of-order data we hold; the options take room from the payload
+                optLen = _TcpSackOptionSet(pSkt, options);
+            }
+
+            sendLimit = _TcpSendLimit(pSkt);
             if(pSkt->txHead == pSkt->txUnackedTail)
             {
                 // All caught up on data TX, no real data for this packet
@@ -4033,13 +4083,14 @@ static _TCP_SEND_RES _TcpSend(TCB_STUB* pSkt, uint8_t vTCPFlags, uint8_t vSendFl
                         maxPayload = pSkt->localMSS;
                     }
                 }
+                maxPayload -= optLen;
 
                 if(pSkt->txHead > pSkt->txUnackedTail)
                 {
                     len = pSkt->txHead - pSkt->txUnackedTail;
-                    if(len > pSkt->remoteWindow)
+                    if(len > sendLimit)
                     {
-                        len = pSkt->remoteWindow;
+                        len = sendLimit;
                     }
 
                     if(len > maxPayload)
@@ -4057,8 +4108,8 @@ static _TCP_SEND_RES _TcpSend(TCB_STUB* pSkt, uint8_t vTCPFlags, uint8_t vSendFl
                     lenEnd = pSkt->txEnd - pSkt->txUnackedTail;
                     len = lenEnd + pSkt->txHead - pSkt->txStart;
 
-                    if(len > pSkt->remoteWindow)
-                        len = pSkt->remoteWindow;
+                    if(len > sendLimit)
+                        len = sendLimit;
 
                     if(len > maxPayload)
                     {
@@ -4091,15 +4142,40 @@ static _TCP_SEND_RES _TcpSend(TCB_STUB* pSkt, uint8_t vTCPFlags, uint8_t vSendFl
             }
 
             // If we are to transmit a FIN, make sure we can put one in this packet
-            if(pSkt->Flags.bTXFIN)
+            // A single segment retransmission never carries it
+            if(pSkt->Flags.bTXFIN && pSkt->ccFlags.rtxOne == 0)
             {
-                if((len != pSkt->remoteWindow) && (len != maxPayload))
+                if((len != pSkt->remoteWindow) && (len != maxPayload) && (pSkt->txUnackedTail == pSkt->txHead))
                 {
                     vTCPFlags |= FIN;
                 }
             }
         }
 
+        if(optLen != 0)
+        {
+            header->DataOffset.Val += optLen >> 2;
+
+#if defined (TCPIP_STACK_USE_IPV6)
+            if(pSkt->addType == IP_ADDRESS_TYPE_IPV6)
+            {
+                if (TCPIP_IPV6_TxIsPutReady((IPV6_PACKET*)pSendPkt, optLen) < optLen)
+                {
+                    sendRes = _TCP_SEND_NO_MEMORY;
+                    break;
+                }
+                TCPIP_IPV6_PutArray((IPV6_PACKET*)pSendPkt, options, optLen);
+            }
+#endif  // defined (TCPIP_STACK_USE_IPV6)
+
+#if defined (TCPIP_STACK_USE_IPV4)
+            if(pSkt->addType == IP_ADDRESS_TYPE_IPV4)
+            {
+                memcpy(header + 1, options, optLen);
+            }
+#endif  // defined (TCPIP_STACK_USE_IPV4)
+        }
+
     loadLen = (uint16_t)len;  // save the TCP payload size
 
         // Ensure that all packets with data of some kind are 
@@ -4116,12 +4192,25 @@ static _TCP_SEND_RES _TcpSend(TCB_STUB* pSkt, uint8_t vTCPFlags, uint8_t vSendFl
             if(len)
             {
                 vTCPFlags |= PSH;
+
+                if((int32_t)(pSkt->MySEQ - pSkt->sndMax) < 0)
+                {   // this data was sent before
+                    // the ACK won't tell which copy arrived, stop timing (Karn)
+                    pSkt->txRetransmits++;
+                    pSkt->ccFlags.rttActive = 0;
+                }
+                else if(pSkt->ccFlags.rttActive == 0)
+                {   // time this segment
+                    pSkt->rttSeq = pSkt->MySEQ + len;
+                    pSkt->rttStartTime = SYS_TMR_TickCountGet();
+                    pSkt->ccFlags.rttActive = 1;
+                }
             }
 
             if(vSendFlags & SENDTCP_RESET_TIMERS)
             {
                 pSkt->retryCount = 0;
-                pSkt->retryInterval = (TCPIP_TCP_START_TIMEOUT_VAL * SYS_TMR_TickCounterFrequencyGet())/1000;
+                pSkt->retryInterval = _TcpRtoTicks(pSkt);
             }	
 
             pSkt->eventTime = SYS_TMR_TickCountGet() + pSkt->retryInterval;
@@ -4169,9 +4258,9 @@ static _TCP_SEND_RES _TcpSend(TCB_STUB* pSkt, uint8_t vTCPFlags, uint8_t vSendFl
         // Update our send sequence number and ensure retransmissions 
         // of SYNs and FINs use the right sequence number
         pSkt->MySEQ += (uint32_t)len;
+        hdrLen = optLen;
         if(vTCPFlags & SYN)
         {
-            hdrLen = sizeof(options);
 
             // SEG.ACK needs to be zero for the first SYN packet for compatibility 
             // with certain paranoid TCP/IP stacks, even though the ACK flag isn't 
@@ -4191,9 +4280,10 @@ static _TCP_SEND_RES _TcpSend(TCB_STUB* pSkt, uint8_t vTCPFlags, uint8_t vSendFl
                 pSkt->flags.bSYNSent = 1;
             }
         }
-        else
+
+        if((int32_t)(pSkt->MySEQ - pSkt->sndMax) > 0)
         {
-            hdrLen = 0;
+            pSkt->sndMax = pSkt->MySEQ;
         }
 
         if(vTCPFlags & FIN)
@@ -4216,6 +4306,7 @@ static _TCP_SEND_RES _TcpSend(TCB_STUB* pSkt, uint8_t vTCPFlags, uint8_t vSendFl
             header->Window = pSkt->rxTail - pSkt->rxHead - 1;
         }
         pSkt->localWindow = header->Window; // store the last advertised window
+        // Note: the RX FIFO is below 64 KB, the window is always announced with a 0 scale shift
 
         _TcpSwapHeader(header);
 
@@ -4490,6 +4581,8 @@ static void _TcpSocketInitialize(TCB_STUB* pSkt, TCP_SOCKET hTCP, uint8_t* txBuf
     // option is received from remote node)
     pSkt->wRemoteMSS = TCP_MIN_DEFAULT_MTU;
 
+    pSkt->ccAlg = TCPIP_TCP_CONGESTION_CONTROL;
+
     TCBStubs[hTCP] = pSkt;  // store it
     
 }
@@ -4520,12 +4613,19 @@ static void _TcpSocketSetIdleState(TCB_STUB* pSkt)
 	pSkt->flags.bFINSent = 0;
     pSkt->flags.seqInc = 0;
 	pSkt->flags.bSYNSent = 0;
-	pSkt->flags.bRXNoneACKed1 = 0;
-	pSkt->flags.bRXNoneACKed2 = 0;
     pSkt->MySEQ = 0;
-	pSkt->sHoleSize = -1;
+    pSkt->oooCount = 0;
+    pSkt->oooRxBytes = 0;
+    pSkt->oooDiscardBytes = 0;
+    pSkt->oooLastSeq = 0;
 	pSkt->remoteWindow = 1;
     pSkt->maxRemoteWindow = 1;
+    pSkt->sndAdvWindow = 1;
+    pSkt->sndWndScale = 0;
+    pSkt->ccFlags.wndScaleRcvd = 0;
+    pSkt->ccFlags.sackPermRcvd = 0;
+    pSkt->ccFlags.sackOk = 0;
+    _TcpCcStart(pSkt);
 
 
     // Note : no result of the explicit binding is maintained!
@@ -4672,98 +4772,239 @@ static void _TcpCloseSocket(TCB_STUB* pSkt, TCPIP_TCP_SIGNAL_TYPE tcpEvent)
 }
 
 
+static __inline__ uint32_t __attribute__((always_inline)) _TcpOptGetUint32(const uint8_t* p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+static __inline__ void __attribute__((always_inline)) _TcpOptSetUint32(uint8_t* p, uint32_t val)
+{
+    p[0] = (uint8_t)(val >> 24);
+    p[1] = (uint8_t)(val >> 16);
+    p[2] = (uint8_t)(val >> 8);
+    p[3] = (uint8_t)val;
+}
+
 /*****************************************************************************
   Function:
-	static uint16_t _GetMaxSegSizeOption(TCP_HEADER* h)
+	static void _TcpOptionsParse(TCP_HEADER* h, TCP_RX_OPTIONS* pOpt)
 
   Summary:
-	Obtains the Maximum Segment Size (MSS) TCP Option out of the TCP header 
-	for the current socket.
+	Extracts the TCP options of a received segment.
 
   Description:
-	Parses the current TCP packet header and extracts the Maximum Segment Size 
-	option.  
+	Parses the options of the TCP header and stores the ones the stack uses:
+    Maximum Segment Size, window scale, SACK permitted and SACK.
 
   Precondition:
 	Must be called while a TCP packet is present and being processed via 
-	_TcpHandleSeg() and only if the the TCP SYN flag is set.
+	_TcpHandleSeg().
 
   Parameters:
 	h - pointer to the TCP header
+    pOpt - address to store the options
 
   Returns:
-	Maximum segment size option value.  If illegal or not present, a failsafe 
-	value of TCP_MIN_DEFAULT_MTU is returned.  If the option is larger than the 
-	TCPIP_TCP_MAX_SEG_SIZE_TX upper limit, then TCPIP_TCP_MAX_SEG_SIZE_TX is returned.
+	None
 
   Remarks:
-	The internal MAC Read Pointer is moved but not restored.
+	A malformed option ends the parsing.
+    The options parsed up to that point are kept.
   ***************************************************************************/
-static uint16_t _GetMaxSegSizeOption(TCP_HEADER* h)
+static void _TcpOptionsParse(TCP_HEADER* h, TCP_RX_OPTIONS* pOpt)
 {
-    uint8_t vOptionsBytes;
-    uint8_t vOption;
-    uint16_t wMSS;
     uint8_t* pOption, *pEnd;
+    uint8_t kind, optLen;
+    int ix, nBlocks;
 
+    memset(pOpt, 0, sizeof(*pOpt));
 
-	vOptionsBytes = (h->DataOffset.Val << 2) - sizeof(*h);
-    // Return minimum default Maximum Segment Size value if no options present
-    if(vOptionsBytes == 0u)
-        return TCP_MIN_DEFAULT_MTU;
-
-    // Seek to beginning of options
     pOption = (uint8_t*)(h + 1);
-    pEnd = pOption + vOptionsBytes;
+    pEnd = (uint8_t*)h + (h->DataOffset.Val << 2);
 
-    // Search for the Maximum Segment Size option	
-    while(vOptionsBytes-- && pOption < pEnd)
+    while(pOption < pEnd)
     {
-        vOption = *pOption++;
-
-        if(vOption == 0u)	// End of Options list
+        kind = *pOption;
+        if(kind == TCP_OPTIONS_END_OF_LIST)
+        {
             break;
+        }
 
-        if(vOption == 1u)	// NOP option
+        if(kind == TCP_OPTIONS_NO_OP)
+        {
+            pOption++;
             continue;
+        }
 
-        if(vOption == 2u)	// Maximum Segment Size option
+        // multi byte option: kind, length, data
+        if(pEnd - pOption < 2)
         {
-            if(vOptionsBytes < 3u)
-                break;
+            break;
+        }
+        optLen = pOption[1];
+        if(optLen < 2 || optLen > pEnd - pOption)
+        {
+            break;
+        }
 
-            wMSS = 0;
+        switch(kind)
+        {
+            case TCP_OPTIONS_MAX_SEG_SIZE:
+                if(optLen == 4)
+                {
+                    pOpt->maxSegSize = ((uint16_t)pOption[2] << 8) | pOption[3];
+                }
+                break;
 
-            // Get option length
-            vOption = *pOption++;
-            if(vOption == 4u)
-            {// Retrieve MSS and swap value to little endian
-                ((uint8_t*)&wMSS)[1] = *pOption++;
-                ((uint8_t*)&wMSS)[0] = *pOption++;
-            }
+            case TCP_OPTIONS_WND_SCALE:
+                if(optLen == 3)
+                {
+                    pOpt->wndScaleRcvd = 1;
+                    pOpt->wndScale = pOption[2] > TCP_WND_SCALE_MAX ? TCP_WND_SCALE_MAX : pOption[2];
+                }
+                break;
 
-            if(wMSS < TCP_MIN_DEFAULT_MTU)
+            case TCP_OPTIONS_SACK_PERMITTED:
+                if(optLen == 2)
+                {
+                    pOpt->sackPermitted = 1;
+                }
                 break;
-            if(wMSS > TCPIP_TCP_MAX_SEG_SIZE_TX)
-                return TCPIP_TCP_MAX_SEG_SIZE_TX;
-            else 
-                return wMSS;
-        }
-        else
-        { // Assume this is a multi byte option and throw it way
-            if(vOptionsBytes < 2u)
+
+            case TCP_OPTIONS_SACK:
+                nBlocks = (optLen - 2) / 8;
+                if(nBlocks > TCP_SACK_MAX_BLOCKS)
+                {
+                    nBlocks = TCP_SACK_MAX_BLOCKS;
+                }
+                for(ix = 0; ix < nBlocks; ix++)
+                {
+                    pOpt->sackBlock[ix].startSeq = _TcpOptGetUint32(pOption + 2 + ix * 8);
+                    pOpt->sackBlock[ix].endSeq = _TcpOptGetUint32(pOption + 6 + ix * 8);
+                }
+                pOpt->nSackBlocks = nBlocks;
                 break;
-            vOption = *pOption++;
-            if(vOptionsBytes < vOption)
+
+            default:
                 break;
-            pOption += vOption;
-            vOptionsBytes -= vOption;
         }
 
+        pOption += optLen;
+    }
+}
+
+// processes the options of a received SYN:
+// sets the remote MSS and records the window scale and SACK permitted options
+// a missing or illegal MSS uses the failsafe TCP_MIN_DEFAULT_MTU value
+static void _TcpSynOptionsProcess(TCB_STUB* pSkt, TCP_HEADER* h)
+{
+    TCP_RX_OPTIONS rxOpt;
+
+    _TcpOptionsParse(h, &rxOpt);
+
+    if(rxOpt.maxSegSize < TCP_MIN_DEFAULT_MTU)
+    {
+        pSkt->wRemoteMSS = TCP_MIN_DEFAULT_MTU;
+    }
+    else if(rxOpt.maxSegSize > TCPIP_TCP_MAX_SEG_SIZE_TX)
+    {
+        pSkt->wRemoteMSS = TCPIP_TCP_MAX_SEG_SIZE_TX;
+    }
+    else
+    {
+        pSkt->wRemoteMSS = rxOpt.maxSegSize;
+    }
+
+    // we always offer both options, so what the remote party sent is what's in use
+    pSkt->ccFlags.wndScaleRcvd = rxOpt.wndScaleRcvd;
+    pSkt->ccFlags.sackPermRcvd = rxOpt.sackPermitted;
+    pSkt->ccFlags.sackOk = rxOpt.sackPermitted;
+    pSkt->sndWndScale = rxOpt.wndScaleRcvd ? rxOpt.wndScale : 0;
+}
+
+// builds the options of a SYN into pOpt; returns their size, a multiple of 4
+// a SYN offers window scaling and SACK
+// a SYN + ACK includes them only if the remote SYN offered them
+// both parties need to offer an option for it to be used
+static uint16_t _TcpSynOptionsSet(TCB_STUB* pSkt, uint8_t* pOpt, uint16_t mss, bool isSynAck)
+{
+    uint16_t optLen = 0;
+
+    pOpt[optLen++] = TCP_OPTIONS_MAX_SEG_SIZE;
+    pOpt[optLen++] = 4;
+    pOpt[optLen++] = (uint8_t)(mss >> 8);
+    pOpt[optLen++] = (uint8_t)mss;
+
+    if(!isSynAck || pSkt->ccFlags.wndScaleRcvd)
+    {   // the RX FIFO is below 64 KB: our own shift is 0
+        pOpt[optLen++] = TCP_OPTIONS_NO_OP;
+        pOpt[optLen++] = TCP_OPTIONS_WND_SCALE;
+        pOpt[optLen++] = 3;
+        pOpt[optLen++] = 0;
+    }
+
+    if(!isSynAck || pSkt->ccFlags.sackPermRcvd)
+    {
+        pOpt[optLen++] = TCP_OPTIONS_NO_OP;
+        pOpt[optLen++] = TCP_OPTIONS_NO_OP;
+        pOpt[optLen++] = TCP_OPTIONS_SACK_PERMITTED;
+        pOpt[optLen++] = 2;
+    }
+
+    return optLen;
+}
+
+// builds a SACK option with the out-of-order ranges held in the RX FIFO
+// the range holding the most recent out-of-order segment goes first, RFC 2018
+// the other ones follow in sequence order
+// returns its size, a multiple of 4; 0 if there's nothing to report
+static uint16_t _TcpSackOptionSet(TCB_STUB* pSkt, uint8_t* pOpt)
+{
+    int ix, nBlocks, lastIx;
+    uint16_t optLen;
+    TCP_SEQ_RANGE* pRange;
+
+    if(pSkt->ccFlags.sackOk == 0 || pSkt->oooCount == 0)
+    {
+        return 0;
+    }
+
+    nBlocks = pSkt->oooCount < TCP_SACK_MAX_BLOCKS ? pSkt->oooCount : TCP_SACK_MAX_BLOCKS;
+
+    pOpt[0] = TCP_OPTIONS_NO_OP;
+    pOpt[1] = TCP_OPTIONS_NO_OP;
+    pOpt[2] = TCP_OPTIONS_SACK;
+    pOpt[3] = 2 + nBlocks * 8;
+    optLen = 4;
+
+    lastIx = -1;
+    for(ix = 0; ix < pSkt->oooCount; ix++)
+    {
+        pRange = pSkt->oooRange + ix;
+        if((int32_t)(pSkt->oooLastSeq - pRange->startSeq) >= 0 && (int32_t)(pSkt->oooLastSeq - pRange->endSeq) < 0)
+        {
+            lastIx = ix;
+            _TcpOptSetUint32(pOpt + optLen, pRange->startSeq);
+            _TcpOptSetUint32(pOpt + optLen + 4, pRange->endSeq);
+            optLen += 8;
+            nBlocks--;
+            break;
+        }
+    }
+
+    for(ix = 0; ix < pSkt->oooCount && nBlocks != 0; ix++)
+    {
+        if(ix == lastIx)
+        {
+            continue;
+        }
+        _TcpOptSetUint32(pOpt + optLen, pSkt->oooRange[ix].startSeq);
+        _TcpOptSetUint32(pOpt + optLen + 4, pSkt->oooRange[ix].endSeq);
+        optLen += 8;
+        nBlocks--;
     }
 
-    // Did not find MSS option, return worst case default
-    return TCP_MIN_DEFAULT_MTU;
+    return optLen;
 }
 
 static void _TCPSetHalfFlushFlag(TCB_STUB* pSkt)
@@ -4791,6 +5032,446 @@ static void _TCPSetHalfFlushFlag(TCB_STUB* pSkt)
     pSkt->flags.halfThresFlush = clrFlushFlag ? 0 : 1;
 }
 
+// adds [startSeq, endSeq) to a sorted list of sequence ranges:
+// the out-of-order data just copied past rxHead
+// or TX data the remote party selectively acknowledged
+// merges it with the ranges it overlaps or touches
+// if the list is full, the range with the highest sequence numbers is dropped
+// and its size added to *pDropBytes
+// returns false if the new range itself is the highest and could not be kept
+static bool _TcpSeqRangeAdd(TCP_SEQ_RANGE* pRangeList, uint16_t* pCount, uint16_t maxCount, uint32_t startSeq, uint32_t endSeq, uint32_t* pDropBytes)
+{
+    int ix, jx;
+    TCP_SEQ_RANGE* pRange;
+
+    // find the first range that does not end before the new data
+    for(ix = 0; ix < *pCount; ix++)
+    {
+        if((int32_t)(pRangeList[ix].endSeq - startSeq) >= 0)
+        {
+            break;
+        }
+    }
+
+    // extend the new range over all the ranges it reaches
+    for(jx = ix; jx < *pCount; jx++)
+    {
+        pRange = pRangeList + jx;
+        if((int32_t)(pRange->startSeq - endSeq) > 0)
+        {   // there's a hole before this one
+            break;
+        }
+
+        if((int32_t)(pRange->startSeq - startSeq) < 0)
+        {
+            startSeq = pRange->startSeq;
+        }
+        if((int32_t)(pRange->endSeq - endSeq) > 0)
+        {
+            endSeq = pRange->endSeq;
+        }
+    }
+
+    if(jx == ix)
+    {   // nothing merged; a new range is inserted at ix
+        if(*pCount == maxCount)
+        {
+            if(ix == maxCount)
+            {
+                return false;
+            }
+
+            pRange = pRangeList + maxCount - 1;
+            *pDropBytes += pRange->endSeq - pRange->startSeq;
+            (*pCount)--;
+        }
+
+        memmove(pRangeList + ix + 1, pRangeList + ix, (*pCount - ix) * sizeof(TCP_SEQ_RANGE));
+        (*pCount)++;
+    }
+    else if(jx - ix > 1)
+    {   // several ranges merged into one
+        memmove(pRangeList + ix + 1, pRangeList + jx, (*pCount - jx) * sizeof(TCP_SEQ_RANGE));
+        *pCount -= jx - ix - 1;
+    }
+
+    pRangeList[ix].startSeq = startSeq;
+    pRangeList[ix].endSeq = endSeq;
+
+    return true;
+}
+
+// advances RemoteSEQ and rxHead over the out-of-order ranges
+// that in-order data has now reached
+static void _TcpOooRangeDrain(TCB_STUB* pSkt)
+{
+    int ix;
+    uint32_t advance;
+    TCP_SEQ_RANGE* pRange;
+
+    for(ix = 0; ix < pSkt->oooCount; ix++)
+    {
+        pRange = pSkt->oooRange + ix;
+        if((int32_t)(pRange->startSeq - pSkt->RemoteSEQ) > 0)
+        {   // still a hole before this one
+            break;
+        }
+
+        if((int32_t)(pRange->endSeq - pSkt->RemoteSEQ) > 0)
+        {
+            advance = pRange->endSeq - pSkt->RemoteSEQ;
+            pSkt->RemoteSEQ += advance;
+            pSkt->rxHead += advance;
+            if(pSkt->rxHead > pSkt->rxEnd)
+            {
+                pSkt->rxHead -= pSkt->rxEnd - pSkt->rxStart + 1;
+            }
+        }
+    }
+
+    if(ix != 0)
+    {
+        memmove(pSkt->oooRange, pSkt->oooRange + ix, (pSkt->oooCount - ix) * sizeof(TCP_SEQ_RANGE));
+        pSkt->oooCount -= ix;
+    }
+}
+
+// current time, ms
+static __inline__ uint32_t __attribute__((always_inline)) _TcpMsecCount(void)
+{
+    return (uint32_t)(((uint64_t)SYS_TMR_TickCountGet() * 1000) / SYS_TMR_TickCounterFrequencyGet());
+}
+
+// starts the congestion control of a connection
+// called once the remote MSS is known
+static void _TcpCcStart(TCB_STUB* pSkt)
+{
+    pSkt->pCcOps = TCPIP_TCP_CcOpsGet((TCP_CC_ALGORITHM)pSkt->ccAlg);
+    (*pSkt->pCcOps->init)(&pSkt->cc, pSkt->wRemoteMSS);
+
+    pSkt->srtt = 0;
+    pSkt->rttVar = 0;
+    pSkt->txRetransmits = 0;
+    pSkt->txFastRecoveries = 0;
+    pSkt->txTimeouts = 0;
+    pSkt->sackCount = 0;
+    pSkt->dupAckCount = 0;
+    pSkt->ccFlags.inRecovery = 0;
+    pSkt->ccFlags.rttActive = 0;
+    pSkt->ccFlags.rtxOne = 0;
+}
+
+// returns the number of bytes sent but not acknowledged
+static uint32_t _TcpUnackedBytes(TCB_STUB* pSkt)
+{
+    int32_t unacked = pSkt->txUnackedTail - pSkt->txTail;
+
+    if(unacked < 0)
+    {
+        unacked += pSkt->txEnd - pSkt->txStart;
+    }
+
+    return (uint32_t)unacked;
+}
+
+// returns how much data the socket can send now:
+// the remote window, limited by the room left in the congestion window
+static uint32_t _TcpSendLimit(TCB_STUB* pSkt)
+{
+    int ix;
+    uint32_t pipe, sacked, cwndAvail;
+
+    if(pSkt->ccFlags.rtxOne)
+    {   // single segment retransmission of data the windows already allowed
+        return pSkt->rtxLen;
+    }
+
+    // the data still in the network:
+    // sent and not acknowledged, less what the remote party selectively acknowledged
+    pipe = _TcpUnackedBytes(pSkt);
+    for(ix = 0; ix < pSkt->sackCount; ix++)
+    {
+        sacked = pSkt->sackRange[ix].endSeq - pSkt->sackRange[ix].startSeq;
+        pipe = pipe > sacked ? pipe - sacked : 0;
+    }
+
+    cwndAvail = pSkt->cc.cwnd > pipe ? pSkt->cc.cwnd - pipe : 0;
+
+    return cwndAvail < pSkt->remoteWindow ? cwndAvail : pSkt->remoteWindow;
+}
+
+// returns the retransmission timeout, in ticks, RFC 6298
+// TCPIP_TCP_START_TIMEOUT_VAL is used until the round trip time is measured
+static uint32_t _TcpRtoTicks(TCB_STUB* pSkt)
+{
+    uint32_t rtoMs;
+
+    if(pSkt->srtt == 0)
+    {
+        rtoMs = TCPIP_TCP_START_TIMEOUT_VAL;
+    }
+    else
+    {   // SRTT + 4 * RTTVAR
+        rtoMs = (pSkt->srtt >> 3) + pSkt->rttVar;
+        if(rtoMs < TCP_RTO_MIN_MS)
+        {
+            rtoMs = TCP_RTO_MIN_MS;
+        }
+        else if(rtoMs > TCP_RTO_MAX_MS)
+        {
+            rtoMs = TCP_RTO_MAX_MS;
+        }
+    }
+
+    return (uint32_t)(((uint64_t)rtoMs * SYS_TMR_TickCounterFrequencyGet()) / 1000);
+}
+
+// updates the smoothed round trip time and its variation with a new measurement, RFC 6298
+// srtt is kept as ms << 3, rttVar as ms << 2
+static void _TcpRttSample(TCB_STUB* pSkt, uint32_t rttMs)
+{
+    int32_t err;
+
+    if(rttMs == 0)
+    {
+        rttMs = 1;
+    }
+
+    if(pSkt->srtt == 0)
+    {   // first measurement
+        pSkt->srtt = rttMs << 3;
+        pSkt->rttVar = rttMs << 1;
+    }
+    else
+    {   // SRTT = 7/8 SRTT + 1/8 R; RTTVAR = 3/4 RTTVAR + 1/4 |SRTT - R|
+        err = (int32_t)rttMs - (int32_t)(pSkt->srtt >> 3);
+        pSkt->srtt += err;
+        if(err < 0)
+        {
+            err = -err;
+        }
+        pSkt->rttVar += err - (int32_t)(pSkt->rttVar >> 2);
+    }
+}
+
+// records the SACK blocks of a received acknowledge
+// and removes the data acknowledged up to sndUna from the SACK scoreboard
+static void _TcpSackUpdate(TCB_STUB* pSkt, TCP_HEADER* h, uint32_t sndUna)
+{
+    int ix;
+    uint32_t dropBytes = 0;
+    TCP_SEQ_RANGE* pBlock;
+    TCP_RX_OPTIONS rxOpt;
+
+    if(h->DataOffset.Val > TCP_DATA_OFFSET_VAL_MIN)
+    {
+        _TcpOptionsParse(h, &rxOpt);
+        for(ix = 0; ix < rxOpt.nSackBlocks; ix++)
+        {   // only blocks of data sent and not yet acknowledged are valid
+            pBlock = rxOpt.sackBlock + ix;
+            if((int32_t)(pBlock->endSeq - pBlock->startSeq) > 0 && (int32_t)(pBlock->startSeq - sndUna) >= 0 && (int32_t)(pBlock->endSeq - pSkt->sndMax) <= 0)
+            {
+                _TcpSeqRangeAdd(pSkt->sackRange, &pSkt->sackCount, TCP_SACK_MAX_BLOCKS, pBlock->startSeq, pBlock->endSeq, &dropBytes);
+            }
+        }
+    }
+
+    for(ix = 0; ix < pSkt->sackCount; ix++)
+    {
+        if((int32_t)(pSkt->sackRange[ix].endSeq - sndUna) > 0)
+        {
+            break;
+        }
+    }
+
+    if(ix != 0)
+    {
+        memmove(pSkt->sackRange, pSkt->sackRange + ix, (pSkt->sackCount - ix) * sizeof(TCP_SEQ_RANGE));
+        pSkt->sackCount -= ix;
+    }
+}
+
+// new data acknowledged:
+// ends the round trip time measurement, advances the fast recovery
+// or grows the congestion window
+static void _TcpNewAckRcvd(TCB_STUB* pSkt, uint32_t ackedBytes, uint32_t ackNumber)
+{
+    pSkt->dupAckCount = 0;
+
+    if(pSkt->ccFlags.rttActive && (int32_t)(ackNumber - pSkt->rttSeq) >= 0)
+    {
+        pSkt->ccFlags.rttActive = 0;
+        _TcpRttSample(pSkt, ((SYS_TMR_TickCountGet() - pSkt->rttStartTime) * 1000) / SYS_TMR_TickCounterFrequencyGet());
+    }
+
+    if(pSkt->ccFlags.inRecovery)
+    {
+        if((int32_t)(ackNumber - pSkt->recoverSeq) >= 0)
+        {   // all the data outstanding at the loss is acknowledged: recovery done
+            pSkt->ccFlags.inRecovery = 0;
+            pSkt->cc.cwnd = pSkt->cc.ssthresh;
+        }
+        else if(pSkt->ccFlags.sackOk)
+        {   // partial acknowledge: repair the next hole
+            _TcpSackRetransmit(pSkt);
+        }
+        else
+        {   // partial acknowledge: the segment at ackNumber was lost too, RFC 6582
+            // deflate the window by the data acknowledged, add back one segment
+            pSkt->cc.cwnd = pSkt->cc.cwnd > ackedBytes ? pSkt->cc.cwnd - ackedBytes : 0;
+            pSkt->cc.cwnd += pSkt->cc.mss;
+            _TcpRetransmitSegment(pSkt, ackNumber, pSkt->cc.mss);
+        }
+        return;
+    }
+
+    (*pSkt->pCcOps->ackRcvd)(&pSkt->cc, ackedBytes, _TcpMsecCount(), pSkt->srtt >> 3);
+}
+
+// duplicate acknowledge received
+// the TCP_DUP_ACK_THRESHOLD one starts a fast retransmit and recovery, RFC 5681, RFC 6582
+// a SACK connection retransmits the holes the remote party reports, RFC 6675
+static void _TcpDupAckRcvd(TCB_STUB* pSkt)
+{
+    uint32_t sndUna;
+
+    if(pSkt->ccFlags.inRecovery)
+    {
+        if(pSkt->ccFlags.sackOk)
+        {
+            _TcpSackRetransmit(pSkt);
+        }
+        else
+        {   // another segment left the network
+            pSkt->cc.cwnd += pSkt->cc.mss;
+        }
+        return;
+    }
+
+    if(++pSkt->dupAckCount < TCP_DUP_ACK_THRESHOLD)
+    {
+        return;
+    }
+
+    sndUna = pSkt->MySEQ - _TcpUnackedBytes(pSkt);
+    (*pSkt->pCcOps->lossEvent)(&pSkt->cc, pSkt->sndMax - sndUna, _TcpMsecCount());
+
+    pSkt->ccFlags.inRecovery = 1;
+    pSkt->ccFlags.rttActive = 0;
+    pSkt->recoverSeq = pSkt->sndMax;
+    pSkt->txFastRecoveries++;
+    if(pSkt->ccFlags.sackOk == 0)
+    {   // the segments that triggered the duplicates left the network
+        pSkt->cc.cwnd += TCP_DUP_ACK_THRESHOLD * pSkt->cc.mss;
+    }
+
+    pSkt->rtxNextSeq = sndUna + _TcpRetransmitSegment(pSkt, sndUna, pSkt->cc.mss);
+}
+
+// retransmission timeout: collapses the congestion window
+// the caller then rolls back and sends again all the unacknowledged data
+static void _TcpRtoExpired(TCB_STUB* pSkt)
+{
+    uint32_t sndUna = pSkt->MySEQ - _TcpUnackedBytes(pSkt);
+
+    (*pSkt->pCcOps->timeout)(&pSkt->cc, pSkt->sndMax - sndUna);
+
+    pSkt->txTimeouts++;
+    pSkt->dupAckCount = 0;
+    pSkt->sackCount = 0;
+    pSkt->ccFlags.inRecovery = 0;
+    pSkt->ccFlags.rttActive = 0;
+}
+
+// retransmits the first hole at or past rtxNextSeq
+// that the remote party did not selectively acknowledge
+// with no SACK information, the data at the first unacknowledged byte is retransmitted
+static void _TcpSackRetransmit(TCB_STUB* pSkt)
+{
+    int ix;
+    uint32_t seq, sndUna, holeLen;
+    TCP_SEQ_RANGE* pRange;
+
+    sndUna = pSkt->MySEQ - _TcpUnackedBytes(pSkt);
+    seq = pSkt->rtxNextSeq;
+    if((int32_t)(seq - sndUna) < 0)
+    {
+        seq = sndUna;
+    }
+
+    for(ix = 0; ix < pSkt->sackCount; ix++)
+    {
+        pRange = pSkt->sackRange + ix;
+        if((int32_t)(seq - pRange->startSeq) < 0)
+        {   // hole [seq, startSeq)
+            holeLen = pRange->startSeq - seq;
+            if(holeLen > pSkt->cc.mss)
+            {
+                holeLen = pSkt->cc.mss;
+            }
+            pSkt->rtxNextSeq = seq + _TcpRetransmitSegment(pSkt, seq, holeLen);
+            return;
+        }
+
+        if((int32_t)(seq - pRange->endSeq) < 0)
+        {
+            seq = pRange->endSeq;
+        }
+    }
+
+    if(pSkt->sackCount == 0 && seq == sndUna)
+    {
+        pSkt->rtxNextSeq = seq + _TcpRetransmitSegment(pSkt, seq, pSkt->cc.mss);
+    }
+}
+
+// retransmits in a single segment up to maxLen bytes of the data sent starting at seq
+// the TX state is restored afterwards, new data continues where it was
+// returns the number of bytes retransmitted
+static uint16_t _TcpRetransmitSegment(TCB_STUB* pSkt, uint32_t seq, uint16_t maxLen)
+{
+    uint32_t unacked, offset;
+    uint32_t saveSeq, saveWindow;
+    uint8_t* saveUnackedTail;
+    uint16_t rtxLen;
+
+    unacked = _TcpUnackedBytes(pSkt);
+    offset = seq - (pSkt->MySEQ - unacked);
+    if(offset >= unacked || maxLen == 0)
+    {   // not sent or already acknowledged
+        return 0;
+    }
+
+    if(maxLen > unacked - offset)
+    {
+        maxLen = unacked - offset;
+    }
+
+    saveSeq = pSkt->MySEQ;
+    saveWindow = pSkt->remoteWindow;
+    saveUnackedTail = pSkt->txUnackedTail;
+
+    pSkt->txUnackedTail = pSkt->txTail + offset;
+    if(pSkt->txUnackedTail >= pSkt->txEnd)
+    {
+        pSkt->txUnackedTail -= pSkt->txEnd - pSkt->txStart;
+    }
+    pSkt->MySEQ = seq;
+    pSkt->rtxLen = maxLen;
+    pSkt->ccFlags.rtxOne = 1;
+
+    _TcpSend(pSkt, ACK, 0);
+
+    pSkt->ccFlags.rtxOne = 0;
+    rtxLen = (uint16_t)(pSkt->MySEQ - seq);
+
+    pSkt->MySEQ = saveSeq;
+    pSkt->remoteWindow = saveWindow;
+    pSkt->txUnackedTail = saveUnackedTail;
+
+    return rtxLen;
+}
+
 
 /*****************************************************************************
   Function:
@@ -4833,7 +5514,8 @@ static void _TcpHandleSeg(TCB_STUB* pSkt, TCP_HEADER* h, uint16_t tcpLen, TCPIP_
     uint32_t localSeqNumber;
     uint16_t len, wSegmentLength;
     bool bSegmentAcceptable;
-    uint16_t wNewWindow;
+    bool bAckNow;
+    uint32_t wNewWindow, sndWindow;
     uint8_t* pSegSrc;
     uint16_t nCopiedBytes;
     uint8_t* newRxHead;
@@ -4843,6 +5525,7 @@ static void _TcpHandleSeg(TCB_STUB* pSkt, TCP_HEADER* h, uint16_t tcpLen, TCPIP_
     localHeaderFlags = h->Flags.byte;
     localAckNumber = h->AckNumber;
     localSeqNumber = h->SeqNumber;
+    bAckNow = false;
 
     // We received a packet, reset the keep alive timer and count
     if(pSkt->Flags.keepAlive)
@@ -4886,8 +5569,9 @@ static void _TcpHandleSeg(TCB_STUB* pSkt, TCP_HEADER* h, uint16_t tcpLen, TCPIP_
                 // We now have a sequence number for the remote node
                 pSkt->RemoteSEQ = localSeqNumber + 1;
 
-                // Set MSS option
-                pSkt->wRemoteMSS = _GetMaxSegSizeOption(h);
+                // Set MSS, window scale and SACK options
+                _TcpSynOptionsProcess(pSkt, h);
+                _TcpCcStart(pSkt);
                 _TCPSetHalfFlushFlag(pSkt);
 
                 // Respond with SYN + ACK
@@ -4944,10 +5628,11 @@ static void _TcpHandleSeg(TCB_STUB* pSkt, TCP_HEADER* h, uint16_t tcpLen, TCPIP_
             {
                 // We now have an initial sequence number and window size
                 pSkt->RemoteSEQ = localSeqNumber + 1;
-                pSkt->remoteWindow = pSkt->maxRemoteWindow = h->Window;
+                pSkt->remoteWindow = pSkt->maxRemoteWindow = pSkt->sndAdvWindow = h->Window;
 
-                // Set MSS option
-                pSkt->wRemoteMSS = _GetMaxSegSizeOption(h);
+                // Set MSS, window scale and SACK options
+                _TcpSynOptionsProcess(pSkt, h);
+                _TcpCcStart(pSkt);
                 _TCPSetHalfFlushFlag(pSkt);
 
                 if(localHeaderFlags & ACK)
@@ -5156,10 +5841,15 @@ static void _TcpHandleSeg(TCB_STUB* pSkt, TCP_HEADER* h, uint16_t tcpLen, TCPIP_
 
             // Calcluate how many bytes were ACKed with this packet
             dwTemp = localAckNumber - dwTemp;
+
+            // Update the SACK scoreboard before any retransmission decision
+            if(pSkt->ccFlags.sackOk)
+            {
+                _TcpSackUpdate(pSkt, h, (int32_t)dwTemp > 0 ? localAckNumber : localAckNumber - dwTemp);
+            }
+
             if(((int32_t)(dwTemp) > 0) && (dwTemp <= pSkt->txEnd - pSkt->txStart))
             {
-                pSkt->flags.bRXNoneACKed1 = 0;
-                pSkt->flags.bRXNoneACKed2 = 0;
                 pSkt->Flags.bHalfFullFlush = false;
 
                 // Bytes ACKed, free up the TX FIFO space
@@ -5195,29 +5885,17 @@ static void _TcpHandleSeg(TCB_STUB* pSkt, TCP_HEADER* h, uint16_t tcpLen, TCPIP_
                 {
                     *pSktEvent |= TCPIP_TCP_SIGNAL_TX_SPACE; 
                 }
+
+                _TcpNewAckRcvd(pSkt, dwTemp, localAckNumber);
             }
-            else
-            {   // no acknowledge
+            else if(dwTemp == 0 && tcpLen == 0 && (localHeaderFlags & (SYN | FIN)) == 0 &&
+                    ((uint32_t)h->Window << pSkt->sndWndScale) == pSkt->sndAdvWindow)
+            {   // duplicate acknowledge: RFC 5681 also needs the advertised window unchanged,
+                // a window update carrying the same ACK is not a loss signal
                 // See if we have outstanding TX data that is waiting for an ACK
                 if(pSkt->txTail != pSkt->txUnackedTail)
                 {
-                    if(pSkt->flags.bRXNoneACKed1)
-                    {
-                        if(pSkt->flags.bRXNoneACKed2)
-                        {
-                            // Set up to perform a fast retransmission
-                            // Roll back unacknowledged TX tail pointer to cause retransmit to occur
-                            pSkt->MySEQ -= (pSkt->txUnackedTail - pSkt->txTail);
-                            if(pSkt->txUnackedTail < pSkt->txTail)
-                            {
-                                pSkt->MySEQ -= (pSkt->txEnd - pSkt->txStart);
-                            }
-                            pSkt->txUnackedTail = pSkt->txTail;
-                            pSkt->Flags.bTXASAPWithoutTimerReset = 1;
-                        }
-                        pSkt->flags.bRXNoneACKed2 = 1;
-                    }
-                    pSkt->flags.bRXNoneACKed1 = 1;
+                    _TcpDupAckRcvd(pSkt);
                 }
             }
 
@@ -5246,14 +5924,22 @@ static void _TcpHandleSeg(TCB_STUB* pSkt, TCP_HEADER* h, uint16_t tcpLen, TCPIP_
             }
 
             // update the max window
-            if(h->Window > pSkt->maxRemoteWindow)
+            // the window of a non SYN segment is scaled
+            sndWindow = (uint32_t)h->Window << pSkt->sndWndScale;
+            if(sndWindow > pSkt->maxRemoteWindow)
             {
-                pSkt->maxRemoteWindow = h->Window;
+                pSkt->maxRemoteWindow = sndWindow;
             }
+            pSkt->sndAdvWindow = sndWindow;
             // The window size advertised in this packet is adjusted to account 
             // for any bytes that we have transmitted but haven't been ACKed yet 
             // by this segment.
-            wNewWindow = h->Window - ((uint16_t)(pSkt->MySEQ - localAckNumber));
+            dwTemp = pSkt->MySEQ - localAckNumber;
+            if((int32_t)dwTemp < 0)
+            {
+                dwTemp = 0;
+            }
+            wNewWindow = sndWindow > dwTemp ? sndWindow - dwTemp : 0;
 
             // Update the local stored copy of the RemoteWindow.
             // If previously we had a zero window, and now we don't, then 
@@ -5264,6 +5950,12 @@ static void _TcpHandleSeg(TCB_STUB* pSkt, TCP_HEADER* h, uint16_t tcpLen, TCPIP_
             }
             pSkt->remoteWindow = wNewWindow;
 
+            // Acknowledges clock out the data the congestion window held back
+            if(_TCPNeedSend(pSkt))
+            {
+                pSkt->Flags.bTXASAP = 1;
+            }
+
             // A couple of states must do all of the TCPIP_TCP_STATE_ESTABLISHED stuff, but also a little more
             if(pSkt->smState == TCPIP_TCP_STATE_FIN_WAIT_1)
             {
@@ -5370,27 +6062,11 @@ static void _TcpHandleSeg(TCB_STUB* pSkt, TCP_HEADER* h, uint16_t tcpLen, TCPIP_
                     *pSktEvent |= TCPIP_TCP_SIGNAL_RX_DATA;
                 }
 
-                // See if we have a hole and other data waiting already in the RX FIFO
-                if(pSkt->sHoleSize != -1)
+                // See if we filled a hole in front of data already waiting in the RX FIFO
+                if(pSkt->oooCount != 0)
                 {
-                    pSkt->sHoleSize -= len;
-                    wTemp = pSkt->wFutureDataSize + pSkt->sHoleSize;
-
-                    // See if we just closed up a hole, and if so, advance head pointer
-                    if((int32_t)wTemp < 0)
-                    {
-                        pSkt->sHoleSize = -1;
-                    }
-                    else if(pSkt->sHoleSize <= 0)
-                    {
-                        pSkt->RemoteSEQ += wTemp;
-                        pSkt->rxHead += wTemp;
-                        if(pSkt->rxHead > pSkt->rxEnd)
-                        {
-                            pSkt->rxHead -= pSkt->rxEnd - pSkt->rxStart + 1;							
-                        }
-                        pSkt->sHoleSize = -1;
-                    }
+                    _TcpOooRangeDrain(pSkt);
+                    bAckNow = true;     // let the remote party know the hole is repaired
                 }
             }
         } 
@@ -5426,42 +6102,20 @@ static void _TcpHandleSeg(TCB_STUB* pSkt, TCP_HEADER* h, uint16_t tcpLen, TCPIP_
                 nCopiedBytes = TCPIP_Helper_PacketCopy(pRxPkt, pSkt->rxHead + wMissingBytes, &pSegSrc, len, true);
             }
 
-            if(nCopiedBytes == len)
-            {
-                // Record the hole is here
-                if(pSkt->sHoleSize == -1)
+            if(nCopiedBytes == len && len != 0)
+            {   // record the range; it's drained once the holes before it are filled
+                if(_TcpSeqRangeAdd(pSkt->oooRange, &pSkt->oooCount, TCP_OOO_MAX_RANGES, pSkt->RemoteSEQ + wMissingBytes, pSkt->RemoteSEQ + wMissingBytes + len, &pSkt->oooDiscardBytes))
                 {
-                    pSkt->sHoleSize = wMissingBytes;
-                    pSkt->wFutureDataSize = len;
+                    pSkt->oooRxBytes += len;
+                    pSkt->oooLastSeq = pSkt->RemoteSEQ + wMissingBytes;
                 }
                 else
                 {
-                    // We already have a hole, see if we can shrink the hole 
-                    // or extend the future data size
-                    if(wMissingBytes < (uint32_t)pSkt->sHoleSize)
-                    {
-                        if((wMissingBytes + len > (uint32_t)pSkt->sHoleSize + pSkt->wFutureDataSize) || (wMissingBytes + len < (uint32_t)pSkt->sHoleSize))
-                        {
-                            pSkt->wFutureDataSize = len;
-                        }
-                        else
-                        {
-                            pSkt->wFutureDataSize = (uint32_t)pSkt->sHoleSize + pSkt->wFutureDataSize - wMissingBytes;
-                        }
-                        pSkt->sHoleSize = wMissingBytes;
-                    }
-                    else if(wMissingBytes + len > (uint32_t)pSkt->sHoleSize + pSkt->wFutureDataSize)
-                    {
-                        // Make sure that there isn't a second hole between 
-                        // our future data and this TCP segment's future data
-                        if(wMissingBytes <= (uint32_t)pSkt->sHoleSize + pSkt->wFutureDataSize)
-                        {
-                            pSkt->wFutureDataSize += wMissingBytes + len - (uint32_t)pSkt->sHoleSize - pSkt->wFutureDataSize;
-                        }
-                    }
-
+                    pSkt->oooDiscardBytes += len;
                 }
             }
+            // a duplicate ACK right away lets the remote party detect the loss
+            bAckNow = true;
         }
     }
 
@@ -5482,7 +6136,7 @@ static void _TcpHandleSeg(TCB_STUB* pSkt, TCP_HEADER* h, uint16_t tcpLen, TCPIP_
             pSkt->rxTail = pSkt->rxHead;
         }
 
-        if(pSkt->Flags.bOneSegmentReceived)
+        if(pSkt->Flags.bOneSegmentReceived || bAckNow)
         {
             _TcpSend(pSkt, ACK, SENDTCP_RESET_TIMERS);
             // bOneSegmentReceived is cleared in _TcpSend(pSkt, ), so no need here
@@ -5684,6 +6338,7 @@ bool TCPIP_TCP_FifoSizeAdjust(TCP_SOCKET hTCP, uint16_t wMinRXSize, uint16_t wMi
 {
     uint16_t    oldTxSize, pendTxEnd, pendTxBeg, txUnackOffs;
     uint16_t    oldRxSize, avlblRxEnd, avlblRxBeg;
+    uint16_t    oooRxSize;
     uint16_t    diffChange;
     uint8_t     *newTxBuff, *newRxBuff;
     bool        adjustFail;
@@ -5852,6 +6507,7 @@ bool TCPIP_TCP_FifoSizeAdjust(TCP_SOCKET hTCP, uint16_t wMinRXSize, uint16_t wMi
     // process the RX data
     // assume no copy, discard 
     avlblRxEnd = avlblRxBeg = 0;
+    oooRxSize = 0;
     while(adjustFail != true && newRxBuff != 0)
     {
         if((vFlags & TCP_ADJUST_PRESERVE_RX) != 0)
@@ -5861,10 +6517,11 @@ bool TCPIP_TCP_FifoSizeAdjust(TCP_SOCKET hTCP, uint16_t wMinRXSize, uint16_t wMi
 
             rxHead = pSkt->rxHead;
 
-            // preserve out-of-order pending data
-            if(pSkt->sHoleSize != -1)
+            // preserve out-of-order pending data, up to the end of the last range
+            if(pSkt->oooCount != 0)
             {
-                rxHead += pSkt->sHoleSize + pSkt->wFutureDataSize;
+                oooRxSize = pSkt->oooRange[pSkt->oooCount - 1].endSeq - pSkt->RemoteSEQ;
+                rxHead += oooRxSize;
                 if(rxHead > pSkt->rxEnd)
                 {
                     rxHead -= pSkt->rxEnd - pSkt->rxStart + 1;
@@ -5935,7 +6592,12 @@ bool TCPIP_TCP_FifoSizeAdjust(TCP_SOCKET hTCP, uint16_t wMinRXSize, uint16_t wMi
         pSkt->rxStart = newRxBuff;
         pSkt->rxEnd = newRxBuff + wMinRXSize;
         pSkt->rxTail = pSkt->rxStart;
-        pSkt->rxHead = pSkt->rxStart + (avlblRxEnd + avlblRxBeg);
+        // the out-of-order data stays past rxHead; the ranges are sequence based so they remain valid
+        pSkt->rxHead = pSkt->rxStart + (avlblRxEnd + avlblRxBeg) - oooRxSize;
+        if((vFlags & TCP_ADJUST_PRESERVE_RX) == 0)
+        {
+            pSkt->oooCount = 0;
+        }
     }
 
     // Send a window update to notify remote node of change
@@ -6307,6 +6969,14 @@ bool TCPIP_TCP_OptionsSet(TCP_SOCKET hTCP, TCP_SOCKET_OPTION option, void* optPa
             case TCP_OPTION_TOS:
                 pSkt->tos = (uint8_t)(unsigned int)optParam;
                 return true;
+
+            case TCP_OPTION_CONGESTION_CONTROL:
+                if((TCP_CC_ALGORITHM)(unsigned int)optParam != TCP_CC_NEWRENO && (TCP_CC_ALGORITHM)(unsigned int)optParam != TCP_CC_CUBIC)
+                {
+                    return false;
+                }
+                pSkt->ccAlg = (uint8_t)(unsigned int)optParam;
+                return true;
                 
             default:
                 return false;   // not supported option
@@ -6369,6 +7039,10 @@ bool TCPIP_TCP_OptionsGet(TCP_SOCKET hTCP, TCP_SOCKET_OPTION option, void* optPa
              case TCP_OPTION_TOS:
                 *(uint8_t*)optParam = pSkt->tos;
                 return true;
+
+            case TCP_OPTION_CONGESTION_CONTROL:
+                *(TCP_CC_ALGORITHM*)optParam = (TCP_CC_ALGORITHM)pSkt->ccAlg;
+                return true;
                 
             default:
                 return false;   // not supported option
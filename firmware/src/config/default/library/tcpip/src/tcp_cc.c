@@ -0,0 +1,337 @@
+/*******************************************************************************
+  Transmission Control Protocol (TCP) Congestion Control
+
+  Summary:
+    Module for Microchip TCP/IP Stack
+
+  Description:
+    -Provides the congestion control algorithms used by the TCP sockets
+    -Reference: RFC 5681, RFC 6582, RFC 6928, RFC 8312
+*******************************************************************************/
+
+/*****************************************************************************
+ Copyright (C) 2012-2020 Microchip Technology Inc. and its subsidiaries.
+
+Microchip Technology Inc. and its subsidiaries.
+
+Subject to your compliance with these terms, you may use Microchip software
+and any derivatives exclusively with Microchip products. It is your
+responsibility to comply with third party license terms applicable to your
+use of third party software (including open source software) that may
+accompany Microchip software.
+
+THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY IMPLIED
+WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS FOR A PARTICULAR
+PURPOSE.
+
+IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS
+BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO THE
+FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN
+ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*****************************************************************************/
+
+
+
+
+
+
+
+
+#define TCPIP_THIS_MODULE_ID    TCPIP_MODULE_TCP
+
+#include "tcpip/src/tcpip_private.h"
+#include "tcpip/src/tcp_private.h"
+
+#if defined(TCPIP_STACK_USE_TCP)
+
+
+// initial window, RFC 6928: min(10 * MSS, max(2 * MSS, 14600))
+#define TCP_CC_INIT_SEGMENTS        (10)
+#define TCP_CC_INIT_WINDOW_BYTES    (14600)
+
+// the congestion window is never grown past the largest window the remote party can announce
+#define TCP_CC_MAX_WINDOW           (0xffffUL << TCP_WND_SCALE_MAX)
+
+// CUBIC constants, RFC 8312
+// C = 0.4, beta = 0.7
+// the NewReno friendly window grows with 3 * (1 - beta) / (1 + beta) ~= 9/17 segments per RTT
+#define TCP_CUBIC_BETA_NUM          (7)
+#define TCP_CUBIC_BETA_DEN          (10)
+#define TCP_CUBIC_RENO_ALPHA_NUM    (9)
+#define TCP_CUBIC_RENO_ALPHA_DEN    (17)
+
+// the time from the origin point used in the cubic function is limited to this, ms
+// keeps the cube of it in 64 bits
+#define TCP_CUBIC_MAX_DELTA_MS      (60000)
+
+
+static void     _TcpCcInitWindow(TCP_CC_STATE* pCc, uint16_t mss);
+static void     _TcpCcSlowStart(TCP_CC_STATE* pCc, uint32_t ackedBytes);
+static uint32_t _TcpCcMinThres(TCP_CC_STATE* pCc, uint32_t thres);
+
+static void     _TcpNewRenoInit(TCP_CC_STATE* pCc, uint16_t mss);
+static void     _TcpNewRenoAckRcvd(TCP_CC_STATE* pCc, uint32_t ackedBytes, uint32_t nowMs, uint32_t srttMs);
+static void     _TcpNewRenoLossEvent(TCP_CC_STATE* pCc, uint32_t flightSize, uint32_t nowMs);
+static void     _TcpNewRenoTimeout(TCP_CC_STATE* pCc, uint32_t flightSize);
+
+static void     _TcpCubicInit(TCP_CC_STATE* pCc, uint16_t mss);
+static void     _TcpCubicAckRcvd(TCP_CC_STATE* pCc, uint32_t ackedBytes, uint32_t nowMs, uint32_t srttMs);
+static void     _TcpCubicLossEvent(TCP_CC_STATE* pCc, uint32_t flightSize, uint32_t nowMs);
+static void     _TcpCubicTimeout(TCP_CC_STATE* pCc, uint32_t flightSize);
+static uint32_t _TcpCubicRoot(uint64_t val);
+
+
+static const TCP_CC_OPS _tcpNewRenoOps =
+{
+    _TcpNewRenoInit,
+    _TcpNewRenoAckRcvd,
+    _TcpNewRenoLossEvent,
+    _TcpNewRenoTimeout,
+};
+
+static const TCP_CC_OPS _tcpCubicOps =
+{
+    _TcpCubicInit,
+    _TcpCubicAckRcvd,
+    _TcpCubicLossEvent,
+    _TcpCubicTimeout,
+};
+
+
+const TCP_CC_OPS* TCPIP_TCP_CcOpsGet(TCP_CC_ALGORITHM alg)
+{
+    switch(alg)
+    {
+        case TCP_CC_NEWRENO:
+            return &_tcpNewRenoOps;
+
+        case TCP_CC_CUBIC:
+            return &_tcpCubicOps;
+
+        default:
+            return TCPIP_TCP_CcOpsGet(TCPIP_TCP_CONGESTION_CONTROL);
+    }
+}
+
+// common helpers
+
+static void _TcpCcInitWindow(TCP_CC_STATE* pCc, uint16_t mss)
+{
+    uint32_t initWnd;
+
+    memset(pCc, 0, sizeof(*pCc));
+    pCc->mss = mss;
+
+    initWnd = 2 * (uint32_t)mss;
+    if(initWnd < TCP_CC_INIT_WINDOW_BYTES)
+    {
+        initWnd = TCP_CC_INIT_WINDOW_BYTES;
+    }
+    if(initWnd > TCP_CC_INIT_SEGMENTS * (uint32_t)mss)
+    {
+        initWnd = TCP_CC_INIT_SEGMENTS * (uint32_t)mss;
+    }
+
+    pCc->cwnd = initWnd;
+    pCc->ssthresh = TCP_CC_MAX_WINDOW;  // no threshold until the first loss
+}
+
+// slow start: one segment for each segment acknowledged, RFC 5681
+static void _TcpCcSlowStart(TCP_CC_STATE* pCc, uint32_t ackedBytes)
+{
+    pCc->cwnd += ackedBytes < pCc->mss ? ackedBytes : pCc->mss;
+}
+
+// the slow start threshold is never below 2 segments
+static uint32_t _TcpCcMinThres(TCP_CC_STATE* pCc, uint32_t thres)
+{
+    return thres < 2 * (uint32_t)pCc->mss ? 2 * (uint32_t)pCc->mss : thres;
+}
+
+// NewReno, RFC 5681/RFC 6582
+// the fast retransmit and recovery are run by the TCP state machine
+
+static void _TcpNewRenoInit(TCP_CC_STATE* pCc, uint16_t mss)
+{
+    _TcpCcInitWindow(pCc, mss);
+}
+
+static void _TcpNewRenoAckRcvd(TCP_CC_STATE* pCc, uint32_t ackedBytes, uint32_t nowMs, uint32_t srttMs)
+{
+    if(pCc->cwnd >= TCP_CC_MAX_WINDOW)
+    {
+        return;
+    }
+
+    if(pCc->cwnd < pCc->ssthresh)
+    {
+        _TcpCcSlowStart(pCc, ackedBytes);
+        return;
+    }
+
+    // congestion avoidance: one segment per window of acknowledged data
+    pCc->cwndAcc += ackedBytes;
+    if(pCc->cwndAcc >= pCc->cwnd)
+    {
+        pCc->cwndAcc -= pCc->cwnd;
+        pCc->cwnd += pCc->mss;
+    }
+}
+
+static void _TcpNewRenoLossEvent(TCP_CC_STATE* pCc, uint32_t flightSize, uint32_t nowMs)
+{
+    pCc->ssthresh = _TcpCcMinThres(pCc, flightSize / 2);
+    pCc->cwnd = pCc->ssthresh;
+    pCc->cwndAcc = 0;
+}
+
+static void _TcpNewRenoTimeout(TCP_CC_STATE* pCc, uint32_t flightSize)
+{
+    pCc->ssthresh = _TcpCcMinThres(pCc, flightSize / 2);
+    pCc->cwnd = pCc->mss;
+    pCc->cwndAcc = 0;
+}
+
+// CUBIC, RFC 8312
+// W(t) = C * (t - K)^3 + Wmax, t being the time since the last loss
+// all arithmetic is integer: times in ms, windows in bytes
+
+static void _TcpCubicInit(TCP_CC_STATE* pCc, uint16_t mss)
+{
+    _TcpCcInitWindow(pCc, mss);
+}
+
+static void _TcpCubicAckRcvd(TCP_CC_STATE* pCc, uint32_t ackedBytes, uint32_t nowMs, uint32_t srttMs)
+{
+    int32_t  deltaMs;
+    int64_t  delta;
+    uint32_t target, renoInc, cwnd;
+    uint64_t num;
+
+    if(pCc->cwnd >= TCP_CC_MAX_WINDOW)
+    {
+        return;
+    }
+
+    if(pCc->cwnd < pCc->ssthresh)
+    {
+        _TcpCcSlowStart(pCc, ackedBytes);
+        return;
+    }
+
+    if(pCc->epochStart == 0)
+    {   // first acknowledge after a loss: start a new epoch
+        pCc->epochStart = nowMs != 0 ? nowMs : 1;
+        pCc->cwndAcc = 0;
+        pCc->renoCwnd = pCc->cwnd;
+        if(pCc->cwnd < pCc->wMax)
+        {   // K = cubic_root((Wmax - cwnd) / C), in ms
+            pCc->k = _TcpCubicRoot(((uint64_t)(pCc->wMax - pCc->cwnd) * 2500000000ULL) / pCc->mss);
+            pCc->originPoint = pCc->wMax;
+        }
+        else
+        {
+            pCc->k = 0;
+            pCc->originPoint = pCc->cwnd;
+        }
+    }
+
+    // the window targeted one RTT from now
+    deltaMs = (int32_t)(nowMs + srttMs - pCc->epochStart - pCc->k);
+    if(deltaMs > TCP_CUBIC_MAX_DELTA_MS)
+    {
+        deltaMs = TCP_CUBIC_MAX_DELTA_MS;
+    }
+    else if(deltaMs < -TCP_CUBIC_MAX_DELTA_MS)
+    {
+        deltaMs = -TCP_CUBIC_MAX_DELTA_MS;
+    }
+    // C * t^3 * mss = 0.4 * (deltaMs / 1000)^3 * mss
+    delta = ((int64_t)deltaMs * deltaMs * deltaMs * pCc->mss * 2) / 5000000000LL;
+    if(delta < -(int64_t)pCc->originPoint)
+    {
+        target = 0;
+    }
+    else
+    {
+        target = (uint32_t)((int64_t)pCc->originPoint + delta);
+    }
+
+    // grow at most to 1.5 * cwnd in one RTT
+    if(target > pCc->cwnd + pCc->cwnd / 2)
+    {
+        target = pCc->cwnd + pCc->cwnd / 2;
+    }
+
+    if(target > pCc->cwnd)
+    {   // (target - cwnd) / cwnd for each byte acknowledged
+        cwnd = pCc->cwnd;
+        num = (uint64_t)(target - cwnd) * ackedBytes + pCc->cwndAcc;
+        pCc->cwnd += (uint32_t)(num / cwnd);
+        pCc->cwndAcc = (uint32_t)(num % cwnd);
+    }
+
+    // NewReno friendly region: never grow slower than an equivalent NewReno flow
+    renoInc = ((uint32_t)pCc->mss * ackedBytes * TCP_CUBIC_RENO_ALPHA_NUM) / (TCP_CUBIC_RENO_ALPHA_DEN * pCc->renoCwnd);
+    pCc->renoCwnd += renoInc;
+    if(pCc->cwnd < pCc->renoCwnd)
+    {
+        pCc->cwnd = pCc->renoCwnd;
+    }
+}
+
+static void _TcpCubicLossEvent(TCP_CC_STATE* pCc, uint32_t flightSize, uint32_t nowMs)
+{
+    pCc->epochStart = 0;
+
+    // fast convergence: release bandwidth faster if the window did not reach the previous maximum
+    if(pCc->cwnd < pCc->wMax)
+    {
+        pCc->wMax = (pCc->cwnd * (TCP_CUBIC_BETA_DEN + TCP_CUBIC_BETA_NUM)) / (2 * TCP_CUBIC_BETA_DEN);
+    }
+    else
+    {
+        pCc->wMax = pCc->cwnd;
+    }
+
+    pCc->ssthresh = _TcpCcMinThres(pCc, (pCc->cwnd / TCP_CUBIC_BETA_DEN) * TCP_CUBIC_BETA_NUM);
+    pCc->cwnd = pCc->ssthresh;
+    pCc->cwndAcc = 0;
+}
+
+static void _TcpCubicTimeout(TCP_CC_STATE* pCc, uint32_t flightSize)
+{
+    pCc->epochStart = 0;
+    pCc->wMax = pCc->cwnd;
+    pCc->ssthresh = _TcpCcMinThres(pCc, (pCc->cwnd / TCP_CUBIC_BETA_DEN) * TCP_CUBIC_BETA_NUM);
+    pCc->cwnd = pCc->mss;
+    pCc->cwndAcc = 0;
+}
+
+// integer cube root, bit by bit
+static uint32_t _TcpCubicRoot(uint64_t val)
+{
+    int      shift;
+    uint64_t root = 0;
+    uint64_t b;
+
+    for(shift = 63; shift >= 0; shift -= 3)
+    {
+        root <<= 1;
+        b = 3 * root * (root + 1) + 1;
+        if((val >> shift) >= b)
+        {
+            val -= b << shift;
+            root++;
+        }
+    }
+
+    return (uint32_t)root;
+}
+
+#endif  // defined(TCPIP_STACK_USE_TCP)
+
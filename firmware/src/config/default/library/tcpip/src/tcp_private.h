@@ -89,12 +89,80 @@ THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
 // the min value of the data offset field, in 32 bit words
 #define TCP_DATA_OFFSET_VAL_MIN    5       // 20 bytes
 
+// number of out-of-order data ranges a socket can hold past its RX head
+// when full, the range farthest from the expected sequence number is dropped
+#define TCP_OOO_MAX_RANGES      (4)
+
+// the maximum size of the TCP options in a header
+#define TCP_OPTIONS_MAX_SIZE    (40)
+
+// the maximum window scale shift, RFC 7323
+#define TCP_WND_SCALE_MAX       (14)
+
+// number of SACK blocks kept from the remote party
+// also the maximum number of blocks sent in an ACK
+#define TCP_SACK_MAX_BLOCKS     (4)
+
+// number of duplicate ACKs that trigger a fast retransmit
+#define TCP_DUP_ACK_THRESHOLD   (3)
+
+// retransmission timeout limits once the round trip time is measured, ms
+#define TCP_RTO_MIN_MS          (200)
+#define TCP_RTO_MAX_MS          (60000)
+
+// congestion control used when not selected with TCP_OPTION_CONGESTION_CONTROL
+#if !defined(TCPIP_TCP_CONGESTION_CONTROL)
+#define TCPIP_TCP_CONGESTION_CONTROL    TCP_CC_NEWRENO
+#endif
+
 /****************************************************************************
   Section:
 	State Machine Variables
   ***************************************************************************/
 
 
+// a range of sequence numbers:
+// out-of-order data held in the RX FIFO, past rxHead
+// or TX data the remote party selectively acknowledged
+typedef struct
+{
+    uint32_t    startSeq;       // sequence number of the first byte
+    uint32_t    endSeq;         // sequence number following the last byte
+}TCP_SEQ_RANGE;
+
+// congestion control state of a connection
+// all window values are in bytes
+typedef struct
+{
+    uint32_t    cwnd;           // congestion window
+    uint32_t    ssthresh;       // slow start threshold
+    uint32_t    cwndAcc;        // acknowledged bytes not yet turned into window growth
+    uint32_t    wMax;           // CUBIC: window before the last reduction
+    uint32_t    originPoint;    // CUBIC: window the cubic curve reaches at epochStart + k
+    uint32_t    renoCwnd;       // CUBIC: window a NewReno flow would have in the same epoch
+    uint32_t    epochStart;     // CUBIC: time the current growth epoch started, ms; 0 if none
+    uint32_t    k;              // CUBIC: time from epochStart until originPoint is reached, ms
+    uint16_t    mss;            // segment size the window arithmetic uses
+}TCP_CC_STATE;
+
+// congestion control algorithm
+// called by the TCP state machine to update the TCP_CC_STATE
+typedef struct
+{
+    // connection start: sets the initial window
+    void    (*init)(TCP_CC_STATE* pCc, uint16_t mss);
+    // new data acknowledged, outside of a recovery
+    void    (*ackRcvd)(TCP_CC_STATE* pCc, uint32_t ackedBytes, uint32_t nowMs, uint32_t srttMs);
+    // loss detected by duplicate acknowledges; flightSize is the data outstanding
+    void    (*lossEvent)(TCP_CC_STATE* pCc, uint32_t flightSize, uint32_t nowMs);
+    // retransmission timeout
+    void    (*timeout)(TCP_CC_STATE* pCc, uint32_t flightSize);
+}TCP_CC_OPS;
+
+// returns the operations of a TCP_CC_ALGORITHM
+// an unknown algorithm returns the TCPIP_TCP_CONGESTION_CONTROL one
+const TCP_CC_OPS* TCPIP_TCP_CcOpsGet(TCP_CC_ALGORITHM alg);
+
 typedef struct
 {
     IPV4_PACKET             v4Pkt;      // safe cast to IPV4_PACKET
@@ -156,15 +224,19 @@ typedef struct
 	uint32_t            retryInterval;			    // How long to wait before retrying transmission
 	uint32_t		    MySEQ;					    // Local sequence number
 	uint32_t		    RemoteSEQ;				    // Remote sequence number
-	int32_t		        sHoleSize;				    // Size of the hole, or -1 for none exists.  (0 indicates hole has just been filled)
+    TCP_SEQ_RANGE       oooRange[TCP_OOO_MAX_RANGES];   // out-of-order ranges, sorted, neither overlapping nor adjacent
+    uint32_t            oooRxBytes;                 // out-of-order bytes received and kept
+    uint32_t            oooDiscardBytes;            // out-of-order bytes received but dropped for lack of ranges
+    uint32_t            oooLastSeq;                 // first sequence number of the most recent out-of-order segment
     TCP_PORT            remotePort;			    	// Remote port number
     TCP_PORT        	localPort;				    // Local port number
-	uint16_t		    remoteWindow;			    // Remote window size
+	uint32_t		    remoteWindow;			    // Remote window size
 	uint16_t		    localWindow;			    // last advertised window size
-	uint16_t		    wFutureDataSize;		    // How much out-of-order data has been received
+    uint16_t            oooCount;                   // number of valid entries in oooRange
 	uint16_t		    wRemoteMSS;				    // Maximum Segment Size option advertised by the remote node during initial handshaking
 	uint16_t		    localMSS;				    // our advertised MSS
-	uint16_t		    maxRemoteWindow;	        // max advertised remote window size
+	uint32_t		    maxRemoteWindow;	        // max advertised remote window size
+    uint32_t            sndAdvWindow;               // window advertised in the last segment from the remote node, scaled
     uint16_t            keepAliveTmo;               // timeout, ms
     uint16_t            remoteHash;	                // Consists of remoteIP, remotePort, localPort for connected sockets.
     struct
@@ -172,8 +244,6 @@ typedef struct
 		uint16_t openAddType    : 2;		        // the address type used at open
         uint16_t bFINSent       : 1;		        // A FIN has been sent
 		uint16_t bSYNSent       : 1;		        // A SYN has been sent
-		uint16_t bRXNoneACKed1  : 1;	            // A duplicate ACK was likely received
-		uint16_t bRXNoneACKed2  : 1;	            // A second duplicate ACK was likely received
 		uint16_t nonLinger      : 1; 		        // linger option
 		uint16_t nonGraceful    : 1; 		        // graceful close
         uint16_t ackSent        : 1;                // acknowledge sent in this pass
@@ -207,6 +277,36 @@ typedef struct
 
     uint8_t ttl;                    // socket TTL value
     uint8_t tos;                    // socket TOS value
+
+    // congestion control and loss recovery
+    const TCP_CC_OPS*   pCcOps;                     // congestion control algorithm of the connection
+    TCP_CC_STATE        cc;                         // congestion control state
+    uint32_t            sndMax;                     // highest sequence number sent
+    uint32_t            recoverSeq;                 // fast recovery ends when this is acknowledged
+    uint32_t            rtxNextSeq;                 // the next SACK hole retransmission starts here
+    uint32_t            rttSeq;                     // acknowledging this ends the RTT measurement
+    uint32_t            rttStartTime;               // tick count the timed segment was sent at
+    uint32_t            srtt;                       // smoothed round trip time, ms << 3; 0 if not measured
+    uint32_t            rttVar;                     // round trip time variation, ms << 2
+    uint32_t            txRetransmits;              // segments retransmitted
+    uint32_t            txFastRecoveries;           // fast recoveries entered
+    uint32_t            txTimeouts;                 // retransmission timeouts
+    TCP_SEQ_RANGE       sackRange[TCP_SACK_MAX_BLOCKS]; // TX data selectively acknowledged, sorted
+    uint16_t            sackCount;                  // number of valid entries in sackRange
+    uint16_t            rtxLen;                     // size of a single segment retransmission
+    uint8_t             ccAlg;                      // TCP_CC_ALGORITHM of the next connection
+    uint8_t             sndWndScale;                // shift of the windows received from the remote party
+    uint8_t             dupAckCount;                // duplicate ACKs received in a row
+    struct
+    {
+        uint8_t wndScaleRcvd    : 1;                // remote party sent the window scale option
+        uint8_t sackPermRcvd    : 1;                // remote party sent the SACK permitted option
+        uint8_t sackOk          : 1;                // SACK in use for this connection
+        uint8_t inRecovery      : 1;                // fast recovery in progress
+        uint8_t rttActive       : 1;                // a segment is being timed
+        uint8_t rtxOne          : 1;                // _TcpSend retransmits a single segment
+        uint8_t reserved        : 2;                // not used
+    } ccFlags;
     uint8_t pad[];                  // padding; not used
 } TCB_STUB;
 
@@ -5026,6 +5026,7 @@ static int _Command_HeapList(SYS_CMD_DEVICE_NODE* pCmdIO, int argc, char** argv)
 
         (*pCmdIO->pCmdApi->print)(cmdIoParam, "Entry ix: %d, blockSize: %d, nBlocks: %d, freeBlocks: %d\r\n", ix, entryList.blockSize, entryList.nBlocks, entryList.freeBlocks);
         (*pCmdIO->pCmdApi->print)(cmdIoParam, "Entry ix: %d, totEntrySize: %d, totFreeSize: %d\r\n", ix, entryList.totEntrySize, entryList.totFreeSize);
+        (*pCmdIO->pCmdApi->print)(cmdIoParam, "Entry ix: %d, maxUsedBlocks: %d, allocs: %d, fallbacks: %d, failed: %d\r\n", ix, entryList.maxUsedBlocks, entryList.nAllocs, entryList.nFallbacks, entryList.nFailed);
 
         totSize += entryList.totEntrySize;
         totFreeSize += entryList.totFreeSize;
@@ -5033,6 +5034,12 @@ static int _Command_HeapList(SYS_CMD_DEVICE_NODE* pCmdIO, int argc, char** argv)
     }
     (*pCmdIO->pCmdApi->print)(cmdIoParam, "Pool Heap total size: %d, total free: %d, expansion: %d\r\n", totSize, totFreeSize, expansionSize);
 
+    TCPIP_HEAP_POOL_EXT_STATS extStats;
+    if(TCPIP_HEAP_POOL_ExtStats(heapH, &extStats) && extStats.enabled)
+    {
+        (*pCmdIO->pCmdApi->print)(cmdIoParam, "External fallback allocs: %d, failed: %d, currBytes: %d, maxBytes: %d\r\n", extStats.nAllocs, extStats.nFailed, extStats.currBytes, extStats.maxBytes);
+    }
+
     return false;
 }
 #endif  // defined(TCPIP_STACK_USE_INTERNAL_HEAP_POOL)
@@ -573,8 +573,24 @@ typedef struct
     // the expansion size at the moment of call
     // Note that this is a global pool number, not per entry  
     int expansionSize;
+    // run time counters
+    int maxUsedBlocks;  // high watermark of the blocks in use
+    int nAllocs;        // allocations served by this entry
+    int nFallbacks;     // allocations that fit this entry but were served by a larger entry or externally
+    int nFailed;        // allocations that fit this entry and failed
 }TCPIP_HEAP_POOL_ENTRY_LIST;
 
+// pool external allocation counters
+// used when the pool heap is created with TCPIP_STACK_HEAP_FLAG_POOL_EXTERNAL_FALLBACK
+typedef struct
+{
+    bool enabled;       // the external fallback is enabled
+    int nAllocs;        // allocations passed to the external allocation function
+    int nFailed;        // external allocations that failed
+    int currBytes;      // bytes currently allocated externally
+    int maxBytes;       // high watermark of currBytes
+}TCPIP_HEAP_POOL_EXT_STATS;
+
 // returns the number of entries in the pool heap
 int     TCPIP_HEAP_POOL_Entries(TCPIP_STACK_HEAP_HANDLE heapH);
 
@@ -582,6 +598,9 @@ int     TCPIP_HEAP_POOL_Entries(TCPIP_STACK_HEAP_HANDLE heapH);
 // lists a pool entry identified by its index
 bool TCPIP_HEAP_POOL_EntryList(TCPIP_STACK_HEAP_HANDLE heapH, int entryIx, TCPIP_HEAP_POOL_ENTRY_LIST* pList);
 
+// returns the external allocation counters of a pool heap
+bool TCPIP_HEAP_POOL_ExtStats(TCPIP_STACK_HEAP_HANDLE heapH, TCPIP_HEAP_POOL_EXT_STATS* pStats);
+
 
 
 // *****************************************************************************
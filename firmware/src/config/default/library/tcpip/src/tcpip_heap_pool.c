@@ -0,0 +1,919 @@
+/*******************************************************************************
+  TCPIP Pool Heap Allocation Manager
+
+  Summary:
+    Fixed size block pool heap for the TCP/IP stack
+    
+  Description:
+    The heap region is allocated once, at creation, and split into
+    pool entries of fixed size blocks.
+    Allocations and releases take blocks from/to the entry free lists
+    so the heap cannot fragment and the allocation time is bounded
+    by the number of entries.
+*******************************************************************************/
+
+/*****************************************************************************
+ Copyright (C) 2012-2018 Microchip Technology Inc. and its subsidiaries.
+
+Microchip Technology Inc. and its subsidiaries.
+
+Subject to your compliance with these terms, you may use Microchip software 
+and any derivatives exclusively with Microchip products. It is your 
+responsibility to comply with third party license terms applicable to your 
+use of third party software (including open source software) that may 
+accompany Microchip software.
+
+THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER 
+EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY IMPLIED 
+WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS FOR A PARTICULAR 
+PURPOSE.
+
+IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE, 
+INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND 
+WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS 
+BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO THE 
+FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN 
+ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY, 
+THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*****************************************************************************/
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+#include <string.h>
+#include <stdlib.h>
+
+#if defined(__mips__)
+#include <sys/kmem.h>
+#endif
+
+
+#include "tcpip/src/tcpip_private.h"
+// definitions
+
+
+// min heap alignment
+// always power of 2
+#if (CACHE_LINE_SIZE >= 8u)
+typedef struct __attribute__((aligned(CACHE_LINE_SIZE)))
+{
+    uint64_t     pad[CACHE_LINE_SIZE / 8];
+}_heap_Align;
+#elif (CACHE_LINE_SIZE >= 4u)
+typedef uint32_t _heap_Align;
+#else
+#error "TCP/IP Heap: incorrect CACHE_LINE_SIZE!"
+#endif // (CACHE_LINE_SIZE >= 8u) 
+
+// header preceding each pool block
+typedef union __attribute__((aligned(CACHE_LINE_SIZE))) _tag_poolHead
+{
+    _heap_Align x;
+    struct
+    {
+        struct _tag_poolEntryDcpt*  pEntry;     // entry this block belongs to
+        union _tag_poolHead*        next;       // next free block in the entry; valid only while free
+        uint32_t                    inUse;      // block is allocated; catches double or foreign releases
+    };
+}_poolHead;
+
+// header preceding a block allocated with the external allocation function
+typedef union __attribute__((aligned(CACHE_LINE_SIZE))) _tag_extHead
+{
+    _heap_Align x;
+    struct
+    {
+        void*       allocPtr;   // pointer as returned by the external allocation function
+        size_t      allocSize;  // size requested by the caller
+    };
+}_extHead;
+
+
+// a pool entry: blocks of the same size
+typedef struct _tag_poolEntryDcpt
+{
+    _poolHead*  freeList;       // list of free blocks
+    uint32_t    blockSize;      // size of a block, without the header; multiple of sizeof(_poolHead)
+    uint16_t    nBlocks;        // blocks in this entry, expanded ones included
+    uint16_t    freeBlocks;     // blocks currently in the free list
+    uint16_t    maxUsedBlocks;  // high watermark of the blocks in use
+    uint8_t     nExpBlks;       // blocks to add from the expansion area when the entry runs out
+    uint8_t     entryPad[1];    // padding, not used
+    // run time counters
+    uint32_t    nAllocs;        // allocations served by this entry
+    uint32_t    nFallbacks;     // allocations that fit this entry but were served by another one or externally
+    uint32_t    nFailed;        // allocations that fit this entry and failed
+}TCPIP_HEAP_POOL_ENTRY_DCPT;
+
+
+typedef struct
+{
+    TCPIP_HEAP_POOL_ENTRY_DCPT*         poolEntries;        // entries table, sorted by increasing block size
+    int                                 nEntries;           // number of entries
+    void* (*malloc_fnc)(size_t bytes);                      // external allocation function
+    void  (*free_fnc)(void* ptr);                           // external release function
+
+    void*                               allocRegion;        // heap region as returned by the allocation function
+    uint8_t*                            regionStart;        // aligned, non-cached if needed, start of the blocks
+    uint8_t*                            regionEnd;          // end of the heap region
+    uint8_t*                            expansionPtr;       // next free byte in the expansion area
+    size_t                              usedBytes;          // bytes in the allocated pool blocks
+    size_t                              maxUsedBytes;       // high watermark of usedBytes
+
+    // TCPIP_STACK_HEAP_FLAG_POOL_EXTERNAL_FALLBACK counters
+    uint32_t                            extAllocs;          // allocations passed to the external allocator
+    uint32_t                            extFailed;          // external allocations that failed
+    size_t                              extCurrBytes;       // bytes currently allocated externally
+    size_t                              extMaxBytes;        // high watermark of extCurrBytes
+
+    OSAL_SEM_HANDLE_TYPE                _heapSemaphore;     // protection semaphore
+    TCPIP_STACK_HEAP_RES                _lastHeapErr;       // last error encountered
+
+    // run time flags - faster access
+    uint8_t                             heapDoProtect;      // protect the heap access
+    uint8_t                             heapDoMap;          // region mapped to non-cached
+    uint8_t                             heapStrict;         // allocate only from the entry that matches the size
+    uint8_t                             heapExtFallback;    // use the external allocation function when the pool fails
+}TCPIP_HEAP_POOL_DCPT; // descriptor of a pool heap
+
+
+// local data
+//
+
+static TCPIP_STACK_HEAP_RES   _TCPIP_HEAP_Delete(TCPIP_STACK_HEAP_HANDLE heapH);
+static void*            _TCPIP_HEAP_Malloc(TCPIP_STACK_HEAP_HANDLE heapH, size_t nBytes);
+static void*            _TCPIP_HEAP_Calloc(TCPIP_STACK_HEAP_HANDLE heapH, size_t nElems, size_t elemSize);
+static size_t           _TCPIP_HEAP_Free(TCPIP_STACK_HEAP_HANDLE heapH, const void* pBuff);
+
+static size_t           _TCPIP_HEAP_Size(TCPIP_STACK_HEAP_HANDLE heapH);
+static size_t           _TCPIP_HEAP_MaxSize(TCPIP_STACK_HEAP_HANDLE heapH);
+static size_t           _TCPIP_HEAP_FreeSize(TCPIP_STACK_HEAP_HANDLE heapH);
+static size_t           _TCPIP_HEAP_HighWatermark(TCPIP_STACK_HEAP_HANDLE heapH);
+static TCPIP_STACK_HEAP_RES   _TCPIP_HEAP_LastError(TCPIP_STACK_HEAP_HANDLE heapH);
+#if defined(TCPIP_STACK_DRAM_DEBUG_ENABLE) 
+static size_t           _TCPIP_HEAP_AllocSize(TCPIP_STACK_HEAP_HANDLE heapH, const void* ptr);
+#endif  // defined(TCPIP_STACK_DRAM_DEBUG_ENABLE) 
+
+// maps a buffer to non cached memory
+const void*   _TCPIP_HEAP_BufferMapNonCached(const void* buffer, size_t buffSize);
+
+// maps a pointer back to cached memory
+const void*   _TCPIP_HEAP_PointerMapCached(const void* ptr);
+
+
+
+// the heap object
+static const TCPIP_HEAP_OBJECT      _tcpip_heap_object = 
+{
+    .TCPIP_HEAP_Delete = _TCPIP_HEAP_Delete,
+    .TCPIP_HEAP_Malloc = _TCPIP_HEAP_Malloc,
+    .TCPIP_HEAP_Calloc = _TCPIP_HEAP_Calloc,
+    .TCPIP_HEAP_Free = _TCPIP_HEAP_Free,
+    .TCPIP_HEAP_Size = _TCPIP_HEAP_Size,
+    .TCPIP_HEAP_MaxSize = _TCPIP_HEAP_MaxSize,
+    .TCPIP_HEAP_FreeSize = _TCPIP_HEAP_FreeSize,
+    .TCPIP_HEAP_HighWatermark = _TCPIP_HEAP_HighWatermark,
+    .TCPIP_HEAP_LastError = _TCPIP_HEAP_LastError,
+#if defined(TCPIP_STACK_DRAM_DEBUG_ENABLE) 
+    .TCPIP_HEAP_AllocSize = _TCPIP_HEAP_AllocSize,
+#endif  // defined(TCPIP_STACK_DRAM_DEBUG_ENABLE) 
+};
+
+typedef struct
+{
+    TCPIP_HEAP_OBJECT       heapObj;    // heap object API
+    TCPIP_HEAP_POOL_DCPT    heapDcpt;   // private heap object data
+    // the entries table follows
+}TCPIP_HEAP_POOL_OBJ_INSTANCE;
+
+
+
+// local prototypes
+//
+static bool                 _TCPIP_HEAP_POOL_EntriesSet(TCPIP_HEAP_POOL_DCPT* hDcpt, const TCPIP_STACK_HEAP_POOL_CONFIG* pHeapConfig);
+static bool                 _TCPIP_HEAP_POOL_EntryExpand(TCPIP_HEAP_POOL_DCPT* hDcpt, TCPIP_HEAP_POOL_ENTRY_DCPT* pEntry);
+static void*                _TCPIP_HEAP_POOL_ExtAlloc(TCPIP_HEAP_POOL_DCPT* hDcpt, size_t nBytes);
+static size_t               _TCPIP_HEAP_POOL_ExtFree(TCPIP_HEAP_POOL_DCPT* hDcpt, const void* ptr);
+
+// returns the TCPIP_HEAP_POOL_OBJ_INSTANCE associated with a heap handle
+// null if invalid
+static __inline__ TCPIP_HEAP_POOL_OBJ_INSTANCE* __attribute__((always_inline)) _TCPIP_HEAP_ObjInstance(TCPIP_STACK_HEAP_HANDLE heapH)
+{
+#if defined(TCPIP_STACK_DRAM_DEBUG_ENABLE) 
+    if(heapH)
+    {
+        TCPIP_HEAP_POOL_OBJ_INSTANCE* pInst = (TCPIP_HEAP_POOL_OBJ_INSTANCE*)heapH;
+        if(pInst->heapObj.TCPIP_HEAP_Delete == _TCPIP_HEAP_Delete)
+        {
+            return pInst;
+        }
+    }
+    return 0;
+#else
+    return (heapH == 0) ? 0 : (TCPIP_HEAP_POOL_OBJ_INSTANCE*)heapH;
+#endif  // defined(TCPIP_STACK_DRAM_DEBUG_ENABLE) 
+
+}
+
+// returns the TCPIP_HEAP_POOL_DCPT associated with a heap handle
+// null if invalid
+static __inline__ TCPIP_HEAP_POOL_DCPT* __attribute__((always_inline)) _TCPIP_HEAP_ObjDcpt(TCPIP_STACK_HEAP_HANDLE heapH)
+{
+    TCPIP_HEAP_POOL_OBJ_INSTANCE* hInst = _TCPIP_HEAP_ObjInstance(heapH);
+
+    return (hInst == 0) ? 0 : &hInst->heapDcpt;
+}
+
+// returns the TCPIP_HEAP_POOL_DCPT associated with a heap handle
+// always checks that the handle is a pool heap
+// used by the pool specific API that can be called with any heap handle
+static TCPIP_HEAP_POOL_DCPT* _TCPIP_HEAP_PoolDcpt(TCPIP_STACK_HEAP_HANDLE heapH)
+{
+    if(heapH)
+    {
+        TCPIP_HEAP_POOL_OBJ_INSTANCE* pInst = (TCPIP_HEAP_POOL_OBJ_INSTANCE*)heapH;
+        if(pInst->heapObj.TCPIP_HEAP_Delete == _TCPIP_HEAP_Delete)
+        {
+            return &pInst->heapDcpt;
+        }
+    }
+    return 0;
+}
+
+// rounds a size up to a multiple of the block header size
+static __inline__ size_t __attribute__((always_inline)) _TCPIP_HEAP_POOL_Round(size_t nBytes)
+{
+    return ((nBytes + sizeof(_poolHead) - 1) / sizeof(_poolHead)) * sizeof(_poolHead);
+}
+
+// adds a block to an entry free list
+static __inline__ void __attribute__((always_inline)) _TCPIP_HEAP_POOL_BlockPut(TCPIP_HEAP_POOL_ENTRY_DCPT* pEntry, _poolHead* pHead)
+{
+    pHead->pEntry = pEntry;
+    pHead->inUse = 0;
+    pHead->next = pEntry->freeList;
+    pEntry->freeList = pHead;
+    pEntry->freeBlocks++;
+}
+
+// takes a block from an entry free list; 0 if the entry is empty
+static __inline__ _poolHead* __attribute__((always_inline)) _TCPIP_HEAP_POOL_BlockGet(TCPIP_HEAP_POOL_ENTRY_DCPT* pEntry)
+{
+    _poolHead* pHead = pEntry->freeList;
+    if(pHead)
+    {
+        pEntry->freeList = pHead->next;
+        pEntry->freeBlocks--;
+        pHead->inUse = 1;
+    }
+
+    return pHead;
+}
+
+// API
+
+TCPIP_STACK_HEAP_HANDLE TCPIP_HEAP_CreateInternalPool(const TCPIP_STACK_HEAP_POOL_CONFIG* pHeapConfig, TCPIP_STACK_HEAP_RES* pRes)
+{
+    TCPIP_HEAP_POOL_DCPT* hDcpt;
+    TCPIP_HEAP_POOL_OBJ_INSTANCE* hInst;
+    TCPIP_HEAP_POOL_ENTRY_DCPT* pEntry;
+    TCPIP_STACK_HEAP_RES  res;
+    size_t  regionSize, expansionSize;
+    uint8_t* pBlock;
+    int     entryIx, blkIx;
+    
+
+    while(true)
+    {
+        hDcpt =0;
+        hInst = 0;
+
+        if( pHeapConfig == 0 || pHeapConfig->nPoolEntries == 0 || pHeapConfig->pEntries == 0)
+        {
+            res = TCPIP_STACK_HEAP_RES_INIT_ERR;
+            break;
+        }
+
+        hInst = (TCPIP_HEAP_POOL_OBJ_INSTANCE*)(*pHeapConfig->calloc_fnc)(1, sizeof(*hInst) + pHeapConfig->nPoolEntries * sizeof(TCPIP_HEAP_POOL_ENTRY_DCPT));
+
+        if(hInst == 0)
+        {
+            res = TCPIP_STACK_HEAP_RES_CREATE_ERR;
+            break;
+        }
+
+        hDcpt = &hInst->heapDcpt;
+        hDcpt->poolEntries = (TCPIP_HEAP_POOL_ENTRY_DCPT*)(hInst + 1);
+        hDcpt->nEntries = pHeapConfig->nPoolEntries;
+        hDcpt->malloc_fnc = pHeapConfig->malloc_fnc;
+        hDcpt->free_fnc = pHeapConfig->free_fnc;
+
+        if(!_TCPIP_HEAP_POOL_EntriesSet(hDcpt, pHeapConfig))
+        {
+            (*pHeapConfig->free_fnc)(hInst);
+            hInst = 0;
+            res = TCPIP_STACK_HEAP_RES_INIT_ERR;
+            break;
+        }
+
+        // calculate the size of the region: all the blocks + the expansion area
+        regionSize = 0;
+        pEntry = hDcpt->poolEntries;
+        for(entryIx = 0; entryIx < hDcpt->nEntries; entryIx++, pEntry++)
+        {
+            regionSize += pEntry->nBlocks * (sizeof(_poolHead) + pEntry->blockSize);
+        }
+        expansionSize = (pHeapConfig->expansionHeapSize / sizeof(_poolHead)) * sizeof(_poolHead);
+        regionSize += expansionSize;
+
+        if(regionSize == 0)
+        {
+            (*pHeapConfig->free_fnc)(hInst);
+            hInst = 0;
+            res = TCPIP_STACK_HEAP_RES_BUFF_SIZE_ERR;
+            break;
+        }
+
+        // allocate the region; extra room for alignment
+        hDcpt->allocRegion = (*pHeapConfig->malloc_fnc)(regionSize + sizeof(_poolHead) - 1);
+        if(hDcpt->allocRegion == 0)
+        {
+            (*pHeapConfig->free_fnc)(hInst);
+            hInst = 0;
+            res = TCPIP_STACK_HEAP_RES_CREATE_ERR;
+            break;
+        }
+
+        if((pHeapConfig->heapFlags & TCPIP_STACK_HEAP_FLAG_NO_MTHREAD_SYNC) == 0)
+        {
+            if(OSAL_SEM_Create(&hDcpt->_heapSemaphore, OSAL_SEM_TYPE_BINARY, 1, 1) != OSAL_RESULT_TRUE)
+            {
+                (*pHeapConfig->free_fnc)(hDcpt->allocRegion);
+                (*pHeapConfig->free_fnc)(hInst);
+                hInst = 0;
+                res = TCPIP_STACK_HEAP_RES_SYNCH_ERR;
+                break;
+            }
+
+            hDcpt->heapDoProtect = true;
+        }
+
+        // the whole region is mapped once; always alloc uncached!
+        hDcpt->regionStart = (uint8_t*)(((uintptr_t)hDcpt->allocRegion + sizeof(_poolHead) - 1) & ~(sizeof(_poolHead) - 1));
+        pBlock = (uint8_t*)_TCPIP_HEAP_BufferMapNonCached(hDcpt->regionStart, regionSize);
+        if(pBlock != hDcpt->regionStart)
+        {
+            hDcpt->heapDoMap = true;
+            hDcpt->regionStart = pBlock;
+        }
+        hDcpt->regionEnd = hDcpt->regionStart + regionSize;
+
+        // split the region into the entries blocks
+        pEntry = hDcpt->poolEntries;
+        for(entryIx = 0; entryIx < hDcpt->nEntries; entryIx++, pEntry++)
+        {
+            for(blkIx = 0; blkIx < pEntry->nBlocks; blkIx++)
+            {
+                _TCPIP_HEAP_POOL_BlockPut(pEntry, (_poolHead*)pBlock);
+                pBlock += sizeof(_poolHead) + pEntry->blockSize;
+            }
+        }
+        hDcpt->expansionPtr = pBlock;
+
+        hDcpt->heapStrict = (pHeapConfig->heapFlags & TCPIP_STACK_HEAP_FLAG_POOL_STRICT) != 0;
+        hDcpt->heapExtFallback = (pHeapConfig->heapFlags & TCPIP_STACK_HEAP_FLAG_POOL_EXTERNAL_FALLBACK) != 0;
+
+        // create the object
+        hInst->heapObj = _tcpip_heap_object;
+
+        res = TCPIP_STACK_HEAP_RES_OK;
+        break;
+    }
+
+    if(pRes)
+    {
+        *pRes = res;
+    }
+
+    return hInst;
+    
+}
+
+int TCPIP_HEAP_POOL_Entries(TCPIP_STACK_HEAP_HANDLE heapH)
+{
+    TCPIP_HEAP_POOL_DCPT* hDcpt = _TCPIP_HEAP_PoolDcpt(heapH);
+
+    return (hDcpt == 0) ? 0 : hDcpt->nEntries;
+}
+
+bool TCPIP_HEAP_POOL_EntryList(TCPIP_STACK_HEAP_HANDLE heapH, int entryIx, TCPIP_HEAP_POOL_ENTRY_LIST* pList)
+{
+    TCPIP_HEAP_POOL_ENTRY_DCPT* pEntry;
+    TCPIP_HEAP_POOL_DCPT* hDcpt = _TCPIP_HEAP_PoolDcpt(heapH);
+
+    if(hDcpt == 0 || entryIx < 0 || entryIx >= hDcpt->nEntries)
+    {
+        return false;
+    }
+
+    if(pList)
+    {
+        pEntry = hDcpt->poolEntries + entryIx;
+        pList->blockSize = pEntry->blockSize;
+        pList->nBlocks = pEntry->nBlocks;
+        pList->freeBlocks = pEntry->freeBlocks;
+        pList->totEntrySize = pEntry->nBlocks * pEntry->blockSize;
+        pList->totFreeSize = pEntry->freeBlocks * pEntry->blockSize;
+        pList->expansionSize = hDcpt->regionEnd - hDcpt->expansionPtr;
+        pList->maxUsedBlocks = pEntry->maxUsedBlocks;
+        pList->nAllocs = pEntry->nAllocs;
+        pList->nFallbacks = pEntry->nFallbacks;
+        pList->nFailed = pEntry->nFailed;
+    }
+
+    return true;
+}
+
+bool TCPIP_HEAP_POOL_ExtStats(TCPIP_STACK_HEAP_HANDLE heapH, TCPIP_HEAP_POOL_EXT_STATS* pStats)
+{
+    TCPIP_HEAP_POOL_DCPT* hDcpt = _TCPIP_HEAP_PoolDcpt(heapH);
+
+    if(hDcpt == 0)
+    {
+        return false;
+    }
+
+    if(pStats)
+    {
+        pStats->enabled = hDcpt->heapExtFallback;
+        pStats->nAllocs = hDcpt->extAllocs;
+        pStats->nFailed = hDcpt->extFailed;
+        pStats->currBytes = hDcpt->extCurrBytes;
+        pStats->maxBytes = hDcpt->extMaxBytes;
+    }
+
+    return true;
+}
+
+// internal functions
+//
+
+// copies the configuration entries into the heap entries table
+// the table is sorted by increasing block size
+// returns false if the entries are not valid:
+// 0 size or non distinct sizes, after rounding to the block alignment
+static bool _TCPIP_HEAP_POOL_EntriesSet(TCPIP_HEAP_POOL_DCPT* hDcpt, const TCPIP_STACK_HEAP_POOL_CONFIG* pHeapConfig)
+{
+    int ix, jx;
+    uint32_t blockSize;
+    TCPIP_HEAP_POOL_ENTRY_DCPT* pEntry;
+    const TCPIP_STACK_HEAP_POOL_ENTRY* pCfgEntry = pHeapConfig->pEntries;
+
+    for(ix = 0; ix < hDcpt->nEntries; ix++, pCfgEntry++)
+    {
+        if(pCfgEntry->entrySize == 0)
+        {
+            return false;
+        }
+        blockSize = _TCPIP_HEAP_POOL_Round(pCfgEntry->entrySize);
+
+        // insertion sort; the number of entries is small
+        for(jx = ix; jx > 0; jx--)
+        {
+            pEntry = hDcpt->poolEntries + jx - 1;
+            if(pEntry->blockSize == blockSize)
+            {
+                return false;
+            }
+            if(pEntry->blockSize < blockSize)
+            {
+                break;
+            }
+            *(pEntry + 1) = *pEntry;
+        }
+
+        pEntry = hDcpt->poolEntries + jx;
+        memset(pEntry, 0, sizeof(*pEntry));
+        pEntry->blockSize = blockSize;
+        pEntry->nBlocks = pCfgEntry->nBlocks;
+        pEntry->nExpBlks = pCfgEntry->nExpBlks;
+    }
+
+    return true;
+}
+
+// adds nExpBlks blocks from the expansion area to an entry
+// the blocks stay with the entry, the expansion area does not fragment
+// returns false if there's no room
+static bool _TCPIP_HEAP_POOL_EntryExpand(TCPIP_HEAP_POOL_DCPT* hDcpt, TCPIP_HEAP_POOL_ENTRY_DCPT* pEntry)
+{
+    int blkIx;
+    size_t blkSize = sizeof(_poolHead) + pEntry->blockSize;
+
+    if(pEntry->nExpBlks == 0 || hDcpt->regionEnd - hDcpt->expansionPtr < pEntry->nExpBlks * blkSize)
+    {
+        return false;
+    }
+
+    for(blkIx = 0; blkIx < pEntry->nExpBlks; blkIx++)
+    {
+        _TCPIP_HEAP_POOL_BlockPut(pEntry, (_poolHead*)hDcpt->expansionPtr);
+        hDcpt->expansionPtr += blkSize;
+    }
+    pEntry->nBlocks += pEntry->nExpBlks;
+
+    return true;
+}
+
+// allocates a block with the external allocation function
+// the block is aligned and mapped like the pool blocks
+static void* _TCPIP_HEAP_POOL_ExtAlloc(TCPIP_HEAP_POOL_DCPT* hDcpt, size_t nBytes)
+{
+    _extHead*   pHead;
+    void*       allocPtr;
+    void*       alignPtr;
+    size_t      allocBytes;
+
+    // allocate multiple of units + 1 unit for the header + 1 unit for the alignment
+    allocBytes = ((nBytes + sizeof(_extHead) - 1) / sizeof(_extHead) + 2) * sizeof(_extHead);
+    allocPtr = (*hDcpt->malloc_fnc)(allocBytes);
+    if(allocPtr == 0)
+    {
+        hDcpt->extFailed++;
+        return 0;
+    }
+
+    pHead = (_extHead*)(((uintptr_t)allocPtr + sizeof(_extHead) - 1) & ~(sizeof(_extHead) - 1));
+    pHead->allocPtr = allocPtr;
+    pHead->allocSize = nBytes;
+    alignPtr = pHead + 1;
+
+    if(hDcpt->heapDoMap)
+    {   // map to non-cached
+        alignPtr = (void*)_TCPIP_HEAP_BufferMapNonCached(alignPtr, nBytes);
+    }
+
+    // update stats
+    hDcpt->extAllocs++;
+    hDcpt->extCurrBytes += nBytes;
+    if(hDcpt->extCurrBytes > hDcpt->extMaxBytes)
+    {
+        hDcpt->extMaxBytes = hDcpt->extCurrBytes;
+    }
+
+    return alignPtr;
+}
+
+// releases a block allocated with _TCPIP_HEAP_POOL_ExtAlloc
+// returns the size of the block
+static size_t _TCPIP_HEAP_POOL_ExtFree(TCPIP_HEAP_POOL_DCPT* hDcpt, const void* ptr)
+{
+    _extHead*   pHead;
+    size_t      allocSize;
+
+    if(hDcpt->heapDoMap)
+    {   // map back to cached
+        ptr = _TCPIP_HEAP_PointerMapCached(ptr);
+    }
+
+    pHead = (_extHead*)ptr - 1;
+    allocSize = pHead->allocSize;
+    (*hDcpt->free_fnc)(pHead->allocPtr);
+
+    hDcpt->extCurrBytes -= allocSize;
+
+    return allocSize;
+}
+
+// deallocates the heap
+static TCPIP_STACK_HEAP_RES _TCPIP_HEAP_Delete(TCPIP_STACK_HEAP_HANDLE heapH)
+{
+    TCPIP_HEAP_POOL_OBJ_INSTANCE*   hInst = _TCPIP_HEAP_ObjInstance(heapH);
+    TCPIP_HEAP_POOL_DCPT*   hDcpt = _TCPIP_HEAP_ObjDcpt(heapH);
+
+    if(hDcpt)
+    {
+        if(hDcpt->usedBytes != 0 || hDcpt->extCurrBytes != 0)
+        {
+            return TCPIP_STACK_HEAP_RES_IN_USE;
+        }
+
+        if (hDcpt->heapDoProtect)
+        {
+            OSAL_SEM_Delete(&hDcpt->_heapSemaphore);
+        }
+        // invalidate it
+        memset(&hInst->heapObj, 0, sizeof(hInst->heapObj));
+        (*hDcpt->free_fnc)(hDcpt->allocRegion);
+        (*hDcpt->free_fnc)(hInst);
+        return TCPIP_STACK_HEAP_RES_OK;
+    }
+
+    return TCPIP_STACK_HEAP_RES_NO_HEAP; 
+}
+
+
+// allocation policy:
+//  - a free block from the smallest entry that fits the size
+//  - new blocks for that entry from the expansion area, if its nExpBlks != 0
+//  - if not TCPIP_STACK_HEAP_FLAG_POOL_STRICT, a free block from a larger entry
+//  - if TCPIP_STACK_HEAP_FLAG_POOL_EXTERNAL_FALLBACK, the external allocation function
+// the pool steps are bounded by the number of entries
+static void* _TCPIP_HEAP_Malloc(TCPIP_STACK_HEAP_HANDLE heapH, size_t nBytes)
+{
+    TCPIP_HEAP_POOL_ENTRY_DCPT  *pEntry, *pReqEntry, *pLastEntry;
+    _poolHead*  pHead;
+    void*       ptr;
+    size_t      usedBlocks;
+    TCPIP_HEAP_POOL_DCPT*   hDcpt = _TCPIP_HEAP_ObjDcpt(heapH);
+
+    
+	if(hDcpt == 0 || nBytes == 0)
+    {
+        return 0;
+    }
+
+    if (hDcpt->heapDoProtect)
+    {
+        (void)OSAL_SEM_Pend(&hDcpt->_heapSemaphore, OSAL_WAIT_FOREVER);
+    }
+
+    pHead = 0;
+    ptr = 0;
+    pLastEntry = hDcpt->poolEntries + hDcpt->nEntries;
+
+    // find the entry that matches the size
+    for(pReqEntry = hDcpt->poolEntries; pReqEntry != pLastEntry; pReqEntry++)
+    {
+        if(pReqEntry->blockSize >= nBytes)
+        {
+            break;
+        }
+    }
+
+    pEntry = pReqEntry;
+    if(pReqEntry != pLastEntry)
+    {
+        pHead = _TCPIP_HEAP_POOL_BlockGet(pReqEntry);
+        if(pHead == 0 && _TCPIP_HEAP_POOL_EntryExpand(hDcpt, pReqEntry))
+        {
+            pHead = _TCPIP_HEAP_POOL_BlockGet(pReqEntry);
+        }
+
+        if(pHead == 0 && !hDcpt->heapStrict)
+        {
+            for(pEntry = pReqEntry + 1; pEntry != pLastEntry; pEntry++)
+            {
+                if((pHead = _TCPIP_HEAP_POOL_BlockGet(pEntry)) != 0)
+                {
+                    break;
+                }
+            }
+        }
+    }
+
+    if(pHead != 0)
+    {   // update stats
+        pEntry->nAllocs++;
+        usedBlocks = pEntry->nBlocks - pEntry->freeBlocks;
+        if(usedBlocks > pEntry->maxUsedBlocks)
+        {
+            pEntry->maxUsedBlocks = usedBlocks;
+        }
+        hDcpt->usedBytes += pEntry->blockSize;
+        if(hDcpt->usedBytes > hDcpt->maxUsedBytes)
+        {
+            hDcpt->maxUsedBytes = hDcpt->usedBytes;
+        }
+        ptr = pHead + 1;
+    }
+    else if(hDcpt->heapExtFallback)
+    {
+        ptr = _TCPIP_HEAP_POOL_ExtAlloc(hDcpt, nBytes);
+    }
+
+    if(pReqEntry != pLastEntry)
+    {
+        if(ptr == 0)
+        {
+            pReqEntry->nFailed++;
+        }
+        else if(pEntry != pReqEntry)
+        {
+            pReqEntry->nFallbacks++;
+        }
+    }
+
+    if(ptr == 0)
+    {   // failed
+        hDcpt->_lastHeapErr = (pReqEntry == pLastEntry) ? TCPIP_STACK_HEAP_RES_SIZE_ERR : TCPIP_STACK_HEAP_RES_NO_MEM;
+    }
+
+    if (hDcpt->heapDoProtect)
+    {
+        (void)OSAL_SEM_Post(&hDcpt->_heapSemaphore);
+    }
+
+    return ptr;
+}
+
+static void* _TCPIP_HEAP_Calloc(TCPIP_STACK_HEAP_HANDLE heapH, size_t nElems, size_t elemSize)
+{
+    size_t nBytes = nElems * elemSize;
+
+    // redirect to malloc
+
+    void* ptr = _TCPIP_HEAP_Malloc(heapH, nBytes);
+    if(ptr)
+    {
+        memset(ptr, 0, nBytes);
+    }
+
+    return ptr;
+}
+
+static size_t _TCPIP_HEAP_Free(TCPIP_STACK_HEAP_HANDLE heapH, const void* ptr)
+{
+    _poolHead*  pHead;
+    TCPIP_HEAP_POOL_ENTRY_DCPT* pEntry;
+    size_t      freedBytes = 0;
+    TCPIP_HEAP_POOL_DCPT*   hDcpt = _TCPIP_HEAP_ObjDcpt(heapH);
+  
+	if(hDcpt != 0 && ptr != 0)
+    {
+        if (hDcpt->heapDoProtect)
+        {
+            (void)OSAL_SEM_Pend(&hDcpt->_heapSemaphore, OSAL_WAIT_FOREVER);
+        }
+
+        if((const uint8_t*)ptr > hDcpt->regionStart && (const uint8_t*)ptr < hDcpt->regionEnd)
+        {   // pool block
+            pHead = (_poolHead*)ptr - 1;
+            pEntry = pHead->pEntry;
+            if(pHead->inUse == 0 || pEntry < hDcpt->poolEntries || pEntry >= hDcpt->poolEntries + hDcpt->nEntries)
+            {
+                hDcpt->_lastHeapErr = TCPIP_STACK_HEAP_RES_PTR_ERR;
+            }
+            else
+            {
+                _TCPIP_HEAP_POOL_BlockPut(pEntry, pHead);
+                freedBytes = pEntry->blockSize;
+                hDcpt->usedBytes -= freedBytes;
+            }
+        }
+        else if(hDcpt->heapExtFallback)
+        {
+            freedBytes = _TCPIP_HEAP_POOL_ExtFree(hDcpt, ptr);
+        }
+        else
+        {
+            hDcpt->_lastHeapErr = TCPIP_STACK_HEAP_RES_PTR_ERR;
+        }
+
+        if (hDcpt->heapDoProtect)
+        {
+            (void)OSAL_SEM_Post(&hDcpt->_heapSemaphore);
+        }
+    }
+
+    return freedBytes;
+}
+
+
+static size_t _TCPIP_HEAP_Size(TCPIP_STACK_HEAP_HANDLE heapH)
+{
+    TCPIP_HEAP_POOL_DCPT*      hDcpt;
+
+    hDcpt = _TCPIP_HEAP_ObjDcpt(heapH);
+
+    if(hDcpt)
+    {
+        return hDcpt->regionEnd - hDcpt->regionStart;
+    }
+
+    return 0;
+}
+
+// the largest block that can be currently allocated from the pool
+static size_t _TCPIP_HEAP_MaxSize(TCPIP_STACK_HEAP_HANDLE heapH)
+{
+    TCPIP_HEAP_POOL_ENTRY_DCPT* pEntry;
+    TCPIP_HEAP_POOL_DCPT*      hDcpt;
+
+    hDcpt = _TCPIP_HEAP_ObjDcpt(heapH);
+
+    if(hDcpt)
+    {
+        for(pEntry = hDcpt->poolEntries + hDcpt->nEntries - 1; pEntry >= hDcpt->poolEntries; pEntry--)
+        {
+            if(pEntry->freeBlocks != 0)
+            {
+                return pEntry->blockSize;
+            }
+            if(pEntry->nExpBlks != 0 && hDcpt->regionEnd - hDcpt->expansionPtr >= pEntry->nExpBlks * (sizeof(_poolHead) + pEntry->blockSize))
+            {   // can be expanded
+                return pEntry->blockSize;
+            }
+        }
+    }
+
+    return 0;
+}
+
+static size_t _TCPIP_HEAP_FreeSize(TCPIP_STACK_HEAP_HANDLE heapH)
+{
+    int     entryIx;
+    size_t  freeSize;
+    TCPIP_HEAP_POOL_ENTRY_DCPT* pEntry;
+    TCPIP_HEAP_POOL_DCPT*      hDcpt;
+
+    hDcpt = _TCPIP_HEAP_ObjDcpt(heapH);
+
+    if(hDcpt)
+    {
+        freeSize = hDcpt->regionEnd - hDcpt->expansionPtr;
+        pEntry = hDcpt->poolEntries;
+        for(entryIx = 0; entryIx < hDcpt->nEntries; entryIx++, pEntry++)
+        {
+            freeSize += pEntry->freeBlocks * pEntry->blockSize;
+        }
+        return freeSize;
+    }
+
+    return 0;
+}
+
+static size_t _TCPIP_HEAP_HighWatermark(TCPIP_STACK_HEAP_HANDLE heapH)
+{
+    TCPIP_HEAP_POOL_DCPT*      hDcpt;
+
+    hDcpt = _TCPIP_HEAP_ObjDcpt(heapH);
+
+    if(hDcpt)
+    {
+        return hDcpt->maxUsedBytes;
+    }
+
+    return 0;
+}
+
+static TCPIP_STACK_HEAP_RES _TCPIP_HEAP_LastError(TCPIP_STACK_HEAP_HANDLE heapH)
+{
+    TCPIP_HEAP_POOL_DCPT*      hDcpt;
+    TCPIP_STACK_HEAP_RES  res;
+
+    hDcpt = _TCPIP_HEAP_ObjDcpt(heapH);
+
+    if(hDcpt)
+    {
+        res = hDcpt->_lastHeapErr;
+        hDcpt->_lastHeapErr = TCPIP_STACK_HEAP_RES_OK;
+    }
+    else
+    {
+        res = TCPIP_STACK_HEAP_RES_NO_HEAP; 
+    }
+
+    return res;
+}
+
+#if defined(TCPIP_STACK_DRAM_DEBUG_ENABLE) 
+static size_t _TCPIP_HEAP_AllocSize(TCPIP_STACK_HEAP_HANDLE heapH, const void* ptr)
+{
+    TCPIP_HEAP_POOL_DCPT*   hDcpt = _TCPIP_HEAP_ObjDcpt(heapH);
+
+    if(hDcpt && ptr)
+    {
+        if((const uint8_t*)ptr > hDcpt->regionStart && (const uint8_t*)ptr < hDcpt->regionEnd)
+        {
+            return ((_poolHead*)ptr - 1)->pEntry->blockSize;
+        }
+
+        if(hDcpt->heapExtFallback)
+        {
+            if(hDcpt->heapDoMap)
+            {
+                ptr = _TCPIP_HEAP_PointerMapCached(ptr);
+            }
+            return ((_extHead*)ptr - 1)->allocSize;
+        }
+    }
+
+    return 0;
+}
+#endif  // defined(TCPIP_STACK_DRAM_DEBUG_ENABLE) 
+
+
@@ -391,6 +391,8 @@ static uint16_t         _UDPv4IsTxPutReady(UDP_SOCKET_DCPT* pSkt);
 static uint16_t         _UDPv4Flush(UDP_SOCKET_DCPT* pSkt);
 static void*            _TxSktGetLockedV4Pkt(UDP_SOCKET_DCPT* pSkt, bool clrSktPkt);
 static void             _UDPv4TxPktReset(UDP_SOCKET_DCPT* pSkt, IPV4_PACKET* pPkt);
+static bool             _UDPv4TxSpareFits(UDP_SOCKET_DCPT* pSkt, TCPIP_MAC_PACKET* pPkt);
+static IPV4_PACKET*     _TxSktGetLockedV4Spare(UDP_SOCKET_DCPT* pSkt);
 static TCPIP_MAC_PKT_ACK_RES TCPIP_UDP_ProcessIPv4(TCPIP_MAC_PACKET* pRxPkt);
 #endif  // defined (TCPIP_STACK_USE_IPV4)
 
@@ -1216,9 +1218,16 @@ static void* _UDPv4AllocateSktTxBuffer(UDP_SOCKET_DCPT* pSkt, IP_ADDRESS_TYPE ad
     if(pSkt->flags.txSplitAlloc == 0)
     {
         pktSize = sizeof(UDP_V4_PACKET);
+        // reuse the packet kept on acknowledge, if any
+        pPkt = (TCPIP_MAC_PACKET*)_TxSktGetLockedV4Spare(pSkt);
+        if(pPkt != 0)
+        {
+            pPkt->next = 0;
+            pSkt->txSpareReuses++;
+        }
         // allocate from pool, if possible
 #if (TCPIP_UDP_USE_POOL_BUFFERS != 0)
-        if(pSkt->flags.usePool != 0 && pSkt->txSize <= udpPoolPacketSize)
+        if(pPkt == 0 && pSkt->flags.usePool != 0 && pSkt->txSize <= udpPoolPacketSize)
         {
             pPkt = (TCPIP_MAC_PACKET*)_PoolRemoveNodeLocked();
             if(pPkt != 0)
@@ -1226,6 +1235,7 @@ static void* _UDPv4AllocateSktTxBuffer(UDP_SOCKET_DCPT* pSkt, IP_ADDRESS_TYPE ad
                 pPkt->pktFlags = allocFlags | UDP_SOCKET_POOL_BUFFER_FLAG;
                 pPkt->next = 0;
                 pPkt->pDSeg->segLen = 0;
+                pSkt->txPoolAllocs++;
             }
         }
 #endif  // (TCPIP_UDP_USE_POOL_BUFFERS != 0)
@@ -1239,6 +1249,10 @@ static void* _UDPv4AllocateSktTxBuffer(UDP_SOCKET_DCPT* pSkt, IP_ADDRESS_TYPE ad
     if(pPkt == 0)
     {   // allocate from main packet pool
         pPkt = _UDPAllocateTxPacket(pktSize, pSkt->txSize, allocFlags);
+        if(pPkt != 0)
+        {
+            pSkt->txHeapAllocs++;
+        }
     }
 
     if(pPkt)
@@ -1310,6 +1324,15 @@ static bool _UDPv4TxAckFnc (TCPIP_MAC_PACKET * pPkt, const void * param)
         }
         if(pSkt->pV4Pkt != (IPV4_PACKET*)pPkt)
         {   // no longer using this packet;
+            // keep it for the next allocation rather than free it, if it still fits the socket
+            if(_UDPv4TxSpareFits(pSkt, pPkt))
+            {
+                pPkt->pDSeg->segLen = 0;
+                pPkt->pktFlags &= ~TCPIP_MAC_PKT_FLAG_QUEUED;
+                pSkt->pV4Spare = (IPV4_PACKET*)pPkt;
+                pSkt->txAllocCnt--;
+                freePkt = false;
+            }
             break;
         }
 
@@ -1378,6 +1401,46 @@ static void _UDPv4TxPktReset(UDP_SOCKET_DCPT* pSkt, IPV4_PACKET* pPkt)
 
 }
 
+// checks that an acknowledged packet can be kept as the socket spare:
+// there is no spare yet, the packet is not from the shared pool
+// and its buffer is large enough for the current socket TX size
+// called with the socket locked
+static bool _UDPv4TxSpareFits(UDP_SOCKET_DCPT* pSkt, TCPIP_MAC_PACKET* pPkt)
+{
+    uint8_t* pLoadEnd;
+
+    if(pSkt->pV4Spare != 0 || pSkt->flags.txSplitAlloc != 0)
+    {
+        return false;
+    }
+
+#if (TCPIP_UDP_USE_POOL_BUFFERS != 0)
+    if((pPkt->pktFlags & UDP_SOCKET_POOL_BUFFER_FLAG) != 0)
+    {   // pool packets go back to the pool to be shared
+        return false;
+    }
+#endif  // (TCPIP_UDP_USE_POOL_BUFFERS != 0)
+
+    pLoadEnd = pPkt->pDSeg->segLoad + pPkt->pDSeg->segSize;
+
+    return (pLoadEnd - (pPkt->pTransportLayer + sizeof(UDP_HEADER))) >= pSkt->txSize;
+}
+
+// takes the socket spare TX packet, if any
+static IPV4_PACKET* _TxSktGetLockedV4Spare(UDP_SOCKET_DCPT* pSkt)
+{
+    IPV4_PACKET* pPkt;
+
+    // don't let TX thread interfere
+    OSAL_CRITSECT_DATA_TYPE status = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_LOW);
+
+    pPkt = pSkt->pV4Spare;
+    pSkt->pV4Spare = 0;
+
+    OSAL_CRIT_Leave(OSAL_CRIT_TYPE_LOW, status);
+    return pPkt;
+}
+
 // following is the implementation for the TX thread lock
 // This a global lock that needs to be very fast
 
@@ -2317,6 +2380,14 @@ static void _UDPFreeTxResources(UDP_SOCKET_DCPT* pSkt)
 
 #if defined(TCPIP_STACK_USE_IPV4)
         case IP_ADDRESS_TYPE_IPV4:
+            {   // the spare is not counted as allocated
+                IPV4_PACKET* pSparePkt = _TxSktGetLockedV4Spare(pSkt);
+                if(pSparePkt)
+                {
+                    TCPIP_PKT_PacketFree(&pSparePkt->macPkt);
+                }
+            }
+
             pCurrPkt = _TxSktGetLockedV4Pkt(pSkt, true);
             if(pCurrPkt)
             {
@@ -2409,6 +2480,9 @@ bool TCPIP_UDP_SocketInfoGet(UDP_SOCKET s, UDP_SOCKET_INFO* pInfo)
     pInfo->hNet = pSkt->pSktNet;
     pInfo->rxQueueSize = TCPIP_Helper_SingleListCount(&pSkt->rxQueue);
     pInfo->txSize = pSkt->txEnd - pSkt->txStart;
+    pInfo->txHeapAllocs = pSkt->txHeapAllocs;
+    pInfo->txPoolAllocs = pSkt->txPoolAllocs;
+    pInfo->txSpareReuses = pSkt->txSpareReuses;
 
 	return true;
 
@@ -241,6 +241,10 @@ typedef struct
     uint16_t        sigMask;        // TCPIP_UDP_SIGNAL_TYPE: active events
     uint8_t         rxQueueLimit;   // max number of RX packets that can be queued at a certain time
     uint8_t         ttl;            // socket TTL value 
+    IPV4_PACKET*    pV4Spare;       // acknowledged IPv4 TX packet kept for reuse instead of being freed
+    uint32_t        txHeapAllocs;   // TX packets allocated from the heap
+    uint32_t        txPoolAllocs;   // TX packets taken from the private pool
+    uint32_t        txSpareReuses;  // TX packets reused from pV4Spare
     uint8_t         padding[];      // padding; not used
 
 } UDP_SOCKET_DCPT;
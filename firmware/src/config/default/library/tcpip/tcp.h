@@ -163,6 +163,27 @@ typedef enum
 
 
 
+// *****************************************************************************
+/*
+  Enumeration:
+    TCP_CC_ALGORITHM
+
+  Summary:
+    List of the TCP congestion control algorithms.
+
+  Description:
+    Describes the congestion control algorithms a TCP socket can use.
+    The algorithm decides how the congestion window grows while data is acknowledged
+    and how much it is reduced when a loss is detected.
+     
+*/
+typedef enum
+{
+    TCP_CC_NEWRENO,                 // NewReno (RFC 5681, RFC 6582): the window grows by one segment per round trip
+    TCP_CC_CUBIC,                   // CUBIC (RFC 8312): the window grows with the time since the last loss,
+                                    // independent of the round trip time; suited to high bandwidth-delay paths
+}TCP_CC_ALGORITHM;
+
 // *****************************************************************************
 /*
   Structure:
@@ -188,6 +209,18 @@ typedef struct
     uint16_t            rxPending;          // bytes pending in RX buffer
     uint16_t            txPending;          // bytes pending in TX buffer
     TCP_SOCKET_FLAGS    flags;              // socket flags
+    uint32_t            rxOooBytes;         // bytes received out of order and kept for reassembly
+    uint32_t            rxOooDiscardBytes;  // bytes received out of order but dropped
+    TCP_CC_ALGORITHM    ccAlgorithm;        // congestion control algorithm in use
+    uint32_t            cwnd;               // congestion window, bytes
+    uint32_t            ssthresh;           // slow start threshold, bytes
+    uint32_t            srtt;               // smoothed round trip time, ms; 0 if not measured yet
+    uint32_t            rttVar;             // round trip time variation, ms
+    uint32_t            txRetransmits;      // segments retransmitted
+    uint32_t            txFastRecoveries;   // losses recovered by fast retransmit
+    uint32_t            txTimeouts;         // retransmission timeouts
+    uint8_t             sndWndScale;        // window scale shift announced by the remote party; 0 if not in use
+    bool                sackPermitted;      // selective acknowledgments negotiated for the connection
 } TCP_SOCKET_INFO;
 
 // *****************************************************************************
@@ -252,6 +285,9 @@ typedef enum
                                     // If 0, the socket will use the default global IPv4 TTL setting.
                                     // This option allows the user to specify a different TTL value.
     TCP_OPTION_TOS,     			// Sets the Type of Service (TOS) for IPv4 packets sent by the socket
+    TCP_OPTION_CONGESTION_CONTROL,  // Selects the congestion control algorithm of the socket, a TCP_CC_ALGORITHM value.
+                                    // The default is the TCPIP_TCP_CONGESTION_CONTROL build time setting.
+                                    // A change takes effect with the next connection of the socket.
 } TCP_SOCKET_OPTION;
 
 
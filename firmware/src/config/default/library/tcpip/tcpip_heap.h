@@ -302,6 +302,14 @@ typedef enum
     // will be tried.
     TCPIP_STACK_HEAP_FLAG_POOL_STRICT       = 0x08,
 
+    // TCPIP_STACK_HEAP_TYPE_INTERNAL_HEAP_POOL type specific flag:
+    // If enabled, an allocation that the pool entries cannot satisfy
+    // (size larger than all entries or no free blocks)
+    // is passed to the malloc_fnc/free_fnc external functions.
+    // Otherwise the allocation fails.
+    // default is disabled
+    TCPIP_STACK_HEAP_FLAG_POOL_EXTERNAL_FALLBACK = 0x20,
+
 
     // when debugging is enabled, do not issue a warning when
     // a memory allocation operation fails
@@ -134,6 +134,9 @@ typedef struct
     TCPIP_NET_HANDLE    hNet;               // associated interface
     uint16_t            rxQueueSize;        // packets waiting in the rx queue
     uint16_t            txSize;             // tx buffer size
+    uint32_t            txHeapAllocs;       // tx packets allocated from the heap
+    uint32_t            txPoolAllocs;       // tx packets taken from the UDP private pool
+    uint32_t            txSpareReuses;      // tx packets reused after acknowledge, without allocation
 } UDP_SOCKET_INFO;
 
 
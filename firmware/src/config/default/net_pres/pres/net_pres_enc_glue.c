@@ -209,6 +209,8 @@ bool NET_PRES_EncProviderStreamClientDeinit0(void)
 }
 
 char *sni_host_name = NULL;
+const uint8_t *net_pres_server_id = NULL;
+int net_pres_server_id_len = 0;
 
 bool NET_PRES_EncProviderStreamClientOpen0(uintptr_t transHandle, void * providerData)
 {
@@ -231,6 +233,14 @@ bool NET_PRES_EncProviderStreamClientOpen0(uintptr_t transHandle, void * provide
     	        return false;
         	}
                 }
+        if ((NULL != net_pres_server_id) && (net_pres_server_id_len > 0))
+        {
+            /* Resume a cached session with this server where possible */
+#ifdef HAVE_SESSION_TICKET
+            wolfSSL_UseSessionTicket(ssl);
+#endif
+            wolfSSL_SetServerID(ssl, net_pres_server_id, net_pres_server_id_len, 0);
+        }
         if (wolfSSL_UseALPN(ssl, NET_PRES_ALPN_PROTOCOL_NAME_LIST, sizeof(NET_PRES_ALPN_PROTOCOL_NAME_LIST),WOLFSSL_ALPN_FAILED_ON_MISMATCH) != WOLFSSL_SUCCESS)
         {
             return false;
@@ -34,7 +34,6 @@ SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
 
 #define SYS_MQTT_MAX_NUM_OF_INSTANCES  1
 extern SYS_MQTT_Handle g_asSysMqttHandle[SYS_MQTT_MAX_NUM_OF_INSTANCES];
-MQTTMessage g_sMqttMsg;
 
 extern uint8_t g_OmitPacketType;
 #define SYS_MQTT_DBG_OMIT_PKT_TYPE_KEEPALIVE    1
@@ -153,12 +152,321 @@ void SYS_MQTT_ProcessTimeout(SYS_MQTT_Handle *hdl, SYS_MQTT_EVENT_TYPE cbEvent,
     }
 }
 
+/*
+ ** Take a Semaphore before accessing the In-flight Slots, shared by the 
+ ** Publishing Task and the Task running SYS_MQTT_Paho_Task()
+ */
+static int32_t SYS_MQTT_TakeSemaphore(SYS_MQTT_Handle *hdl)
+{
+    return OSAL_SEM_Pend(&hdl->InstSemaphore, OSAL_WAIT_FOREVER);
+}
+
+/*
+ ** Give the Semaphore while leaving Critical Section
+ */
+static void SYS_MQTT_GiveSemaphore(SYS_MQTT_Handle *hdl)
+{
+    OSAL_SEM_Post(&hdl->InstSemaphore);
+}
+
+static void SYS_MQTT_InflightFree(SYS_MQTT_PahoInflightSlot *psSlot)
+{
+    if (psSlot->topicName)
+    {
+        /* Topic and Payload share one allocation */
+        OSAL_Free(psSlot->topicName);
+    }
+
+    memset(psSlot, 0, sizeof (SYS_MQTT_PahoInflightSlot));
+}
+
+static SYS_MQTT_PahoInflightSlot *SYS_MQTT_InflightFind(SYS_MQTT_Handle *hdl, uint16_t packetId)
+{
+    int i = 0;
+
+    for (i = 0; i < SYS_MQTT_PAHO_INFLIGHT_WINDOW; i++)
+    {
+        SYS_MQTT_PahoInflightSlot *psSlot = &hdl->uVendorInfo.sPahoInfo.asInflight[i];
+
+        if ((psSlot->eState != SYS_MQTT_PAHO_INFLIGHT_FREE) && (psSlot->packetId == packetId))
+        {
+            return psSlot;
+        }
+    }
+
+    return NULL;
+}
+
+static SYS_MQTT_PahoInflightSlot *SYS_MQTT_InflightAlloc(SYS_MQTT_Handle *hdl, const char *topicName, const char *message, uint16_t message_len)
+{
+    int i = 0;
+    size_t topicLen = strlen(topicName);
+
+    for (i = 0; i < SYS_MQTT_PAHO_INFLIGHT_WINDOW; i++)
+    {
+        SYS_MQTT_PahoInflightSlot *psSlot = &hdl->uVendorInfo.sPahoInfo.asInflight[i];
+
+        if (psSlot->eState != SYS_MQTT_PAHO_INFLIGHT_FREE)
+        {
+            continue;
+        }
+
+        psSlot->topicName = OSAL_Malloc(topicLen + 1 + message_len);
+        if (psSlot->topicName == NULL)
+        {
+            return NULL;
+        }
+
+        memcpy(psSlot->topicName, topicName, topicLen + 1);
+
+        psSlot->payload = (uint8_t *) &psSlot->topicName[topicLen + 1];
+
+        memcpy(psSlot->payload, message, message_len);
+
+        psSlot->payloadLen = message_len;
+
+        return psSlot;
+    }
+
+    return NULL;
+}
+
+/* Drop every outstanding Publish, letting the Application know they were never acknowledged */
+static void SYS_MQTT_InflightReset(SYS_MQTT_Handle *hdl)
+{
+    int i = 0;
+
+    for (i = 0; i < SYS_MQTT_PAHO_INFLIGHT_WINDOW; i++)
+    {
+        SYS_MQTT_PahoInflightSlot *psSlot = &hdl->uVendorInfo.sPahoInfo.asInflight[i];
+        uint16_t packetId;
+
+        SYS_MQTT_TakeSemaphore(hdl);
+
+        if (psSlot->eState == SYS_MQTT_PAHO_INFLIGHT_FREE)
+        {
+            SYS_MQTT_GiveSemaphore(hdl);
+
+            continue;
+        }
+
+        packetId = psSlot->packetId;
+
+        SYS_MQTT_InflightFree(psSlot);
+
+        SYS_MQTT_GiveSemaphore(hdl);
+
+        if (hdl->callback_fn)
+        {
+            hdl->callback_fn(SYS_MQTT_EVENT_MSG_PUBACK_TO,
+                             &packetId,
+                             sizeof (packetId),
+                             hdl->vCookie);
+        }
+    }
+}
+
+/* Callback registered with Paho SW to get the PUBACK/ PUBREC/ PUBCOMP for the Publishes in flight */
+static void SYS_MQTT_InflightAckCallback(void *ctx, int packetType, unsigned short packetId)
+{
+    SYS_MQTT_Handle *hdl = (SYS_MQTT_Handle *) ctx;
+    SYS_MQTT_PahoInflightSlot *psSlot = NULL;
+
+    if (g_OmitPacketType == SYS_MQTT_DBG_OMIT_PKT_TYPE_PUBACK)
+    {
+        return; //This is test stub 
+    }
+
+    SYS_MQTT_TakeSemaphore(hdl);
+
+    psSlot = SYS_MQTT_InflightFind(hdl, packetId);
+    if (psSlot == NULL)
+    {
+        SYS_MQTT_GiveSemaphore(hdl);
+
+        SYS_MQTTDEBUG_DBG_PRINT(g_AppDebugHdl, MQTT_DATA, "Ack (%d) for unknown Packet Id (%d)\r\n", packetType, packetId);
+
+        return;
+    }
+
+    if ((packetType == PUBREC) && (psSlot->eState == SYS_MQTT_PAHO_INFLIGHT_WAIT_PUBREC))
+    {
+        /* Paho has already sent the PUBREL */
+        psSlot->eState = SYS_MQTT_PAHO_INFLIGHT_WAIT_PUBCOMP;
+
+        psSlot->retries = 0;
+
+        psSlot->sentTime = SYS_TMR_TickCountGet();
+
+        SYS_MQTT_GiveSemaphore(hdl);
+
+        return;
+    }
+
+    if (((packetType == PUBACK) && (psSlot->eState == SYS_MQTT_PAHO_INFLIGHT_WAIT_PUBACK)) ||
+            ((packetType == PUBCOMP) && (psSlot->eState == SYS_MQTT_PAHO_INFLIGHT_WAIT_PUBCOMP)))
+    {
+        SYS_MQTT_InflightFree(psSlot);
+
+        SYS_MQTT_GiveSemaphore(hdl);
+
+        SYS_MQTTDEBUG_DBG_PRINT(g_AppDebugHdl, MQTT_DATA, "Publish (%d) acknowledged\r\n", packetId);
+
+        /* Tell the Application that the Publish is complete */
+        if (hdl->callback_fn)
+        {
+            uint16_t id = packetId;
+
+            hdl->callback_fn(SYS_MQTT_EVENT_MSG_PUBLISHED,
+                             &id,
+                             sizeof (id),
+                             hdl->vCookie);
+        }
+
+        return;
+    }
+
+    SYS_MQTT_GiveSemaphore(hdl);
+}
+
+/* Retransmit the overdue Publishes with DUP set; returns false if the connection had to be dropped */
+static bool SYS_MQTT_InflightProcess(SYS_MQTT_Handle *hdl)
+{
+    int i = 0;
+    int rc = 0;
+
+    for (i = 0; i < SYS_MQTT_PAHO_INFLIGHT_WINDOW; i++)
+    {
+        SYS_MQTT_PahoInflightSlot *psSlot = &hdl->uVendorInfo.sPahoInfo.asInflight[i];
+
+        SYS_MQTT_TakeSemaphore(hdl);
+
+        if ((psSlot->eState == SYS_MQTT_PAHO_INFLIGHT_FREE) ||
+                ((SYS_TMR_TickCountGet() - psSlot->sentTime) <= SYS_MQTT_TIMEOUT_CONST))
+        {
+            SYS_MQTT_GiveSemaphore(hdl);
+
+            continue;
+        }
+
+        if (psSlot->retries >= SYS_MQTT_PAHO_INFLIGHT_MAX_RETRIES)
+        {
+            uint16_t packetId = psSlot->packetId;
+
+            SYS_MQTT_InflightFree(psSlot);
+
+            SYS_MQTT_GiveSemaphore(hdl);
+
+            if (hdl->callback_fn)
+            {
+                hdl->callback_fn(SYS_MQTT_EVENT_MSG_PUBACK_TO,
+                                 &packetId,
+                                 sizeof (packetId),
+                                 hdl->vCookie);
+            }
+
+            continue;
+        }
+
+        if (psSlot->eState == SYS_MQTT_PAHO_INFLIGHT_WAIT_PUBCOMP)
+        {
+            rc = MQTTPubrel(&(hdl->uVendorInfo.sPahoInfo.sPahoClient), psSlot->packetId);
+        }
+        else
+        {
+            MQTTMessage sMqttMsg;
+
+            memset(&sMqttMsg, 0, sizeof (sMqttMsg));
+
+            sMqttMsg.dup = 1;
+
+            sMqttMsg.id = psSlot->packetId;
+
+            sMqttMsg.payload = psSlot->payload;
+
+            sMqttMsg.payloadlen = psSlot->payloadLen;
+
+            sMqttMsg.qos = (enum QoS)psSlot->qos;
+
+            sMqttMsg.retained = psSlot->retain;
+
+            rc = MQTTPublish(&(hdl->uVendorInfo.sPahoInfo.sPahoClient), psSlot->topicName, &sMqttMsg);
+        }
+
+        if (rc != 0)
+        {
+            SYS_MQTTDEBUG_ERR_PRINT(g_AppDebugHdl, MQTT_DATA, "Retransmit of (%d) Failed (%d)\r\n", psSlot->packetId, rc);
+
+            SYS_MQTT_GiveSemaphore(hdl);
+
+            if ((rc = SYS_NET_CtrlMsg(hdl->netSrvcHdl,
+                                      SYS_NET_CTRL_MSG_DISCONNECT,
+                                      NULL, 0)) != SYS_NET_SUCCESS)
+            {
+                SYS_MQTTDEBUG_ERR_PRINT(g_AppDebugHdl, MQTT_DATA, "SYS_NET_CtrlMsg() Failed (%d)\r\n", rc);
+            }
+
+            SYS_MQTT_SetInstStatus(hdl, SYS_MQTT_STATUS_MQTT_DISCONNECTING);
+
+            return false;
+        }
+
+        SYS_MQTTDEBUG_DBG_PRINT(g_AppDebugHdl, MQTT_DATA, "Retransmitted (%d)\r\n", psSlot->packetId);
+
+        psSlot->retries++;
+
+        psSlot->sentTime = SYS_TMR_TickCountGet();
+
+        SYS_MQTT_GiveSemaphore(hdl);
+    }
+
+    return true;
+}
+
 /* Callback registered with Paho SW to get the messages received on the subscribed topic */
-void SYS_MQTT_messageCallback(MessageData* data)
+/* Hand the Application a view of the message still sitting in the Paho Read Buffer */
+static void SYS_MQTT_messageView(SYS_MQTT_Handle *hdl, MessageData* data, size_t offset, size_t totalLen)
 {
-    SYS_MQTT_PublishConfig sMsg;
+    SYS_MQTT_PublishView sView;
+
+    sView.qos = data->message->qos;
+
+    sView.retain = data->message->retained;
+
+    sView.topicName = data->topicName->lenstring.data;
 
-    SYS_MQTTDEBUG_DBG_PRINT(g_AppDebugHdl, MQTT_CFG, "Topic = %s\r\n", (char *) data->topicName->lenstring.data);
+    sView.topicLength = data->topicName->lenstring.len;
+
+    sView.message = (const uint8_t *) data->message->payload;
+
+    sView.messageLength = (uint16_t) data->message->payloadlen;
+
+    sView.offset = offset;
+
+    sView.totalLength = totalLen;
+
+    if (hdl->callback_fn)
+    {
+        hdl->callback_fn(SYS_MQTT_EVENT_MSG_RCVD_VIEW,
+                         &sView,
+                         sizeof (sView),
+                         hdl->vCookie);
+    }
+}
+
+/* Callback registered with Paho SW to get the pieces of a message larger than the Read Buffer */
+static void SYS_MQTT_messageChunkCallback(void *ctx, MessageData* data, size_t offset, size_t totalLen)
+{
+    SYS_MQTT_messageView((SYS_MQTT_Handle *) ctx, data, offset, totalLen);
+}
+
+/* 
+ ** Copy of the message for Applications that keep using SYS_MQTT_EVENT_MSG_RCVD;
+ ** kept out of line so that the View path does not carry its stack frame
+ */
+static void __attribute__((noinline)) SYS_MQTT_messageCopy(SYS_MQTT_Handle *hdl, MessageData* data)
+{
+    SYS_MQTT_PublishConfig sMsg;
 
     memset(&sMsg, 0, sizeof (sMsg));
 
@@ -171,15 +479,31 @@ void SYS_MQTT_messageCallback(MessageData* data)
     sMsg.topicLength = data->topicName->lenstring.len;
 
     /* Sending the Published message to the Application */
-    if (g_asSysMqttHandle[0].callback_fn)
+    if (hdl->callback_fn)
     {
-        g_asSysMqttHandle[0].callback_fn(SYS_MQTT_EVENT_MSG_RCVD,
-                                         &sMsg,
-                                         sizeof (sMsg),
-                                         g_asSysMqttHandle[0].vCookie);
+        hdl->callback_fn(SYS_MQTT_EVENT_MSG_RCVD,
+                         &sMsg,
+                         sizeof (sMsg),
+                         hdl->vCookie);
     }
 }
 
+void SYS_MQTT_messageCallback(MessageData* data)
+{
+    SYS_MQTT_Handle *hdl = &g_asSysMqttHandle[0];
+
+    SYS_MQTTDEBUG_DBG_PRINT(g_AppDebugHdl, MQTT_CFG, "Topic Length = %d\r\n", data->topicName->lenstring.len);
+
+    if (hdl->sCfgInfo.bMsgRcvdView)
+    {
+        SYS_MQTT_messageView(hdl, data, 0, data->message->payloadlen);
+
+        return;
+    }
+
+    SYS_MQTT_messageCopy(hdl, data);
+}
+
 extern char *sni_host_name;
 
 SYS_MODULE_OBJ SYS_MQTT_PAHO_Open(SYS_MQTT_Config *cfg,
@@ -343,6 +667,16 @@ void SYS_MQTT_Paho_Task(SYS_MODULE_OBJ obj)
             firstConnect++;
         }
 
+        /* Nothing received on the previous socket is valid anymore */
+        pic32mzw1_rx_reset(&(hdl->uVendorInfo.sPahoInfo.sPahoNetwork));
+
+        MQTTSetAckHandler(&(hdl->uVendorInfo.sPahoInfo.sPahoClient), SYS_MQTT_InflightAckCallback, hdl);
+
+        /* Without the View, a message larger than the Read Buffer has nowhere to go */
+        MQTTSetChunkHandler(&(hdl->uVendorInfo.sPahoInfo.sPahoClient),
+                            hdl->sCfgInfo.bMsgRcvdView ? SYS_MQTT_messageChunkCallback : NULL,
+                            hdl);
+
         connectData.MQTTVersion = 4; //use protocol version 3.1.1
 
         if (strlen(hdl->sCfgInfo.sBrokerConfig.clientId) == 0)
@@ -589,43 +923,8 @@ void SYS_MQTT_Paho_Task(SYS_MODULE_OBJ obj)
     }
         break;
 
-        /* Waiting for Pub Ack */
+        /* MQTT Connection Up; Pub Acks are matched to the in-flight slots as they arrive */
     case SYS_MQTT_STATUS_WAIT_FOR_MQTT_PUBACK:
-    {
-        /* Wait for the MQTT Publish Ack */
-        int rc = MQTTWaitForPublishAck(&(hdl->uVendorInfo.sPahoInfo.sPahoClient),
-                                       &g_sMqttMsg);
-
-        if (g_OmitPacketType == SYS_MQTT_DBG_OMIT_PKT_TYPE_PUBACK)
-        {
-            rc = FAILURE; //This is test stub 
-        }
-
-        if (rc == SUCCESS)
-        {
-            SYS_MQTT_ResetTimer(hdl);
-
-            SYS_MQTT_SetInstStatus(hdl, SYS_MQTT_STATUS_MQTT_CONNECTED);
-
-            SYS_MQTTDEBUG_DBG_PRINT(g_AppDebugHdl, MQTT_DATA, "Puback received\r\n", g_sMqttMsg.payload);
-
-            /* Tell the Application that we have received the PUBACK */
-            if (hdl->callback_fn)
-            {
-                hdl->callback_fn(SYS_MQTT_EVENT_MSG_PUBLISHED,
-                                 NULL,
-                                 0,
-                                 hdl->vCookie);
-            }
-        }
-        else
-        {
-            SYS_MQTT_ProcessTimeout(hdl, SYS_MQTT_EVENT_MSG_PUBACK_TO, SYS_MQTT_STATUS_MQTT_DISCONNECTING);
-        }
-    }
-        break;
-
-        /* MQTT Connection Up */
     case SYS_MQTT_STATUS_MQTT_CONNECTED:
     {
         /* Wait for any message on the Subscribed Topics */
@@ -633,6 +932,14 @@ void SYS_MQTT_Paho_Task(SYS_MODULE_OBJ obj)
         if (rc == SUCCESS)
         {
         }
+
+        /* The client mutex is taken ahead of the In-flight Semaphore, in the
+           same order as the publishing task and the Ack callback */
+        MutexLock(&(hdl->uVendorInfo.sPahoInfo.sPahoClient.mutex));
+
+        SYS_MQTT_InflightProcess(hdl);
+
+        MutexUnlock(&(hdl->uVendorInfo.sPahoInfo.sPahoClient.mutex));
     }
         break;
 
@@ -658,6 +965,8 @@ void SYS_MQTT_Paho_Task(SYS_MODULE_OBJ obj)
             hdl->sCfgInfo.sSubscribeConfig[i].entryValid = 0;
         }
 
+        SYS_MQTT_InflightReset(hdl);
+
         SYS_MQTT_SetInstStatus(hdl, SYS_MQTT_STATUS_MQTT_DISCONNECTED);
 
         /* Call the Application CB to give 'Disconnected' event */
@@ -946,6 +1255,8 @@ int32_t SYS_MQTT_Paho_CtrlMsg(SYS_MODULE_OBJ obj, SYS_MQTT_CtrlMsgType eCtrlMsgT
 int32_t SYS_MQTT_Paho_SendMsg(SYS_MODULE_OBJ obj, SYS_MQTT_PublishTopicCfg *psTopicCfg, char *message, uint16_t message_len)
 {
     SYS_MQTT_Handle *hdl = (SYS_MQTT_Handle *) obj;
+    SYS_MQTT_PahoInflightSlot *psSlot = NULL;
+    MQTTMessage sMqttMsg;
     int rc = 0;
 
     SYS_MQTTDEBUG_FN_ENTER_PRINT(g_AppDebugHdl, MQTT_DATA);
@@ -957,27 +1268,57 @@ int32_t SYS_MQTT_Paho_SendMsg(SYS_MODULE_OBJ obj, SYS_MQTT_PublishTopicCfg *psTo
         return SYS_MQTT_FAILURE;
     }
 
-    memset(&g_sMqttMsg, 0, sizeof (g_sMqttMsg));
+    /* The client is also driven by the MQTT task; its mutex is taken ahead of
+       the In-flight Semaphore, in the same order as the Ack callback */
+    MutexLock(&(hdl->uVendorInfo.sPahoInfo.sPahoClient.mutex));
 
-    g_sMqttMsg.dup = 0;
+    /* Held until the slot carries the Packet Id, so that an early Ack is not missed */
+    SYS_MQTT_TakeSemaphore(hdl);
+
+    if (psTopicCfg->qos != 0)
+    {
+        /* Keep a copy of the message for retransmission until it is acknowledged */
+        psSlot = SYS_MQTT_InflightAlloc(hdl, psTopicCfg->topicName, message, message_len);
+        if (psSlot == NULL)
+        {
+            SYS_MQTT_GiveSemaphore(hdl);
+
+            MutexUnlock(&(hdl->uVendorInfo.sPahoInfo.sPahoClient.mutex));
+
+            SYS_MQTTDEBUG_ERR_PRINT(g_AppDebugHdl, MQTT_DATA, "No free In-flight Slot\r\n");
+
+            return SYS_MQTT_WINDOW_FULL;
+        }
+    }
 
-    g_sMqttMsg.id = 1;
+    memset(&sMqttMsg, 0, sizeof (sMqttMsg));
 
-    g_sMqttMsg.payload = message;
+    sMqttMsg.dup = 0;
 
-    g_sMqttMsg.payloadlen = message_len;
+    sMqttMsg.payload = message;
 
-    g_sMqttMsg.qos = psTopicCfg->qos;
+    sMqttMsg.payloadlen = message_len;
 
-    g_sMqttMsg.retained = psTopicCfg->retain;
+    sMqttMsg.qos = (enum QoS)psTopicCfg->qos;
+
+    sMqttMsg.retained = psTopicCfg->retain;
 
     rc = MQTTPublish(&(hdl->uVendorInfo.sPahoInfo.sPahoClient),
                      psTopicCfg->topicName,
-                     &g_sMqttMsg);
+                     &sMqttMsg);
     if (rc != 0)
     {
         SYS_MQTTDEBUG_ERR_PRINT(g_AppDebugHdl, MQTT_DATA, "MQTTPublish() Failed (%d)\r\n", rc);
 
+        if (psSlot)
+        {
+            SYS_MQTT_InflightFree(psSlot);
+        }
+
+        SYS_MQTT_GiveSemaphore(hdl);
+
+        MutexUnlock(&(hdl->uVendorInfo.sPahoInfo.sPahoClient.mutex));
+
         if ((rc = SYS_NET_CtrlMsg(hdl->netSrvcHdl,
                                   SYS_NET_CTRL_MSG_DISCONNECT,
                                   NULL, 0)) != SYS_NET_SUCCESS)
@@ -992,14 +1333,28 @@ int32_t SYS_MQTT_Paho_SendMsg(SYS_MODULE_OBJ obj, SYS_MQTT_PublishTopicCfg *psTo
         return SYS_MQTT_FAILURE;
     }
 
-    SYS_MQTT_StartTimer(hdl, SYS_MQTT_TIMEOUT_CONST);
+    psTopicCfg->packetId = sMqttMsg.id;
 
-    if (psTopicCfg->qos != 0)
+    if (psSlot)
     {
-        SYS_MQTT_SetInstStatus(hdl, SYS_MQTT_STATUS_WAIT_FOR_MQTT_PUBACK);
+        psSlot->packetId = sMqttMsg.id;
+
+        psSlot->qos = psTopicCfg->qos;
+
+        psSlot->retain = psTopicCfg->retain;
+
+        psSlot->retries = 0;
+
+        psSlot->sentTime = SYS_TMR_TickCountGet();
+
+        psSlot->eState = (psTopicCfg->qos == 1) ? SYS_MQTT_PAHO_INFLIGHT_WAIT_PUBACK : SYS_MQTT_PAHO_INFLIGHT_WAIT_PUBREC;
     }
 
-    SYS_MQTTDEBUG_DBG_PRINT(g_AppDebugHdl, MQTT_DATA, "Publish to Topic (%s)\r\n", psTopicCfg->topicName);
+    SYS_MQTT_GiveSemaphore(hdl);
+
+    MutexUnlock(&(hdl->uVendorInfo.sPahoInfo.sPahoClient.mutex));
+
+    SYS_MQTTDEBUG_DBG_PRINT(g_AppDebugHdl, MQTT_DATA, "Publish to Topic (%s) Id (%d)\r\n", psTopicCfg->topicName, sMqttMsg.id);
 
     return SYS_MQTT_SUCCESS;
 }
@@ -173,6 +173,9 @@ typedef enum
 
     // Sys NET Invalid Handle
     SYS_MQTT_INVALID_HANDLE = -6,
+
+    // All In-flight Publish Slots are awaiting Acknowledgement
+    SYS_MQTT_WINDOW_FULL = -7,
 } SYS_MQTT_RESULT;
 
 typedef enum
@@ -283,6 +286,48 @@ typedef struct
 
 // *****************************************************************************
 
+/* System MQTT Received Message View
+
+  Summary:
+    Borrowed view of a message received on a topic subscribed to, pointing 
+        straight into the receive buffer of the MQTT service.
+
+  Remarks:
+    This View is passed to the Application via the SYS_MQTT_CALLBACK() function
+        with the SYS_MQTT_EVENT_MSG_RCVD_VIEW event when bMsgRcvdView is set in
+        the SYS_MQTT_Config. The pointers are only valid till the callback returns.
+        A message larger than the receive buffer comes in several callbacks, 
+        one for each piece, in the order of offset.
+ */
+typedef struct
+{
+    //Qos (0/ 1/ 2)
+    uint8_t qos;
+
+    //Retain (0/1)
+    uint8_t retain;
+
+    //Topic on which the message was received; not NULL terminated
+    const char *topicName;
+
+    //Topic Length
+    uint16_t topicLength;
+
+    //This piece of the Message
+    const uint8_t *message;
+
+    //Length of this piece of the Message
+    uint16_t messageLength;
+
+    //Offset of this piece within the Message
+    uint32_t offset;
+
+    //Length of the complete Message
+    uint32_t totalLength;
+} SYS_MQTT_PublishView;
+
+// *****************************************************************************
+
 /* System MQTT Read Published Message
 
   Summary:
@@ -304,6 +349,9 @@ typedef struct
 
     //Topic Length
     uint16_t topicLength;
+
+    //Packet Identifier assigned to a QoS 1/2 message, filled in by SYS_MQTT_Publish()
+    uint16_t packetId;
 } SYS_MQTT_PublishTopicCfg;
 
 // *****************************************************************************
@@ -334,7 +382,7 @@ typedef enum
     //MQTT Client UnSubscribed from a Grp
     SYS_MQTT_EVENT_MSG_UNSUBSCRIBED,
 
-    //MQTT Client Published to a Grp	
+    //MQTT Client Published to a Grp; data points to the uint16_t Packet Identifier
     SYS_MQTT_EVENT_MSG_PUBLISHED,
 
     //MQTT Client ConnAck TimeOut
@@ -343,11 +391,14 @@ typedef enum
     //MQTT Client SubAck TimeOut
     SYS_MQTT_EVENT_MSG_SUBACK_TO,
 
-    //MQTT Client PubAck TimeOut
+    //MQTT Client PubAck TimeOut; data points to the uint16_t Packet Identifier
     SYS_MQTT_EVENT_MSG_PUBACK_TO,
 
     //MQTT Client PubAck TimeOut
     SYS_MQTT_EVENT_MSG_UNSUBACK_TO,
+
+    //Message received on a topic subscribed to; data points to a SYS_MQTT_PublishView
+    SYS_MQTT_EVENT_MSG_RCVD_VIEW,
 } SYS_MQTT_EVENT_TYPE;
 
 // *****************************************************************************
@@ -380,6 +431,9 @@ typedef struct
 
     //Network Interface - Wifi or Ethernet
     uint8_t intf;
+
+    //Deliver received messages as SYS_MQTT_EVENT_MSG_RCVD_VIEW instead of copying them into SYS_MQTT_EVENT_MSG_RCVD
+    bool bMsgRcvdView;
 } SYS_MQTT_Config;
 
 extern const SYS_MQTT_Config g_sSysMqttConfig;
@@ -507,6 +561,8 @@ SYS_MQTT_STATUS SYS_MQTT_GetStatus(SYS_MODULE_OBJ obj);
    Returns:
                 SYS_MQTT_SUCCESS - Indicates that the Request was catered to successfully
                 SYS_MQTT_FAILURE - Indicates that the Request failed
+                SYS_MQTT_WINDOW_FULL - Indicates that SYS_MQTT_PAHO_INFLIGHT_WINDOW QoS 1/2 
+                        messages are already awaiting acknowledgement
 
    Example:
        <code>
@@ -524,6 +580,11 @@ SYS_MQTT_STATUS SYS_MQTT_GetStatus(SYS_MODULE_OBJ obj);
                 }
                 </code>
 
+  Remarks:
+       QoS 1/2 messages do not block further publishing; up to SYS_MQTT_PAHO_INFLIGHT_WINDOW 
+       may be outstanding. The Packet Identifier is returned in psPubCfg->packetId and is 
+       passed back with the SYS_MQTT_EVENT_MSG_PUBLISHED/ SYS_MQTT_EVENT_MSG_PUBACK_TO events.
+
  */
 int32_t SYS_MQTT_Publish(SYS_MODULE_OBJ obj, SYS_MQTT_PublishTopicCfg *psPubCfg, char *message, uint16_t message_len);
 
@@ -33,11 +33,42 @@ SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
 
 #define SYS_MQTT_PAHO_MAX_TX_BUFF_LEN  1500
 #define SYS_MQTT_PAHO_MAX_RX_BUFF_LEN  1500
+
+/* Number of QoS 1/2 publishes which may be awaiting acknowledgement at once */
+#ifndef SYS_MQTT_PAHO_INFLIGHT_WINDOW
+#define SYS_MQTT_PAHO_INFLIGHT_WINDOW       8
+#endif
+
+/* Number of DUP retransmissions of an unacknowledged publish before giving up */
+#ifndef SYS_MQTT_PAHO_INFLIGHT_MAX_RETRIES
+#define SYS_MQTT_PAHO_INFLIGHT_MAX_RETRIES  3
+#endif
+
+typedef enum {
+    SYS_MQTT_PAHO_INFLIGHT_FREE = 0,
+    SYS_MQTT_PAHO_INFLIGHT_WAIT_PUBACK,     /* QoS 1 - PUBLISH sent */
+    SYS_MQTT_PAHO_INFLIGHT_WAIT_PUBREC,     /* QoS 2 - PUBLISH sent */
+    SYS_MQTT_PAHO_INFLIGHT_WAIT_PUBCOMP,    /* QoS 2 - PUBREL sent */
+} SYS_MQTT_PAHO_INFLIGHT_STATE;
+
+typedef struct {
+    SYS_MQTT_PAHO_INFLIGHT_STATE eState;
+    uint16_t        packetId;
+    uint8_t         qos;
+    uint8_t         retain;
+    uint8_t         retries;
+    uint32_t        sentTime;
+    uint16_t        payloadLen;
+    char            *topicName;     /* topic and payload kept for DUP retransmission */
+    uint8_t         *payload;
+} SYS_MQTT_PahoInflightSlot;
+
 typedef struct {
     Network sPahoNetwork;
     MQTTClient sPahoClient;
     uint8_t         subscribeCount;
  	SYS_MQTT_PublishConfig   sPubSubCfgInProgress;
+    SYS_MQTT_PahoInflightSlot   asInflight[SYS_MQTT_PAHO_INFLIGHT_WINDOW];
 	unsigned char   sendbuf[SYS_MQTT_PAHO_MAX_TX_BUFF_LEN];
     unsigned char   recvbuf[SYS_MQTT_PAHO_MAX_RX_BUFF_LEN];
 } SYS_MQTT_PahoInfo;
@@ -67,7 +67,7 @@ void _APP_Tasks(  void *pvParameters  )
     while(1)
     {
         APP_Tasks();
-        vTaskDelay(100 / portTICK_PERIOD_MS);
+        APP_TasksWait();
     }
 }
 /* Handle for the MQTT_APP_Tasks. */
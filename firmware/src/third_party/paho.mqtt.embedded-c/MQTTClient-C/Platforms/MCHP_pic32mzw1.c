@@ -61,18 +61,123 @@ void TimerInit(Timer* timer) {
 	timer->end_time = 0;
 }
 
+void MutexInit(Mutex* mutex)
+{
+    /* The client is re-initialised on every clean session, keep the mutex */
+    if (mutex->mutex == NULL)
+    {
+        OSAL_MUTEX_Create(&mutex->mutex);
+        mutex->owner = NULL;
+        mutex->count = 0;
+    }
+}
+
+int MutexLock(Mutex* mutex)
+{
+    TaskHandle_t task = xTaskGetCurrentTaskHandle();
+
+    if (mutex->owner == task)
+    {
+        mutex->count++;
+        return 0;
+    }
+
+    if (OSAL_MUTEX_Lock(&mutex->mutex, OSAL_WAIT_FOREVER) != OSAL_RESULT_TRUE)
+    {
+        return -1;
+    }
+
+    mutex->owner = task;
+    mutex->count = 1;
+
+    return 0;
+}
+
+int MutexUnlock(Mutex* mutex)
+{
+    if (mutex->owner != xTaskGetCurrentTaskHandle())
+    {
+        return -1;
+    }
+
+    if (--mutex->count > 0)
+    {
+        return 0;
+    }
+
+    mutex->owner = NULL;
+
+    return (OSAL_MUTEX_Unlock(&mutex->mutex) == OSAL_RESULT_TRUE) ? 0 : -1;
+}
+
+int ThreadStart(Thread* thread, void (*fn)(void*), void* arg)
+{
+    if (xTaskCreate(fn, "MQTTTask", 1024, arg, uxTaskPriorityGet(NULL), &thread->task) != pdPASS)
+    {
+        return -1;
+    }
+
+    return 0;
+}
+
 int pic32mzw1_read(Network* n, unsigned char* buffer, int len, int timeout_ms) 
 { 
+    int copied = 0;
     int recv_len = 0;
     SYS_MODULE_OBJ obj = SYS_MQTT_Paho_GetNetHdlFromNw(n);
 
     if(obj  == SYS_MODULE_OBJ_INVALID)
     {
-        SYS_CONSOLE_PRINT("pic32mzw1_write():Invalid Nw Handle\r\n");
+        SYS_CONSOLE_PRINT("pic32mzw1_read():Invalid Nw Handle\r\n");
 		return -1;
     }
-    recv_len = SYS_NET_RecvMsg(obj, buffer, len);
-    return recv_len;
+
+    while (copied < len)
+    {
+        int chunk = n->rxLen - n->rxRead;
+
+        if (chunk == 0)
+        {
+            n->rxRead = 0;
+            n->rxLen = 0;
+
+            if ((len - copied) >= PIC32MZW1_RX_RING_LEN)
+            {
+                /* Large enough to go straight into the caller's buffer */
+                recv_len = SYS_NET_RecvMsg(obj, buffer + copied, len - copied);
+                if (recv_len <= 0)
+                {
+                    break;
+                }
+
+                copied += recv_len;
+                continue;
+            }
+
+            /* Take everything the socket has, upto the size of the ring */
+            recv_len = SYS_NET_RecvMsg(obj, n->rxRing, PIC32MZW1_RX_RING_LEN);
+            if (recv_len <= 0)
+            {
+                break;
+            }
+
+            n->rxLen = recv_len;
+            chunk = recv_len;
+        }
+
+        if (chunk > (len - copied))
+        {
+            chunk = len - copied;
+        }
+
+        memcpy(buffer + copied, &n->rxRing[n->rxRead], chunk);
+
+        n->rxRead += chunk;
+        copied += chunk;
+    }
+
+    /* Report the socket status only if nothing at all could be read */
+    return (copied > 0) ? copied : recv_len;
 }
 
 int pic32mzw1_write(Network* n, unsigned char* buffer, int len, int timeout_ms) 
@@ -99,9 +204,20 @@ int pic32mzw1_write(Network* n, unsigned char* buffer, int len, int timeout_ms)
   return bytes_sent;
 }
 
+void pic32mzw1_rx_reset(Network* n) 
+{
+    /* Bytes left over from a previous connection must not be served to the next one */
+    n->rxRead = 0;
+    n->rxLen = 0;
+}
+
 void pic32mzw1_disconnect(Network* n) 
 {
-    SYS_MODULE_OBJ obj = SYS_MQTT_Paho_GetNetHdlFromNw(n);
+    SYS_MODULE_OBJ obj;
+
+    pic32mzw1_rx_reset(n);
+
+    obj = SYS_MQTT_Paho_GetNetHdlFromNw(n);
 
     if(obj  == SYS_MODULE_OBJ_INVALID)
     {
@@ -120,4 +236,5 @@ void NetworkInit(Network* n)
 	n->mqttread = pic32mzw1_read;
 	n->mqttwrite = pic32mzw1_write;
 	n->disconnect = pic32mzw1_disconnect;
+	pic32mzw1_rx_reset(n);
 }
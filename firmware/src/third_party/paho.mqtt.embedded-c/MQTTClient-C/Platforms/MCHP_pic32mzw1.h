@@ -24,6 +24,12 @@ SUBSTITUTE GOODS, TECHNOLOGY, SERVICES, OR ANY CLAIMS BY THIRD PARTIES
 #ifndef MCHP_PIC32MZW1_H
 #define MCHP_PIC32MZW1_H
 
+#include "osal/osal.h"
+
+/* The client is driven by the MQTT task while other tasks publish and
+   subscribe through it, so every call into it holds the client mutex */
+#define MQTT_TASK
+
 typedef struct Timer Timer;
 
 struct Timer {
@@ -31,6 +37,12 @@ struct Timer {
 	unsigned long end_time;
 };
 
+/* Bytes pulled from the socket in one go, so that the header and remaining
+   length of a packet are served from memory instead of one SYS_NET_RecvMsg() each */
+#ifndef PIC32MZW1_RX_RING_LEN
+#define PIC32MZW1_RX_RING_LEN	256
+#endif
+
 typedef struct Network Network;
 
 struct Network
@@ -40,6 +52,9 @@ struct Network
 	int (*mqttread) (Network*, unsigned char*, int, int);
 	int (*mqttwrite) (Network*, unsigned char*, int, int);
 	void (*disconnect) (Network*);
+	unsigned short rxRead;
+	unsigned short rxLen;
+	unsigned char rxRing[PIC32MZW1_RX_RING_LEN];
 };
 
 char TimerIsExpired(Timer*);
@@ -49,9 +64,30 @@ int TimerLeftMS(Timer*);
 
 void TimerInit(Timer*);
 
+/* The client calls back into itself (e.g. keepalive disconnecting from within
+   cycle) with the mutex held, so the owning task may take it again */
+typedef struct Mutex
+{
+	OSAL_MUTEX_HANDLE_TYPE mutex;
+	TaskHandle_t owner;
+	int count;
+} Mutex;
+
+void MutexInit(Mutex*);
+int MutexLock(Mutex*);
+int MutexUnlock(Mutex*);
+
+typedef struct Thread
+{
+	TaskHandle_t task;
+} Thread;
+
+int ThreadStart(Thread*, void (*fn)(void*), void* arg);
+
 int pic32mzw1_read(Network*, unsigned char*, int, int);
 int pic32mzw1_write(Network*, unsigned char*, int, int);
 void pic32mzw1_disconnect(Network*);
+void pic32mzw1_rx_reset(Network*);
 void NetworkInit(Network* n);
 
 int ConnectNetwork(Network*, char*, int, int);
@@ -74,6 +74,10 @@ void MQTTClientInit(MQTTClient* c, Network* network, unsigned int command_timeou
     c->cleansession = 0;
     c->ping_outstanding = 0;
     c->defaultMessageHandler = NULL;
+    c->ackNotify = NULL;
+    c->ackNotifyCtx = NULL;
+    c->chunkNotify = NULL;
+    c->chunkNotifyCtx = NULL;
 	  c->next_packetid = 1;
     TimerInit(&c->last_sent);
     TimerInit(&c->last_received);
@@ -111,6 +115,92 @@ exit:
 }
 
 
+/* returned by readPacket() once an oversized PUBLISH has been handed to chunkNotify and acknowledged */
+#define PUBLISH_CHUNKED (PUBLISH | 0x80)
+
+
+static int sendPublishAck(MQTTClient* c, enum QoS qos, unsigned short id, Timer* timer)
+{
+    int len = 0;
+
+    if (qos == QOS0)
+        return SUCCESS;
+    len = MQTTSerialize_ack(c->buf, c->buf_size, (qos == QOS1) ? PUBACK : PUBREC, 0, id);
+    if (len <= 0)
+        return FAILURE;
+    return sendPacket(c, len, timer);
+}
+
+
+/* the fixed header is already in readbuf; the topic stays in readbuf while the payload streams through the rest of it */
+static int readPublishChunked(MQTTClient* c, int len, int rem_len, Timer* timer)
+{
+    MQTTHeader header = {0};
+    MQTTString topicName = MQTTString_initializer;
+    MQTTMessage msg;
+    MessageData md;
+    unsigned char* curdata = c->readbuf + len;
+    int topic_len = 0;
+    int hdr_len = 2;
+    size_t offset = 0;
+    size_t total = 0;
+    int rc = FAILURE;
+
+    header.byte = c->readbuf[0];
+    msg.dup = header.bits.dup;
+    msg.qos = (enum QoS)header.bits.qos;
+    msg.retained = header.bits.retain;
+    msg.id = 0;
+
+    /* the topic length tells how much of the variable header is left */
+    if (c->ipstack->mqttread(c->ipstack, curdata, 2, TimerLeftMS(timer)) != 2)
+        goto exit;
+    topic_len = (curdata[0] << 8) + curdata[1];
+    hdr_len += topic_len;
+    if (msg.qos != QOS0)
+        hdr_len += 2;
+    if (hdr_len > rem_len || (len + hdr_len) >= (int)c->readbuf_size)
+    {
+        SYS_CONSOLE_PRINT("Topic does not fit the Read Buffer\r\n");
+        goto exit;
+    }
+    if (c->ipstack->mqttread(c->ipstack, curdata + 2, hdr_len - 2, TimerLeftMS(timer)) != (hdr_len - 2))
+        goto exit;
+    topicName.lenstring.len = topic_len;
+    topicName.lenstring.data = (char*)curdata + 2;
+    if (msg.qos != QOS0)
+        msg.id = (curdata[2 + topic_len] << 8) + curdata[3 + topic_len];
+
+    curdata += hdr_len;
+    total = rem_len - hdr_len;
+    NewMessageData(&md, &topicName, &msg);
+    do
+    {
+        size_t chunk = c->readbuf_size - (curdata - c->readbuf);
+
+        if (chunk > (total - offset))
+            chunk = total - offset;
+        if (chunk > 0 && c->ipstack->mqttread(c->ipstack, curdata, chunk, TimerLeftMS(timer)) != (int)chunk)
+        {
+            SYS_CONSOLE_PRINT("Publish cut short at %d of %d bytes\r\n", offset, total);
+            goto exit;
+        }
+        msg.payload = curdata;
+        msg.payloadlen = chunk;
+        c->chunkNotify(c->chunkNotifyCtx, &md, offset, total);
+        offset += chunk;
+    } while (offset < total);
+
+    if (c->keepAliveInterval > 0)
+        TimerCountdown(&c->last_received, c->keepAliveInterval);
+
+    if (sendPublishAck(c, msg.qos, msg.id, timer) == SUCCESS)
+        rc = PUBLISH_CHUNKED;
+exit:
+    return rc;
+}
+
+
 static int readPacket(MQTTClient* c, Timer* timer)
 {
     MQTTHeader header = {0};
@@ -129,6 +219,12 @@ static int readPacket(MQTTClient* c, Timer* timer)
 
     if (rem_len > (c->readbuf_size - len))
     {
+        header.byte = c->readbuf[0];
+        if (header.bits.type == PUBLISH && c->chunkNotify != NULL)
+        {
+            rc = readPublishChunked(c, len, rem_len, timer);
+            goto exit;
+        }
         rc = BUFFER_OVERFLOW;
         SYS_CONSOLE_PRINT("Buffer Overflow\r\n");
         goto exit;
@@ -286,9 +382,18 @@ int cycle(MQTTClient* c, Timer* timer)
         case 0: /* timed out reading packet */
             break;
         case CONNACK:
-        case PUBACK:
         case SUBACK:
             break;
+        case PUBACK:
+        {
+            unsigned short mypacketid;
+            unsigned char dup, type;
+            if (MQTTDeserialize_ack(&type, &dup, &mypacketid, c->readbuf, c->readbuf_size) != 1)
+                rc = FAILURE;
+            else if (c->ackNotify != NULL)
+                c->ackNotify(c->ackNotifyCtx, PUBACK, mypacketid);
+            break;
+        }
         case PUBLISH:
         {
             MQTTString topicName;
@@ -300,21 +405,13 @@ int cycle(MQTTClient* c, Timer* timer)
                 goto exit;
             msg.qos = (enum QoS)intQoS;
             deliverMessage(c, &topicName, &msg);
-            if (msg.qos != QOS0)
-            {
-                if (msg.qos == QOS1)
-                    len = MQTTSerialize_ack(c->buf, c->buf_size, PUBACK, 0, msg.id);
-                else if (msg.qos == QOS2)
-                    len = MQTTSerialize_ack(c->buf, c->buf_size, PUBREC, 0, msg.id);
-                if (len <= 0)
-                    rc = FAILURE;
-                else
-                    rc = sendPacket(c, len, timer);
-                if (rc == FAILURE)
-                    goto exit; // there was a problem
-            }
+            if ((rc = sendPublishAck(c, msg.qos, msg.id, timer)) == FAILURE)
+                goto exit; // there was a problem
             break;
         }
+        case PUBLISH_CHUNKED:
+            packet_type = PUBLISH;
+            break;
         case PUBREC:
         case PUBREL:
         {
@@ -329,11 +426,21 @@ int cycle(MQTTClient* c, Timer* timer)
                 rc = FAILURE; // there was a problem
             if (rc == FAILURE)
                 goto exit; // there was a problem
+            if ((packet_type == PUBREC) && (c->ackNotify != NULL))
+                c->ackNotify(c->ackNotifyCtx, PUBREC, mypacketid);
             break;
         }
 
         case PUBCOMP:
+        {
+            unsigned short mypacketid;
+            unsigned char dup, type;
+            if (MQTTDeserialize_ack(&type, &dup, &mypacketid, c->readbuf, c->readbuf_size) != 1)
+                rc = FAILURE;
+            else if (c->ackNotify != NULL)
+                c->ackNotify(c->ackNotifyCtx, PUBCOMP, mypacketid);
             break;
+        }
         case PINGRESP:
             c->ping_outstanding = 0;
             break;
@@ -370,6 +477,9 @@ int MQTTYield(MQTTClient* c, int timeout_ms)
     TimerInit(&timer);
     TimerCountdownMS(&timer, timeout_ms);
 
+#if defined(MQTT_TASK)
+	  MutexLock(&c->mutex);
+#endif
 	  do
     {
         if (cycle(c, &timer) < 0)
@@ -378,6 +488,9 @@ int MQTTYield(MQTTClient* c, int timeout_ms)
             break;
         }
   	} while (!TimerIsExpired(&timer));
+#if defined(MQTT_TASK)
+	  MutexUnlock(&c->mutex);
+#endif
 
     return rc;
 }
@@ -793,10 +906,11 @@ int MQTTPublish(MQTTClient* c, const char* topicName, MQTTMessage* message)
     TimerInit(&timer);
     TimerCountdownMS(&timer, c->command_timeout_ms);
 
-    if (message->qos == QOS1 || message->qos == QOS2)
+    /* a retransmission (dup set) keeps the packet id it was first sent with */
+    if ((message->qos == QOS1 || message->qos == QOS2) && (message->dup == 0))
         message->id = getNextPacketId(c);
 
-    len = MQTTSerialize_publish(c->buf, c->buf_size, 0, message->qos, message->retained, message->id,
+    len = MQTTSerialize_publish(c->buf, c->buf_size, message->dup, message->qos, message->retained, message->id,
               topic, (unsigned char*)message->payload, message->payloadlen);
     if (len <= 0)
     {
@@ -843,6 +957,47 @@ exit:
     return rc;
 }
 
+int MQTTSetAckHandler(MQTTClient* c, ackHandler handler, void* ctx)
+{
+    c->ackNotify = handler;
+    c->ackNotifyCtx = ctx;
+    return SUCCESS;
+}
+
+
+int MQTTSetChunkHandler(MQTTClient* c, chunkHandler handler, void* ctx)
+{
+    c->chunkNotify = handler;
+    c->chunkNotifyCtx = ctx;
+    return SUCCESS;
+}
+
+
+int MQTTPubrel(MQTTClient* c, unsigned short packetid)
+{
+    int rc = FAILURE;
+    Timer timer;
+    int len = 0;
+
+#if defined(MQTT_TASK)
+	  MutexLock(&c->mutex);
+#endif
+    if (!c->isconnected)
+        goto exit;
+
+    TimerInit(&timer);
+    TimerCountdownMS(&timer, c->command_timeout_ms);
+
+    if ((len = MQTTSerialize_ack(c->buf, c->buf_size, PUBREL, 0, packetid)) <= 0)
+        goto exit;
+    rc = sendPacket(c, len, &timer); // resend the PUBREL packet
+exit:
+#if defined(MQTT_TASK)
+	  MutexUnlock(&c->mutex);
+#endif
+    return rc;
+}
+
 #ifndef MQTT_BLOCKING
 int MQTTWaitForPublishAck(MQTTClient* c, MQTTMessage* message)
 {
@@ -896,10 +1051,16 @@ int MQTTWaitForPublish(MQTTClient* c)
     if (!c->isconnected)
     	return FAILURE;
 
+#if defined(MQTT_TASK)
+	  MutexLock(&c->mutex);
+#endif
     if (waitfor(c, PUBLISH, NULL) == PUBLISH)
     {
         rc = SUCCESS;
     }
+#if defined(MQTT_TASK)
+	  MutexUnlock(&c->mutex);
+#endif
 
 	return rc;
 }
@@ -110,6 +110,12 @@ typedef struct MQTTSubackData
 
 typedef void (*messageHandler)(MessageData*);
 
+/* Called from cycle() with the packet type (PUBACK, PUBREC or PUBCOMP) and packet id of every publish acknowledgement */
+typedef void (*ackHandler)(void* ctx, int packetType, unsigned short packetId);
+
+/* Called from cycle() for each piece of a publish too large for readbuf; the payload is only valid during the call */
+typedef void (*chunkHandler)(void* ctx, MessageData* md, size_t offset, size_t totalLen);
+
 typedef struct MQTTClient
 {
     unsigned int next_packetid,
@@ -131,6 +137,12 @@ typedef struct MQTTClient
 
     void (*defaultMessageHandler) (MessageData*);
 
+    ackHandler ackNotify;
+    void* ackNotifyCtx;
+
+    chunkHandler chunkNotify;
+    void* chunkNotifyCtx;
+
     Network* ipstack;
     Timer last_sent, last_received;
 #if defined(MQTT_TASK)
@@ -220,6 +232,31 @@ DLLExport int MQTTDisconnect(MQTTClient* client);
  */
 DLLExport int MQTTYield(MQTTClient* client, int time);
 
+/** MQTT SetAckHandler - register a handler notified of every PUBACK/PUBREC/PUBCOMP received,
+ *  so that several QoS 1/2 publishes can be outstanding at the same time.
+ *  @param client - the client object to use
+ *  @param handler - the handler, or NULL to remove it
+ *  @param ctx - opaque pointer passed back to the handler
+ *  @return success code
+ */
+DLLExport int MQTTSetAckHandler(MQTTClient* client, ackHandler handler, void* ctx);
+
+/** MQTT SetChunkHandler - register a handler that receives the payload of publishes larger than
+ *  the read buffer piece by piece, instead of the packet being dropped
+ *  @param client - the client object to use
+ *  @param handler - the handler, or NULL to remove it
+ *  @param ctx - opaque pointer passed back to the handler
+ *  @return success code
+ */
+DLLExport int MQTTSetChunkHandler(MQTTClient* client, chunkHandler handler, void* ctx);
+
+/** MQTT Pubrel - retransmit the PUBREL of a QoS 2 publish whose PUBCOMP is overdue
+ *  @param client - the client object to use
+ *  @param packetid - the packet id of the publish
+ *  @return success code
+ */
+DLLExport int MQTTPubrel(MQTTClient* client, unsigned short packetid);
+
 int MQTTWaitForConnect(MQTTClient* c);
 int MQTTWaitForSubscribeAck(MQTTClient* c, const char* topicFilter, messageHandler messageHandler);
 int MQTTWaitForPublishAck(MQTTClient* c, MQTTMessage* message);